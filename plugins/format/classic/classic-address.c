@@ -0,0 +1,476 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <libprelude/idmef.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+
+#include "classic-address.h"
+
+
+/*
+ * Addresses are packed as 16 bytes in network order, IPv4 addresses being
+ * mapped to ::ffff:0:0/96. Byte wise comparison of the packed value then
+ * follows the numeric order, so that a subnet is a contiguous range any
+ * B-tree index can scan.
+ */
+
+
+static int parse_decimal(const char **str, unsigned int max, unsigned int *out)
+{
+        const char *ptr = *str;
+        unsigned int value = 0;
+
+        if ( *ptr < '0' || *ptr > '9' )
+                return -1;
+
+        while ( *ptr >= '0' && *ptr <= '9' ) {
+                value = value * 10 + (*ptr++ - '0');
+                if ( value > max )
+                        return -1;
+        }
+
+        *str = ptr;
+        *out = value;
+
+        return 0;
+}
+
+
+
+static int parse_ipv4(const char **str, unsigned char *out)
+{
+        int i, ret;
+        unsigned int value;
+
+        for ( i = 0; i < 4; i++ ) {
+                if ( i > 0 && *(*str)++ != '.' )
+                        return -1;
+
+                ret = parse_decimal(str, 255, &value);
+                if ( ret < 0 )
+                        return ret;
+
+                out[i] = value;
+        }
+
+        return 0;
+}
+
+
+
+static int hex_value(char c)
+{
+        if ( c >= '0' && c <= '9' )
+                return c - '0';
+
+        if ( c >= 'a' && c <= 'f' )
+                return c - 'a' + 10;
+
+        if ( c >= 'A' && c <= 'F' )
+                return c - 'A' + 10;
+
+        return -1;
+}
+
+
+
+static int parse_ipv6(const char **str, unsigned char *out)
+{
+        int digit;
+        const char *ptr = *str;
+        unsigned int value, len, i, ngroup = 0, gap = 16;
+
+        memset(out, 0, CLASSIC_ADDRESS_SIZE);
+
+        if ( ptr[0] == ':' ) {
+                if ( ptr[1] != ':' )
+                        return -1;
+
+                gap = 0;
+                ptr += 2;
+        }
+
+        while ( *ptr && *ptr != '/' && ngroup < 16 ) {
+                /*
+                 * A trailing dotted quad stands for the last two groups.
+                 */
+                len = strcspn(ptr, ":/");
+                if ( ngroup <= 12 && memchr(ptr, '.', len) ) {
+                        if ( parse_ipv4(&ptr, &out[ngroup]) < 0 )
+                                return -1;
+
+                        ngroup += 4;
+                        break;
+                }
+
+                for ( value = 0, len = 0; (digit = hex_value(*ptr)) >= 0 && len < 4; ptr++, len++ )
+                        value = (value << 4) | digit;
+
+                if ( len == 0 )
+                        return -1;
+
+                out[ngroup++] = value >> 8;
+                out[ngroup++] = value & 0xff;
+
+                if ( *ptr != ':' )
+                        break;
+
+                if ( ptr[1] == ':' ) {
+                        if ( gap != 16 )
+                                return -1;
+
+                        gap = ngroup;
+                        ptr += 2;
+                }
+
+                else if ( ! *++ptr || *ptr == '/' )
+                        return -1;
+        }
+
+        if ( gap == 16 ) {
+                if ( ngroup != 16 )
+                        return -1;
+        }
+
+        else {
+                if ( ngroup > 14 )
+                        return -1;
+
+                len = ngroup - gap;
+                for ( i = 0; i < len; i++ ) {
+                        out[15 - i] = out[ngroup - 1 - i];
+                        out[ngroup - 1 - i] = 0;
+                }
+        }
+
+        *str = ptr;
+
+        return 0;
+}
+
+
+
+/*
+ * Parse an IPv4 or IPv6 address, optionally followed by a /prefix length,
+ * and set @low and @high to the first and last packed address it covers.
+ */
+int classic_address_parse(const char *str, unsigned char *low, unsigned char *high)
+{
+        int ret;
+        unsigned int i, prefix, bits;
+
+        if ( strchr(str, ':') ) {
+                ret = parse_ipv6(&str, low);
+                bits = 128;
+        }
+
+        else {
+                memset(low, 0, 10);
+                low[10] = low[11] = 0xff;
+
+                ret = parse_ipv4(&str, &low[12]);
+                bits = 32;
+        }
+
+        if ( ret < 0 )
+                return ret;
+
+        prefix = bits;
+        if ( *str == '/' ) {
+                str++;
+
+                ret = parse_decimal(&str, bits, &prefix);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( *str )
+                return -1;
+
+        prefix += 128 - bits;
+        memcpy(high, low, CLASSIC_ADDRESS_SIZE);
+
+        for ( i = 0; i < CLASSIC_ADDRESS_SIZE; i++ ) {
+                if ( prefix >= 8 ) {
+                        prefix -= 8;
+                        continue;
+                }
+
+                low[i] &= 0xff << (8 - prefix) & 0xff;
+                high[i] |= 0xff >> prefix;
+                prefix = 0;
+        }
+
+        return 0;
+}
+
+
+
+/*
+ * Escape the packed form of @str, for storage alongside its textual form.
+ * Anything that is not an IP address (hostname, MAC, ...) is stored as NULL.
+ */
+int classic_address_escape(preludedb_sql_t *sql, const char *str, char **output)
+{
+        unsigned char low[CLASSIC_ADDRESS_SIZE], high[CLASSIC_ADDRESS_SIZE];
+
+        if ( ! str || classic_address_parse(str, low, high) < 0 ) {
+                *output = strdup("NULL");
+                return *output ? 0 : preludedb_error_from_errno(errno);
+        }
+
+        return preludedb_sql_escape_binary(sql, low, sizeof(low), output);
+}
+
+
+
+/*
+ * Whether @path designates an address.address, which has a packed column.
+ */
+prelude_bool_t classic_address_is_address_path(const idmef_path_t *path)
+{
+        unsigned int depth = idmef_path_get_depth(path);
+
+        return depth > 2 && idmef_path_get_class(path, depth - 2) == IDMEF_CLASS_ID_ADDRESS &&
+               strcmp(idmef_path_get_name(path, depth - 1), "address") == 0;
+}
+
+
+
+static const char *get_string_value(idmef_criterion_value_t *value)
+{
+        const idmef_value_t *fixed;
+
+        if ( idmef_criterion_value_get_type(value) != IDMEF_CRITERION_VALUE_TYPE_VALUE )
+                return NULL;
+
+        fixed = idmef_criterion_value_get_value(value);
+        if ( idmef_value_get_type(fixed) != IDMEF_VALUE_TYPE_STRING )
+                return NULL;
+
+        return prelude_string_get_string(idmef_value_get_string(fixed));
+}
+
+
+
+/*
+ * Translate subnet and ordering criteria on an address into range
+ * predicates on its packed column @field. Equality with a single address
+ * is left to the textual column, which also matches rows stored before
+ * the packed column existed.
+ *
+ * Returns: 1 if the criterion was built, 0 if the caller should fall back
+ * to a textual comparison, or a negative value if an error occur.
+ */
+int classic_address_build_criterion_string(preludedb_sql_t *sql, prelude_string_t *output, const char *field,
+                                           idmef_criterion_operator_t operator, idmef_criterion_value_t *value)
+{
+        int ret;
+        const char *str;
+        char *low_str, *high_str;
+        prelude_bool_t single;
+        unsigned char low[CLASSIC_ADDRESS_SIZE], high[CLASSIC_ADDRESS_SIZE];
+
+        str = get_string_value(value);
+        if ( ! str || classic_address_parse(str, low, high) < 0 )
+                return 0;
+
+        single = (memcmp(low, high, sizeof(low)) == 0);
+
+        if ( (operator == IDMEF_CRITERION_OPERATOR_EQUAL || operator == IDMEF_CRITERION_OPERATOR_NOT_EQUAL) && single )
+                return 0;
+
+        if ( operator != IDMEF_CRITERION_OPERATOR_EQUAL && operator != IDMEF_CRITERION_OPERATOR_NOT_EQUAL &&
+             operator != IDMEF_CRITERION_OPERATOR_LESSER && operator != IDMEF_CRITERION_OPERATOR_LESSER_OR_EQUAL &&
+             operator != IDMEF_CRITERION_OPERATOR_GREATER && operator != IDMEF_CRITERION_OPERATOR_GREATER_OR_EQUAL )
+                return 0;
+
+        ret = preludedb_sql_escape_binary(sql, low, sizeof(low), &low_str);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_escape_binary(sql, high, sizeof(high), &high_str);
+        if ( ret < 0 ) {
+                free(low_str);
+                return ret;
+        }
+
+        if ( operator == IDMEF_CRITERION_OPERATOR_EQUAL )
+                ret = prelude_string_sprintf(output, "%s BETWEEN %s AND %s", field, low_str, high_str);
+
+        else if ( operator == IDMEF_CRITERION_OPERATOR_NOT_EQUAL )
+                ret = prelude_string_sprintf(output, "(%s IS NULL OR %s NOT BETWEEN %s AND %s)",
+                                             field, field, low_str, high_str);
+
+        else if ( operator == IDMEF_CRITERION_OPERATOR_LESSER )
+                ret = prelude_string_sprintf(output, "%s < %s", field, low_str);
+
+        else if ( operator == IDMEF_CRITERION_OPERATOR_LESSER_OR_EQUAL )
+                ret = prelude_string_sprintf(output, "%s <= %s", field, high_str);
+
+        else if ( operator == IDMEF_CRITERION_OPERATOR_GREATER )
+                ret = prelude_string_sprintf(output, "%s > %s", field, high_str);
+
+        else
+                ret = prelude_string_sprintf(output, "%s >= %s", field, low_str);
+
+        free(low_str);
+        free(high_str);
+
+        return (ret < 0) ? ret : 1;
+}
+
+
+
+static int backfill_row(preludedb_sql_t *sql, preludedb_sql_row_t *row)
+{
+        int ret;
+        char *bin;
+        unsigned int i;
+        preludedb_sql_field_t *field[5];
+        unsigned char low[CLASSIC_ADDRESS_SIZE], high[CLASSIC_ADDRESS_SIZE];
+
+        for ( i = 0; i < 5; i++ ) {
+                ret = preludedb_sql_row_get_field(row, i, &field[i]);
+                if ( ret <= 0 )
+                        return ret;
+        }
+
+        if ( classic_address_parse(preludedb_sql_field_get_value(field[4]), low, high) < 0 )
+                return 0;
+
+        ret = preludedb_sql_escape_binary(sql, low, sizeof(low), &bin);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_query_sprintf(sql, NULL,
+                                          "UPDATE Prelude_Address SET _address_bin = %s WHERE _parent_type = '%s' AND "
+                                          "_message_ident = %s AND _parent0_index = %s AND _index = %s",
+                                          bin, preludedb_sql_field_get_value(field[0]), preludedb_sql_field_get_value(field[1]),
+                                          preludedb_sql_field_get_value(field[2]), preludedb_sql_field_get_value(field[3]));
+        free(bin);
+
+        return ret;
+}
+
+
+
+static int get_backfill_end(preludedb_sql_t *sql, uint64_t cursor, unsigned int count, uint64_t *end)
+{
+        int ret;
+        preludedb_sql_row_t *row;
+        preludedb_sql_field_t *field;
+        preludedb_sql_table_t *table;
+
+        ret = preludedb_sql_query_sprintf(sql, &table,
+                                          "SELECT MAX(_message_ident) FROM (SELECT _message_ident FROM Prelude_Address "
+                                          "WHERE _parent_type IN ('A', 'H', 'S', 'T') AND _address_bin IS NULL AND "
+                                          "_message_ident > %" PRELUDE_PRIu64 " ORDER BY _message_ident LIMIT %u) AS batch",
+                                          cursor, count);
+        if ( ret <= 0 )
+                return ret;
+
+        ret = preludedb_sql_table_fetch_row(table, &row);
+        if ( ret > 0 )
+                ret = preludedb_sql_row_get_field(row, 0, &field);
+
+        if ( ret > 0 )
+                ret = preludedb_sql_field_to_uint64(field, end);
+
+        preludedb_sql_table_destroy(table);
+
+        return (ret < 0) ? ret : (ret > 0);
+}
+
+
+
+/*
+ * Fill the packed column of addresses stored before it existed, which
+ * the update scripts cannot do on every backend, for the messages
+ * following *@cursor. A batch covers about @count addresses, in whole
+ * messages, and is committed on its own; *@cursor is then moved past it.
+ * Addresses that are not IP addresses are left NULL, which is why the
+ * cursor is needed for the scan to move forward.
+ *
+ * Returns 1 if a batch was processed, 0 once no address is left.
+ */
+int classic_address_backfill(preludedb_sql_t *sql, uint64_t *cursor, unsigned int count)
+{
+        int ret;
+        uint64_t end;
+        preludedb_sql_row_t *row;
+        preludedb_sql_table_t *table;
+
+        ret = get_backfill_end(sql, *cursor, count, &end);
+        if ( ret <= 0 )
+                return ret;
+
+        ret = preludedb_sql_query_sprintf(sql, &table,
+                                          "SELECT _parent_type, _message_ident, _parent0_index, _index, address "
+                                          "FROM Prelude_Address WHERE _parent_type IN ('A', 'H', 'S', 'T') AND _address_bin IS NULL "
+                                          "AND _message_ident > %" PRELUDE_PRIu64 " AND _message_ident <= %" PRELUDE_PRIu64,
+                                          *cursor, end);
+        if ( ret < 0 )
+                return ret;
+
+        if ( ret == 0 ) {
+                *cursor = end;
+                return 1;
+        }
+
+        ret = preludedb_sql_transaction_start(sql);
+        if ( ret < 0 ) {
+                preludedb_sql_table_destroy(table);
+                return ret;
+        }
+
+        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+                ret = backfill_row(sql, row);
+                if ( ret < 0 )
+                        break;
+        }
+
+        preludedb_sql_table_destroy(table);
+
+        if ( ret < 0 ) {
+                preludedb_sql_transaction_abort(sql);
+                return ret;
+        }
+
+        ret = preludedb_sql_transaction_end(sql);
+        if ( ret < 0 )
+                return ret;
+
+        *cursor = end;
+
+        return 1;
+}
@@ -0,0 +1,497 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <libprelude/prelude.h>
+
+#include "glthread/lock.h"
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+#include "preludedb-path-selection.h"
+#include "preludedb.h"
+
+#include "classic-sql-join.h"
+#include "classic-advisor.h"
+
+
+/*
+ * The advisor keeps count of the criteria shapes resolved by the plugin:
+ * for each table a query filters on, the set of columns compared for
+ * equality and the column compared against a range, which is what
+ * a composite index serves best when ordered the same way.
+ *
+ * Format plugins have no per database state, so the registry is shared
+ * by every database opened in the process, and bounded.
+ */
+#define MAX_SHAPE_ENTRIES 256
+#define MAX_SHAPE_TABLES  8
+#define MAX_EQUAL_COLUMNS 4
+#define NAME_SIZE         32
+
+
+typedef struct {
+        char table[NAME_SIZE];
+        char parent_type;
+        unsigned int nequal;
+        char equal[MAX_EQUAL_COLUMNS][NAME_SIZE];
+        char range[NAME_SIZE];
+} table_shape_t;
+
+
+struct classic_advisor_shape {
+        prelude_bool_t disjunctive;
+        unsigned int ntable;
+        const void *owner[MAX_SHAPE_TABLES];
+        table_shape_t tables[MAX_SHAPE_TABLES];
+};
+
+
+typedef struct {
+        table_shape_t shape;
+        unsigned long count;
+} shape_entry_t;
+
+
+typedef struct {
+        const char *table;
+        const char *columns[3];
+} schema_index_t;
+
+
+/*
+ * Indexes created by the schema, leaving out the _parent_type and _index
+ * columns, which the join constraints already provide.
+ */
+static const schema_index_t schema_indexes[] = {
+        { "Prelude_Alert", { "messageid" } },
+        { "Prelude_Analyzer", { "analyzerid" } },
+        { "Prelude_Analyzer", { "model" } },
+        { "Prelude_Classification", { "text" } },
+        { "Prelude_Reference", { "name" } },
+        { "Prelude_Impact", { "severity" } },
+        { "Prelude_Impact", { "completion" } },
+        { "Prelude_Impact", { "type" } },
+        { "Prelude_CreateTime", { "time" } },
+        { "Prelude_DetectTime", { "time" } },
+        { "Prelude_AnalyzerTime", { "time" } },
+        { "Prelude_Node", { "location" } },
+        { "Prelude_Node", { "name" } },
+        { "Prelude_Address", { "address" } },
+        { "Prelude_Address", { "_address_bin" } },
+        { "Prelude_Service", { "protocol", "port" } },
+        { "Prelude_Service", { "protocol", "name" } },
+};
+
+
+/*
+ * Columns of a type that cannot be part of an index on every database.
+ */
+static const schema_index_t unindexable_columns[] = {
+        { "Prelude_Impact", { "description" } },
+        { "Prelude_AdditionalData", { "data" } },
+        { "Prelude_OverflowAlert", { "buffer" } },
+};
+
+
+static unsigned int shape_entry_count = 0;
+static shape_entry_t shape_entries[MAX_SHAPE_ENTRIES];
+gl_lock_define_initialized(static, shape_entries_lock);
+
+
+
+int classic_advisor_shape_new(classic_advisor_shape_t **shape)
+{
+        *shape = calloc(1, sizeof(**shape));
+        if ( ! *shape )
+                return preludedb_error_from_errno(errno);
+
+        return 0;
+}
+
+
+
+void classic_advisor_shape_destroy(classic_advisor_shape_t *shape)
+{
+        free(shape);
+}
+
+
+
+/*
+ * A disjunction cannot be served by a single composite index: the shape is
+ * not recorded at all.
+ */
+void classic_advisor_shape_set_disjunctive(classic_advisor_shape_t *shape)
+{
+        shape->disjunctive = TRUE;
+}
+
+
+
+static prelude_bool_t is_indexable(const char *table, const char *column)
+{
+        size_t i;
+
+        if ( strlen(column) >= NAME_SIZE || strspn(column, "abcdefghijklmnopqrstuvwxyz_0123456789") != strlen(column) )
+                return FALSE;
+
+        for ( i = 0; i < sizeof(unindexable_columns) / sizeof(*unindexable_columns); i++ ) {
+                if ( strcmp(unindexable_columns[i].table, table) == 0 &&
+                     strcmp(unindexable_columns[i].columns[0], column) == 0 )
+                        return FALSE;
+        }
+
+        return TRUE;
+}
+
+
+
+static table_shape_t *get_table_shape(classic_advisor_shape_t *shape, const idmef_path_t *path,
+                                      classic_sql_joined_table_t *table)
+{
+        unsigned int i;
+        const char *name;
+        table_shape_t *tshape;
+
+        for ( i = 0; i < shape->ntable; i++ ) {
+                if ( shape->owner[i] == table )
+                        return &shape->tables[i];
+        }
+
+        if ( shape->ntable == MAX_SHAPE_TABLES )
+                return NULL;
+
+        if ( table )
+                name = classic_sql_joined_table_get_table_name(table);
+
+        else if ( idmef_path_get_class(path, 0) == IDMEF_CLASS_ID_HEARTBEAT )
+                name = "Prelude_Heartbeat";
+
+        else
+                name = "Prelude_Alert";
+
+        if ( strlen(name) >= NAME_SIZE )
+                return NULL;
+
+        tshape = &shape->tables[shape->ntable];
+        shape->owner[shape->ntable++] = table;
+
+        strcpy(tshape->table, name);
+        tshape->parent_type = table ? classic_sql_joined_table_get_parent_type(table) : 0;
+
+        return tshape;
+}
+
+
+
+/*
+ * Record that @field, the resolved column of @path in @table (NULL for
+ * the top level message table), is compared using @operator.
+ */
+void classic_advisor_shape_add_criterion(classic_advisor_shape_t *shape, const idmef_path_t *path,
+                                         classic_sql_joined_table_t *table, const char *field,
+                                         idmef_criterion_operator_t operator, idmef_criterion_value_t *value)
+{
+        unsigned int i;
+        const char *column;
+        table_shape_t *tshape;
+        idmef_criterion_value_type_t vtype;
+
+        if ( shape->disjunctive )
+                return;
+
+        /*
+         * Negations, case insensitive and pattern matches do not make use
+         * of a B-tree index, and neither do broken down time values, which
+         * compare extracted fields.
+         */
+        if ( operator & (IDMEF_CRITERION_OPERATOR_NOT|IDMEF_CRITERION_OPERATOR_NOCASE|IDMEF_CRITERION_OPERATOR_SUBSTR|
+                         IDMEF_CRITERION_OPERATOR_REGEX|IDMEF_CRITERION_OPERATOR_NULL) )
+                return;
+
+        vtype = idmef_criterion_value_get_type(value);
+        if ( vtype != IDMEF_CRITERION_VALUE_TYPE_VALUE && vtype != IDMEF_CRITERION_VALUE_TYPE_LIST )
+                return;
+
+        column = strchr(field, '.');
+        if ( ! column )
+                return;
+
+        tshape = get_table_shape(shape, path, table);
+        if ( ! tshape || ! is_indexable(tshape->table, ++column) )
+                return;
+
+        if ( strcmp(tshape->range, column) == 0 )
+                return;
+
+        for ( i = 0; i < tshape->nequal; i++ ) {
+                if ( strcmp(tshape->equal[i], column) == 0 )
+                        return;
+        }
+
+        if ( operator & (IDMEF_CRITERION_OPERATOR_LESSER|IDMEF_CRITERION_OPERATOR_GREATER) ) {
+                if ( ! *tshape->range )
+                        strcpy(tshape->range, column);
+        }
+
+        else if ( operator == IDMEF_CRITERION_OPERATOR_EQUAL && tshape->nequal < MAX_EQUAL_COLUMNS )
+                strcpy(tshape->equal[tshape->nequal++], column);
+}
+
+
+
+static int cmp_column(const void *a, const void *b)
+{
+        return strcmp(a, b);
+}
+
+
+
+static void record_table_shape(table_shape_t *tshape)
+{
+        unsigned int i;
+
+        if ( ! tshape->nequal && ! *tshape->range )
+                return;
+
+        qsort(tshape->equal, tshape->nequal, sizeof(*tshape->equal), cmp_column);
+
+        for ( i = 0; i < shape_entry_count; i++ ) {
+                if ( memcmp(&shape_entries[i].shape, tshape, sizeof(*tshape)) == 0 ) {
+                        shape_entries[i].count++;
+                        return;
+                }
+        }
+
+        if ( shape_entry_count == MAX_SHAPE_ENTRIES )
+                return;
+
+        memcpy(&shape_entries[shape_entry_count].shape, tshape, sizeof(*tshape));
+        shape_entries[shape_entry_count++].count = 1;
+}
+
+
+
+void classic_advisor_shape_commit(classic_advisor_shape_t *shape)
+{
+        unsigned int i;
+
+        if ( shape->disjunctive )
+                return;
+
+        gl_lock_lock(shape_entries_lock);
+
+        for ( i = 0; i < shape->ntable; i++ )
+                record_table_shape(&shape->tables[i]);
+
+        gl_lock_unlock(shape_entries_lock);
+}
+
+
+
+static prelude_bool_t has_equal_column(const table_shape_t *tshape, const char *column)
+{
+        unsigned int i;
+
+        for ( i = 0; i < tshape->nequal; i++ ) {
+                if ( strcmp(tshape->equal[i], column) == 0 )
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
+
+
+/*
+ * Whether an index from the schema starts with the equality columns of
+ * @tshape, in any order, followed by its range column.
+ */
+static prelude_bool_t is_covered_by_schema(const table_shape_t *tshape)
+{
+        size_t i;
+        unsigned int j, ncolumn;
+        const schema_index_t *index;
+
+        for ( i = 0; i < sizeof(schema_indexes) / sizeof(*schema_indexes); i++ ) {
+                index = &schema_indexes[i];
+                if ( strcmp(index->table, tshape->table) != 0 )
+                        continue;
+
+                ncolumn = tshape->nequal + (*tshape->range ? 1 : 0);
+                if ( ncolumn > sizeof(index->columns) / sizeof(*index->columns) )
+                        continue;
+
+                for ( j = 0; j < tshape->nequal; j++ ) {
+                        if ( ! index->columns[j] || ! has_equal_column(tshape, index->columns[j]) )
+                                break;
+                }
+
+                if ( j < tshape->nequal )
+                        continue;
+
+                if ( ! *tshape->range || (index->columns[j] && strcmp(index->columns[j], tshape->range) == 0) )
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
+
+
+static int cmp_entry(const void *a, const void *b)
+{
+        const shape_entry_t *ea = a, *eb = b;
+
+        if ( ea->count == eb->count )
+                return 0;
+
+        return (ea->count > eb->count) ? -1 : 1;
+}
+
+
+
+static unsigned long hash_string(unsigned long hash, const char *str)
+{
+        while ( *str )
+                hash = hash * 33 + (unsigned char) *str++;
+
+        return hash;
+}
+
+
+
+static int build_columns(const table_shape_t *tshape, prelude_string_t *output)
+{
+        int ret;
+        unsigned int i;
+
+        for ( i = 0; i < tshape->nequal; i++ ) {
+                ret = prelude_string_sprintf(output, "%s%s", (i > 0) ? ", " : "", tshape->equal[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( *tshape->range ) {
+                ret = prelude_string_sprintf(output, "%s%s", (i > 0) ? ", " : "", tshape->range);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        /*
+         * Carry the message identifier, so that the join back to the
+         * message table does not have to read the indexed table itself.
+         */
+        if ( strcmp(tshape->table, "Prelude_Alert") == 0 || strcmp(tshape->table, "Prelude_Heartbeat") == 0 )
+                return prelude_string_cat(output, ", _ident");
+
+        return prelude_string_cat(output, ", _message_ident");
+}
+
+
+
+static int build_advice(preludedb_sql_t *sql, const shape_entry_t *entry, prelude_string_t *output)
+{
+        int ret;
+        unsigned long hash;
+        prelude_string_t *columns;
+        char name[32], parent_type[4] = { '\'', 0, '\'', 0 };
+        const table_shape_t *tshape = &entry->shape;
+
+        ret = prelude_string_new(&columns);
+        if ( ret < 0 )
+                return ret;
+
+        ret = build_columns(tshape, columns);
+        if ( ret < 0 )
+                goto error;
+
+        parent_type[1] = tshape->parent_type;
+
+        hash = hash_string(5381, tshape->table);
+        hash = hash_string(hash, parent_type);
+        hash = hash_string(hash, prelude_string_get_string(columns));
+        snprintf(name, sizeof(name), "prelude_advice_%08lx", hash & 0xffffffff);
+
+        ret = prelude_string_sprintf(output, "-- %lu queries\n", entry->count);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_build_create_index_string(sql, name, tshape->table, prelude_string_get_string(columns),
+                                                      tshape->parent_type ? "_parent_type" : NULL,
+                                                      tshape->parent_type ? parent_type : NULL, output);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(output, ";\n");
+
+ error:
+        prelude_string_destroy(columns);
+        return ret;
+}
+
+
+
+/*
+ * Recommend an index for each of the @max most frequent table shapes not
+ * already served by the schema, most frequent first.
+ */
+int classic_advisor_get_index_advice(preludedb_t *db, unsigned int max, prelude_string_t *output)
+{
+        int ret = 0;
+        shape_entry_t *entries;
+        unsigned int i, count, nadvice = 0;
+
+        entries = malloc(MAX_SHAPE_ENTRIES * sizeof(*entries));
+        if ( ! entries )
+                return preludedb_error_from_errno(errno);
+
+        gl_lock_lock(shape_entries_lock);
+        count = shape_entry_count;
+        memcpy(entries, shape_entries, count * sizeof(*entries));
+        gl_lock_unlock(shape_entries_lock);
+
+        qsort(entries, count, sizeof(*entries), cmp_entry);
+
+        for ( i = 0; i < count && nadvice < max; i++ ) {
+                if ( is_covered_by_schema(&entries[i].shape) )
+                        continue;
+
+                ret = build_advice(preludedb_get_sql(db), &entries[i], output);
+                if ( ret < 0 )
+                        break;
+
+                nadvice++;
+        }
+
+        free(entries);
+
+        return (ret < 0) ? ret : (int) nadvice;
+}
@@ -0,0 +1,1093 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql.h"
+#include "preludedb-path-selection.h"
+#include "preludedb.h"
+
+#include "classic-approx.h"
+#include "classic-sketch.h"
+
+
+/*
+ * When the SQL plugin cannot compute approx_count_distinct() or
+ * percentile() itself, the raw values are selected and the aggregates
+ * are computed here, in a single pass over the rows and in bounded
+ * memory per group:
+ *
+ * - approx_count_distinct() uses a HyperLogLog sketch,
+ * - percentile() uses the P-square estimator of Jain and Chlamtac,
+ * - topk() keeps TOPK_CAPACITY_FACTOR * k groups with the space-saving
+ *   algorithm, so that the number of groups does not grow with the
+ *   number of distinct values.
+ *
+ * Each group keeps the first row it was seen with to output its key
+ * columns, other rows are released as soon as they are accounted for.
+ *
+ * The same grouping merges the partial aggregates of a selection run
+ * over disjoint ranges of messages (see classic_approx_new_merged()):
+ * counts are summed, and the row holding the lowest or highest value is
+ * kept for min() and max().
+ */
+#define TOPK_CAPACITY_FACTOR 8
+#define GROUP_BUCKETS_MIN 64
+
+
+int classic_get_value(preludedb_sql_t *sql, preludedb_sql_row_t *row, int cnt, preludedb_selected_path_t *selected,
+                      preludedb_result_values_get_field_cb_func_t cb, void **out);
+
+
+typedef enum {
+        COLUMN_KEY,
+        COLUMN_COUNT,
+        COLUMN_APPROX_COUNT_DISTINCT,
+        COLUMN_PERCENTILE,
+        COLUMN_MIN,
+        COLUMN_MAX
+} column_type_t;
+
+
+typedef struct {
+        column_type_t type;
+        preludedb_selected_path_t *selected;
+        preludedb_selected_path_flags_t flags;
+        unsigned int position;
+        unsigned int ncolumns;
+        double quantile;
+} approx_column_t;
+
+
+typedef struct {
+        uint64_t count;
+        uint8_t *registers;
+        classic_p2_t p2;
+        preludedb_sql_row_t *row;
+
+        prelude_bool_t is_null;
+        double value;
+} approx_aggregate_t;
+
+
+typedef struct approx_group {
+        struct approx_group *next;
+        classic_approx_t *approx;
+
+        uint64_t hash;
+        char *key;
+        size_t keylen;
+
+        preludedb_sql_row_t *row;
+
+        uint64_t hits;
+        uint64_t error;
+        uint64_t serial;
+        size_t index;
+
+        approx_aggregate_t aggregates[];
+} approx_group_t;
+
+
+struct classic_approx {
+        preludedb_sql_table_t **tables;
+        unsigned int ntables;
+        prelude_bool_t merge;
+
+        approx_column_t *columns;
+        unsigned int ncolumns;
+        prelude_bool_t has_key;
+        prelude_bool_t has_order;
+
+        size_t topk;
+        size_t capacity;
+
+        approx_group_t **buckets;
+        size_t nbuckets;
+
+        approx_group_t **groups;
+        size_t ngroups;
+        size_t groups_size;
+        uint64_t serial;
+
+        approx_group_t **rows;
+        size_t nrows;
+        size_t cursor;
+};
+
+
+
+static int get_param(preludedb_selected_object_t *object)
+{
+        preludedb_selected_object_t *arg;
+
+        arg = preludedb_selected_object_get_arg(object, 1);
+        if ( ! arg || preludedb_selected_object_get_type(arg) != PRELUDEDB_SELECTED_OBJECT_TYPE_INT )
+                return -1;
+
+        return *(const int *) preludedb_selected_object_get_data(arg);
+}
+
+
+
+/**
+ * classic_approx_get_topk:
+ * @selection: Pointer to a path selection.
+ *
+ * Returns: the number of groups requested by the topk() function of
+ * @selection, or 0 if it does not use topk().
+ */
+int classic_approx_get_topk(preludedb_path_selection_t *selection)
+{
+        preludedb_selected_path_t *selected = NULL;
+        preludedb_selected_object_t *object;
+
+        while ( (selected = preludedb_path_selection_get_next(selection, selected)) ) {
+                object = preludedb_selected_path_get_object(selected);
+                if ( preludedb_selected_object_get_type(object) == PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK )
+                        return get_param(object);
+        }
+
+        return 0;
+}
+
+
+
+static int setup_columns(classic_approx_t *approx, preludedb_path_selection_t *selection)
+{
+        int index, param;
+        prelude_bool_t topk = FALSE;
+        approx_column_t *column;
+        preludedb_selected_path_t *selected = NULL;
+        preludedb_selected_object_t *object;
+
+        approx->columns = malloc(preludedb_path_selection_get_count(selection) * sizeof(*approx->columns));
+        if ( ! approx->columns )
+                return preludedb_error_from_errno(errno);
+
+        while ( (selected = preludedb_path_selection_get_next(selection, selected)) ) {
+                column = &approx->columns[approx->ncolumns++];
+                object = preludedb_selected_path_get_object(selected);
+
+                index = preludedb_selected_path_get_column_index(selected);
+                if ( index < 0 )
+                        return index;
+
+                column->selected = selected;
+                column->flags = preludedb_selected_path_get_flags(selected);
+                column->position = index;
+                column->ncolumns = preludedb_selected_path_get_column_count(selected);
+                column->quantile = 0;
+
+                if ( column->flags & (PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_ASC|PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC) )
+                        approx->has_order = TRUE;
+
+                switch ( preludedb_selected_object_get_type(object) ) {
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT:
+                        column->type = COLUMN_COUNT;
+                        break;
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT:
+                        column->type = COLUMN_APPROX_COUNT_DISTINCT;
+                        break;
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE:
+                        param = get_param(object);
+                        if ( param < 0 || param > 100 )
+                                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Invalid percentile parameter '%d'", param);
+
+                        column->type = COLUMN_PERCENTILE;
+                        column->quantile = param / 100.0;
+                        break;
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_MIN:
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_MAX:
+                        if ( approx->merge ) {
+                                column->type = (preludedb_selected_object_get_type(object) == PRELUDEDB_SELECTED_OBJECT_TYPE_MIN) ?
+                                                COLUMN_MIN : COLUMN_MAX;
+                                break;
+                        }
+
+                        /* fall through */
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_AVG:
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC,
+                                                       "min(), max() and avg() cannot be combined with approximate functions on this database");
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK:
+                        if ( topk )
+                                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Only one topk() function can be selected");
+
+                        topk = TRUE;
+                        /* fall through */
+
+                default:
+                        column->type = COLUMN_KEY;
+                        approx->has_key = TRUE;
+                        break;
+                }
+        }
+
+        return 0;
+}
+
+
+
+static int build_key(classic_approx_t *approx, preludedb_sql_row_t *row, prelude_string_t *key)
+{
+        int ret;
+        unsigned int i, j;
+        approx_column_t *column;
+        preludedb_sql_field_t *field;
+
+        for ( i = 0; i < approx->ncolumns; i++ ) {
+                column = &approx->columns[i];
+                if ( column->type != COLUMN_KEY )
+                        continue;
+
+                for ( j = column->position; j < column->position + column->ncolumns; j++ ) {
+                        ret = preludedb_sql_row_get_field(row, j, &field);
+                        if ( ret < 0 )
+                                return ret;
+
+                        /*
+                         * Length prefixed values, so that the key is not ambiguous.
+                         */
+                        if ( ret == 0 )
+                                ret = prelude_string_cat(key, "-");
+                        else {
+                                ret = prelude_string_sprintf(key, "%" PRELUDE_PRIu64 ":", (uint64_t) preludedb_sql_field_get_len(field));
+                                if ( ret < 0 )
+                                        return ret;
+
+                                ret = prelude_string_ncat(key, preludedb_sql_field_get_value(field), preludedb_sql_field_get_len(field));
+                        }
+
+                        if ( ret < 0 )
+                                return ret;
+                }
+        }
+
+        return 0;
+}
+
+
+
+static int resize_buckets(classic_approx_t *approx)
+{
+        size_t i, nbuckets;
+        approx_group_t **buckets, *group, *next;
+
+        nbuckets = (approx->nbuckets) ? approx->nbuckets * 2 : GROUP_BUCKETS_MIN;
+
+        buckets = calloc(nbuckets, sizeof(*buckets));
+        if ( ! buckets )
+                return preludedb_error_from_errno(errno);
+
+        for ( i = 0; i < approx->nbuckets; i++ ) {
+                for ( group = approx->buckets[i]; group; group = next ) {
+                        next = group->next;
+                        group->next = buckets[group->hash & (nbuckets - 1)];
+                        buckets[group->hash & (nbuckets - 1)] = group;
+                }
+        }
+
+        free(approx->buckets);
+        approx->buckets = buckets;
+        approx->nbuckets = nbuckets;
+
+        return 0;
+}
+
+
+
+static approx_group_t *lookup_group(classic_approx_t *approx, uint64_t hash, const char *key, size_t keylen)
+{
+        approx_group_t *group;
+
+        if ( ! approx->nbuckets )
+                return NULL;
+
+        for ( group = approx->buckets[hash & (approx->nbuckets - 1)]; group; group = group->next ) {
+                if ( group->hash == hash && group->keylen == keylen && memcmp(group->key, key, keylen) == 0 )
+                        return group;
+        }
+
+        return NULL;
+}
+
+
+
+static void unlink_group(classic_approx_t *approx, approx_group_t *group)
+{
+        approx_group_t **ptr;
+
+        for ( ptr = &approx->buckets[group->hash & (approx->nbuckets - 1)]; *ptr; ptr = &(*ptr)->next ) {
+                if ( *ptr == group ) {
+                        *ptr = group->next;
+                        break;
+                }
+        }
+}
+
+
+
+/*
+ * The groups of a topk() selection are kept in a min-heap ordered on
+ * their hits, so that the least frequent group is the one evicted.
+ */
+static void heap_swap(classic_approx_t *approx, size_t i, size_t j)
+{
+        approx_group_t *tmp = approx->groups[i];
+
+        approx->groups[i] = approx->groups[j];
+        approx->groups[j] = tmp;
+
+        approx->groups[i]->index = i;
+        approx->groups[j]->index = j;
+}
+
+
+
+static void heap_sift_up(classic_approx_t *approx, size_t i)
+{
+        while ( i > 0 && approx->groups[(i - 1) / 2]->hits > approx->groups[i]->hits ) {
+                heap_swap(approx, i, (i - 1) / 2);
+                i = (i - 1) / 2;
+        }
+}
+
+
+
+static void heap_sift_down(classic_approx_t *approx, size_t i)
+{
+        size_t smallest, child;
+
+        while ( 1 ) {
+                smallest = i;
+
+                child = 2 * i + 1;
+                if ( child < approx->ngroups && approx->groups[child]->hits < approx->groups[smallest]->hits )
+                        smallest = child;
+
+                child++;
+                if ( child < approx->ngroups && approx->groups[child]->hits < approx->groups[smallest]->hits )
+                        smallest = child;
+
+                if ( smallest == i )
+                        break;
+
+                heap_swap(approx, i, smallest);
+                i = smallest;
+        }
+}
+
+
+
+static void reset_aggregates(classic_approx_t *approx, approx_group_t *group)
+{
+        unsigned int i;
+
+        for ( i = 0; i < approx->ncolumns; i++ ) {
+                if ( group->aggregates[i].registers )
+                        free(group->aggregates[i].registers);
+
+                memset(&group->aggregates[i], 0, sizeof(group->aggregates[i]));
+        }
+}
+
+
+
+static int new_group(classic_approx_t *approx, uint64_t hash, const char *key, size_t keylen,
+                     preludedb_sql_row_t *row, approx_group_t **out)
+{
+        int ret;
+        approx_group_t *group, **groups;
+
+        if ( approx->topk && approx->ngroups == approx->capacity ) {
+                /*
+                 * Space-saving: the least frequent group is replaced, the
+                 * new one inheriting its hits as an overestimation error.
+                 */
+                group = approx->groups[0];
+
+                unlink_group(approx, group);
+                reset_aggregates(approx, group);
+
+                free(group->key);
+                group->key = NULL;
+                group->error = group->hits;
+
+                if ( group->row )
+                        preludedb_sql_row_destroy(group->row);
+        }
+
+        else {
+                if ( approx->ngroups == approx->groups_size ) {
+                        approx->groups_size = (approx->groups_size) ? approx->groups_size * 2 : GROUP_BUCKETS_MIN;
+
+                        groups = realloc(approx->groups, approx->groups_size * sizeof(*groups));
+                        if ( ! groups )
+                                return preludedb_error_from_errno(errno);
+
+                        approx->groups = groups;
+                }
+
+                if ( approx->ngroups >= approx->nbuckets ) {
+                        ret = resize_buckets(approx);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                group = calloc(1, sizeof(*group) + approx->ncolumns * sizeof(*group->aggregates));
+                if ( ! group )
+                        return preludedb_error_from_errno(errno);
+
+                group->approx = approx;
+                group->index = approx->ngroups;
+                approx->groups[approx->ngroups++] = group;
+
+                if ( approx->topk )
+                        heap_sift_up(approx, group->index);
+        }
+
+        group->row = NULL;
+
+        group->key = malloc(keylen + 1);
+        if ( ! group->key )
+                return preludedb_error_from_errno(errno);
+
+        memcpy(group->key, key, keylen);
+        group->key[keylen] = 0;
+        group->keylen = keylen;
+
+        group->hash = hash;
+        group->row = row;
+        group->serial = approx->serial++;
+
+        group->next = approx->buckets[hash & (approx->nbuckets - 1)];
+        approx->buckets[hash & (approx->nbuckets - 1)] = group;
+
+        *out = group;
+
+        return 0;
+}
+
+
+
+static const char *get_row_value(preludedb_sql_row_t *row, approx_column_t *column)
+{
+        int ret;
+        preludedb_sql_field_t *field;
+
+        if ( ! row )
+                return NULL;
+
+        ret = preludedb_sql_row_get_field(row, column->position, &field);
+        if ( ret <= 0 )
+                return NULL;
+
+        return preludedb_sql_field_get_value(field);
+}
+
+
+
+/*
+ * Compares values numerically when both are numbers, NULL first.
+ */
+static int compare_values(const char *v1, const char *v2)
+{
+        double d1, d2;
+        char *end1, *end2;
+
+        if ( ! v1 || ! v2 )
+                return (v1 == v2) ? 0 : (v1) ? 1 : -1;
+
+        d1 = strtod(v1, &end1);
+        d2 = strtod(v2, &end2);
+        if ( end1 == v1 || *end1 || end2 == v2 || *end2 )
+                return strcmp(v1, v2);
+
+        return (d1 < d2) ? -1 : (d1 > d2) ? 1 : 0;
+}
+
+
+
+/*
+ * Partial results are small: their rows are all kept until the result is
+ * destroyed, and the extremum only references the row holding it.
+ */
+static int merge_extremum(approx_column_t *column, approx_aggregate_t *aggregate, preludedb_sql_row_t *row, const char *value)
+{
+        int ret;
+
+        if ( aggregate->row ) {
+                ret = compare_values(value, get_row_value(aggregate->row, column));
+                if ( (column->type == COLUMN_MIN && ret >= 0) || (column->type == COLUMN_MAX && ret <= 0) )
+                        return 0;
+        }
+
+        aggregate->row = row;
+
+        return 0;
+}
+
+
+
+static int update_aggregate(classic_approx_t *approx, approx_column_t *column, approx_aggregate_t *aggregate, preludedb_sql_row_t *row)
+{
+        int ret;
+        double value;
+        uint64_t count;
+        preludedb_sql_field_t *field;
+
+        if ( column->type == COLUMN_KEY )
+                return 0;
+
+        ret = preludedb_sql_row_get_field(row, column->position, &field);
+        if ( ret <= 0 )
+                return ret;
+
+        if ( column->type == COLUMN_MIN || column->type == COLUMN_MAX )
+                return merge_extremum(column, aggregate, row, preludedb_sql_field_get_value(field));
+
+        if ( approx->merge ) {
+                ret = preludedb_sql_field_to_uint64(field, &count);
+                if ( ret < 0 )
+                        return ret;
+
+                aggregate->count += count;
+                return 0;
+        }
+
+        aggregate->count++;
+
+        if ( column->type == COLUMN_APPROX_COUNT_DISTINCT )
+                return classic_hll_add(&aggregate->registers, preludedb_sql_field_get_value(field), preludedb_sql_field_get_len(field));
+
+        if ( column->type == COLUMN_PERCENTILE ) {
+                ret = preludedb_sql_field_to_double(field, &value);
+                if ( ret < 0 )
+                        return ret;
+
+                classic_p2_add(&aggregate->p2, column->quantile, value);
+        }
+
+        return 0;
+}
+
+
+
+static int add_row(classic_approx_t *approx, prelude_string_t *key, preludedb_sql_row_t *row)
+{
+        int ret;
+        uint64_t hash;
+        unsigned int i;
+        approx_group_t *group;
+        prelude_bool_t keep_row = FALSE;
+
+        prelude_string_clear(key);
+
+        ret = build_key(approx, row, key);
+        if ( ret < 0 )
+                return ret;
+
+        hash = classic_sketch_hash(prelude_string_get_string_or_default(key, ""), prelude_string_get_len(key));
+
+        group = lookup_group(approx, hash, prelude_string_get_string_or_default(key, ""), prelude_string_get_len(key));
+        if ( ! group ) {
+                ret = new_group(approx, hash, prelude_string_get_string_or_default(key, ""), prelude_string_get_len(key), row, &group);
+                if ( ret < 0 )
+                        return ret;
+
+                keep_row = TRUE;
+        }
+
+        group->hits++;
+        if ( approx->topk )
+                heap_sift_down(approx, group->index);
+
+        for ( i = 0; i < approx->ncolumns; i++ ) {
+                ret = update_aggregate(approx, &approx->columns[i], &group->aggregates[i], row);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( ! keep_row && ! approx->merge )
+                preludedb_sql_row_destroy(row);
+
+        return 0;
+}
+
+
+
+static void finalize_group(classic_approx_t *approx, approx_group_t *group)
+{
+        unsigned int i;
+        approx_aggregate_t *aggregate;
+
+        for ( i = 0; i < approx->ncolumns; i++ ) {
+                aggregate = &group->aggregates[i];
+
+                switch ( approx->columns[i].type ) {
+                case COLUMN_COUNT:
+                        aggregate->value = aggregate->count + group->error;
+                        break;
+
+                case COLUMN_APPROX_COUNT_DISTINCT:
+                        aggregate->value = floor(classic_hll_estimate(aggregate->registers) + 0.5);
+                        break;
+
+                case COLUMN_PERCENTILE:
+                        aggregate->is_null = (aggregate->p2.count == 0);
+                        if ( ! aggregate->is_null )
+                                aggregate->value = classic_p2_get(&aggregate->p2, approx->columns[i].quantile);
+                        break;
+
+                case COLUMN_MIN:
+                case COLUMN_MAX:
+                        aggregate->is_null = (aggregate->row == NULL);
+                        break;
+
+                default:
+                        break;
+                }
+        }
+}
+
+
+
+static int compare_column(approx_column_t *column, approx_group_t *g1, approx_group_t *g2, unsigned int i)
+{
+        double d1, d2;
+
+        if ( column->type == COLUMN_KEY )
+                return compare_values(get_row_value(g1->row, column), get_row_value(g2->row, column));
+
+        if ( column->type == COLUMN_MIN || column->type == COLUMN_MAX )
+                return compare_values(get_row_value(g1->aggregates[i].row, column), get_row_value(g2->aggregates[i].row, column));
+
+        if ( g1->aggregates[i].is_null || g2->aggregates[i].is_null )
+                return g2->aggregates[i].is_null - g1->aggregates[i].is_null;
+
+        d1 = g1->aggregates[i].value;
+        d2 = g2->aggregates[i].value;
+
+        return (d1 < d2) ? -1 : (d1 > d2) ? 1 : 0;
+}
+
+
+
+static int compare_groups(const void *a, const void *b)
+{
+        int ret;
+        unsigned int i;
+        approx_group_t *g1 = *(approx_group_t * const *) a;
+        approx_group_t *g2 = *(approx_group_t * const *) b;
+        classic_approx_t *approx = g1->approx;
+
+        if ( approx->topk && g1->hits != g2->hits )
+                return (g1->hits > g2->hits) ? -1 : 1;
+
+        for ( i = 0; i < approx->ncolumns; i++ ) {
+                if ( ! (approx->columns[i].flags & (PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_ASC|PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC)) )
+                        continue;
+
+                ret = compare_column(&approx->columns[i], g1, g2, i);
+                if ( ret )
+                        return (approx->columns[i].flags & PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC) ? -ret : ret;
+        }
+
+        return (g1->serial < g2->serial) ? -1 : (g1->serial > g2->serial) ? 1 : 0;
+}
+
+
+
+static int build_rows(classic_approx_t *approx, int limit, int offset)
+{
+        int ret;
+        size_t i, start;
+        approx_group_t *group;
+
+        /*
+         * Aggregates without any key always produce a single row.
+         */
+        if ( ! approx->has_key && approx->ngroups == 0 ) {
+                ret = new_group(approx, classic_sketch_hash("", 0), "", 0, NULL, &group);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( ! approx->ngroups )
+                return 0;
+
+        approx->rows = malloc(approx->ngroups * sizeof(*approx->rows));
+        if ( ! approx->rows )
+                return preludedb_error_from_errno(errno);
+
+        for ( i = 0; i < approx->ngroups; i++ ) {
+                finalize_group(approx, approx->groups[i]);
+                approx->rows[i] = approx->groups[i];
+        }
+
+        approx->nrows = approx->ngroups;
+
+        if ( approx->topk || approx->has_order )
+                qsort(approx->rows, approx->nrows, sizeof(*approx->rows), compare_groups);
+
+        if ( approx->topk && approx->nrows > approx->topk )
+                approx->nrows = approx->topk;
+
+        start = (offset > 0) ? (size_t) offset : 0;
+        if ( start >= approx->nrows )
+                approx->nrows = 0;
+
+        else if ( start ) {
+                memmove(approx->rows, approx->rows + start, (approx->nrows - start) * sizeof(*approx->rows));
+                approx->nrows -= start;
+        }
+
+        if ( limit >= 0 && (size_t) limit < approx->nrows )
+                approx->nrows = limit;
+
+        return 0;
+}
+
+
+
+static int approx_new(classic_approx_t **approx, preludedb_path_selection_t *selection, prelude_bool_t merge,
+                      preludedb_sql_table_t **tables, unsigned int ntables, int limit, int offset)
+{
+        int ret;
+        unsigned int i;
+        prelude_string_t *key;
+        preludedb_sql_row_t *row;
+
+        *approx = calloc(1, sizeof(**approx));
+        if ( *approx )
+                (*approx)->tables = malloc(ntables * sizeof(*tables));
+
+        if ( ! *approx || ! (*approx)->tables ) {
+                ret = preludedb_error_from_errno(errno);
+
+                if ( *approx )
+                        free(*approx);
+
+                for ( i = 0; i < ntables; i++ ) {
+                        if ( tables[i] )
+                                preludedb_sql_table_destroy(tables[i]);
+                }
+
+                return ret;
+        }
+
+        memcpy((*approx)->tables, tables, ntables * sizeof(*tables));
+        (*approx)->ntables = ntables;
+        (*approx)->merge = merge;
+
+        ret = setup_columns(*approx, selection);
+        if ( ret < 0 )
+                goto error;
+
+        ret = classic_approx_get_topk(selection);
+        if ( ret < 0 ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Invalid topk parameter '%d'", ret);
+                goto error;
+        }
+
+        (*approx)->topk = ret;
+        (*approx)->capacity = (*approx)->topk * TOPK_CAPACITY_FACTOR;
+
+        ret = prelude_string_new(&key);
+        if ( ret < 0 )
+                goto error;
+
+        for ( i = 0; i < ntables && ret >= 0; i++ ) {
+                while ( tables[i] && (ret = preludedb_sql_table_fetch_row(tables[i], &row)) > 0 ) {
+                        ret = add_row(*approx, key, row);
+                        if ( ret < 0 )
+                                break;
+                }
+        }
+
+        prelude_string_destroy(key);
+
+        if ( ret < 0 )
+                goto error;
+
+        ret = build_rows(*approx, limit, offset);
+        if ( ret < 0 )
+                goto error;
+
+        return 0;
+
+ error:
+        classic_approx_destroy(*approx);
+        return ret;
+}
+
+
+
+/**
+ * classic_approx_new:
+ * @approx: Pointer where to store the newly created object.
+ * @selection: Pointer to the path selection the rows were selected with.
+ * @table: Table of raw values, or NULL if the selection returned no rows.
+ * @limit: Maximum number of rows to output, or -1.
+ * @offset: Number of rows to skip, or -1.
+ *
+ * Computes the aggregates of @selection out of the raw values of @table,
+ * which is then owned by @approx.
+ *
+ * Returns: 0 on success, a negative value if an error occured.
+ */
+int classic_approx_new(classic_approx_t **approx, preludedb_path_selection_t *selection,
+                       preludedb_sql_table_t *table, int limit, int offset)
+{
+        return approx_new(approx, selection, FALSE, &table, 1, limit, offset);
+}
+
+
+
+/**
+ * classic_approx_new_merged:
+ * @approx: Pointer where to store the newly created object.
+ * @selection: Pointer to the path selection the rows were selected with.
+ * @tables: Array of @ntables partial results, NULL for those with no rows.
+ * @ntables: Number of partial results.
+ * @limit: Maximum number of rows to output, or -1.
+ * @offset: Number of rows to skip, or -1.
+ *
+ * Merges the results of @selection run over disjoint sets of messages,
+ * see classic_approx_can_merge(). The tables are then owned by @approx.
+ *
+ * Returns: 0 on success, a negative value if an error occured.
+ */
+int classic_approx_new_merged(classic_approx_t **approx, preludedb_path_selection_t *selection,
+                              preludedb_sql_table_t **tables, unsigned int ntables, int limit, int offset)
+{
+        return approx_new(approx, selection, TRUE, tables, ntables, limit, offset);
+}
+
+
+
+static prelude_bool_t has_aggregate(preludedb_selected_object_t *object)
+{
+        size_t i;
+        preludedb_selected_object_t *arg;
+
+        if ( ! preludedb_selected_object_is_function(object) )
+                return FALSE;
+
+        switch ( preludedb_selected_object_get_type(object) ) {
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_MIN:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_MAX:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_AVG:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK:
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE:
+                return TRUE;
+
+        default:
+                break;
+        }
+
+        for ( i = 0; (arg = preludedb_selected_object_get_arg(object, i)); i++ ) {
+                if ( has_aggregate(arg) )
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
+
+
+/**
+ * classic_approx_can_merge:
+ * @selection: Pointer to a path selection.
+ *
+ * Tells whether the results of @selection run over disjoint sets of
+ * messages can be merged: it must select count(), min() or max() of
+ * plain values, and no other aggregate.
+ *
+ * Returns: TRUE if the results can be merged, FALSE otherwise.
+ */
+prelude_bool_t classic_approx_can_merge(preludedb_path_selection_t *selection)
+{
+        size_t i;
+        prelude_bool_t found = FALSE;
+        preludedb_selected_object_t *object, *arg;
+        preludedb_selected_path_t *selected = NULL;
+
+        while ( (selected = preludedb_path_selection_get_next(selection, selected)) ) {
+                object = preludedb_selected_path_get_object(selected);
+
+                switch ( preludedb_selected_object_get_type(object) ) {
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_MIN:
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_MAX:
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT:
+                        for ( i = 0; (arg = preludedb_selected_object_get_arg(object, i)); i++ ) {
+                                if ( has_aggregate(arg) )
+                                        return FALSE;
+                        }
+
+                        found = TRUE;
+                        break;
+
+                default:
+                        if ( has_aggregate(object) )
+                                return FALSE;
+
+                        break;
+                }
+        }
+
+        return found;
+}
+
+
+
+void classic_approx_destroy(classic_approx_t *approx)
+{
+        size_t i;
+
+        for ( i = 0; i < approx->ngroups; i++ ) {
+                reset_aggregates(approx, approx->groups[i]);
+
+                if ( approx->groups[i]->key )
+                        free(approx->groups[i]->key);
+
+                free(approx->groups[i]);
+        }
+
+        for ( i = 0; i < approx->ntables; i++ ) {
+                if ( approx->tables[i] )
+                        preludedb_sql_table_destroy(approx->tables[i]);
+        }
+
+        free(approx->tables);
+
+        if ( approx->rows )
+                free(approx->rows);
+
+        if ( approx->groups )
+                free(approx->groups);
+
+        if ( approx->buckets )
+                free(approx->buckets);
+
+        if ( approx->columns )
+                free(approx->columns);
+
+        free(approx);
+}
+
+
+
+int classic_approx_get_row_count(classic_approx_t *approx)
+{
+        return approx->nrows;
+}
+
+
+
+int classic_approx_get_row(classic_approx_t *approx, unsigned int rnum, void **row)
+{
+        if ( rnum == (unsigned int) -1 )
+                rnum = approx->cursor;
+
+        if ( rnum == approx->nrows )
+                return 0;
+
+        if ( rnum > approx->nrows )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INDEX, "Invalid row '%u'", rnum);
+
+        *row = approx->rows[rnum];
+        if ( rnum >= approx->cursor )
+                approx->cursor = rnum + 1;
+
+        return 1;
+}
+
+
+
+int classic_approx_get_field(classic_approx_t *approx, preludedb_sql_t *sql, void *row, preludedb_selected_path_t *selected,
+                             preludedb_result_values_get_field_cb_func_t cb, void **out)
+{
+        int ret;
+        char buf[64];
+        unsigned int i;
+        const void *data;
+        approx_group_t *group = row;
+        approx_column_t *column;
+        approx_aggregate_t *aggregate;
+        idmef_value_type_id_t type;
+        preludedb_selected_object_type_t dtype;
+
+        for ( i = 0; i < approx->ncolumns && approx->columns[i].selected != selected; i++ );
+
+        if ( i == approx->ncolumns )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Selected path does not belong to this result");
+
+        column = &approx->columns[i];
+        aggregate = &group->aggregates[i];
+
+        if ( column->type == COLUMN_KEY ) {
+                if ( ! group->row )
+                        return cb(out, NULL, 0, 0);
+
+                return classic_get_value(sql, group->row, column->position, selected, cb, out);
+        }
+
+        if ( column->type == COLUMN_MIN || column->type == COLUMN_MAX ) {
+                if ( ! aggregate->row )
+                        return cb(out, NULL, 0, 0);
+
+                return classic_get_value(sql, aggregate->row, column->position, selected, cb, out);
+        }
+
+        if ( aggregate->is_null )
+                ret = cb(out, NULL, 0, 0);
+
+        else {
+                type = preludedb_selected_object_get_value_type(preludedb_selected_path_get_object(selected), &data, &dtype);
+
+                if ( column->type == COLUMN_PERCENTILE )
+                        snprintf(buf, sizeof(buf), "%.15g", aggregate->value);
+                else
+                        snprintf(buf, sizeof(buf), "%" PRELUDE_PRIu64, (uint64_t) aggregate->value);
+
+                ret = cb(out, buf, strlen(buf), type);
+        }
+
+        return (ret < 0) ? ret : 1;
+}
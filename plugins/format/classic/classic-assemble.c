@@ -0,0 +1,567 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql.h"
+#include "preludedb.h"
+
+#include "classic-assemble.h"
+
+
+/*
+ * Messages are rebuilt from flat row streams rather than from one query
+ * per parent object: the first time a table is needed, its rows for all
+ * the messages of the assembly are selected at once, together with the
+ * columns linking them to their parent (_message_ident, _parent_type,
+ * _parentN_index and _index).
+ *
+ * The rows of a table are then kept in a single array, sorted on these
+ * keys, so that the children of any parent are a contiguous range found
+ * with a binary search, and come in _index order.
+ *
+ * Tables are only loaded when a lookup needs them, so that subtrees which
+ * are not requested, or parents which have no rows at all, do not cost a
+ * query.
+ */
+#define ASSEMBLY_IDENTS_PER_QUERY 256
+#define ASSEMBLY_ROWS_MIN 16
+
+
+struct classic_assembly_row {
+        uint64_t message_ident;
+        int32_t parent_index[3];
+        int32_t index;
+        char parent_type;
+        preludedb_sql_row_t *row;
+};
+
+
+typedef struct {
+        const char *columns;
+        const char *from;
+        const char *prefix;
+        const char *ident;
+        prelude_bool_t parent_type;
+        unsigned int parents;
+        prelude_bool_t listed;
+} table_desc_t;
+
+
+typedef struct {
+        prelude_bool_t loaded;
+        size_t nrows;
+        size_t size;
+        classic_assembly_row_t *rows;
+        unsigned int nresults;
+        preludedb_sql_table_t **results;
+} table_rows_t;
+
+
+struct classic_assembly {
+        preludedb_sql_t *sql;
+        size_t nidents;
+        uint64_t *idents;
+        table_rows_t tables[CLASSIC_ASSEMBLY_TABLE_COUNT];
+};
+
+
+static const table_desc_t tables[CLASSIC_ASSEMBLY_TABLE_COUNT] = {
+        [CLASSIC_ASSEMBLY_ALERT] = {
+                "messageid", "Prelude_Alert", "", "_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_HEARTBEAT] = {
+                "messageid, heartbeat_interval", "Prelude_Heartbeat", "", "_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_ANALYZER] = {
+                "a.analyzerid, COALESCE(a.name, d.name), COALESCE(a.manufacturer, d.manufacturer), "
+                "COALESCE(a.model, d.model), COALESCE(a.version, d.version), COALESCE(a.class, d.class), "
+                "COALESCE(a.ostype, d.ostype), COALESCE(a.osversion, d.osversion)",
+                "Prelude_Analyzer AS a LEFT JOIN Prelude_AnalyzerDict AS d ON d._ident = a._dict_ident",
+                "a.", "_message_ident", TRUE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_ANALYZER_TIME] = {
+                "time, gmtoff, usec", "Prelude_AnalyzerTime", "", "_message_ident", TRUE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_CREATE_TIME] = {
+                "time, gmtoff, usec", "Prelude_CreateTime", "", "_message_ident", TRUE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_DETECT_TIME] = {
+                "time, gmtoff, usec", "Prelude_DetectTime", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_NODE] = {
+                "n.ident, COALESCE(n.category, d.category), COALESCE(n.location, d.location), COALESCE(n.name, d.name)",
+                "Prelude_Node AS n LEFT JOIN Prelude_NodeDict AS d ON d._ident = n._dict_ident",
+                "n.", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_ADDRESS] = {
+                "ident, category, vlan_name, vlan_num, address, netmask", "Prelude_Address", "", "_message_ident", TRUE, 1, TRUE },
+        [CLASSIC_ASSEMBLY_USER] = {
+                "ident, category", "Prelude_User", "", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_USER_ID] = {
+                "ident, type, name, number, tty", "Prelude_UserId", "", "_message_ident", TRUE, 3, TRUE },
+        [CLASSIC_ASSEMBLY_PROCESS] = {
+                "ident, name, pid, path", "Prelude_Process", "", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_PROCESS_ARG] = {
+                "arg", "Prelude_ProcessArg", "", "_message_ident", TRUE, 1, TRUE },
+        [CLASSIC_ASSEMBLY_PROCESS_ENV] = {
+                "env", "Prelude_ProcessEnv", "", "_message_ident", TRUE, 1, TRUE },
+        [CLASSIC_ASSEMBLY_SERVICE] = {
+                "ident, ip_version, name, port, iana_protocol_number, iana_protocol_name, portlist, protocol",
+                "Prelude_Service", "", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_WEB_SERVICE] = {
+                "url, cgi, http_method", "Prelude_WebService", "", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_WEB_SERVICE_ARG] = {
+                "arg", "Prelude_WebServiceArg", "", "_message_ident", TRUE, 1, TRUE },
+        [CLASSIC_ASSEMBLY_SNMP_SERVICE] = {
+                "snmp_oid, message_processing_model, security_model, security_name, "
+                "security_level, context_name, context_engine_id, command",
+                "Prelude_SnmpService", "", "_message_ident", TRUE, 1, FALSE },
+        [CLASSIC_ASSEMBLY_ASSESSMENT] = {
+                "_message_ident", "Prelude_Assessment", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_IMPACT] = {
+                "severity, completion, type, description", "Prelude_Impact", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_CONFIDENCE] = {
+                "rating, confidence", "Prelude_Confidence", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_ACTION] = {
+                "category, description", "Prelude_Action", "", "_message_ident", FALSE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_SOURCE] = {
+                "ident, spoofed, interface", "Prelude_Source", "", "_message_ident", FALSE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_TARGET] = {
+                "ident, decoy, interface", "Prelude_Target", "", "_message_ident", FALSE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_FILE] = {
+                "ident, category, name, path, create_time, create_time_gmtoff, "
+                "modify_time, modify_time_gmtoff, access_time, "
+                "access_time_gmtoff, data_size, disk_size, fstype, file_type",
+                "Prelude_File", "", "_message_ident", FALSE, 1, TRUE },
+        [CLASSIC_ASSEMBLY_FILE_ACCESS] = {
+                "_index", "Prelude_FileAccess", "", "_message_ident", FALSE, 2, TRUE },
+        [CLASSIC_ASSEMBLY_FILE_ACCESS_PERMISSION] = {
+                "permission", "Prelude_FileAccess_Permission", "", "_message_ident", FALSE, 3, TRUE },
+        [CLASSIC_ASSEMBLY_LINKAGE] = {
+                "category, name, path", "Prelude_Linkage", "", "_message_ident", FALSE, 2, TRUE },
+        [CLASSIC_ASSEMBLY_INODE] = {
+                "change_time, change_time_gmtoff, number, major_device, minor_device, c_major_device, c_minor_device",
+                "Prelude_Inode", "", "_message_ident", FALSE, 2, FALSE },
+        [CLASSIC_ASSEMBLY_CHECKSUM] = {
+                "value, checksum_key, algorithm", "Prelude_Checksum", "", "_message_ident", FALSE, 2, TRUE },
+        [CLASSIC_ASSEMBLY_CLASSIFICATION] = {
+                "c.ident, COALESCE(c.text, d.text)",
+                "Prelude_Classification AS c LEFT JOIN Prelude_ClassificationDict AS d ON d._ident = c._dict_ident",
+                "c.", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_REFERENCE] = {
+                "origin, name, url, meaning", "Prelude_Reference", "", "_message_ident", FALSE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_ADDITIONAL_DATA] = {
+                "type, meaning, data", "Prelude_AdditionalData", "", "_message_ident", TRUE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_TOOL_ALERT] = {
+                "name, command", "Prelude_ToolAlert", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_CORRELATION_ALERT] = {
+                "name", "Prelude_CorrelationAlert", "", "_message_ident", FALSE, 0, FALSE },
+        [CLASSIC_ASSEMBLY_ALERTIDENT] = {
+                "alertident, analyzerid", "Prelude_Alertident", "", "_message_ident", TRUE, 0, TRUE },
+        [CLASSIC_ASSEMBLY_OVERFLOW_ALERT] = {
+                "program, size, buffer", "Prelude_OverflowAlert", "", "_message_ident", FALSE, 0, FALSE },
+};
+
+
+
+static int compare_idents(const void *a, const void *b)
+{
+        uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+        return (x > y) - (x < y);
+}
+
+
+
+/*
+ * Orders rows on their parent, ignoring their own _index.
+ */
+static int compare_parent(const classic_assembly_row_t *a, const classic_assembly_row_t *b)
+{
+        int i;
+
+        if ( a->message_ident != b->message_ident )
+                return (a->message_ident < b->message_ident) ? -1 : 1;
+
+        if ( a->parent_type != b->parent_type )
+                return (a->parent_type < b->parent_type) ? -1 : 1;
+
+        for ( i = 0; i < 3; i++ ) {
+                if ( a->parent_index[i] != b->parent_index[i] )
+                        return (a->parent_index[i] < b->parent_index[i]) ? -1 : 1;
+        }
+
+        return 0;
+}
+
+
+
+static int compare_rows(const void *a, const void *b)
+{
+        int ret;
+        const classic_assembly_row_t *x = a, *y = b;
+
+        ret = compare_parent(x, y);
+        if ( ret != 0 )
+                return ret;
+
+        return (x->index > y->index) - (x->index < y->index);
+}
+
+
+
+static int get_key_int32(preludedb_sql_row_t *row, int column, int32_t *value)
+{
+        int ret;
+        preludedb_sql_field_t *field;
+
+        ret = preludedb_sql_row_get_field(row, column, &field);
+        if ( ret <= 0 ) {
+                *value = 0;
+                return ret;
+        }
+
+        return preludedb_sql_field_to_int32(field, value);
+}
+
+
+
+/*
+ * The key columns follow the data columns, so that the row is read by
+ * the same column numbers as a plain per-parent query. They are counted
+ * from the end of the row.
+ */
+static int read_key(const table_desc_t *desc, preludedb_sql_row_t *row, classic_assembly_row_t *out)
+{
+        int ret;
+        unsigned int i;
+        preludedb_sql_field_t *field;
+        int column = -(1 + !!desc->parent_type + desc->parents + !!desc->listed);
+
+        memset(out, 0, sizeof(*out));
+        out->row = row;
+
+        ret = preludedb_sql_row_get_field(row, column++, &field);
+        if ( ret <= 0 )
+                return (ret < 0) ? ret : preludedb_error(PRELUDEDB_ERROR_INVALID_MESSAGE_IDENT);
+
+        ret = preludedb_sql_field_to_uint64(field, &out->message_ident);
+        if ( ret < 0 )
+                return ret;
+
+        if ( desc->parent_type ) {
+                ret = preludedb_sql_row_get_field(row, column++, &field);
+                if ( ret < 0 )
+                        return ret;
+
+                if ( ret > 0 )
+                        out->parent_type = *preludedb_sql_field_get_value(field);
+        }
+
+        for ( i = 0; i < desc->parents; i++ ) {
+                ret = get_key_int32(row, column++, &out->parent_index[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( desc->listed ) {
+                ret = get_key_int32(row, column, &out->index);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int build_query(const table_desc_t *desc, const uint64_t *idents, size_t count, prelude_string_t *query)
+{
+        int ret;
+        size_t i;
+        unsigned int j;
+
+        ret = prelude_string_sprintf(query, "SELECT %s, %s%s", desc->columns, desc->prefix, desc->ident);
+        if ( ret < 0 )
+                return ret;
+
+        if ( desc->parent_type ) {
+                ret = prelude_string_sprintf(query, ", %s_parent_type", desc->prefix);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        for ( j = 0; j < desc->parents; j++ ) {
+                ret = prelude_string_sprintf(query, ", %s_parent%u_index", desc->prefix, j);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( desc->listed ) {
+                ret = prelude_string_sprintf(query, ", %s_index", desc->prefix);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        ret = prelude_string_sprintf(query, " FROM %s WHERE %s%s IN (", desc->from, desc->prefix, desc->ident);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < count; i++ ) {
+                ret = prelude_string_sprintf(query, "%s%" PRELUDE_PRIu64, (i > 0) ? ", " : "", idents[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        ret = prelude_string_cat(query, ")");
+        if ( ret < 0 )
+                return ret;
+
+        if ( desc->listed )
+                ret = prelude_string_sprintf(query, " AND %s_index != -1", desc->prefix);
+
+        return ret;
+}
+
+
+
+static int add_result(table_rows_t *rows, preludedb_sql_table_t *result)
+{
+        preludedb_sql_table_t **tmp;
+
+        tmp = realloc(rows->results, (rows->nresults + 1) * sizeof(*rows->results));
+        if ( ! tmp )
+                return preludedb_error_from_errno(errno);
+
+        rows->results = tmp;
+        rows->results[rows->nresults++] = result;
+
+        return 0;
+}
+
+
+
+static int add_row(const table_desc_t *desc, table_rows_t *rows, preludedb_sql_row_t *row)
+{
+        size_t size;
+        classic_assembly_row_t *tmp;
+
+        if ( rows->nrows == rows->size ) {
+                size = rows->size ? rows->size * 2 : ASSEMBLY_ROWS_MIN;
+
+                tmp = realloc(rows->rows, size * sizeof(*rows->rows));
+                if ( ! tmp )
+                        return preludedb_error_from_errno(errno);
+
+                rows->rows = tmp;
+                rows->size = size;
+        }
+
+        return read_key(desc, row, &rows->rows[rows->nrows++]);
+}
+
+
+
+static int load_table(classic_assembly_t *assembly, classic_assembly_table_t table)
+{
+        int ret = 0;
+        size_t i, count;
+        prelude_string_t *query;
+        preludedb_sql_row_t *row;
+        preludedb_sql_table_t *result;
+        const table_desc_t *desc = &tables[table];
+        table_rows_t *rows = &assembly->tables[table];
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < assembly->nidents; i += count ) {
+                count = assembly->nidents - i;
+                if ( count > ASSEMBLY_IDENTS_PER_QUERY )
+                        count = ASSEMBLY_IDENTS_PER_QUERY;
+
+                prelude_string_clear(query);
+
+                ret = build_query(desc, assembly->idents + i, count, query);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = preludedb_sql_query(assembly->sql, prelude_string_get_string(query), &result);
+                if ( ret < 0 )
+                        goto error;
+
+                if ( ret == 0 )
+                        continue;
+
+                ret = add_result(rows, result);
+                if ( ret < 0 ) {
+                        preludedb_sql_table_destroy(result);
+                        goto error;
+                }
+
+                /*
+                 * Fetch every row before the next query is issued, so that
+                 * no result stays pending on the connection.
+                 */
+                while ( (ret = preludedb_sql_table_fetch_row(result, &row)) > 0 ) {
+                        ret = add_row(desc, rows, row);
+                        if ( ret < 0 )
+                                goto error;
+                }
+
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        qsort(rows->rows, rows->nrows, sizeof(*rows->rows), compare_rows);
+        rows->loaded = TRUE;
+
+ error:
+        if ( ret < 0 )
+                rows->nrows = 0;
+
+        prelude_string_destroy(query);
+
+        return ret;
+}
+
+
+
+int classic_assembly_get_rows(classic_assembly_t *assembly, classic_assembly_table_t table,
+                              uint64_t message_ident, char parent_type,
+                              int parent0_index, int parent1_index, int parent2_index,
+                              classic_assembly_rows_t *out)
+{
+        int ret;
+        size_t low, high, mid;
+        classic_assembly_row_t key;
+        const table_desc_t *desc = &tables[table];
+        table_rows_t *rows = &assembly->tables[table];
+
+        if ( ! rows->loaded ) {
+                ret = load_table(assembly, table);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        memset(&key, 0, sizeof(key));
+        key.message_ident = message_ident;
+        key.parent_type = desc->parent_type ? parent_type : 0;
+        key.parent_index[0] = (desc->parents > 0) ? parent0_index : 0;
+        key.parent_index[1] = (desc->parents > 1) ? parent1_index : 0;
+        key.parent_index[2] = (desc->parents > 2) ? parent2_index : 0;
+
+        low = 0;
+        high = rows->nrows;
+
+        while ( low < high ) {
+                mid = low + (high - low) / 2;
+
+                if ( compare_parent(&rows->rows[mid], &key) < 0 )
+                        low = mid + 1;
+                else
+                        high = mid;
+        }
+
+        high = low;
+        while ( high < rows->nrows && compare_parent(&rows->rows[high], &key) == 0 )
+                high++;
+
+        out->next = rows->rows + low;
+        out->end = rows->rows + high;
+
+        return high - low;
+}
+
+
+
+int classic_assembly_rows_next(classic_assembly_rows_t *rows, preludedb_sql_row_t **row)
+{
+        if ( rows->next == rows->end )
+                return 0;
+
+        *row = (rows->next++)->row;
+
+        return 1;
+}
+
+
+
+preludedb_sql_t *classic_assembly_get_sql(classic_assembly_t *assembly)
+{
+        return assembly->sql;
+}
+
+
+
+/*
+ * Creates an assembly for the messages of @idents, duplicates being
+ * ignored. Nothing is queried until rows are requested.
+ */
+int classic_assembly_new(classic_assembly_t **assembly, preludedb_sql_t *sql, const uint64_t *idents, size_t count)
+{
+        size_t i, n = 0;
+
+        *assembly = calloc(1, sizeof(**assembly));
+        if ( ! *assembly )
+                return preludedb_error_from_errno(errno);
+
+        (*assembly)->sql = sql;
+
+        (*assembly)->idents = malloc((count ? count : 1) * sizeof(*idents));
+        if ( ! (*assembly)->idents ) {
+                free(*assembly);
+                return preludedb_error_from_errno(errno);
+        }
+
+        memcpy((*assembly)->idents, idents, count * sizeof(*idents));
+        qsort((*assembly)->idents, count, sizeof(*idents), compare_idents);
+
+        for ( i = 0; i < count; i++ ) {
+                if ( n == 0 || (*assembly)->idents[n - 1] != (*assembly)->idents[i] )
+                        (*assembly)->idents[n++] = (*assembly)->idents[i];
+        }
+
+        (*assembly)->nidents = n;
+
+        return 0;
+}
+
+
+
+void classic_assembly_destroy(classic_assembly_t *assembly)
+{
+        unsigned int i, j;
+
+        for ( i = 0; i < CLASSIC_ASSEMBLY_TABLE_COUNT; i++ ) {
+                for ( j = 0; j < assembly->tables[i].nresults; j++ )
+                        preludedb_sql_table_destroy(assembly->tables[i].results[j]);
+
+                free(assembly->tables[i].results);
+                free(assembly->tables[i].rows);
+        }
+
+        free(assembly->idents);
+        free(assembly);
+}
@@ -0,0 +1,385 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+/*
+ * Alerts may additionally be stored as a single row of Prelude_MessageBlob,
+ * holding the libprelude binary encoding of the whole message. Retrieving
+ * an alert then takes one primary key lookup instead of a query per table.
+ * The relational tables remain the reference: they are still written and
+ * searched, and blobs are dropped whenever the message is updated.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+#include <libprelude/idmef.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+
+#include "classic-compress.h"
+#include "classic-blob.h"
+
+
+#define BLOB_IDENTS_PER_QUERY 256
+
+
+typedef struct {
+        prelude_io_t *io;
+        int error;
+} blob_writer_t;
+
+
+
+static int is_enabled(preludedb_sql_t *sql)
+{
+        char *eptr;
+        const char *str;
+        unsigned long value;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_MESSAGE_BLOB);
+        if ( ! str )
+                return 0;
+
+        value = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "invalid value '%s' for setting '%s'",
+                                               str, PRELUDEDB_SQL_SETTING_MESSAGE_BLOB);
+
+        return value ? 1 : 0;
+}
+
+
+
+static int get_compression(preludedb_sql_t *sql, classic_compress_algorithm_t *algorithm)
+{
+        const char *str;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_MESSAGE_BLOB_COMPRESSION);
+        if ( ! str ) {
+                *algorithm = CLASSIC_COMPRESS_NONE;
+                return 0;
+        }
+
+        return classic_compress_algorithm_from_string(str, algorithm);
+}
+
+
+
+static int write_msg_cb(prelude_msgbuf_t *msgbuf, prelude_msg_t *msg)
+{
+        int ret;
+        blob_writer_t *writer = prelude_msgbuf_get_data(msgbuf);
+
+        ret = prelude_msg_write(msg, writer->io);
+        if ( ret < 0 && writer->error == 0 )
+                writer->error = ret;
+
+        prelude_msg_recycle(msg);
+
+        return ret;
+}
+
+
+
+static int encode_message(idmef_message_t *message, unsigned char **data, size_t *size)
+{
+        int ret;
+        FILE *fd;
+        blob_writer_t writer;
+        prelude_msgbuf_t *msgbuf;
+
+        *data = NULL;
+
+        fd = open_memstream((char **) data, size);
+        if ( ! fd )
+                return preludedb_error_from_errno(errno);
+
+        ret = prelude_io_new(&writer.io);
+        if ( ret < 0 ) {
+                fclose(fd);
+                free(*data);
+                return ret;
+        }
+
+        prelude_io_set_file_io(writer.io, fd);
+        writer.error = 0;
+
+        ret = prelude_msgbuf_new(&msgbuf);
+        if ( ret < 0 )
+                goto out;
+
+        prelude_msgbuf_set_data(msgbuf, &writer);
+        prelude_msgbuf_set_callback(msgbuf, write_msg_cb);
+
+        ret = idmef_message_write(message, msgbuf);
+        if ( ret >= 0 )
+                prelude_msgbuf_mark_end(msgbuf);
+
+        prelude_msgbuf_destroy(msgbuf);
+
+        if ( ret >= 0 )
+                ret = writer.error;
+
+ out:
+        /*
+         * Closing the stream is what makes *data and *size final.
+         */
+        prelude_io_destroy(writer.io);
+
+        if ( ret < 0 )
+                free(*data);
+
+        return ret;
+}
+
+
+
+static int decode_message(const unsigned char *data, size_t size, idmef_message_t **message)
+{
+        int ret;
+        FILE *fd;
+        prelude_io_t *io;
+        prelude_msg_t *msg = NULL;
+
+        fd = fmemopen((void *) data, size, "r");
+        if ( ! fd )
+                return preludedb_error_from_errno(errno);
+
+        ret = prelude_io_new(&io);
+        if ( ret < 0 ) {
+                fclose(fd);
+                return ret;
+        }
+
+        prelude_io_set_file_io(io, fd);
+
+        ret = prelude_msg_read(&msg, io);
+        prelude_io_destroy(io);
+
+        if ( ret < 0 )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "corrupted message blob: %s", prelude_strerror(ret));
+
+        ret = idmef_message_new(message);
+        if ( ret < 0 ) {
+                prelude_msg_destroy(msg);
+                return ret;
+        }
+
+        /*
+         * The decoded message refers to the data held by msg.
+         */
+        idmef_message_set_pmsg(*message, msg);
+
+        ret = idmef_message_read(*message, msg);
+        if ( ret < 0 ) {
+                idmef_message_destroy(*message);
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "corrupted message blob: %s", prelude_strerror(ret));
+        }
+
+        return 0;
+}
+
+
+
+int classic_blob_insert(preludedb_sql_t *sql, uint64_t ident, idmef_message_t *message)
+{
+        int ret;
+        size_t size, csize;
+        char *escaped;
+        unsigned char *data, *cdata;
+        classic_compress_algorithm_t algorithm;
+
+        ret = is_enabled(sql);
+        if ( ret <= 0 )
+                return ret;
+
+        ret = get_compression(sql, &algorithm);
+        if ( ret < 0 )
+                return ret;
+
+        ret = encode_message(message, &data, &size);
+        if ( ret < 0 )
+                return ret;
+
+        ret = classic_compress(algorithm, NULL, data, size, &cdata, &csize);
+        free(data);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_escape_binary(sql, cdata, csize, &escaped);
+        free(cdata);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_insert(sql, "Prelude_MessageBlob", "_message_ident, data", "%" PRELUDE_PRIu64 ", %s", ident, escaped);
+        free(escaped);
+
+        return ret;
+}
+
+
+
+static int read_blob(preludedb_sql_t *sql, preludedb_sql_field_t *field, idmef_message_t **message)
+{
+        int ret;
+        size_t size, dsize;
+        unsigned char *data, *ddata;
+
+        ret = preludedb_sql_unescape_binary(sql, preludedb_sql_field_get_value(field), preludedb_sql_field_get_len(field), &data, &size);
+        if ( ret < 0 )
+                return ret;
+
+        ret = classic_decompress(NULL, data, size, &ddata, &dsize);
+        if ( ret < 0 ) {
+                free(data);
+                return ret;
+        }
+
+        if ( ret == 1 ) {
+                free(data);
+                data = ddata;
+                size = dsize;
+        }
+
+        ret = decode_message(data, size, message);
+        free(data);
+
+        return ret;
+}
+
+
+
+static int get_blobs(preludedb_sql_t *sql, const uint64_t *idents, size_t count, idmef_message_t **messages)
+{
+        int ret, found = 0;
+        size_t i;
+        uint64_t ident;
+        prelude_string_t *query;
+        preludedb_sql_table_t *table;
+        preludedb_sql_row_t *row;
+        preludedb_sql_field_t *field;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_cat(query, "SELECT _message_ident, data FROM Prelude_MessageBlob WHERE _message_ident IN (");
+        if ( ret < 0 )
+                goto error;
+
+        for ( i = 0; i < count; i++ ) {
+                ret = prelude_string_sprintf(query, "%s%" PRELUDE_PRIu64, (i > 0) ? ", " : "", idents[i]);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = prelude_string_cat(query, ")");
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_query(sql, prelude_string_get_string(query), &table);
+        if ( ret <= 0 )
+                goto error;
+
+        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+                ret = preludedb_sql_row_get_field(row, 0, &field);
+                if ( ret < 0 )
+                        break;
+
+                ret = preludedb_sql_field_to_uint64(field, &ident);
+                if ( ret < 0 )
+                        break;
+
+                for ( i = 0; i < count && (idents[i] != ident || messages[i]); i++ );
+                if ( i == count )
+                        continue;
+
+                ret = preludedb_sql_row_get_field(row, 1, &field);
+                if ( ret < 0 )
+                        break;
+
+                ret = read_blob(sql, field, &messages[i]);
+                if ( ret < 0 ) {
+                        messages[i] = NULL;
+                        break;
+                }
+
+                found++;
+        }
+
+        preludedb_sql_table_destroy(table);
+
+ error:
+        prelude_string_destroy(query);
+
+        return (ret < 0) ? ret : found;
+}
+
+
+
+/*
+ * Fill @messages with the alerts of @idents that have a blob, leaving
+ * the others NULL, and return how many were found.
+ */
+int classic_blob_get_alerts(preludedb_sql_t *sql, const uint64_t *idents, size_t count, idmef_message_t **messages)
+{
+        int ret, found = 0;
+        size_t i, n;
+
+        for ( i = 0; i < count; i++ )
+                messages[i] = NULL;
+
+        ret = is_enabled(sql);
+        if ( ret <= 0 )
+                return ret;
+
+        for ( i = 0; i < count; i += n ) {
+                n = count - i;
+                if ( n > BLOB_IDENTS_PER_QUERY )
+                        n = BLOB_IDENTS_PER_QUERY;
+
+                ret = get_blobs(sql, idents + i, n, messages + i);
+                if ( ret < 0 )
+                        goto error;
+
+                found += ret;
+        }
+
+        return found;
+
+ error:
+        for ( i = 0; i < count; i++ ) {
+                if ( messages[i] ) {
+                        idmef_message_destroy(messages[i]);
+                        messages[i] = NULL;
+                }
+        }
+
+        return ret;
+}
@@ -0,0 +1,619 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_ZSTD
+# include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+# include <lz4.h>
+#endif
+
+#include <libprelude/prelude.h>
+
+#include "glthread/lock.h"
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+
+#include "classic-compress.h"
+
+
+/*
+ * Compressed values start with a small header: a 3 bytes magic, the
+ * algorithm and the uncompressed size as a big endian 32 bits integer.
+ * The first magic byte is never the first byte of a valid UTF-8 string,
+ * so that values written without compression can still be told apart
+ * from compressed ones.
+ */
+#define HEADER_SIZE 8
+#define HEADER_MAGIC "\xffPZ"
+#define HEADER_MAGIC_SIZE 3
+
+#define ZSTD_LEVEL 3
+
+/*
+ * Highest ratio each algorithm can reach: a 4 bytes zstd RLE block expands
+ * to 128 KiB, and an LZ4 match byte to 255 bytes.
+ */
+#define LZ4_MAX_RATIO  255
+#define ZSTD_MAX_RATIO 32768
+
+/*
+ * Column values smaller than this are stored as is: they gain little from
+ * compression, and remain usable in criteria.
+ */
+#define DEFAULT_COLUMN_THRESHOLD 512
+
+
+struct classic_compress_dict {
+#ifdef HAVE_ZSTD
+        ZSTD_CDict *cdict;
+        ZSTD_DDict *ddict;
+#else
+        char unused;
+#endif
+};
+
+
+static const struct {
+        const char *setting;
+} columns[] = {
+        { PRELUDEDB_SQL_SETTING_ADDITIONAL_DATA_COMPRESSION },
+        { PRELUDEDB_SQL_SETTING_OVERFLOW_ALERT_COMPRESSION },
+};
+
+
+static const char dict_key;
+
+gl_lock_define_initialized(static, dict_lock);
+
+
+static const struct {
+        const char *name;
+        classic_compress_algorithm_t algorithm;
+} algorithms[] = {
+        { "none", CLASSIC_COMPRESS_NONE },
+#ifdef HAVE_LZ4
+        { "lz4", CLASSIC_COMPRESS_LZ4 },
+#endif
+#ifdef HAVE_ZSTD
+        { "zstd", CLASSIC_COMPRESS_ZSTD },
+#endif
+};
+
+
+
+int classic_compress_algorithm_from_string(const char *str, classic_compress_algorithm_t *algorithm)
+{
+        size_t i;
+
+        for ( i = 0; i < sizeof(algorithms) / sizeof(*algorithms); i++ ) {
+                if ( strcmp(str, algorithms[i].name) == 0 ) {
+                        *algorithm = algorithms[i].algorithm;
+                        return 0;
+                }
+        }
+
+        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                       "compression algorithm '%s' is not supported", str);
+}
+
+
+
+static void write_header(unsigned char *output, classic_compress_algorithm_t algorithm, size_t size)
+{
+        memcpy(output, HEADER_MAGIC, HEADER_MAGIC_SIZE);
+
+        output[3] = algorithm;
+        output[4] = (size >> 24) & 0xff;
+        output[5] = (size >> 16) & 0xff;
+        output[6] = (size >> 8) & 0xff;
+        output[7] = size & 0xff;
+}
+
+
+
+static size_t compress_bound(classic_compress_algorithm_t algorithm, size_t size)
+{
+#ifdef HAVE_LZ4
+        if ( algorithm == CLASSIC_COMPRESS_LZ4 )
+                return LZ4_compressBound(size);
+#endif
+
+#ifdef HAVE_ZSTD
+        if ( algorithm == CLASSIC_COMPRESS_ZSTD )
+                return ZSTD_compressBound(size);
+#endif
+
+        return size;
+}
+
+
+
+/*
+ * Returns the compressed size, or 0 if @input does not compress.
+ */
+static size_t do_compress(classic_compress_algorithm_t algorithm, const classic_compress_dict_t *dict,
+                          const unsigned char *input, size_t size, unsigned char *output, size_t outsize)
+{
+#ifdef HAVE_LZ4
+        if ( algorithm == CLASSIC_COMPRESS_LZ4 ) {
+                int ret = LZ4_compress_default((const char *) input, (char *) output, size, outsize);
+                return (ret > 0) ? (size_t) ret : 0;
+        }
+#endif
+
+#ifdef HAVE_ZSTD
+        if ( algorithm == CLASSIC_COMPRESS_ZSTD && dict ) {
+                size_t ret;
+                ZSTD_CCtx *ctx;
+
+                ctx = ZSTD_createCCtx();
+                if ( ! ctx )
+                        return 0;
+
+                ret = ZSTD_compress_usingCDict(ctx, output, outsize, input, size, dict->cdict);
+                ZSTD_freeCCtx(ctx);
+
+                return ZSTD_isError(ret) ? 0 : ret;
+        }
+
+        if ( algorithm == CLASSIC_COMPRESS_ZSTD ) {
+                size_t ret = ZSTD_compress(output, outsize, input, size, ZSTD_LEVEL);
+                return ZSTD_isError(ret) ? 0 : ret;
+        }
+#endif
+
+        return 0;
+}
+
+
+
+/*
+ * Stores @input, with its header, into a new buffer. The value is kept
+ * uncompressed when @algorithm does not make it smaller. With zstd, @dict
+ * is used if not NULL.
+ */
+int classic_compress(classic_compress_algorithm_t algorithm, const classic_compress_dict_t *dict,
+                     const unsigned char *input, size_t size, unsigned char **output, size_t *outsize)
+{
+        size_t len = 0, bound;
+
+        if ( size > 0xffffffffUL )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "value of %lu bytes is too large to be compressed",
+                                               (unsigned long) size);
+
+        bound = compress_bound(algorithm, size);
+
+        *output = malloc(HEADER_SIZE + ((bound > size) ? bound : size));
+        if ( ! *output )
+                return preludedb_error_from_errno(errno);
+
+        if ( algorithm != CLASSIC_COMPRESS_NONE )
+                len = do_compress(algorithm, dict, input, size, *output + HEADER_SIZE, bound);
+
+        if ( algorithm == CLASSIC_COMPRESS_ZSTD && dict )
+                algorithm = CLASSIC_COMPRESS_ZSTD_DICT;
+
+        if ( len == 0 || len >= size ) {
+                algorithm = CLASSIC_COMPRESS_NONE;
+                memcpy(*output + HEADER_SIZE, input, size);
+                len = size;
+        }
+
+        write_header(*output, algorithm, size);
+        *outsize = HEADER_SIZE + len;
+
+        return 0;
+}
+
+
+
+/*
+ * Returns 1 if @len, the uncompressed size recorded in the header, is one
+ * that @algorithm can produce from the @size bytes of @input, 0 if not.
+ * This bounds the memory allocated for values read from the database.
+ */
+static int check_header(classic_compress_algorithm_t algorithm, const unsigned char *input, size_t size, size_t len)
+{
+        switch ( algorithm ) {
+        case CLASSIC_COMPRESS_NONE:
+                return len == size;
+
+        case CLASSIC_COMPRESS_LZ4:
+#ifdef HAVE_LZ4
+                return len / LZ4_MAX_RATIO <= size;
+#else
+                break;
+#endif
+
+        case CLASSIC_COMPRESS_ZSTD:
+        case CLASSIC_COMPRESS_ZSTD_DICT:
+#ifdef HAVE_ZSTD
+                return len / ZSTD_MAX_RATIO <= size && ZSTD_getFrameContentSize(input, size) == len;
+#else
+                break;
+#endif
+
+        default:
+                return 0;
+        }
+
+        return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "value compressed with unsupported algorithm %d", algorithm);
+}
+
+
+
+/*
+ * Returns 1 if @input does not decode to @outsize bytes.
+ */
+static int do_decompress(classic_compress_algorithm_t algorithm, const classic_compress_dict_t *dict,
+                         const unsigned char *input, size_t size, unsigned char *output, size_t outsize)
+{
+        switch ( algorithm ) {
+        case CLASSIC_COMPRESS_NONE:
+                if ( size != outsize )
+                        break;
+
+                memcpy(output, input, size);
+                return 0;
+
+#ifdef HAVE_LZ4
+        case CLASSIC_COMPRESS_LZ4:
+                if ( LZ4_decompress_safe((const char *) input, (char *) output, size, outsize) != (int) outsize )
+                        break;
+
+                return 0;
+#endif
+
+#ifdef HAVE_ZSTD
+        case CLASSIC_COMPRESS_ZSTD:
+                if ( ZSTD_decompress(output, outsize, input, size) != outsize )
+                        break;
+
+                return 0;
+
+        case CLASSIC_COMPRESS_ZSTD_DICT: {
+                size_t ret;
+                ZSTD_DCtx *ctx;
+
+                if ( ! dict )
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "value compressed with a dictionary, but setting '%s' is not set",
+                                                       PRELUDEDB_SQL_SETTING_COMPRESSION_DICTIONARY);
+
+                ctx = ZSTD_createDCtx();
+                if ( ! ctx )
+                        return preludedb_error_from_errno(ENOMEM);
+
+                ret = ZSTD_decompress_usingDDict(ctx, output, outsize, input, size, dict->ddict);
+                ZSTD_freeDCtx(ctx);
+
+                if ( ret != outsize )
+                        break;
+
+                return 0;
+        }
+#endif
+
+        default:
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "value compressed with unsupported algorithm %d", algorithm);
+        }
+
+        return 1;
+}
+
+
+
+/*
+ * Returns 0 without touching @output if @input has no compression header,
+ * 1 once @input is decompressed into a new buffer, that holds a trailing
+ * nul byte not accounted for in @outsize.
+ *
+ * Values stored as is before compression support may start like a
+ * compressed value: those whose header or data does not decode are
+ * considered to have no header.
+ */
+int classic_decompress(const classic_compress_dict_t *dict, const unsigned char *input, size_t size,
+                       unsigned char **output, size_t *outsize)
+{
+        int ret;
+        size_t len;
+
+        if ( size < HEADER_SIZE || memcmp(input, HEADER_MAGIC, HEADER_MAGIC_SIZE) != 0 )
+                return 0;
+
+        len = ((size_t) input[4] << 24) | ((size_t) input[5] << 16) | ((size_t) input[6] << 8) | input[7];
+
+        ret = check_header(input[3], input + HEADER_SIZE, size - HEADER_SIZE, len);
+        if ( ret <= 0 )
+                return ret;
+
+        *output = malloc(len + 1);
+        if ( ! *output )
+                return preludedb_error_from_errno(errno);
+
+        ret = do_decompress(input[3], dict, input + HEADER_SIZE, size - HEADER_SIZE, *output, len);
+        if ( ret != 0 ) {
+                free(*output);
+                return (ret < 0) ? ret : 0;
+        }
+
+        (*output)[len] = 0;
+        *outsize = len;
+
+        return 1;
+}
+
+
+
+static void dict_destroy(void *data)
+{
+        classic_compress_dict_t *dict = data;
+
+#ifdef HAVE_ZSTD
+        ZSTD_freeCDict(dict->cdict);
+        ZSTD_freeDDict(dict->ddict);
+#endif
+
+        free(dict);
+}
+
+
+
+#ifdef HAVE_ZSTD
+static int load_dict(const char *filename, classic_compress_dict_t **dict)
+{
+        int ret = 0;
+        long size;
+        FILE *fd;
+        void *buf;
+
+        fd = fopen(filename, "r");
+        if ( ! fd )
+                return preludedb_error_verbose(prelude_error_code_from_errno(errno), "could not open compression dictionary '%s': %s",
+                                               filename, strerror(errno));
+
+        if ( fseek(fd, 0, SEEK_END) < 0 || (size = ftell(fd)) < 0 || fseek(fd, 0, SEEK_SET) < 0 ) {
+                ret = preludedb_error_from_errno(errno);
+                fclose(fd);
+                return ret;
+        }
+
+        buf = malloc(size ? size : 1);
+        if ( ! buf ) {
+                ret = preludedb_error_from_errno(errno);
+                fclose(fd);
+                return ret;
+        }
+
+        if ( fread(buf, 1, size, fd) != (size_t) size ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "could not read compression dictionary '%s'", filename);
+                goto out;
+        }
+
+        *dict = calloc(1, sizeof(**dict));
+        if ( ! *dict ) {
+                ret = preludedb_error_from_errno(errno);
+                goto out;
+        }
+
+        (*dict)->cdict = ZSTD_createCDict(buf, size, ZSTD_LEVEL);
+        (*dict)->ddict = ZSTD_createDDict(buf, size);
+
+        if ( ! (*dict)->cdict || ! (*dict)->ddict ) {
+                dict_destroy(*dict);
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "invalid compression dictionary '%s'", filename);
+        }
+
+ out:
+        free(buf);
+        fclose(fd);
+
+        return ret;
+}
+#else
+static int load_dict(const char *filename, classic_compress_dict_t **dict)
+{
+        return preludedb_error_verbose(prelude_error_code_from_errno(ENOSYS),
+                                       "compression dictionaries require zstd support, which is not built in");
+}
+#endif
+
+
+
+/*
+ * The dictionary given by the compression_dictionary setting, loaded once
+ * per connection, or NULL if the setting is not set.
+ */
+static int get_dict(preludedb_sql_t *sql, classic_compress_dict_t **dict)
+{
+        int ret = 0;
+        const char *filename;
+
+        *dict = NULL;
+
+        filename = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_COMPRESSION_DICTIONARY);
+        if ( ! filename )
+                return 0;
+
+        gl_lock_lock(dict_lock);
+
+        *dict = preludedb_sql_get_data(sql, &dict_key);
+        if ( *dict )
+                goto out;
+
+        ret = load_dict(filename, dict);
+        if ( ret < 0 )
+                goto out;
+
+        ret = preludedb_sql_set_data(sql, &dict_key, *dict, dict_destroy);
+        if ( ret < 0 ) {
+                dict_destroy(*dict);
+                *dict = NULL;
+        }
+
+ out:
+        gl_lock_unlock(dict_lock);
+
+        return ret;
+}
+
+
+
+static int get_column_settings(preludedb_sql_t *sql, classic_compress_column_t column,
+                               classic_compress_algorithm_t *algorithm, size_t *threshold)
+{
+        int ret;
+        char *eptr;
+        const char *str;
+        unsigned long value;
+        const preludedb_sql_settings_t *settings = preludedb_sql_get_settings(sql);
+
+        str = preludedb_sql_settings_get(settings, columns[column].setting);
+        if ( ! str ) {
+                *algorithm = CLASSIC_COMPRESS_NONE;
+                return 0;
+        }
+
+        ret = classic_compress_algorithm_from_string(str, algorithm);
+        if ( ret < 0 )
+                return ret;
+
+        *threshold = DEFAULT_COLUMN_THRESHOLD;
+
+        str = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_COMPRESSION_THRESHOLD);
+        if ( ! str )
+                return 0;
+
+        value = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "invalid value '%s' for setting '%s'",
+                                               str, PRELUDEDB_SQL_SETTING_COMPRESSION_THRESHOLD);
+
+        *threshold = value;
+
+        return 0;
+}
+
+
+
+/*
+ * Escape @input for insertion within @column, compressing it first if
+ * compression is enabled for this column.
+ */
+int classic_compress_escape_column(preludedb_sql_t *sql, classic_compress_column_t column,
+                                   const unsigned char *input, size_t size, char **output)
+{
+        int ret;
+        size_t csize;
+        unsigned char *cdata;
+        size_t threshold = 0;
+        classic_compress_dict_t *dict = NULL;
+        classic_compress_algorithm_t algorithm;
+
+        ret = get_column_settings(sql, column, &algorithm, &threshold);
+        if ( ret < 0 )
+                return ret;
+
+        /*
+         * Values left as is are still wrapped if they happen to start
+         * like a compressed value, so that they are read back unchanged.
+         */
+        if ( algorithm == CLASSIC_COMPRESS_NONE || size < threshold ) {
+                if ( size < HEADER_SIZE || memcmp(input, HEADER_MAGIC, HEADER_MAGIC_SIZE) != 0 )
+                        return preludedb_sql_escape_binary(sql, input, size, output);
+
+                algorithm = CLASSIC_COMPRESS_NONE;
+        }
+
+        if ( algorithm == CLASSIC_COMPRESS_ZSTD ) {
+                ret = get_dict(sql, &dict);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        ret = classic_compress(algorithm, dict, input, size, &cdata, &csize);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_escape_binary(sql, cdata, csize, output);
+        free(cdata);
+
+        return ret;
+}
+
+
+
+/*
+ * Unescape the value of @field, decompressing it if it was stored
+ * compressed. Values written before compression was enabled are returned
+ * as is.
+ */
+int classic_compress_unescape_column(preludedb_sql_t *sql, preludedb_sql_field_t *field,
+                                     unsigned char **output, size_t *outsize)
+{
+        int ret;
+        size_t size, dsize;
+        unsigned char *data, *ddata;
+        classic_compress_dict_t *dict;
+
+        ret = preludedb_sql_unescape_binary(sql, preludedb_sql_field_get_value(field), preludedb_sql_field_get_len(field), &data, &size);
+        if ( ret < 0 )
+                return ret;
+
+        if ( size >= HEADER_SIZE && memcmp(data, HEADER_MAGIC, HEADER_MAGIC_SIZE) == 0 && data[3] == CLASSIC_COMPRESS_ZSTD_DICT ) {
+                ret = get_dict(sql, &dict);
+                if ( ret < 0 ) {
+                        free(data);
+                        return ret;
+                }
+        } else
+                dict = NULL;
+
+        ret = classic_decompress(dict, data, size, &ddata, &dsize);
+        if ( ret < 0 ) {
+                free(data);
+                return ret;
+        }
+
+        if ( ret == 0 ) {
+                *output = data;
+                *outsize = size;
+                return 0;
+        }
+
+        free(data);
+
+        *output = ddata;
+        *outsize = dsize;
+
+        return 0;
+}
@@ -89,6 +89,7 @@ static int do_delete_alert(preludedb_sql_t *sql, const char *idents)
                 "DELETE FROM Prelude_Inode WHERE _message_ident %s",
                 "DELETE FROM Prelude_Checksum WHERE _message_ident %s",
                 "DELETE FROM Prelude_Linkage WHERE _message_ident %s",
+                "DELETE FROM Prelude_MessageBlob WHERE _message_ident %s",
                 "DELETE FROM Prelude_Node WHERE _message_ident %s AND _parent_type != 'H'",
                 "DELETE FROM Prelude_OverflowAlert WHERE _message_ident %s",
                 "DELETE FROM Prelude_Process WHERE _message_ident %s AND _parent_type != 'H'",
@@ -122,6 +123,7 @@ static int do_delete_heartbeat(preludedb_sql_t *sql, const char *idents)
                 "DELETE FROM Prelude_Process WHERE _parent_type = 'H' AND _message_ident %s",
                 "DELETE FROM Prelude_ProcessArg WHERE _parent_type = 'H' AND _message_ident %s",
                 "DELETE FROM Prelude_ProcessEnv WHERE _parent_type = 'H' AND _message_ident %s",
+                "DELETE FROM Prelude_HeartbeatState WHERE _message_ident %s",
                 "DELETE FROM Prelude_Heartbeat WHERE _ident %s",
         };
 
@@ -129,7 +131,7 @@ static int do_delete_heartbeat(preludedb_sql_t *sql, const char *idents)
 }
 
 
-static ssize_t get_string_from_ident_list(prelude_string_t **out, uint64_t *ident, size_t size)
+ssize_t classic_ident_list_to_string(prelude_string_t **out, uint64_t *ident, size_t size)
 {
         int ret;
         size_t i;
@@ -165,7 +167,7 @@ static ssize_t get_string_from_ident_list(prelude_string_t **out, uint64_t *iden
 
 
 
-static ssize_t get_string_from_result_ident(prelude_string_t **out, preludedb_result_idents_t *res)
+ssize_t classic_result_idents_to_string(prelude_string_t **out, preludedb_result_idents_t *res)
 {
         int ret;
         uint64_t ident;
@@ -236,7 +238,7 @@ ssize_t classic_delete_alert_from_result_idents(preludedb_t *db, preludedb_resul
         ssize_t count;
         prelude_string_t *buf;
 
-        count = get_string_from_result_ident(&buf, results);
+        count = classic_result_idents_to_string(&buf, results);
         if ( count <= 0 )
                 return count;
 
@@ -253,7 +255,7 @@ ssize_t classic_delete_alert_from_list(preludedb_t *db, uint64_t *ident, size_t
         ssize_t count;
         prelude_string_t *buf;
 
-        count = get_string_from_ident_list(&buf, ident, size);
+        count = classic_ident_list_to_string(&buf, ident, size);
         if ( count < 0 )
                 return count;
 
@@ -271,7 +273,7 @@ ssize_t classic_delete_heartbeat_from_result_idents(preludedb_t *db, preludedb_r
         ssize_t count;
         prelude_string_t *buf;
 
-        count = get_string_from_result_ident(&buf, results);
+        count = classic_result_idents_to_string(&buf, results);
         if ( count <= 0 )
                 return count;
 
@@ -289,7 +291,7 @@ ssize_t classic_delete_heartbeat_from_list(preludedb_t *db, uint64_t *ident, siz
         ssize_t count;
         prelude_string_t *buf;
 
-        count = get_string_from_ident_list(&buf, ident, size);
+        count = classic_ident_list_to_string(&buf, ident, size);
         if ( count < 0 )
                 return count;
 
@@ -0,0 +1,509 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+
+#include "glthread/lock.h"
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+
+#include "classic-dict.h"
+
+
+/*
+ * With the "dictionary" setting, the strings of the analyzer, node and
+ * classification rows, which are repeated over most messages, are
+ * interned once in a dictionary table, and rows only reference the
+ * dictionary entry through their _dict_ident column.
+ *
+ * A dictionary entry is identified by a 63 bits hash of its values, so
+ * that the reference is known without a round trip: the database is
+ * only queried to insert the entry the first time it is seen by this
+ * process, and to check that it does not collide with another one, in
+ * which case the values are stored inline as without the setting.
+ */
+#define DICT_MAX_COLUMNS 7
+#define DICT_CACHE_BUCKETS 4096
+#define DICT_CACHE_MAX_ENTRIES 65536
+
+
+typedef struct {
+        const char *table;
+        const char *dict_table;
+        const char *fields;
+        const char *columns[DICT_MAX_COLUMNS + 1];
+} dict_desc_t;
+
+
+typedef struct {
+        prelude_list_t list;
+        uint64_t ident;
+        uint64_t check;
+} dict_entry_t;
+
+
+typedef struct {
+        gl_lock_t mutex;
+        size_t count;
+        prelude_list_t buckets[DICT_CACHE_BUCKETS];
+} dict_cache_t;
+
+
+typedef struct {
+        uint64_t ident;
+        uint64_t check;
+} dict_pending_t;
+
+
+static const dict_desc_t dicts[] = {
+        { "Prelude_Analyzer", "Prelude_AnalyzerDict",
+          "name, manufacturer, model, version, class, ostype, osversion",
+          { "name", "manufacturer", "model", "version", "class", "ostype", "osversion", NULL } },
+
+        { "Prelude_Node", "Prelude_NodeDict",
+          "category, location, name",
+          { "category", "location", "name", NULL } },
+
+        { "Prelude_Classification", "Prelude_ClassificationDict",
+          "text",
+          { "text", NULL } },
+};
+
+
+/*
+ * Only its address matters, as the key of the cache attached to a sql object.
+ */
+static const char dict_cache_key;
+
+gl_lock_define_initialized(static, dict_cache_lock);
+
+
+
+static const dict_desc_t *search_dict(const char *table)
+{
+        unsigned int i;
+
+        for ( i = 0; i < sizeof(dicts) / sizeof(*dicts); i++ ) {
+                if ( strcmp(dicts[i].table, table) == 0 )
+                        return &dicts[i];
+        }
+
+        return NULL;
+}
+
+
+
+const char *classic_dict_get_table(const char *table)
+{
+        const dict_desc_t *dict = search_dict(table);
+        return dict ? dict->dict_table : NULL;
+}
+
+
+
+prelude_bool_t classic_dict_has_column(const char *table, const char *column)
+{
+        unsigned int i;
+        const dict_desc_t *dict = search_dict(table);
+
+        if ( ! dict )
+                return FALSE;
+
+        for ( i = 0; dict->columns[i]; i++ ) {
+                if ( strcmp(dict->columns[i], column) == 0 )
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
+
+
+static uint64_t hash_update(uint64_t hash, const void *data, size_t len)
+{
+        size_t i;
+        const unsigned char *ptr = data;
+
+        for ( i = 0; i < len; i++ ) {
+                hash ^= ptr[i];
+                hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+}
+
+
+
+/*
+ * FNV-1a of the values, each prefixed with a marker telling NULL apart
+ * from the empty string.
+ */
+static uint64_t hash_values(uint64_t hash, classic_dict_type_t type, const char * const *values, size_t size)
+{
+        size_t i;
+        unsigned char marker;
+
+        marker = type;
+        hash = hash_update(hash, &marker, 1);
+
+        for ( i = 0; i < size; i++ ) {
+                marker = values[i] ? 1 : 0;
+                hash = hash_update(hash, &marker, 1);
+
+                if ( values[i] )
+                        hash = hash_update(hash, values[i], strlen(values[i]) + 1);
+        }
+
+        return hash;
+}
+
+
+
+static void dict_cache_clear(dict_cache_t *cache)
+{
+        size_t i;
+        prelude_list_t *tmp, *bkp;
+
+        for ( i = 0; i < DICT_CACHE_BUCKETS; i++ ) {
+                prelude_list_for_each_safe(&cache->buckets[i], tmp, bkp) {
+                        prelude_list_del(tmp);
+                        free(prelude_list_entry(tmp, dict_entry_t, list));
+                }
+        }
+
+        cache->count = 0;
+}
+
+
+
+static void dict_cache_destroy(void *data)
+{
+        dict_cache_t *cache = data;
+
+        dict_cache_clear(cache);
+        gl_lock_destroy(cache->mutex);
+        free(cache);
+}
+
+
+
+static int get_dict_cache(preludedb_sql_t *sql, dict_cache_t **out)
+{
+        int ret = 0;
+        size_t i;
+        dict_cache_t *cache;
+
+        gl_lock_lock(dict_cache_lock);
+
+        cache = preludedb_sql_get_data(sql, &dict_cache_key);
+        if ( cache )
+                goto out;
+
+        cache = malloc(sizeof(*cache));
+        if ( ! cache ) {
+                ret = preludedb_error_from_errno(errno);
+                goto out;
+        }
+
+        cache->count = 0;
+        gl_lock_init(cache->mutex);
+
+        for ( i = 0; i < DICT_CACHE_BUCKETS; i++ )
+                prelude_list_init(&cache->buckets[i]);
+
+        ret = preludedb_sql_set_data(sql, &dict_cache_key, cache, dict_cache_destroy);
+        if ( ret < 0 ) {
+                dict_cache_destroy(cache);
+                cache = NULL;
+        }
+
+ out:
+        gl_lock_unlock(dict_cache_lock);
+        *out = cache;
+
+        return ret;
+}
+
+
+
+static prelude_bool_t dict_cache_lookup(dict_cache_t *cache, uint64_t ident, uint64_t check)
+{
+        prelude_list_t *tmp;
+        dict_entry_t *entry;
+        prelude_bool_t found = FALSE;
+
+        gl_lock_lock(cache->mutex);
+
+        prelude_list_for_each(&cache->buckets[ident % DICT_CACHE_BUCKETS], tmp) {
+                entry = prelude_list_entry(tmp, dict_entry_t, list);
+                if ( entry->ident == ident && entry->check == check ) {
+                        found = TRUE;
+                        break;
+                }
+        }
+
+        gl_lock_unlock(cache->mutex);
+
+        return found;
+}
+
+
+
+static void dict_cache_add(dict_cache_t *cache, uint64_t ident, uint64_t check)
+{
+        dict_entry_t *entry;
+
+        entry = malloc(sizeof(*entry));
+        if ( ! entry )
+                return;
+
+        entry->ident = ident;
+        entry->check = check;
+
+        gl_lock_lock(cache->mutex);
+
+        /*
+         * Dictionaries are expected to stay small: should they not, start
+         * over rather than keeping track of the least used entries.
+         */
+        if ( cache->count == DICT_CACHE_MAX_ENTRIES )
+                dict_cache_clear(cache);
+
+        prelude_list_add(&cache->buckets[ident % DICT_CACHE_BUCKETS], &entry->list);
+        cache->count++;
+
+        gl_lock_unlock(cache->mutex);
+}
+
+
+
+/*
+ * An entry inserted within a transaction only exists once it is
+ * committed: it is cached then, and forgotten if rolled back.
+ */
+static void transaction_ended_cb(preludedb_sql_t *sql, prelude_bool_t committed, void *data)
+{
+        dict_cache_t *cache;
+        dict_pending_t *pending = data;
+
+        if ( committed && get_dict_cache(sql, &cache) == 0 )
+                dict_cache_add(cache, pending->ident, pending->check);
+
+        free(pending);
+}
+
+
+
+static void dict_cache_add_committed(preludedb_sql_t *sql, dict_cache_t *cache, uint64_t ident, uint64_t check)
+{
+        int ret;
+        dict_pending_t *pending;
+
+        pending = malloc(sizeof(*pending));
+        if ( ! pending )
+                return;
+
+        pending->ident = ident;
+        pending->check = check;
+
+        ret = preludedb_sql_transaction_add_callback(sql, transaction_ended_cb, pending);
+        if ( ret < 0 ) {
+                free(pending);
+
+                if ( prelude_error_get_code(ret) == PRELUDEDB_ERROR_NOT_IN_TRANSACTION )
+                        dict_cache_add(cache, ident, check);
+        }
+}
+
+
+
+static int is_enabled(preludedb_sql_t *sql)
+{
+        char *eptr;
+        const char *str;
+        unsigned long value;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_DICTIONARY);
+        if ( ! str )
+                return 0;
+
+        value = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "invalid value '%s' for setting '%s'",
+                                               str, PRELUDEDB_SQL_SETTING_DICTIONARY);
+
+        return value ? 1 : 0;
+}
+
+
+
+static int insert_entry(preludedb_sql_t *sql, const dict_desc_t *dict, uint64_t ident,
+                        const char * const *values, size_t size)
+{
+        int ret;
+        size_t i;
+        prelude_string_t *fields, *output;
+
+        ret = prelude_string_new(&fields);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_new(&output);
+        if ( ret < 0 ) {
+                prelude_string_destroy(fields);
+                return ret;
+        }
+
+        ret = prelude_string_sprintf(fields, "_ident, %s", dict->fields);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_sprintf(output, "%" PRELUDE_PRIu64, ident);
+        if ( ret < 0 )
+                goto error;
+
+        for ( i = 0; i < size; i++ ) {
+                ret = prelude_string_cat(output, ", ");
+                if ( ret < 0 )
+                        goto error;
+
+                ret = preludedb_sql_escape_append(sql, output, values[i], values[i] ? strlen(values[i]) : 0);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = preludedb_sql_insert_ignore(sql, dict->dict_table, prelude_string_get_string(fields), "_ident",
+                                          "%s", prelude_string_get_string(output));
+
+ error:
+        prelude_string_destroy(output);
+        prelude_string_destroy(fields);
+
+        return ret;
+}
+
+
+
+/*
+ * Returns 1 if the entry @ident holds @values, 0 if it holds other values.
+ */
+static int check_entry(preludedb_sql_t *sql, const dict_desc_t *dict, uint64_t ident,
+                       const char * const *values, size_t size)
+{
+        int ret;
+        size_t i;
+        const char *value;
+        preludedb_sql_row_t *row;
+        preludedb_sql_field_t *field;
+        preludedb_sql_table_t *table;
+
+        ret = preludedb_sql_query_sprintf(sql, &table, "SELECT %s FROM %s WHERE _ident = %" PRELUDE_PRIu64,
+                                          dict->fields, dict->dict_table, ident);
+        if ( ret <= 0 )
+                return ret;
+
+        ret = preludedb_sql_table_fetch_row(table, &row);
+        if ( ret <= 0 )
+                goto error;
+
+        for ( i = 0; i < size; i++ ) {
+                ret = preludedb_sql_row_get_field(row, i, &field);
+                if ( ret < 0 )
+                        goto error;
+
+                value = (ret > 0) ? preludedb_sql_field_get_value(field) : NULL;
+
+                if ( (! value) != (! values[i]) || (value && strcmp(value, values[i]) != 0) ) {
+                        ret = 0;
+                        goto error;
+                }
+        }
+
+        ret = 1;
+
+ error:
+        preludedb_sql_table_destroy(table);
+
+        return ret;
+}
+
+
+
+/*
+ * Intern @values, the values of the dictionary columns of the rows of
+ * @type, in their listed order. Returns 1 and the entry in @ident if
+ * the row is to reference it, or 0 if the values are to be stored
+ * inline.
+ */
+int classic_dict_intern(preludedb_sql_t *sql, classic_dict_type_t type, const char * const *values, uint64_t *ident)
+{
+        int ret;
+        size_t size;
+        uint64_t check;
+        dict_cache_t *cache;
+        const dict_desc_t *dict = &dicts[type];
+
+        ret = is_enabled(sql);
+        if ( ret <= 0 )
+                return ret;
+
+        for ( size = 0; dict->columns[size]; size++ );
+
+        *ident = hash_values(0xcbf29ce484222325ULL, type, values, size) & 0x7fffffffffffffffULL;
+        check = hash_values(0x84222325cbf29ce4ULL, type, values, size);
+
+        ret = get_dict_cache(sql, &cache);
+        if ( ret < 0 )
+                return ret;
+
+        if ( dict_cache_lookup(cache, *ident, check) )
+                return 1;
+
+        ret = insert_entry(sql, dict, *ident, values, size);
+        if ( ret < 0 ) {
+                /*
+                 * Databases lacking an INSERT ... ON CONFLICT statement
+                 * keep storing the values inline.
+                 */
+                if ( prelude_error_get_code(ret) == prelude_error_code_from_errno(ENOSYS) )
+                        return 0;
+
+                return ret;
+        }
+
+        ret = check_entry(sql, dict, *ident, values, size);
+        if ( ret <= 0 )
+                return ret;
+
+        dict_cache_add_committed(sql, cache, *ident, check);
+
+        return 1;
+}
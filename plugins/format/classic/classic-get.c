@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <time.h>
 
@@ -34,13 +35,50 @@
 #include <libprelude/idmef-tree-wrap.h>
 
 #include "preludedb.h"
+#include "classic-assemble.h"
+#include "classic-blob.h"
+#include "classic-compress.h"
 #include "classic-get.h"
 
 #define db_log(sql) prelude_log(PRELUDE_LOG_ERR, "%s\n", prelude_sql_error(sql))
 #define log_memory_exhausted() prelude_log(PRELUDE_LOG_ERR, "memory exhausted !\n")
 
+/*
+ * Alert subtrees, each of them stored in its own set of tables.
+ */
+#define SUBTREE_ASSESSMENT        0x0001
+#define SUBTREE_ANALYZER          0x0002
+#define SUBTREE_CREATE_TIME       0x0004
+#define SUBTREE_DETECT_TIME       0x0008
+#define SUBTREE_ANALYZER_TIME     0x0010
+#define SUBTREE_SOURCE            0x0020
+#define SUBTREE_TARGET            0x0040
+#define SUBTREE_CLASSIFICATION    0x0080
+#define SUBTREE_ADDITIONAL_DATA   0x0100
+#define SUBTREE_TOOL_ALERT        0x0200
+#define SUBTREE_CORRELATION_ALERT 0x0400
+#define SUBTREE_OVERFLOW_ALERT    0x0800
+#define SUBTREE_ALL               0x0fff
+
+/*
+ * Source and target children, fetched separately from the
+ * Prelude_Source and Prelude_Target rows.
+ */
+#define CHILD_NODE                0x01
+#define CHILD_USER                0x02
+#define CHILD_PROCESS             0x04
+#define CHILD_SERVICE             0x08
+#define CHILD_FILE                0x10
+#define CHILD_ALL                 0x1f
+
+/*
+ * Layout of the mask of fetched subtrees kept by lazy alerts.
+ */
+#define FETCHED_SOURCE_SHIFT      12
+#define FETCHED_TARGET_SHIFT      17
+
 #define get_(type, name)                                                                        \
-static int _get_ ## name (preludedb_sql_t *sql, preludedb_sql_row_t *row,                       \
+static int _get_ ## name (preludedb_sql_row_t *row,                                             \
                          int index,                                                             \
                          void *parent, int (*parent_new_child)(void *parent, type **child))     \
 {                                                                                               \
@@ -64,24 +102,24 @@ get_(uint16_t, uint16)
 get_(uint32_t, uint32)
 get_(float, float)
 
-#define get_uint8(sql, row, index, parent, parent_new_child) \
-        _get_uint8(sql, row, index, parent, (int (*)(void *, uint8_t **)) parent_new_child)
+#define get_uint8(row, index, parent, parent_new_child) \
+        _get_uint8(row, index, parent, (int (*)(void *, uint8_t **)) parent_new_child)
 
-#define get_uint16(sql, row, index, parent, parent_new_child) \
-        _get_uint16(sql, row, index, parent, (int (*)(void *, uint16_t **)) parent_new_child)
+#define get_uint16(row, index, parent, parent_new_child) \
+        _get_uint16(row, index, parent, (int (*)(void *, uint16_t **)) parent_new_child)
 
-#define get_uint32(sql, row, index, parent, parent_new_child) \
-        _get_uint32(sql, row, index, parent, (int (*)(void *, uint32_t **)) parent_new_child)
+#define get_uint32(row, index, parent, parent_new_child) \
+        _get_uint32(row, index, parent, (int (*)(void *, uint32_t **)) parent_new_child)
 
-#define get_float(sql, row, index, parent, parent_new_child) \
-        _get_float(sql, row, index, parent, (int (*)(void *, float **)) parent_new_child)
+#define get_float(row, index, parent, parent_new_child) \
+        _get_float(row, index, parent, (int (*)(void *, float **)) parent_new_child)
 
 
 int classic_unescape_binary_safe(preludedb_sql_t *sql, preludedb_sql_field_t *field,
                                  idmef_additional_data_type_t type, unsigned char **output, size_t *outsize);
 
 
-static int _get_string(preludedb_sql_t *sql, preludedb_sql_row_t *row,
+static int _get_string(preludedb_sql_row_t *row,
                        int index,
                        void *parent, int (*parent_new_child)(void *parent, prelude_string_t **child))
 {
@@ -105,7 +143,7 @@ static int _get_string(preludedb_sql_t *sql, preludedb_sql_row_t *row,
 }
 
 
-static int _get_string_listed(preludedb_sql_t *sql, preludedb_sql_row_t *row,
+static int _get_string_listed(preludedb_sql_row_t *row,
                               int index,
                               void *parent, int (*parent_new_child)(void *parent, prelude_string_t **child, int pos))
 {
@@ -130,7 +168,7 @@ static int _get_string_listed(preludedb_sql_t *sql, preludedb_sql_row_t *row,
 
 
 
-static int _get_enum(preludedb_sql_t *sql, preludedb_sql_row_t *row,
+static int _get_enum(preludedb_sql_row_t *row,
                      int index,
                      void *parent, int (*parent_new_child)(void *parent, int **child), int (*convert_enum)(const char *))
 {
@@ -153,7 +191,7 @@ static int _get_enum(preludedb_sql_t *sql, preludedb_sql_row_t *row,
 
 
 
-static int _get_timestamp(preludedb_sql_t *sql, preludedb_sql_row_t *row,
+static int _get_timestamp(preludedb_sql_row_t *row,
                           int time_index, int gmtoff_index, int usec_index,
                           void *parent, int (*parent_new_child)(void *parent, idmef_time_t **child))
 {
@@ -195,110 +233,92 @@ static int _get_timestamp(preludedb_sql_t *sql, preludedb_sql_row_t *row,
         return preludedb_sql_time_from_timestamp(time, tmp, gmtoff, usec);
 }
 
-#define get_string(sql, row, index, parent, parent_new_child) \
-        _get_string(sql, row, index, parent, (int (*)(void *, prelude_string_t **)) parent_new_child)
+#define get_string(row, index, parent, parent_new_child) \
+        _get_string(row, index, parent, (int (*)(void *, prelude_string_t **)) parent_new_child)
 
-#define get_string_listed(sql, row, index, parent, parent_new_child) \
-        _get_string_listed(sql, row, index, parent, (int (*)(void *, prelude_string_t **, int)) parent_new_child)
+#define get_string_listed(row, index, parent, parent_new_child) \
+        _get_string_listed(row, index, parent, (int (*)(void *, prelude_string_t **, int)) parent_new_child)
 
-#define get_enum(sql, row, index, parent, parent_new_child, convert_enum) \
-        _get_enum(sql, row, index, parent, (int (*)(void *, int **)) parent_new_child, convert_enum)
+#define get_enum(row, index, parent, parent_new_child, convert_enum) \
+        _get_enum(row, index, parent, (int (*)(void *, int **)) parent_new_child, convert_enum)
 
-#define get_timestamp(sql, row, time_index, gmtoff_index, usec_index, parent, parent_new_child) \
-        _get_timestamp(sql, row, time_index, gmtoff_index, usec_index, parent, (int (*)(void *, idmef_time_t **)) parent_new_child)
+#define get_timestamp(row, time_index, gmtoff_index, usec_index, parent, parent_new_child) \
+        _get_timestamp(row, time_index, gmtoff_index, usec_index, parent, (int (*)(void *, idmef_time_t **)) parent_new_child)
 
 
 
-static int get_analyzer_time(preludedb_sql_t *sql,
+static int get_analyzer_time(classic_assembly_t *assembly,
                              uint64_t message_ident,
                              char parent_type,
                              void *parent,
                              int (*parent_new_child)(void *parent, idmef_time_t **child))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT time, gmtoff, usec "
-                                          "FROM Prelude_AnalyzerTime "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 "",
-                                          parent_type, message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ANALYZER_TIME, message_ident, parent_type, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
-        ret = get_timestamp(sql, row, 0, 1, 2, parent, parent_new_child);
+        ret = get_timestamp(row, 0, 1, 2, parent, parent_new_child);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_detect_time(preludedb_sql_t *sql,
+static int get_detect_time(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT time, gmtoff, usec "
-                                          "FROM Prelude_DetectTime "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_DETECT_TIME, message_ident, 0, 0, 0, 0, &rows);
 
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
-        ret = get_timestamp(sql, row, 0, 1, 2, alert, idmef_alert_new_detect_time);
+        ret = get_timestamp(row, 0, 1, 2, alert, idmef_alert_new_detect_time);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_create_time(preludedb_sql_t *sql,
+static int get_create_time(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            char parent_type,
                            void *parent,
                            int (*parent_new_child)(void *parent, idmef_time_t **time))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                         "SELECT time, gmtoff, usec "
-                                         "FROM Prelude_CreateTime "
-                                         "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 "",
-                                         parent_type, message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_CREATE_TIME, message_ident, parent_type, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
-        ret = get_timestamp(sql, row, 0, 1, 2, parent, parent_new_child);
+        ret = get_timestamp(row, 0, 1, 2, parent, parent_new_child);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_user_id(preludedb_sql_t *sql,
+static int get_user_id(classic_assembly_t *assembly,
                        uint64_t message_ident,
                        char parent_type,
                        int parent_index,
@@ -307,22 +327,17 @@ static int get_user_id(preludedb_sql_t *sql,
                        void *parent, prelude_bool_t listed,
                        int (*_parent_new_child)(void *, idmef_user_id_t **child))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_user_id_t *user_id;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, type, name, number, tty "
-                                          "FROM Prelude_UserId "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND "
-                                          "_parent0_index = %d AND _parent1_index = %d AND _parent2_index = %d AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          parent_type, message_ident, parent_index, file_index, file_access_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_USER_ID, message_ident,
+                                        parent_type, parent_index, file_index, file_access_index, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 if ( listed ) {
                         int (*parent_new_child)(void *parent, idmef_user_id_t **, int) =
@@ -336,54 +351,48 @@ static int get_user_id(preludedb_sql_t *sql,
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, user_id, idmef_user_id_new_ident);
+                ret = get_string(row, 0, user_id, idmef_user_id_new_ident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 1, user_id, idmef_user_id_new_type, idmef_user_id_type_to_numeric);
+                ret = get_enum(row, 1, user_id, idmef_user_id_new_type, idmef_user_id_type_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, user_id, idmef_user_id_new_name);
+                ret = get_string(row, 2, user_id, idmef_user_id_new_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_uint32(sql, row, 3, user_id, idmef_user_id_new_number);
+                ret = get_uint32(row, 3, user_id, idmef_user_id_new_number);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 4, user_id, idmef_user_id_new_tty);
+                ret = get_string(row, 4, user_id, idmef_user_id_new_tty);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_user(preludedb_sql_t *sql,
+static int get_user(classic_assembly_t *assembly,
                     uint64_t message_ident,
                     char parent_type,
                     int parent_index,
                     void *parent,
                     int (*parent_new_child)(void *parent, idmef_user_t **child))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_user_t *user;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, category "
-                                          "FROM Prelude_User "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_USER, message_ident, parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -391,110 +400,93 @@ static int get_user(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, user, idmef_user_new_ident);
+        ret = get_string(row, 0, user, idmef_user_new_ident);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 1, user, idmef_user_new_category, idmef_user_category_to_numeric);
+        ret = get_enum(row, 1, user, idmef_user_new_category, idmef_user_category_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_user_id(sql, message_ident, parent_type, parent_index, 0, 0, user,
+        ret = get_user_id(assembly, message_ident, parent_type, parent_index, 0, 0, user,
                           TRUE, (int (*)(void *, idmef_user_id_t **)) idmef_user_new_user_id);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_process_arg(preludedb_sql_t *sql,
+static int get_process_arg(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            char parent_type,
                            char parent_index,
                            void *parent,
                            int (*parent_new_child)(void *parent, prelude_string_t **child, int pos))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT arg "
-                                          "FROM Prelude_ProcessArg "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _index != -1 ORDER BY _index ASC",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_PROCESS_ARG, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
-                ret = get_string_listed(sql, row, 0, parent, parent_new_child);
+                ret = get_string_listed(row, 0, parent, parent_new_child);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_process_env(preludedb_sql_t *sql,
+static int get_process_env(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            char parent_type,
                            int parent_index,
                            void *parent,
                            int (*parent_new_child)(void *parent, prelude_string_t **child, int pos))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT env "
-                                          "FROM Prelude_ProcessEnv "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _index != -1 ORDER BY _index ASC",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_PROCESS_ENV, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
-                ret = get_string_listed(sql, row, 0, parent, parent_new_child);
+                ret = get_string_listed(row, 0, parent, parent_new_child);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_process(preludedb_sql_t *sql,
+static int get_process(classic_assembly_t *assembly,
                        uint64_t message_ident,
                        char parent_type,
                        int parent_index,
                        void *parent,
                        int (*parent_new_child)(void *parent, idmef_process_t **child))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_process_t *process;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, name, pid, path "
-                                          "FROM Prelude_Process "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_PROCESS, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -502,88 +494,77 @@ static int get_process(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, process, idmef_process_new_ident);
+        ret = get_string(row, 0, process, idmef_process_new_ident);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 1, process, idmef_process_new_name);
+        ret = get_string(row, 1, process, idmef_process_new_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 2, process, idmef_process_new_pid);
+        ret = get_uint32(row, 2, process, idmef_process_new_pid);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 3, process, idmef_process_new_path);
+        ret = get_string(row, 3, process, idmef_process_new_path);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_process_arg(sql, message_ident, parent_type, parent_index, process,
+        ret = get_process_arg(assembly, message_ident, parent_type, parent_index, process,
                               (int (*)(void *, prelude_string_t **, int)) idmef_process_new_arg);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_process_env(sql, message_ident, parent_type, parent_index, process,
+        ret = get_process_env(assembly, message_ident, parent_type, parent_index, process,
                               (int (*)(void *, prelude_string_t **, int)) idmef_process_new_env);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_web_service_arg(preludedb_sql_t *sql,
+static int get_web_service_arg(classic_assembly_t *assembly,
                                uint64_t message_ident,
                                char parent_type,
                                int parent_index,
                                idmef_web_service_t *web_service)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT arg "
-                                          "FROM Prelude_WebServiceArg "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _index != -1 ORDER BY _index ASC",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_WEB_SERVICE_ARG, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
-                ret = get_string_listed(sql, row, 0, web_service, idmef_web_service_new_arg);
+                ret = get_string_listed(row, 0, web_service, idmef_web_service_new_arg);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_web_service(preludedb_sql_t *sql,
+static int get_web_service(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            char parent_type,
                            int parent_index,
                            idmef_service_t *service)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_web_service_t *web_service;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT url, cgi, http_method "
-                                          "FROM Prelude_WebService "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_WEB_SERVICE, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -591,47 +572,41 @@ static int get_web_service(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, web_service, idmef_web_service_new_url);
+        ret = get_string(row, 0, web_service, idmef_web_service_new_url);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 1, web_service, idmef_web_service_new_cgi);
+        ret = get_string(row, 1, web_service, idmef_web_service_new_cgi);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 2, web_service, idmef_web_service_new_http_method);
+        ret = get_string(row, 2, web_service, idmef_web_service_new_http_method);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_web_service_arg(sql, message_ident, parent_type, parent_index, web_service);
+        ret = get_web_service_arg(assembly, message_ident, parent_type, parent_index, web_service);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_snmp_service(preludedb_sql_t *sql,
+static int get_snmp_service(classic_assembly_t *assembly,
                             uint64_t message_ident,
                             char parent_type,
                             int parent_index,
                             idmef_service_t *service)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_snmp_service_t *snmp_service;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT snmp_oid, message_processing_model, security_model, security_name, "
-                                          "security_level, context_name, context_engine_id, command "
-                                          "FROM Prelude_SnmpService "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_SNMP_SERVICE, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -639,63 +614,58 @@ static int get_snmp_service(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, snmp_service, idmef_snmp_service_new_oid);
+        ret = get_string(row, 0, snmp_service, idmef_snmp_service_new_oid);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 1, snmp_service, idmef_snmp_service_new_message_processing_model);
+        ret = get_uint32(row, 1, snmp_service, idmef_snmp_service_new_message_processing_model);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 2, snmp_service, idmef_snmp_service_new_security_model);
+        ret = get_uint32(row, 2, snmp_service, idmef_snmp_service_new_security_model);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 3, snmp_service, idmef_snmp_service_new_security_name);
+        ret = get_string(row, 3, snmp_service, idmef_snmp_service_new_security_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 4, snmp_service, idmef_snmp_service_new_security_level);
+        ret = get_uint32(row, 4, snmp_service, idmef_snmp_service_new_security_level);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 5, snmp_service, idmef_snmp_service_new_context_name);
+        ret = get_string(row, 5, snmp_service, idmef_snmp_service_new_context_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 6, snmp_service, idmef_snmp_service_new_context_engine_id);
+        ret = get_string(row, 6, snmp_service, idmef_snmp_service_new_context_engine_id);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 7, snmp_service, idmef_snmp_service_new_command);
+        ret = get_string(row, 7, snmp_service, idmef_snmp_service_new_command);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_service(preludedb_sql_t *sql,
+static int get_service(classic_assembly_t *assembly,
                        uint64_t message_ident,
                        char parent_type,
                        int parent_index,
                        void *parent,
                        int (*parent_new_child)(void *parent, idmef_service_t **child))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_service_t *service;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, ip_version, name, port, iana_protocol_number, iana_protocol_name, portlist, protocol "
-                                          "FROM Prelude_Service "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_SERVICE, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return 0;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -703,129 +673,117 @@ static int get_service(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, service, idmef_service_new_ident);
+        ret = get_string(row, 0, service, idmef_service_new_ident);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint8(sql, row, 1, service, idmef_service_new_ip_version);
+        ret = get_uint8(row, 1, service, idmef_service_new_ip_version);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 2, service, idmef_service_new_name);
+        ret = get_string(row, 2, service, idmef_service_new_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint16(sql, row, 3, service, idmef_service_new_port);
+        ret = get_uint16(row, 3, service, idmef_service_new_port);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint8(sql, row, 4, service, idmef_service_new_iana_protocol_number);
+        ret = get_uint8(row, 4, service, idmef_service_new_iana_protocol_number);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 5, service, idmef_service_new_iana_protocol_name);
+        ret = get_string(row, 5, service, idmef_service_new_iana_protocol_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 6, service, idmef_service_new_portlist);
+        ret = get_string(row, 6, service, idmef_service_new_portlist);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 7, service, idmef_service_new_protocol);
+        ret = get_string(row, 7, service, idmef_service_new_protocol);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_web_service(sql, message_ident, parent_type, parent_index, service);
+        ret = get_web_service(assembly, message_ident, parent_type, parent_index, service);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_snmp_service(sql, message_ident, parent_type, parent_index, service);
+        ret = get_snmp_service(assembly, message_ident, parent_type, parent_index, service);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_address(preludedb_sql_t *sql,
+static int get_address(classic_assembly_t *assembly,
                        uint64_t message_ident,
                        char parent_type,
                        int parent_index,
                        void *parent,
                        int (*parent_new_child)(void *parent, idmef_address_t **child, int pos))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_address_t *idmef_address;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, category, vlan_name, vlan_num, address, netmask "
-                                          "FROM Prelude_Address "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _index != -1 ORDER BY _index ASC",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ADDRESS, message_ident,
+                                        parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = parent_new_child(parent, &idmef_address, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, idmef_address, idmef_address_new_ident);
+                ret = get_string(row, 0, idmef_address, idmef_address_new_ident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 1, idmef_address, idmef_address_new_category, idmef_address_category_to_numeric);
+                ret = get_enum(row, 1, idmef_address, idmef_address_new_category, idmef_address_category_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, idmef_address, idmef_address_new_vlan_name);
+                ret = get_string(row, 2, idmef_address, idmef_address_new_vlan_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_uint32(sql, row, 3, idmef_address, idmef_address_new_vlan_num);
+                ret = get_uint32(row, 3, idmef_address, idmef_address_new_vlan_num);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 4, idmef_address, idmef_address_new_address);
+                ret = get_string(row, 4, idmef_address, idmef_address_new_address);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 5, idmef_address, idmef_address_new_netmask);
+                ret = get_string(row, 5, idmef_address, idmef_address_new_netmask);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_node(preludedb_sql_t *sql,
+static int get_node(classic_assembly_t *assembly,
                     uint64_t message_ident,
                     char parent_type,
                     int parent_index,
                     void *parent,
                     int (*parent_new_child)(void *parent, idmef_node_t **node))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_node_t *node;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, category, location, name "
-                                          "FROM Prelude_Node "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d",
-                                          parent_type, message_ident, parent_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_NODE, message_ident, parent_type, parent_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -833,96 +791,89 @@ static int get_node(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, node, idmef_node_new_ident);
+        ret = get_string(row, 0, node, idmef_node_new_ident);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 1, node, idmef_node_new_category, idmef_node_category_to_numeric);
+        ret = get_enum(row, 1, node, idmef_node_new_category, idmef_node_category_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 2, node, idmef_node_new_location);
+        ret = get_string(row, 2, node, idmef_node_new_location);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 3, node, idmef_node_new_name);
+        ret = get_string(row, 3, node, idmef_node_new_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_address(sql, message_ident, parent_type, parent_index, node,
+        ret = get_address(assembly, message_ident, parent_type, parent_index, node,
                           (int (*)(void *, idmef_address_t **, int)) idmef_node_new_address);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_analyzer(preludedb_sql_t *sql,
+static int get_analyzer(classic_assembly_t *assembly,
                         uint64_t message_ident,
                         char parent_type,
                         void *parent,
                         int (*parent_new_child)(void *parent, idmef_analyzer_t **child, int pos))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_analyzer_t *analyzer;
         int ret;
         int index;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT analyzerid, name, manufacturer, model, version, class, ostype, osversion "
-                                          "FROM Prelude_Analyzer "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          parent_type, message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ANALYZER, message_ident, parent_type, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
         index = 0;
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
                 ret = parent_new_child(parent, &analyzer, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, analyzer, idmef_analyzer_new_analyzerid);
+                ret = get_string(row, 0, analyzer, idmef_analyzer_new_analyzerid);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, analyzer, idmef_analyzer_new_name);
+                ret = get_string(row, 1, analyzer, idmef_analyzer_new_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, analyzer, idmef_analyzer_new_manufacturer);
+                ret = get_string(row, 2, analyzer, idmef_analyzer_new_manufacturer);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 3, analyzer, idmef_analyzer_new_model);
+                ret = get_string(row, 3, analyzer, idmef_analyzer_new_model);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 4, analyzer, idmef_analyzer_new_version);
+                ret = get_string(row, 4, analyzer, idmef_analyzer_new_version);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 5, analyzer, idmef_analyzer_new_class);
+                ret = get_string(row, 5, analyzer, idmef_analyzer_new_class);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 6, analyzer, idmef_analyzer_new_ostype);
+                ret = get_string(row, 6, analyzer, idmef_analyzer_new_ostype);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 7, analyzer, idmef_analyzer_new_osversion);
+                ret = get_string(row, 7, analyzer, idmef_analyzer_new_osversion);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_node(sql, message_ident, parent_type, index, analyzer,
+                ret = get_node(assembly, message_ident, parent_type, index, analyzer,
                                (int (*)(void *, idmef_node_t **)) idmef_analyzer_new_node);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_process(sql, message_ident, parent_type, index, analyzer,
+                ret = get_process(assembly, message_ident, parent_type, index, analyzer,
                                   (int (*)(void *, idmef_process_t **)) idmef_analyzer_new_process);
                 if ( ret < 0 )
                         goto error;
@@ -931,68 +882,55 @@ static int get_analyzer(preludedb_sql_t *sql,
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_action(preludedb_sql_t *sql,
+static int get_action(classic_assembly_t *assembly,
                       uint64_t message_ident,
                       idmef_assessment_t *assessment)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_action_t *action;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT category, description "
-                                          "FROM Prelude_Action "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ACTION, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_assessment_new_action(assessment, &action, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         return ret;
 
-                ret = get_enum(sql, row, 0, action, idmef_action_new_category, idmef_action_category_to_numeric);
+                ret = get_enum(row, 0, action, idmef_action_new_category, idmef_action_category_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, action, idmef_action_new_description);
+                ret = get_string(row, 1, action, idmef_action_new_description);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_confidence(preludedb_sql_t *sql,
+static int get_confidence(classic_assembly_t *assembly,
                           uint64_t message_ident,
                           idmef_assessment_t *assessment)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_confidence_t *confidence;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT rating, confidence "
-                                          "FROM Prelude_Confidence "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_CONFIDENCE, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1000,36 +938,30 @@ static int get_confidence(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 0, confidence, idmef_confidence_new_rating, idmef_confidence_rating_to_numeric);
+        ret = get_enum(row, 0, confidence, idmef_confidence_new_rating, idmef_confidence_rating_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_float(sql, row, 1, confidence, idmef_confidence_new_confidence);
+        ret = get_float(row, 1, confidence, idmef_confidence_new_confidence);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_impact(preludedb_sql_t *sql,
+static int get_impact(classic_assembly_t *assembly,
                       uint64_t message_ident,
                       idmef_assessment_t *assessment)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_impact_t *impact;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT severity, completion, type, description "
-                                          "FROM Prelude_Impact "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_IMPACT, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1037,57 +969,49 @@ static int get_impact(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 0, impact, idmef_impact_new_severity, idmef_impact_severity_to_numeric);
+        ret = get_enum(row, 0, impact, idmef_impact_new_severity, idmef_impact_severity_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 1, impact, idmef_impact_new_completion, idmef_impact_completion_to_numeric);
+        ret = get_enum(row, 1, impact, idmef_impact_new_completion, idmef_impact_completion_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_enum(sql, row, 2, impact, idmef_impact_new_type, idmef_impact_type_to_numeric);
+        ret = get_enum(row, 2, impact, idmef_impact_new_type, idmef_impact_type_to_numeric);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 3, impact, idmef_impact_new_description);
+        ret = get_string(row, 3, impact, idmef_impact_new_description);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_assessment(preludedb_sql_t *sql,
+static int get_assessment(classic_assembly_t *assembly,
                           uint64_t message_ident,
                           idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         idmef_assessment_t *assessment;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT _message_ident "
-                                          "FROM Prelude_Assessment "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ASSESSMENT, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        preludedb_sql_table_destroy(table);
-
         ret = idmef_alert_new_assessment(alert, &assessment);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_impact(sql, message_ident, assessment);
+        ret = get_impact(assembly, message_ident, assessment);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_confidence(sql, message_ident, assessment);
+        ret = get_confidence(assembly, message_ident, assessment);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_action(sql, message_ident, assessment);
+        ret = get_action(assembly, message_ident, assessment);
         if ( ret < 0 )
                 goto error;
 
@@ -1095,74 +1019,51 @@ static int get_assessment(preludedb_sql_t *sql,
         return ret;
 }
 
-static int get_file_access_permission(preludedb_sql_t *sql,
+static int get_file_access_permission(classic_assembly_t *assembly,
                                       uint64_t message_ident,
                                       int target_index,
                                       int file_index,
                                       int file_access_index,
                                       idmef_file_access_t *parent)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT permission "
-                                          "FROM Prelude_FileAccess_Permission "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d AND "
-                                          "_parent1_index = %d AND _parent2_index = %d AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident, target_index, file_index, file_access_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_FILE_ACCESS_PERMISSION, message_ident,
+                                        0, target_index, file_index, file_access_index, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
-                ret = get_string_listed(sql, row, 0, parent, idmef_file_access_new_permission);
+                ret = get_string_listed(row, 0, parent, idmef_file_access_new_permission);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_file_access(preludedb_sql_t *sql,
+static int get_file_access(classic_assembly_t *assembly,
                            uint64_t message_ident,
                            int target_index,
                            int file_index,
                            idmef_file_t *file)
 {
-        preludedb_sql_table_t *table;
-        preludedb_sql_row_t *row;
-        preludedb_sql_field_t *field;
+        classic_assembly_rows_t rows;
         idmef_file_access_t *file_access;
-        uint32_t file_access_count;
+        unsigned int file_access_count;
         unsigned int cnt;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT COUNT(*) "
-                                          "FROM Prelude_FileAccess "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _parent1_index = %d AND _index != -1",
-                                          message_ident, target_index, file_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_FILE_ACCESS, message_ident,
+                                        0, target_index, file_index, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
-        if ( ret <= 0 )
-                goto error;
-
-        ret = preludedb_sql_row_get_field(row, 0, &field);
-        if ( ret <= 0 )
-                goto error;
-
-        ret = preludedb_sql_field_to_uint32(field, &file_access_count);
-        if ( ret < 0 )
-                goto error;
+        file_access_count = ret;
 
         for ( cnt = 0; cnt < file_access_count; cnt++ ) {
 
@@ -1170,58 +1071,50 @@ static int get_file_access(preludedb_sql_t *sql,
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_user_id(sql, message_ident, 'F', target_index, file_index, cnt,
+                ret = get_user_id(assembly, message_ident, 'F', target_index, file_index, cnt,
                                   file_access, FALSE, (int (*)(void *, idmef_user_id_t **)) idmef_file_access_new_user_id);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_file_access_permission(sql, message_ident, target_index, file_index, cnt, file_access);
+                ret = get_file_access_permission(assembly, message_ident, target_index, file_index, cnt, file_access);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_linkage(preludedb_sql_t *sql,
+static int get_linkage(classic_assembly_t *assembly,
                        uint64_t message_ident,
                        int target_index,
                        int file_index,
                        idmef_file_t *file)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_linkage_t *linkage;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT category, name, path "
-                                          "FROM Prelude_Linkage "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _parent1_index = %d AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident, target_index, file_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_LINKAGE, message_ident, 0, target_index, file_index, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_file_new_linkage(file, &linkage, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 0, linkage, idmef_linkage_new_category, idmef_linkage_category_to_numeric);
+                ret = get_enum(row, 0, linkage, idmef_linkage_new_category, idmef_linkage_category_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, linkage, idmef_linkage_new_name);
+                ret = get_string(row, 1, linkage, idmef_linkage_new_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, linkage, idmef_linkage_new_path);
+                ret = get_string(row, 2, linkage, idmef_linkage_new_path);
                 if ( ret < 0 )
                         goto error;
         }
@@ -1229,32 +1122,25 @@ static int get_linkage(preludedb_sql_t *sql,
         /* FIXME: file in linkage is not currently supported  */
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_inode(preludedb_sql_t *sql,
+static int get_inode(classic_assembly_t *assembly,
                      uint64_t message_ident,
                      int target_index,
                      int file_index,
                      idmef_file_t *file)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_inode_t *inode;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT change_time, change_time_gmtoff, number, major_device, minor_device, "
-                                          "c_major_device, c_minor_device "
-                                          "FROM Prelude_Inode "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d AND _parent1_index = %d",
-                                          message_ident, target_index, file_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_INODE, message_ident, 0, target_index, file_index, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1262,153 +1148,137 @@ static int get_inode(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_timestamp(sql, row, 0, 1, -1, inode, idmef_inode_new_change_time);
+        ret = get_timestamp(row, 0, 1, -1, inode, idmef_inode_new_change_time);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 2, inode, idmef_inode_new_number);
+        ret = get_uint32(row, 2, inode, idmef_inode_new_number);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 3, inode, idmef_inode_new_major_device);
+        ret = get_uint32(row, 3, inode, idmef_inode_new_major_device);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 4, inode, idmef_inode_new_minor_device);
+        ret = get_uint32(row, 4, inode, idmef_inode_new_minor_device);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 5, inode, idmef_inode_new_c_major_device);
+        ret = get_uint32(row, 5, inode, idmef_inode_new_c_major_device);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 6, inode, idmef_inode_new_c_minor_device);
+        ret = get_uint32(row, 6, inode, idmef_inode_new_c_minor_device);
         if ( ret < 0 )
                 goto error;
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
 
-static int get_checksum(preludedb_sql_t *sql,
+static int get_checksum(classic_assembly_t *assembly,
                         uint64_t message_ident,
                         int target_index,
                         int file_index,
                         idmef_file_t *file)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_checksum_t *checksum;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT value, checksum_key, algorithm "
-                                          "FROM Prelude_Checksum "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64
-                                          " AND _parent0_index = %d AND _parent1_index = %d AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident, target_index, file_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_CHECKSUM, message_ident,
+                                        0, target_index, file_index, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_file_new_checksum(file, &checksum, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, checksum, idmef_checksum_new_value);
+                ret = get_string(row, 0, checksum, idmef_checksum_new_value);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, checksum, idmef_checksum_new_key);
+                ret = get_string(row, 1, checksum, idmef_checksum_new_key);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 2, checksum, idmef_checksum_new_algorithm, idmef_checksum_algorithm_to_numeric);
+                ret = get_enum(row, 2, checksum, idmef_checksum_new_algorithm, idmef_checksum_algorithm_to_numeric);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
 
-static int get_file(preludedb_sql_t *sql,
+static int get_file(classic_assembly_t *assembly,
                     uint64_t message_ident,
                     int target_index,
                     idmef_target_t *target)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_file_t *file = NULL;
         int cnt;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, category, name, path, create_time, create_time_gmtoff, "
-                                          "modify_time, modify_time_gmtoff, access_time, "
-                                          "access_time_gmtoff, data_size, disk_size, fstype, file_type "
-                                          "FROM Prelude_File "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _parent0_index = %d AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident, target_index);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_FILE, message_ident, 0, target_index, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_target_new_file(target, &file, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, file, idmef_file_new_ident);
+                ret = get_string(row, 0, file, idmef_file_new_ident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 1, file, idmef_file_new_category, idmef_file_category_to_numeric);
+                ret = get_enum(row, 1, file, idmef_file_new_category, idmef_file_category_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, file, idmef_file_new_name);
+                ret = get_string(row, 2, file, idmef_file_new_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 3, file, idmef_file_new_path);
+                ret = get_string(row, 3, file, idmef_file_new_path);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_timestamp(sql, row, 4, 5, -1, file, idmef_file_new_create_time);
+                ret = get_timestamp(row, 4, 5, -1, file, idmef_file_new_create_time);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_timestamp(sql, row, 6, 7, -1, file, idmef_file_new_modify_time);
+                ret = get_timestamp(row, 6, 7, -1, file, idmef_file_new_modify_time);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_timestamp(sql, row, 8, 9, -1, file, idmef_file_new_access_time);
+                ret = get_timestamp(row, 8, 9, -1, file, idmef_file_new_access_time);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_uint32(sql, row, 10, file, idmef_file_new_data_size);
+                ret = get_uint32(row, 10, file, idmef_file_new_data_size);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_uint32(sql, row, 11, file, idmef_file_new_disk_size);
+                ret = get_uint32(row, 11, file, idmef_file_new_disk_size);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 12, file, idmef_file_new_fstype, idmef_file_fstype_to_numeric);
+                ret = get_enum(row, 12, file, idmef_file_new_fstype, idmef_file_fstype_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 13, file, idmef_file_new_file_type);
+                ret = get_string(row, 13, file, idmef_file_new_file_type);
                 if ( ret < 0 )
                         goto error;
         }
@@ -1417,19 +1287,19 @@ static int get_file(preludedb_sql_t *sql,
         cnt = 0;
         while ( (file = idmef_target_get_next_file(target, file)) ) {
 
-                ret = get_file_access(sql, message_ident, target_index, cnt, file);
+                ret = get_file_access(assembly, message_ident, target_index, cnt, file);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_linkage(sql, message_ident, target_index, cnt, file);
+                ret = get_linkage(assembly, message_ident, target_index, cnt, file);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_inode(sql, message_ident, target_index, cnt, file);
+                ret = get_inode(assembly, message_ident, target_index, cnt, file);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_checksum(sql, message_ident, target_index, cnt, file);
+                ret = get_checksum(assembly, message_ident, target_index, cnt, file);
                 if ( ret < 0 )
                         goto error;
 
@@ -1437,151 +1307,189 @@ static int get_file(preludedb_sql_t *sql,
         }
 
  error:
-        preludedb_sql_table_destroy(table);
+        return ret;
+}
+
+static int get_source_children(classic_assembly_t *assembly,
+                               uint64_t message_ident,
+                               idmef_alert_t *alert,
+                               unsigned int children)
+{
+        idmef_source_t *source = NULL;
+        int cnt = 0;
+        int ret = 0;
+
+        while ( (source = idmef_alert_get_next_source(alert, source)) ) {
+
+                if ( children & CHILD_NODE && ! idmef_source_get_node(source) ) {
+                        ret = get_node(assembly, message_ident, 'S', cnt, source, (int (*)(void *, idmef_node_t **)) idmef_source_new_node);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_USER && ! idmef_source_get_user(source) ) {
+                        ret = get_user(assembly, message_ident, 'S', cnt, source, (int (*)(void *, idmef_user_t **)) idmef_source_new_user);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_PROCESS && ! idmef_source_get_process(source) ) {
+                        ret = get_process(assembly, message_ident, 'S', cnt, source, (int (*)(void *, idmef_process_t **)) idmef_source_new_process);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_SERVICE && ! idmef_source_get_service(source) ) {
+                        ret = get_service(assembly, message_ident, 'S', cnt, source, (int (*)(void *, idmef_service_t **)) idmef_source_new_service);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                cnt++;
+        }
 
         return ret;
 }
 
-static int get_source(preludedb_sql_t *sql,
+static int get_source(classic_assembly_t *assembly,
                       uint64_t message_ident,
-                      idmef_alert_t *alert)
+                      idmef_alert_t *alert,
+                      unsigned int children)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_source_t *source;
-        int cnt;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, spoofed, interface "
-                                          "FROM Prelude_Source "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident);
+        if ( idmef_alert_get_next_source(alert, NULL) )
+                return get_source_children(assembly, message_ident, alert, children);
+
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_SOURCE, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_alert_new_source(alert, &source, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, source, idmef_source_new_ident);
+                ret = get_string(row, 0, source, idmef_source_new_ident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 1, source, idmef_source_new_spoofed, idmef_source_spoofed_to_numeric);
+                ret = get_enum(row, 1, source, idmef_source_new_spoofed, idmef_source_spoofed_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, source, idmef_source_new_interface);
+                ret = get_string(row, 2, source, idmef_source_new_interface);
                 if ( ret < 0 )
                         goto error;
         }
 
-        source = NULL;
-        cnt = 0;
-        while ( (source = idmef_alert_get_next_source(alert, source)) ) {
+        if ( ret < 0 )
+                goto error;
 
-                ret = get_node(sql, message_ident, 'S', cnt, source, (int (*)(void *, idmef_node_t **)) idmef_source_new_node);
-                if ( ret < 0 )
-                        goto error;
+        ret = get_source_children(assembly, message_ident, alert, children);
 
-                ret = get_user(sql, message_ident, 'S', cnt, source, (int (*)(void *, idmef_user_t **)) idmef_source_new_user);
-                if ( ret < 0 )
-                        goto error;
+ error:
+        return ret;
+}
 
-                ret = get_process(sql, message_ident, 'S', cnt, source, (int (*)(void *, idmef_process_t **)) idmef_source_new_process);
-                if ( ret < 0 )
-                        goto error;
+static int get_target_children(classic_assembly_t *assembly,
+                               uint64_t message_ident,
+                               idmef_alert_t *alert,
+                               unsigned int children)
+{
+        idmef_target_t *target = NULL;
+        int cnt = 0;
+        int ret = 0;
 
-                ret = get_service(sql, message_ident, 'S', cnt, source, (int (*)(void *, idmef_service_t **)) idmef_source_new_service);
-                if ( ret < 0 )
-                        goto error;
+        while ( (target = idmef_alert_get_next_target(alert, target)) ) {
+
+                if ( children & CHILD_NODE && ! idmef_target_get_node(target) ) {
+                        ret = get_node(assembly, message_ident, 'T', cnt, target, (int (*)(void *, idmef_node_t **)) idmef_target_new_node);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_USER && ! idmef_target_get_user(target) ) {
+                        ret = get_user(assembly, message_ident, 'T', cnt, target, (int (*)(void *, idmef_user_t **)) idmef_target_new_user);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_PROCESS && ! idmef_target_get_process(target) ) {
+                        ret = get_process(assembly, message_ident, 'T', cnt, target, (int (*)(void *, idmef_process_t **)) idmef_target_new_process);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_SERVICE && ! idmef_target_get_service(target) ) {
+                        ret = get_service(assembly, message_ident, 'T', cnt, target, (int (*)(void *, idmef_service_t **)) idmef_target_new_service);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( children & CHILD_FILE && ! idmef_target_get_next_file(target, NULL) ) {
+                        ret = get_file(assembly, message_ident, cnt, target);
+                        if ( ret < 0 )
+                                return ret;
+                }
 
                 cnt++;
         }
 
- error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_target(preludedb_sql_t *sql,
+static int get_target(classic_assembly_t *assembly,
                       uint64_t message_ident,
-                      idmef_alert_t *alert)
+                      idmef_alert_t *alert,
+                      unsigned int children)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_target_t *target;
-        int cnt;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, decoy, interface "
-                                          "FROM Prelude_Target "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident);
+        if ( idmef_alert_get_next_target(alert, NULL) )
+                return get_target_children(assembly, message_ident, alert, children);
+
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_TARGET, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_alert_new_target(alert, &target, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, target, idmef_target_new_ident);
+                ret = get_string(row, 0, target, idmef_target_new_ident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 1, target, idmef_target_new_decoy, idmef_target_decoy_to_numeric);
+                ret = get_enum(row, 1, target, idmef_target_new_decoy, idmef_target_decoy_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, target, idmef_target_new_interface);
+                ret = get_string(row, 2, target, idmef_target_new_interface);
                 if ( ret < 0 )
                         goto error;
         }
 
-        target = NULL;
-        cnt = 0;
-        while ( (target = idmef_alert_get_next_target(alert, target)) ) {
-
-                ret = get_node(sql, message_ident, 'T', cnt, target, (int (*)(void *, idmef_node_t **)) idmef_target_new_node);
-                if ( ret < 0 )
-                        goto error;
-
-                ret = get_user(sql, message_ident, 'T', cnt, target, (int (*)(void *, idmef_user_t **)) idmef_target_new_user);
-                if ( ret < 0 )
-                        goto error;
-
-                ret = get_process(sql, message_ident, 'T', cnt, target, (int (*)(void *, idmef_process_t **)) idmef_target_new_process);
-                if ( ret < 0 )
-                        goto error;
-
-                ret = get_service(sql, message_ident, 'T', cnt, target, (int (*)(void *, idmef_service_t **)) idmef_target_new_service);
-                if ( ret < 0 )
-                        goto error;
-
-                ret = get_file(sql, message_ident, cnt, target);
-                if ( ret < 0 )
-                        goto error;
+        if ( ret < 0 )
+                goto error;
 
-                cnt++;
-        }
+        ret = get_target_children(assembly, message_ident, alert, children);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
 
-static int get_additional_data(preludedb_sql_t *sql,
+static int get_additional_data(classic_assembly_t *assembly,
                                uint64_t message_ident,
                                char parent_type,
                                void *parent,
@@ -1591,34 +1499,29 @@ static int get_additional_data(preludedb_sql_t *sql,
         char *svalue = NULL;
         size_t svalue_size;
         prelude_bool_t svalue_need_free;
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_additional_data_type_t type;
         idmef_additional_data_t *additional_data;
         idmef_data_t *data;
         preludedb_sql_field_t *field;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT type, meaning, data "
-                                          "FROM Prelude_AdditionalData "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          parent_type, message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ADDITIONAL_DATA, message_ident, parent_type, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = parent_new_child(parent, &additional_data, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 0, additional_data, idmef_additional_data_new_type,
+                ret = get_enum(row, 0, additional_data, idmef_additional_data_new_type,
                                idmef_additional_data_type_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, additional_data, idmef_additional_data_new_meaning);
+                ret = get_string(row, 1, additional_data, idmef_additional_data_new_meaning);
                 if ( ret < 0 )
                         goto error;
 
@@ -1632,7 +1535,7 @@ static int get_additional_data(preludedb_sql_t *sql,
 
                 type = idmef_additional_data_get_type(additional_data);
 
-                ret = classic_unescape_binary_safe(sql, field, type, (unsigned char **) &svalue, &svalue_size);
+                ret = classic_unescape_binary_safe(classic_assembly_get_sql(assembly), field, type, (unsigned char **) &svalue, &svalue_size);
                 if ( ret < 0 )
                         break;
 
@@ -1724,77 +1627,64 @@ static int get_additional_data(preludedb_sql_t *sql,
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_reference(preludedb_sql_t *sql,
+static int get_reference(classic_assembly_t *assembly,
                          uint64_t message_ident,
                          idmef_classification_t *classification)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_reference_t *reference;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT origin, name, url, meaning "
-                                          "FROM Prelude_Reference "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 " AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_REFERENCE, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = idmef_classification_new_reference(classification, &reference, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_enum(sql, row, 0, reference, idmef_reference_new_origin,
+                ret = get_enum(row, 0, reference, idmef_reference_new_origin,
                                idmef_reference_origin_to_numeric);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, reference, idmef_reference_new_name);
+                ret = get_string(row, 1, reference, idmef_reference_new_name);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 2, reference, idmef_reference_new_url);
+                ret = get_string(row, 2, reference, idmef_reference_new_url);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 3, reference, idmef_reference_new_meaning);
+                ret = get_string(row, 3, reference, idmef_reference_new_meaning);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_classification(preludedb_sql_t *sql,
+static int get_classification(classic_assembly_t *assembly,
                               uint64_t message_ident,
                               idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_classification_t *classification;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT ident, text "
-                                          "FROM Prelude_Classification "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_CLASSIFICATION, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1802,83 +1692,70 @@ static int get_classification(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, classification, idmef_classification_new_ident);
+        ret = get_string(row, 0, classification, idmef_classification_new_ident);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 1, classification, idmef_classification_new_text);
+        ret = get_string(row, 1, classification, idmef_classification_new_text);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_reference(sql, message_ident, classification);
+        ret = get_reference(assembly, message_ident, classification);
         if ( ret < 0 )
                 goto error;
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_alertident(preludedb_sql_t *sql,
+static int get_alertident(classic_assembly_t *assembly,
                           uint64_t message_ident,
                           char parent_type,
                           void *parent,
                           int (*parent_new_child)(void *parent, idmef_alertident_t **child, int pos))
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_alertident_t *alertident = NULL;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT alertident, analyzerid "
-                                          "FROM Prelude_Alertident "
-                                          "WHERE _parent_type = '%c' AND _message_ident = %" PRELUDE_PRIu64" AND _index != -1 "
-                                          "ORDER BY _index ASC",
-                                          parent_type, message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ALERTIDENT, message_ident, parent_type, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        while ( (ret = preludedb_sql_table_fetch_row(table, &row)) > 0 ) {
+        while ( (ret = classic_assembly_rows_next(&rows, &row)) > 0 ) {
 
                 ret = parent_new_child(parent, &alertident, IDMEF_LIST_APPEND);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 0, alertident, idmef_alertident_new_alertident);
+                ret = get_string(row, 0, alertident, idmef_alertident_new_alertident);
                 if ( ret < 0 )
                         goto error;
 
-                ret = get_string(sql, row, 1, alertident, idmef_alertident_new_analyzerid);
+                ret = get_string(row, 1, alertident, idmef_alertident_new_analyzerid);
                 if ( ret < 0 )
                         goto error;
         }
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_tool_alert(preludedb_sql_t *sql,
+static int get_tool_alert(classic_assembly_t *assembly,
                           uint64_t message_ident,
                           idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_tool_alert_t *tool_alert;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT name, command "
-                                          "FROM Prelude_ToolAlert "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_TOOL_ALERT, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1886,41 +1763,35 @@ static int get_tool_alert(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, tool_alert, idmef_tool_alert_new_name);
+        ret = get_string(row, 0, tool_alert, idmef_tool_alert_new_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 1, tool_alert, idmef_tool_alert_new_command);
+        ret = get_string(row, 1, tool_alert, idmef_tool_alert_new_command);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_alertident(sql, message_ident, 'T', tool_alert,
+        ret = get_alertident(assembly, message_ident, 'T', tool_alert,
                              (int (*)(void *, idmef_alertident_t **, int)) idmef_tool_alert_new_alertident);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
-static int get_correlation_alert(preludedb_sql_t *sql,
+static int get_correlation_alert(classic_assembly_t *assembly,
                                  uint64_t message_ident,
                                  idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_correlation_alert_t *correlation_alert;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT name "
-                                          "FROM Prelude_CorrelationAlert "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_CORRELATION_ALERT, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1928,25 +1799,23 @@ static int get_correlation_alert(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, correlation_alert, idmef_correlation_alert_new_name);
+        ret = get_string(row, 0, correlation_alert, idmef_correlation_alert_new_name);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_alertident(sql, message_ident, 'C', correlation_alert,
+        ret = get_alertident(assembly, message_ident, 'C', correlation_alert,
                              (int (*)(void *, idmef_alertident_t **, int)) idmef_correlation_alert_new_alertident);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
 
-static int get_overflow_alert(preludedb_sql_t *sql,
+static int get_overflow_alert(classic_assembly_t *assembly,
                               uint64_t message_ident,
                               idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         idmef_overflow_alert_t *overflow_alert;
         preludedb_sql_field_t *field;
@@ -1955,15 +1824,11 @@ static int get_overflow_alert(preludedb_sql_t *sql,
         size_t data_size;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table,
-                                          "SELECT program, size, buffer "
-                                          "FROM Prelude_OverflowAlert "
-                                          "WHERE _message_ident = %" PRELUDE_PRIu64 "",
-                                          message_ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_OVERFLOW_ALERT, message_ident, 0, 0, 0, 0, &rows);
         if ( ret <= 0 )
                 return ret;
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret <= 0 )
                 goto error;
 
@@ -1971,11 +1836,11 @@ static int get_overflow_alert(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, overflow_alert, idmef_overflow_alert_new_program);
+        ret = get_string(row, 0, overflow_alert, idmef_overflow_alert_new_program);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 1, overflow_alert, idmef_overflow_alert_new_size);
+        ret = get_uint32(row, 1, overflow_alert, idmef_overflow_alert_new_size);
         if ( ret < 0 )
                 goto error;
 
@@ -1987,10 +1852,7 @@ static int get_overflow_alert(preludedb_sql_t *sql,
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_unescape_binary(sql,
-                                            preludedb_sql_field_get_value(field),
-                                            preludedb_sql_field_get_len(field),
-                                            &data, &data_size);
+        ret = classic_compress_unescape_column(classic_assembly_get_sql(assembly), field, &data, &data_size);
 
         if ( ret < 0 )
                 goto error;
@@ -1998,41 +1860,209 @@ static int get_overflow_alert(preludedb_sql_t *sql,
         ret = idmef_data_set_byte_string_nodup(buffer, data, data_size);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return ret;
 }
 
 
-static int get_alert_messageid(preludedb_sql_t *sql, uint64_t ident, idmef_alert_t *alert)
+static int get_alert_messageid(classic_assembly_t *assembly, uint64_t ident, idmef_alert_t *alert)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table, "SELECT messageid FROM Prelude_Alert WHERE _ident = %" PRELUDE_PRIu64 "", ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_ALERT, ident, 0, 0, 0, 0, &rows);
         if ( ret < 0 )
                 return ret;
 
         if ( ret == 0 )
                 return preludedb_error(PRELUDEDB_ERROR_INVALID_MESSAGE_IDENT);
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, alert, idmef_alert_new_messageid);
+        ret = get_string(row, 0, alert, idmef_alert_new_messageid);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return (ret < 0) ? ret : 1;
 }
 
 
-int classic_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message)
+static const struct {
+        const char *name;
+        unsigned int subtree;
+} alert_subtrees[] = {
+        { "assessment", SUBTREE_ASSESSMENT },
+        { "analyzer", SUBTREE_ANALYZER },
+        { "create_time", SUBTREE_CREATE_TIME },
+        { "detect_time", SUBTREE_DETECT_TIME },
+        { "analyzer_time", SUBTREE_ANALYZER_TIME },
+        { "source", SUBTREE_SOURCE },
+        { "target", SUBTREE_TARGET },
+        { "classification", SUBTREE_CLASSIFICATION },
+        { "additional_data", SUBTREE_ADDITIONAL_DATA },
+        { "tool_alert", SUBTREE_TOOL_ALERT },
+        { "correlation_alert", SUBTREE_CORRELATION_ALERT },
+        { "overflow_alert", SUBTREE_OVERFLOW_ALERT },
+};
+
+
+static const struct {
+        const char *name;
+        unsigned int child;
+} alert_children[] = {
+        { "node", CHILD_NODE },
+        { "user", CHILD_USER },
+        { "process", CHILD_PROCESS },
+        { "service", CHILD_SERVICE },
+        { "file", CHILD_FILE },
+};
+
+
+
+/*
+ * Find out which subtrees have to be fetched for @path to be populated.
+ * A path stopping at alert itself requires every subtree, and one stopping
+ * at a subtree root requires the whole subtree. Anything below only
+ * requires the tables its first two elements map to, and attributes of
+ * the alert row itself require no subtree at all.
+ */
+static void get_path_subtrees(const idmef_path_t *path, unsigned int *subtrees,
+                              unsigned int *source_children, unsigned int *target_children)
+{
+        size_t i;
+        const char *name;
+        unsigned int subtree = SUBTREE_ALL, child = CHILD_ALL;
+
+        if ( idmef_path_get_depth(path) > 1 ) {
+                subtree = 0;
+                name = idmef_path_get_name(path, 1);
+
+                for ( i = 0; i < sizeof(alert_subtrees) / sizeof(*alert_subtrees); i++ ) {
+                        if ( strcmp(name, alert_subtrees[i].name) == 0 ) {
+                                subtree = alert_subtrees[i].subtree;
+                                break;
+                        }
+                }
+        }
+
+        if ( idmef_path_get_depth(path) > 2 && (subtree == SUBTREE_SOURCE || subtree == SUBTREE_TARGET) ) {
+                name = idmef_path_get_name(path, 2);
+
+                child = 0;
+                for ( i = 0; i < sizeof(alert_children) / sizeof(*alert_children); i++ ) {
+                        if ( strcmp(name, alert_children[i].name) == 0 ) {
+                                child = alert_children[i].child;
+                                break;
+                        }
+                }
+        }
+
+        *subtrees |= subtree;
+
+        if ( subtree & SUBTREE_SOURCE )
+                *source_children |= child;
+
+        if ( subtree & SUBTREE_TARGET )
+                *target_children |= child;
+}
+
+
+
+/*
+ * Fetch the @subtrees of alert @ident into @alert, which must not hold
+ * them yet. Source and target children are fetched for the sources and
+ * targets @alert already holds when their subtree is not requested.
+ */
+static int get_alert_subtrees(classic_assembly_t *assembly, uint64_t ident, idmef_alert_t *alert, unsigned int subtrees,
+                              unsigned int source_children, unsigned int target_children)
+{
+        int ret;
+
+        if ( subtrees & SUBTREE_ASSESSMENT ) {
+                ret = get_assessment(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_ANALYZER ) {
+                ret = get_analyzer(assembly, ident, 'A', alert, (int (*)(void *, idmef_analyzer_t **, int)) idmef_alert_new_analyzer);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_CREATE_TIME ) {
+                ret = get_create_time(assembly, ident, 'A', alert, (int (*)(void *, idmef_time_t **)) idmef_alert_new_create_time);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_DETECT_TIME ) {
+                ret = get_detect_time(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_ANALYZER_TIME ) {
+                ret = get_analyzer_time(assembly, ident, 'A', alert, (int (*)(void *, idmef_time_t **)) idmef_alert_new_analyzer_time);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_SOURCE )
+                ret = get_source(assembly, ident, alert, source_children);
+        else
+                ret = get_source_children(assembly, ident, alert, source_children);
+
+        if ( ret < 0 )
+                return ret;
+
+        if ( subtrees & SUBTREE_TARGET )
+                ret = get_target(assembly, ident, alert, target_children);
+        else
+                ret = get_target_children(assembly, ident, alert, target_children);
+
+        if ( ret < 0 )
+                return ret;
+
+        if ( subtrees & SUBTREE_CLASSIFICATION ) {
+                ret = get_classification(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_ADDITIONAL_DATA ) {
+                ret = get_additional_data(assembly, ident, 'A', alert,
+                                          (int (*)(void *, idmef_additional_data_t **, int)) idmef_alert_new_additional_data);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_TOOL_ALERT ) {
+                ret = get_tool_alert(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_CORRELATION_ALERT ) {
+                ret = get_correlation_alert(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( subtrees & SUBTREE_OVERFLOW_ALERT ) {
+                ret = get_overflow_alert(assembly, ident, alert);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int assemble_alert(classic_assembly_t *assembly, uint64_t ident, idmef_message_t **message)
 {
-        preludedb_sql_t *sql = preludedb_get_sql(db);
         idmef_alert_t *alert;
         int ret;
 
@@ -2044,103 +2074,206 @@ int classic_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message
         if ( ret < 0 )
                 goto error;
 
-        ret = get_alert_messageid(sql, ident, alert);
+        ret = get_alert_messageid(assembly, ident, alert);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_assessment(sql, ident, alert);
+        ret = get_alert_subtrees(assembly, ident, alert, SUBTREE_ALL, CHILD_ALL, CHILD_ALL);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_analyzer(sql, ident, 'A', alert, (int (*)(void *, idmef_analyzer_t **, int)) idmef_alert_new_analyzer);
-        if ( ret < 0 )
-                goto error;
+        return 0;
 
-        ret = get_create_time(sql, ident, 'A', alert, (int (*)(void *, idmef_time_t **)) idmef_alert_new_create_time);
-        if ( ret < 0 )
-                goto error;
+ error:
+        idmef_message_destroy(*message);
 
-        ret = get_detect_time(sql, ident, alert);
-        if ( ret < 0 )
-                goto error;
+        return ret;
+}
 
-        ret = get_analyzer_time(sql, ident, 'A', alert, (int (*)(void *, idmef_time_t **)) idmef_alert_new_analyzer_time);
-        if ( ret < 0 )
-                goto error;
 
-        ret = get_source(sql, ident, alert);
-        if ( ret < 0 )
-                goto error;
 
-        ret = get_target(sql, ident, alert);
-        if ( ret < 0 )
-                goto error;
+int classic_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message)
+{
+        int ret;
+        classic_assembly_t *assembly;
 
-        ret = get_classification(sql, ident, alert);
-        if ( ret < 0 )
-                goto error;
+        ret = classic_blob_get_alerts(preludedb_get_sql(db), &ident, 1, message);
+        if ( ret != 0 )
+                return (ret < 0) ? ret : 0;
 
-        ret = get_additional_data(sql, ident, 'A', alert,
-                                  (int (*)(void *, idmef_additional_data_t **, int)) idmef_alert_new_additional_data);
+        ret = classic_assembly_new(&assembly, preludedb_get_sql(db), &ident, 1);
         if ( ret < 0 )
-                goto error;
+                return ret;
+
+        ret = assemble_alert(assembly, ident, message);
+        classic_assembly_destroy(assembly);
+
+        return ret;
+}
+
+
+
+/*
+ * Alerts stored as a blob are decoded directly. For the others, every
+ * table is read once for the whole set of alerts, rather than once per
+ * alert.
+ */
+int classic_get_alerts(preludedb_t *db, const uint64_t *idents, size_t count, idmef_message_t **messages)
+{
+        int ret;
+        size_t i, nmissing = 0;
+        uint64_t *missing;
+        classic_assembly_t *assembly;
+        preludedb_sql_t *sql = preludedb_get_sql(db);
 
-        ret = get_tool_alert(sql, ident, alert);
+        ret = classic_blob_get_alerts(sql, idents, count, messages);
         if ( ret < 0 )
+                return ret;
+
+        if ( (size_t) ret == count )
+                return 0;
+
+        missing = malloc((count - ret) * sizeof(*missing));
+        if ( ! missing ) {
+                ret = preludedb_error_from_errno(errno);
                 goto error;
+        }
+
+        for ( i = 0; i < count; i++ ) {
+                if ( ! messages[i] )
+                        missing[nmissing++] = idents[i];
+        }
 
-        ret = get_correlation_alert(sql, ident, alert);
+        ret = classic_assembly_new(&assembly, sql, missing, nmissing);
+        free(missing);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_overflow_alert(sql, ident, alert);
+        for ( i = 0; i < count; i++ ) {
+                if ( messages[i] )
+                        continue;
+
+                ret = assemble_alert(assembly, idents[i], &messages[i]);
+                if ( ret < 0 ) {
+                        messages[i] = NULL;
+                        break;
+                }
+        }
+
+        classic_assembly_destroy(assembly);
+
         if ( ret < 0 )
                 goto error;
 
         return 0;
 
  error:
-        idmef_message_destroy(*message);
+        for ( i = 0; i < count; i++ ) {
+                if ( messages[i] )
+                        idmef_message_destroy(messages[i]);
+        }
 
         return ret;
 }
 
 
 
-static int _get_heartbeat(preludedb_sql_t *sql, uint64_t ident, idmef_heartbeat_t *heartbeat)
+int classic_get_alert_paths(preludedb_t *db, uint64_t ident, const idmef_path_t * const *paths, size_t npaths,
+                            idmef_message_t **message, unsigned int *fetched)
+{
+        int ret;
+        size_t i;
+        idmef_alert_t *alert;
+        prelude_bool_t created = FALSE;
+        classic_assembly_t *assembly;
+        unsigned int subtrees = 0, source_children = 0, target_children = 0;
+
+        for ( i = 0; i < npaths; i++ ) {
+                if ( strcmp(idmef_path_get_name(paths[i], 0), "alert") != 0 )
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "path '%s' does not belong to an alert",
+                                                       idmef_path_get_name(paths[i], -1));
+
+                get_path_subtrees(paths[i], &subtrees, &source_children, &target_children);
+        }
+
+        if ( *message && ! (alert = idmef_message_get_alert(*message)) )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "message to complete is not an alert");
+
+        subtrees &= ~(*fetched & SUBTREE_ALL);
+        source_children &= ~(*fetched >> FETCHED_SOURCE_SHIFT & CHILD_ALL);
+        target_children &= ~(*fetched >> FETCHED_TARGET_SHIFT & CHILD_ALL);
+
+        if ( *message && ! subtrees && ! source_children && ! target_children )
+                return 0;
+
+        ret = classic_assembly_new(&assembly, preludedb_get_sql(db), &ident, 1);
+        if ( ret < 0 )
+                return ret;
+
+        if ( ! *message ) {
+                ret = idmef_message_new(message);
+                if ( ret < 0 )
+                        goto error;
+
+                created = TRUE;
+
+                ret = idmef_message_new_alert(*message, &alert);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = get_alert_messageid(assembly, ident, alert);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = get_alert_subtrees(assembly, ident, alert, subtrees, source_children, target_children);
+        if ( ret >= 0 )
+                *fetched |= subtrees | source_children << FETCHED_SOURCE_SHIFT | target_children << FETCHED_TARGET_SHIFT;
+
+ error:
+        if ( ret < 0 && created ) {
+                idmef_message_destroy(*message);
+                *message = NULL;
+        }
+
+        classic_assembly_destroy(assembly);
+
+        return (ret < 0) ? ret : 0;
+}
+
+
+
+static int _get_heartbeat(classic_assembly_t *assembly, uint64_t ident, idmef_heartbeat_t *heartbeat)
 {
-        preludedb_sql_table_t *table;
+        classic_assembly_rows_t rows;
         preludedb_sql_row_t *row;
         int ret;
 
-        ret = preludedb_sql_query_sprintf(sql, &table, "SELECT messageid, heartbeat_interval FROM Prelude_Heartbeat WHERE _ident = %" PRELUDE_PRIu64 "", ident);
+        ret = classic_assembly_get_rows(assembly, CLASSIC_ASSEMBLY_HEARTBEAT, ident, 0, 0, 0, 0, &rows);
         if ( ret < 0 )
                 return ret;
 
         if ( ret == 0 )
                 return preludedb_error(PRELUDEDB_ERROR_INVALID_MESSAGE_IDENT);
 
-        ret = preludedb_sql_table_fetch_row(table, &row);
+        ret = classic_assembly_rows_next(&rows, &row);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_string(sql, row, 0, heartbeat, idmef_heartbeat_new_messageid);
+        ret = get_string(row, 0, heartbeat, idmef_heartbeat_new_messageid);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_uint32(sql, row, 1, heartbeat, idmef_heartbeat_new_heartbeat_interval);
+        ret = get_uint32(row, 1, heartbeat, idmef_heartbeat_new_heartbeat_interval);
 
  error:
-        preludedb_sql_table_destroy(table);
-
         return (ret < 0) ? ret : 1;
 }
 
 
 
-int classic_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **message)
+static int assemble_heartbeat(classic_assembly_t *assembly, uint64_t ident, idmef_message_t **message)
 {
-        preludedb_sql_t *sql = preludedb_get_sql(db);
         idmef_heartbeat_t *heartbeat;
         int ret;
 
@@ -2152,23 +2285,23 @@ int classic_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **mes
         if ( ret < 0 )
                 goto error;
 
-        ret = _get_heartbeat(sql, ident, heartbeat);
+        ret = _get_heartbeat(assembly, ident, heartbeat);
         if ( ret <= 0 )
                 goto error;
 
-        ret = get_analyzer(sql, ident, 'H', heartbeat, (int (*)(void *, idmef_analyzer_t **, int)) idmef_heartbeat_new_analyzer);
+        ret = get_analyzer(assembly, ident, 'H', heartbeat, (int (*)(void *, idmef_analyzer_t **, int)) idmef_heartbeat_new_analyzer);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_create_time(sql, ident, 'H', heartbeat, (int (*)(void *, idmef_time_t **)) idmef_heartbeat_new_create_time);
+        ret = get_create_time(assembly, ident, 'H', heartbeat, (int (*)(void *, idmef_time_t **)) idmef_heartbeat_new_create_time);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_analyzer_time(sql, ident, 'H', heartbeat, (int (*)(void *, idmef_time_t **)) idmef_heartbeat_new_analyzer_time);
+        ret = get_analyzer_time(assembly, ident, 'H', heartbeat, (int (*)(void *, idmef_time_t **)) idmef_heartbeat_new_analyzer_time);
         if ( ret < 0 )
                 goto error;
 
-        ret = get_additional_data(sql, ident, 'H', heartbeat,
+        ret = get_additional_data(assembly, ident, 'H', heartbeat,
                                   (int (*)(void *, idmef_additional_data_t **, int)) idmef_heartbeat_new_additional_data);
         if ( ret < 0 )
                 goto error;
@@ -2180,3 +2313,20 @@ int classic_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **mes
 
         return ret;
 }
+
+
+
+int classic_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **message)
+{
+        int ret;
+        classic_assembly_t *assembly;
+
+        ret = classic_assembly_new(&assembly, preludedb_get_sql(db), &ident, 1);
+        if ( ret < 0 )
+                return ret;
+
+        ret = assemble_heartbeat(assembly, ident, message);
+        classic_assembly_destroy(assembly);
+
+        return ret;
+}
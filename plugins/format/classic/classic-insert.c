@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 
 #include <libprelude/prelude-log.h>
 #include <libprelude/idmef.h>
@@ -35,6 +36,10 @@
 #include "preludedb.h"
 
 #include "classic-insert.h"
+#include "classic-address.h"
+#include "classic-dict.h"
+#include "classic-blob.h"
+#include "classic-compress.h"
 
 
 static inline const char *get_string(prelude_string_t *string)
@@ -51,17 +56,17 @@ static inline const char *get_string(prelude_string_t *string)
 
 
 
-static int get_data(preludedb_sql_t *sql, idmef_data_t *data, char **output)
+static int get_data(preludedb_sql_t *sql, classic_compress_column_t column, idmef_data_t *data, char **output)
 {
         int ret;
         prelude_string_t *string;
 
         switch ( idmef_data_get_type(data) ) {
         case IDMEF_DATA_TYPE_BYTE_STRING:
-                return preludedb_sql_escape_binary(sql, idmef_data_get_data(data), idmef_data_get_len(data), output);
+                return classic_compress_escape_column(sql, column, idmef_data_get_data(data), idmef_data_get_len(data), output);
 
         case IDMEF_DATA_TYPE_CHAR_STRING:
-                return preludedb_sql_escape_binary(sql, idmef_data_get_data(data), idmef_data_get_len(data) - 1, output);
+                return classic_compress_escape_column(sql, column, idmef_data_get_data(data), idmef_data_get_len(data) - 1, output);
 
         case IDMEF_DATA_TYPE_CHAR:
                 return preludedb_sql_escape_binary(sql, idmef_data_get_data(data), 1, output);
@@ -131,7 +136,7 @@ static int insert_address(preludedb_sql_t *sql,
                           idmef_address_t *address)
 {
         int ret;
-        char *vlan_name, vlan_num[16], *addr, *netmask, *category, *ident;
+        char *vlan_name, vlan_num[16], *addr, *addr_bin, *netmask, *category, *ident;
 
         if ( ! address )
                 return 0;
@@ -170,17 +175,28 @@ static int insert_address(preludedb_sql_t *sql,
                 return ret;
         }
 
+        ret = classic_address_escape(sql, get_string(idmef_address_get_address(address)), &addr_bin);
+        if ( ret < 0 ) {
+                free(ident);
+                free(addr);
+                free(netmask);
+                free(category);
+                free(vlan_name);
+                return ret;
+        }
+
         get_optional_int32(vlan_num, sizeof(vlan_num), idmef_address_get_vlan_num(address));
 
         ret = preludedb_sql_insert(sql, "Prelude_Address",
                                    "_parent_type, _message_ident, _parent0_index, _index,"
-                                   "ident, category, vlan_name, vlan_num, address, netmask",
-                                   "'%c', %" PRELUDE_PRIu64 ", %d, %d, %s, %s, %s, %s, %s, %s",
+                                   "ident, category, vlan_name, vlan_num, address, netmask, _address_bin",
+                                   "'%c', %" PRELUDE_PRIu64 ", %d, %d, %s, %s, %s, %s, %s, %s, %s",
                                    parent_type, message_ident, parent_index, address_index,
-                                   ident, category, vlan_name, vlan_num, addr, netmask);
+                                   ident, category, vlan_name, vlan_num, addr, netmask, addr_bin);
 
         free(ident);
         free(addr);
+        free(addr_bin);
         free(netmask);
         free(category);
         free(vlan_name);
@@ -194,15 +210,27 @@ static int insert_node(preludedb_sql_t *sql,
                        char parent_type, uint64_t message_ident, int parent_index,
                        idmef_node_t *node)
 {
-        int ret;
+        int ret, interned;
+        uint64_t dict_ident;
         idmef_address_t *address, *last_address;
-        char *location, *name, *category, *ident;
+        char *location, *name, *category, *ident, dict_ident_buf[32];
+        const char *values[3];
         int index;
 
         if ( ! node )
                 return 0;
 
-        ret = preludedb_sql_escape(sql, idmef_node_category_to_string(idmef_node_get_category(node)), &category);
+        values[0] = idmef_node_category_to_string(idmef_node_get_category(node));
+        values[1] = get_string(idmef_node_get_location(node));
+        values[2] = get_string(idmef_node_get_name(node));
+
+        interned = ret = classic_dict_intern(sql, CLASSIC_DICT_NODE, values, &dict_ident);
+        if ( ret < 0 )
+                return ret;
+
+        get_optional_uint64(dict_ident_buf, sizeof(dict_ident_buf), interned ? &dict_ident : NULL);
+
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[0], &category);
         if ( ret < 0 )
                 return ret;
 
@@ -212,14 +240,14 @@ static int insert_node(preludedb_sql_t *sql,
                 return ret;
         }
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_node_get_name(node)), &name);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[2], &name);
         if ( ret < 0 ) {
                 free(ident);
                 free(category);
                 return ret;
         }
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_node_get_location(node)), &location);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[1], &location);
         if ( ret < 0 ) {
                 free(name);
                 free(ident);
@@ -229,10 +257,10 @@ static int insert_node(preludedb_sql_t *sql,
 
         ret = preludedb_sql_insert(sql, "Prelude_Node",
                                    "_parent_type, _message_ident, _parent0_index, "
-                                   "ident, category, location, name",
-                                   "'%c', %" PRELUDE_PRIu64 ", %d, %s, %s, %s, %s",
+                                   "ident, category, location, name, _dict_ident",
+                                   "'%c', %" PRELUDE_PRIu64 ", %d, %s, %s, %s, %s, %s",
                                    parent_type, message_ident, parent_index,
-                                   ident, category, location, name);
+                                   ident, category, location, name, dict_ident_buf);
 
         free(name);
         free(ident);
@@ -1189,52 +1217,69 @@ static int insert_analyzer(preludedb_sql_t *sql,
                            char parent_type, uint64_t message_ident, int analyzer_index,
                            idmef_analyzer_t *analyzer)
 {
-        int ret = -1;
+        int ret = -1, interned;
+        uint64_t dict_ident;
+        const char *values[7];
         char *name = NULL, *manufacturer = NULL, *model = NULL, *version = NULL, *class = NULL,
-                *ostype = NULL, *osversion = NULL, *analyzerid = NULL;
+                *ostype = NULL, *osversion = NULL, *analyzerid = NULL, dict_ident_buf[32];
 
         if ( ! analyzer )
                 return 0;
 
+        values[0] = get_string(idmef_analyzer_get_name(analyzer));
+        values[1] = get_string(idmef_analyzer_get_manufacturer(analyzer));
+        values[2] = get_string(idmef_analyzer_get_model(analyzer));
+        values[3] = get_string(idmef_analyzer_get_version(analyzer));
+        values[4] = get_string(idmef_analyzer_get_class(analyzer));
+        values[5] = get_string(idmef_analyzer_get_ostype(analyzer));
+        values[6] = get_string(idmef_analyzer_get_osversion(analyzer));
+
+        interned = ret = classic_dict_intern(sql, CLASSIC_DICT_ANALYZER, values, &dict_ident);
+        if ( ret < 0 )
+                return ret;
+
+        get_optional_uint64(dict_ident_buf, sizeof(dict_ident_buf), interned ? &dict_ident : NULL);
+
         ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_analyzerid(analyzer)), &analyzerid);
         if ( ret < 0 )
                 return ret;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_class(analyzer)), &class);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[4], &class);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_name(analyzer)), &name);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[0], &name);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_model(analyzer)), &model);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[2], &model);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_version(analyzer)), &version);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[3], &version);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_manufacturer(analyzer)), &manufacturer);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[1], &manufacturer);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_ostype(analyzer)), &ostype);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[5], &ostype);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_osversion(analyzer)), &osversion);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[6], &osversion);
         if ( ret < 0 )
                 goto error;
 
         ret = preludedb_sql_insert(sql, "Prelude_Analyzer",
                                    "_parent_type, _message_ident, _index, analyzerid, name, manufacturer, "
                                    "model, version, class, "
-                                   "ostype, osversion",
-                                   "'%c', %" PRELUDE_PRIu64 ", %d, %s, %s, %s, %s, %s, %s, %s, %s",
+                                   "ostype, osversion, _dict_ident",
+                                   "'%c', %" PRELUDE_PRIu64 ", %d, %s, %s, %s, %s, %s, %s, %s, %s, %s",
                                    parent_type, message_ident, analyzer_index,
-                                   analyzerid, name, manufacturer, model, version, class, ostype, osversion);
+                                   analyzerid, name, manufacturer, model, version, class, ostype, osversion,
+                                   dict_ident_buf);
 
         if ( ret < 0 )
                 goto error;
@@ -1321,28 +1366,38 @@ static int insert_reference(preludedb_sql_t *sql,
 
 static int insert_classification(preludedb_sql_t *sql, uint64_t message_ident, idmef_classification_t *classification)
 {
-        char *text, *ident;
+        char *text, *ident, dict_ident_buf[32];
         idmef_reference_t *reference, *last_reference;
+        const char *values[1];
+        uint64_t dict_ident;
         int index;
-        int ret;
+        int ret, interned;
 
         if ( ! classification )
                 return 0;
 
+        values[0] = get_string(idmef_classification_get_text(classification));
+
+        interned = ret = classic_dict_intern(sql, CLASSIC_DICT_CLASSIFICATION, values, &dict_ident);
+        if ( ret < 0 )
+                return ret;
+
+        get_optional_uint64(dict_ident_buf, sizeof(dict_ident_buf), interned ? &dict_ident : NULL);
+
         ret = preludedb_sql_escape(sql, get_string(idmef_classification_get_ident(classification)), &ident);
         if ( ret < 0 )
                 return ret;
 
-        ret = preludedb_sql_escape(sql, get_string(idmef_classification_get_text(classification)), &text);
+        ret = preludedb_sql_escape(sql, interned ? NULL : values[0], &text);
         if ( ret < 0 ) {
                 free(ident);
                 return ret;
         }
 
         ret = preludedb_sql_insert(sql, "Prelude_Classification",
-                                   "_message_ident, ident, text",
-                                   "%" PRELUDE_PRIu64 ", %s, %s",
-                                   message_ident, ident, text);
+                                   "_message_ident, ident, text, _dict_ident",
+                                   "%" PRELUDE_PRIu64 ", %s, %s, %s",
+                                   message_ident, ident, text, dict_ident_buf);
 
         free(text);
         free(ident);
@@ -1389,7 +1444,7 @@ static int insert_additional_data(preludedb_sql_t *sql,
                 return ret;
         }
 
-        ret = get_data(sql, idmef_additional_data_get_data(additional_data), &data);
+        ret = get_data(sql, CLASSIC_COMPRESS_COLUMN_ADDITIONAL_DATA, idmef_additional_data_get_data(additional_data), &data);
         if ( ret < 0 ) {
                 free(type);
                 free(meaning);
@@ -1625,7 +1680,7 @@ static int insert_overflow_alert(preludedb_sql_t *sql, uint64_t message_ident, i
         if ( ret < 0 )
                 return ret;
 
-        ret = get_data(sql, idmef_overflow_alert_get_buffer(overflow_alert), &buffer);
+        ret = get_data(sql, CLASSIC_COMPRESS_COLUMN_OVERFLOW_BUFFER, idmef_overflow_alert_get_buffer(overflow_alert), &buffer);
         if ( ret < 0 ) {
                 free(program);
                 return ret;
@@ -1816,7 +1871,7 @@ static int insert_message_messageid(preludedb_sql_t *sql, const char *table_name
 
 
 
-static int insert_alert(preludedb_sql_t *sql, idmef_alert_t *alert)
+static int insert_alert(preludedb_sql_t *sql, idmef_alert_t *alert, uint64_t *result)
 {
         uint64_t ident;
         idmef_source_t *source, *last_source;
@@ -1948,12 +2003,14 @@ static int insert_alert(preludedb_sql_t *sql, idmef_alert_t *alert)
                         return ret;
         }
 
+        *result = ident;
+
         return 1;
 }
 
 
 
-static int insert_heartbeat(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat)
+static int insert_heartbeat_message(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat, uint64_t *result)
 {
         uint64_t ident;
         idmef_analyzer_t *analyzer, *last_analyzer;
@@ -1962,9 +2019,6 @@ static int insert_heartbeat(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat)
         unsigned int index;
         int ret;
 
-        if ( ! heartbeat )
-                return 0;
-
         ret = preludedb_sql_escape(sql, get_string(idmef_heartbeat_get_messageid(heartbeat)), &messageid);
         if ( ret < 0 )
                 return ret;
@@ -1983,6 +2037,9 @@ static int insert_heartbeat(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat)
         if ( ret < 0 )
                 return ret;
 
+        if ( result )
+                *result = ident;
+
         index = 0;
         last_analyzer = analyzer = NULL;
         while ( (analyzer = idmef_heartbeat_get_next_analyzer(heartbeat, analyzer)) ) {
@@ -2030,9 +2087,236 @@ static int insert_heartbeat(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat)
 
 
 
+static int get_heartbeat_history(preludedb_sql_t *sql, unsigned long *interval)
+{
+        char *eptr;
+        const char *str;
+
+        *interval = 0;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_HEARTBEAT_HISTORY);
+        if ( ! str )
+                return 0;
+
+        *interval = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "invalid value '%s' for setting '%s'",
+                                               str, PRELUDEDB_SQL_SETTING_HEARTBEAT_HISTORY);
+
+        return 0;
+}
+
+
+
+static const char *get_heartbeat_status(idmef_heartbeat_t *heartbeat)
+{
+        idmef_data_t *data;
+        idmef_additional_data_t *additional_data = NULL;
+
+        while ( (additional_data = idmef_heartbeat_get_next_additional_data(heartbeat, additional_data)) ) {
+                if ( ! idmef_additional_data_get_meaning(additional_data) ||
+                     strcmp(get_string(idmef_additional_data_get_meaning(additional_data)), "Analyzer status") != 0 )
+                        continue;
+
+                data = idmef_additional_data_get_data(additional_data);
+                if ( data && idmef_data_get_type(data) == IDMEF_DATA_TYPE_CHAR_STRING )
+                        return idmef_data_get_data(data);
+        }
+
+        return NULL;
+}
+
+
+
+static prelude_bool_t field_changed(preludedb_sql_row_t *row, int column, const char *value)
+{
+        int ret;
+        preludedb_sql_field_t *field;
+
+        ret = preludedb_sql_row_get_field(row, column, &field);
+        if ( ret <= 0 )
+                return value != NULL;
+
+        return ! value || strcmp(preludedb_sql_field_get_value(field), value) != 0;
+}
+
+
+
+/*
+ * Look up the state of the analyzer that emitted @heartbeat: a full
+ * heartbeat is only kept once every @history seconds, or when its
+ * interval or status changed.
+ */
+static int need_heartbeat_history(preludedb_sql_t *sql, const char *analyzerid, idmef_heartbeat_t *heartbeat,
+                                  const char *heartbeat_interval, const char *status, unsigned long history,
+                                  uint64_t *ident, uint64_t *history_time)
+{
+        int ret;
+        preludedb_sql_row_t *row;
+        preludedb_sql_table_t *table;
+        preludedb_sql_field_t *field;
+        time_t now = idmef_time_get_sec(idmef_heartbeat_get_create_time(heartbeat));
+
+        ret = preludedb_sql_query_sprintf(sql, &table,
+                                          "SELECT _message_ident, _history_time, heartbeat_interval, status "
+                                          "FROM Prelude_HeartbeatState WHERE analyzerid = %s", analyzerid);
+        if ( ret <= 0 )
+                return (ret < 0) ? ret : 1;
+
+        ret = preludedb_sql_table_fetch_row(table, &row);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_row_get_field(row, 0, &field);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_field_to_uint64(field, ident);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_row_get_field(row, 1, &field);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_field_to_uint64(field, history_time);
+        if ( ret < 0 )
+                goto error;
+
+        ret = ( now < (time_t) *history_time || (uint64_t) now - *history_time >= history ||
+                field_changed(row, 2, strcmp(heartbeat_interval, "NULL") == 0 ? NULL : heartbeat_interval) ||
+                field_changed(row, 3, status) ) ? 1 : 0;
+
+        preludedb_sql_table_destroy(table);
+
+        return ret;
+
+ error:
+        preludedb_sql_table_destroy(table);
+
+        return (ret < 0) ? ret : 1;
+}
+
+
+
+/*
+ * With the "heartbeat_history" setting, each heartbeat updates the
+ * Prelude_HeartbeatState row of its analyzer in place, and the full
+ * message is only inserted once per history interval. This turns the
+ * eight or so rows every heartbeat used to write into a single upsert,
+ * plus an update of the create_time of the latest history heartbeat,
+ * while Prelude_Heartbeat keeps a down-sampled history for
+ * preludedb_get_heartbeat_idents().
+ */
+static int insert_heartbeat_state(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat, unsigned long history)
+{
+        int ret, need_history;
+        const char *status;
+        char heartbeat_interval[16];
+        char utc_time[PRELUDEDB_SQL_TIMESTAMP_STRING_SIZE], utc_time_usec[16], utc_time_gmtoff[16];
+        char *analyzerid = NULL, *messageid = NULL, *escaped_status = NULL;
+        idmef_analyzer_t *analyzer = NULL, *last_analyzer = NULL;
+        uint64_t ident = 0, history_time = 0;
+
+        while ( (analyzer = idmef_heartbeat_get_next_analyzer(heartbeat, analyzer)) )
+                last_analyzer = analyzer;
+
+        if ( ! last_analyzer || ! idmef_analyzer_get_analyzerid(last_analyzer) || ! idmef_heartbeat_get_create_time(heartbeat) )
+                return insert_heartbeat_message(sql, heartbeat, NULL);
+
+        get_optional_uint32(heartbeat_interval, sizeof(heartbeat_interval),
+                            idmef_heartbeat_get_heartbeat_interval(heartbeat));
+
+        status = get_heartbeat_status(heartbeat);
+
+        ret = preludedb_sql_escape(sql, get_string(idmef_analyzer_get_analyzerid(last_analyzer)), &analyzerid);
+        if ( ret < 0 )
+                return ret;
+
+        need_history = ret = need_heartbeat_history(sql, analyzerid, heartbeat, heartbeat_interval, status,
+                                                    history, &ident, &history_time);
+        if ( ret < 0 )
+                goto error;
+
+        if ( need_history ) {
+                ret = insert_heartbeat_message(sql, heartbeat, &ident);
+                if ( ret < 0 )
+                        goto error;
+
+                history_time = idmef_time_get_sec(idmef_heartbeat_get_create_time(heartbeat));
+        }
+
+        ret = preludedb_sql_time_to_timestamp(sql, idmef_heartbeat_get_create_time(heartbeat), utc_time, sizeof(utc_time),
+                                              utc_time_gmtoff, sizeof(utc_time_gmtoff), utc_time_usec, sizeof(utc_time_usec));
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_escape(sql, get_string(idmef_heartbeat_get_messageid(heartbeat)), &messageid);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_escape(sql, status, &escaped_status);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_upsert(sql, "Prelude_HeartbeatState",
+                                   "analyzerid, _message_ident, _history_time, messageid, heartbeat_interval, status, "
+                                   "create_time, create_time_usec, create_time_gmtoff", "analyzerid",
+                                   "%s, %" PRELUDE_PRIu64 ", %" PRELUDE_PRIu64 ", %s, %s, %s, %s, %s, %s",
+                                   analyzerid, ident, history_time, messageid, heartbeat_interval, escaped_status,
+                                   utc_time, utc_time_usec, utc_time_gmtoff);
+
+        /*
+         * Backends without upsert keep every heartbeat.
+         */
+        if ( ret < 0 && prelude_error_get_code(ret) == prelude_error_code_from_errno(ENOSYS) )
+                ret = need_history ? 1 : insert_heartbeat_message(sql, heartbeat, NULL);
+
+        /*
+         * Readers only see the history: its latest heartbeat carries the
+         * time of the last one received, so that the analyzer does not
+         * look offline in between.
+         */
+        else if ( ret >= 0 && ! need_history )
+                ret = preludedb_sql_query_sprintf(sql, NULL,
+                                                  "UPDATE Prelude_CreateTime SET time = %s, usec = %s, gmtoff = %s "
+                                                  "WHERE _parent_type = 'H' AND _message_ident = %" PRELUDE_PRIu64,
+                                                  utc_time, utc_time_usec, utc_time_gmtoff, ident);
+
+ error:
+        free(escaped_status);
+        free(messageid);
+        free(analyzerid);
+
+        return (ret < 0) ? ret : 1;
+}
+
+
+
+static int insert_heartbeat(preludedb_sql_t *sql, idmef_heartbeat_t *heartbeat)
+{
+        int ret;
+        unsigned long history;
+
+        if ( ! heartbeat )
+                return 0;
+
+        ret = get_heartbeat_history(sql, &history);
+        if ( ret < 0 )
+                return ret;
+
+        if ( ! history )
+                return insert_heartbeat_message(sql, heartbeat, NULL);
+
+        return insert_heartbeat_state(sql, heartbeat, history);
+}
+
+
+
 int classic_insert(preludedb_t *db, idmef_message_t *message)
 {
         int ret;
+        uint64_t ident;
         preludedb_sql_t *sql = preludedb_get_sql(db);
 
         if ( ! message )
@@ -2045,7 +2329,9 @@ int classic_insert(preludedb_t *db, idmef_message_t *message)
         switch ( idmef_message_get_type(message) ) {
 
         case IDMEF_MESSAGE_TYPE_ALERT:
-                ret = insert_alert(sql, idmef_message_get_alert(message));
+                ret = insert_alert(sql, idmef_message_get_alert(message), &ident);
+                if ( ret > 0 )
+                        ret = classic_blob_insert(sql, ident, message);
                 break;
 
         case IDMEF_MESSAGE_TYPE_HEARTBEAT:
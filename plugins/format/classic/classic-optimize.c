@@ -0,0 +1,348 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include <libprelude/prelude-log.h>
+#include <libprelude/idmef.h>
+
+#include "glthread/lock.h"
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+#include "preludedb-path-selection.h"
+#include "preludedb.h"
+
+#include "classic-optimize.h"
+#include "classic-address.h"
+
+
+/*
+ * Number of addresses packed per transaction by the backfill.
+ */
+#define BACKFILL_BATCH_SIZE 1000
+
+
+typedef enum {
+        TABLE_ALERT     = 0x01,
+        TABLE_HEARTBEAT = 0x02,
+        TABLE_SHARED    = TABLE_ALERT|TABLE_HEARTBEAT
+} table_owner_t;
+
+
+typedef struct {
+        const char *name;
+        table_owner_t owner;
+} optimize_table_t;
+
+
+/*
+ * Progress kept across runs on the same connection. A pass over the
+ * tables may span several runs: it starts from the table the previous
+ * pass stopped at, and works from the modification counts seen when it
+ * began.
+ */
+typedef struct {
+        gl_lock_t mutex;
+        uint64_t address_cursor;
+        prelude_bool_t address_done;
+
+        size_t next_table;
+        size_t remaining_tables;
+        prelude_bool_t pass_processed;
+        unsigned long pass_count[4];
+} optimize_state_t;
+
+
+/*
+ * Tables holding rows for both alerts and heartbeats (through _parent_type)
+ * change whenever either kind of message does.
+ */
+static const optimize_table_t tables[] = {
+        { "Prelude_Alert", TABLE_ALERT },
+        { "Prelude_Alertident", TABLE_ALERT },
+        { "Prelude_MessageBlob", TABLE_ALERT },
+        { "Prelude_ToolAlert", TABLE_ALERT },
+        { "Prelude_CorrelationAlert", TABLE_ALERT },
+        { "Prelude_OverflowAlert", TABLE_ALERT },
+        { "Prelude_Classification", TABLE_ALERT },
+        { "Prelude_Reference", TABLE_ALERT },
+        { "Prelude_Source", TABLE_ALERT },
+        { "Prelude_Target", TABLE_ALERT },
+        { "Prelude_File", TABLE_ALERT },
+        { "Prelude_FileAccess", TABLE_ALERT },
+        { "Prelude_FileAccess_Permission", TABLE_ALERT },
+        { "Prelude_Linkage", TABLE_ALERT },
+        { "Prelude_Inode", TABLE_ALERT },
+        { "Prelude_Checksum", TABLE_ALERT },
+        { "Prelude_Impact", TABLE_ALERT },
+        { "Prelude_Action", TABLE_ALERT },
+        { "Prelude_Confidence", TABLE_ALERT },
+        { "Prelude_Assessment", TABLE_ALERT },
+        { "Prelude_CreateTime", TABLE_ALERT },
+        { "Prelude_DetectTime", TABLE_ALERT },
+        { "Prelude_User", TABLE_ALERT },
+        { "Prelude_UserId", TABLE_ALERT },
+        { "Prelude_Service", TABLE_ALERT },
+        { "Prelude_WebService", TABLE_ALERT },
+        { "Prelude_WebServiceArg", TABLE_ALERT },
+        { "Prelude_SnmpService", TABLE_ALERT },
+        { "Prelude_Heartbeat", TABLE_HEARTBEAT },
+        { "Prelude_HeartbeatState", TABLE_HEARTBEAT },
+        { "Prelude_Analyzer", TABLE_SHARED },
+        { "Prelude_AnalyzerTime", TABLE_SHARED },
+        { "Prelude_AdditionalData", TABLE_SHARED },
+        { "Prelude_Node", TABLE_SHARED },
+        { "Prelude_Address", TABLE_SHARED },
+        { "Prelude_Process", TABLE_SHARED },
+        { "Prelude_ProcessArg", TABLE_SHARED },
+        { "Prelude_ProcessEnv", TABLE_SHARED },
+        { "Prelude_AnalyzerDict", TABLE_SHARED },
+        { "Prelude_NodeDict", TABLE_SHARED },
+        { "Prelude_ClassificationDict", TABLE_ALERT },
+};
+
+
+static const char optimize_state_key;
+
+gl_lock_define_initialized(static, optimize_state_lock);
+
+
+
+static void optimize_state_destroy(void *data)
+{
+        optimize_state_t *state = data;
+
+        gl_lock_destroy(state->mutex);
+        free(state);
+}
+
+
+
+static int get_optimize_state(preludedb_sql_t *sql, optimize_state_t **out)
+{
+        int ret = 0;
+        optimize_state_t *state;
+
+        gl_lock_lock(optimize_state_lock);
+
+        state = preludedb_sql_get_data(sql, &optimize_state_key);
+        if ( ! state ) {
+                state = calloc(1, sizeof(*state));
+                if ( ! state ) {
+                        ret = preludedb_error_from_errno(errno);
+                        goto error;
+                }
+
+                gl_lock_init(state->mutex);
+
+                ret = preludedb_sql_set_data(sql, &optimize_state_key, state, optimize_state_destroy);
+                if ( ret < 0 ) {
+                        optimize_state_destroy(state);
+                        goto error;
+                }
+        }
+
+        *out = state;
+
+    error:
+        gl_lock_unlock(optimize_state_lock);
+
+        return ret;
+}
+
+
+
+static int get_uint_setting(preludedb_sql_t *sql, const char *name, unsigned long *value)
+{
+        char *eptr;
+        const char *str;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), name);
+        if ( ! str )
+                return 0;
+
+        *value = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                               "invalid value '%s' for setting '%s'", str, name);
+
+        return 0;
+}
+
+
+
+static preludedb_sql_optimize_flags_t get_table_flags(table_owner_t owner, const unsigned long *count, unsigned long threshold)
+{
+        unsigned long inserted = 0, deleted = 0;
+        preludedb_sql_optimize_flags_t flags = 0;
+
+        if ( owner & TABLE_ALERT ) {
+                inserted += count[PRELUDEDB_MODIFICATION_ALERT_INSERT];
+                deleted += count[PRELUDEDB_MODIFICATION_ALERT_DELETE];
+        }
+
+        if ( owner & TABLE_HEARTBEAT ) {
+                inserted += count[PRELUDEDB_MODIFICATION_HEARTBEAT_INSERT];
+                deleted += count[PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE];
+        }
+
+        if ( inserted + deleted < threshold )
+                return 0;
+
+        flags |= PRELUDEDB_SQL_OPTIMIZE_ANALYZE;
+
+        /*
+         * Insertion alone does not leave reclaimable space behind.
+         */
+        if ( deleted > 0 || threshold == 0 )
+                flags |= PRELUDEDB_SQL_OPTIMIZE_RECLAIM;
+
+        return flags;
+}
+
+
+
+/*
+ * Pack the addresses stored before schema 14.8 that the update scripts
+ * could not, in batches, until done or out of @budget. Addresses written
+ * since are always packed, so this is over once the scan reaches the end.
+ */
+static int backfill_addresses(preludedb_sql_t *sql, optimize_state_t *state, time_t start, unsigned long budget)
+{
+        int ret;
+
+        while ( ! state->address_done ) {
+                if ( budget && (unsigned long) (time(NULL) - start) >= budget )
+                        break;
+
+                ret = classic_address_backfill(sql, &state->address_cursor, BACKFILL_BATCH_SIZE);
+                if ( ret < 0 )
+                        return ret;
+
+                if ( ret == 0 )
+                        state->address_done = TRUE;
+        }
+
+        return 0;
+}
+
+
+
+/*
+ * Maintenance is driven by the number of messages inserted and deleted
+ * through @db: a table is only analyzed once this count reaches the
+ * "optimize_threshold" setting, and space is only reclaimed if rows were
+ * deleted from it. With no threshold configured, every table is processed,
+ * which is what an explicit request from the administrator expects.
+ *
+ * The "optimize_budget" setting bounds the run to a number of seconds: no
+ * new table is started once it is exhausted, and the next run resumes the
+ * pass from the first table left. Counts are only reset once a pass went
+ * through every table, so no table is left behind on a busy database, and
+ * keep adding up while no table reaches the threshold.
+ *
+ * Each run first goes on packing addresses stored before schema 14.8,
+ * within the same budget.
+ */
+int classic_optimize(preludedb_t *db)
+{
+        int ret;
+        size_t i;
+        time_t start;
+        preludedb_sql_t *sql;
+        optimize_state_t *state;
+        preludedb_sql_optimize_flags_t flags;
+        unsigned long threshold = 0, budget = 0;
+        prelude_bool_t processed = FALSE;
+        const size_t ntables = sizeof(tables) / sizeof(*tables);
+
+        sql = preludedb_get_sql(db);
+
+        ret = get_uint_setting(sql, PRELUDEDB_SQL_SETTING_OPTIMIZE_THRESHOLD, &threshold);
+        if ( ret < 0 )
+                return ret;
+
+        ret = get_uint_setting(sql, PRELUDEDB_SQL_SETTING_OPTIMIZE_BUDGET, &budget);
+        if ( ret < 0 )
+                return ret;
+
+        ret = get_optimize_state(sql, &state);
+        if ( ret < 0 )
+                return ret;
+
+        start = time(NULL);
+
+        gl_lock_lock(state->mutex);
+
+        ret = backfill_addresses(sql, state, start, budget);
+        if ( ret < 0 )
+                goto error;
+
+        if ( ! state->remaining_tables ) {
+                for ( i = 0; i < sizeof(state->pass_count) / sizeof(*state->pass_count); i++ )
+                        state->pass_count[i] = preludedb_get_modification_count(db, i);
+
+                state->remaining_tables = ntables;
+                state->pass_processed = FALSE;
+        }
+
+        for ( ; state->remaining_tables; state->remaining_tables-- ) {
+                i = state->next_table;
+
+                flags = get_table_flags(tables[i].owner, state->pass_count, threshold);
+                if ( flags ) {
+                        if ( budget && (unsigned long) (time(NULL) - start) >= budget )
+                                break;
+
+                        ret = preludedb_sql_optimize(sql, tables[i].name, flags);
+                        if ( ret < 0 )
+                                goto error;
+
+                        processed = state->pass_processed = TRUE;
+                }
+
+                state->next_table = (i + 1) % ntables;
+        }
+
+        if ( processed ) {
+                ret = preludedb_sql_optimize(sql, NULL, PRELUDEDB_SQL_OPTIMIZE_ANALYZE|PRELUDEDB_SQL_OPTIMIZE_RECLAIM);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        if ( ! state->remaining_tables && state->pass_processed ) {
+                for ( i = 0; i < sizeof(state->pass_count) / sizeof(*state->pass_count); i++ )
+                        preludedb_reset_modification_count(db, i, state->pass_count[i]);
+        }
+
+    error:
+        gl_lock_unlock(state->mutex);
+
+        return (ret < 0) ? ret : 0;
+}
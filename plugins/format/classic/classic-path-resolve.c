@@ -36,6 +36,9 @@
 
 #include "classic-sql-join.h"
 #include "classic-path-resolve.h"
+#include "classic-address.h"
+#include "classic-advisor.h"
+#include "classic-dict.h"
 
 #define FIELD_CONTEXT_WHERE    1
 #define FIELD_CONTEXT_SELECT   2
@@ -312,12 +315,31 @@ static int get_field_context(preludedb_selected_path_t *selected)
 
 
 
+static int get_joined_table(classic_sql_join_t *join, const idmef_path_t *path,
+                            const classic_idmef_class_t *class, classic_sql_joined_table_t **table)
+{
+        int ret;
+        char *table_name;
+
+        *table = classic_sql_join_lookup_table(join, path);
+        if ( *table )
+                return 0;
+
+        ret = class->resolve_table_name(path, &table_name);
+        if ( ret < 0 )
+                return ret;
+
+        return classic_sql_join_new_table(join, table, path, table_name);
+}
+
+
+
 static int _classic_path_resolve(const idmef_path_t *path, int field_context, void *data, prelude_string_t *output)
 {
         classic_sql_join_t *join = data;
         const classic_idmef_class_t *class;
         classic_sql_joined_table_t *table;
-        char *table_name;
+        const char *table_name, *column, *alias;
         int ret;
 
         if ( idmef_path_get_depth(path) == 2 && idmef_path_get_value_type(path, 1) != IDMEF_VALUE_TYPE_TIME )
@@ -325,23 +347,85 @@ static int _classic_path_resolve(const idmef_path_t *path, int field_context, vo
 
         class = search_path(path);
 
-        table = classic_sql_join_lookup_table(join, path);
+        ret = get_joined_table(join, path, class, &table);
+        if ( ret < 0 )
+                return ret;
 
-        if ( ! table ) {
-                ret = class->resolve_table_name(path, &table_name);
-                if ( ret < 0 )
-                        return ret;
+        alias = classic_sql_joined_table_get_name(table);
+        table_name = classic_sql_joined_table_get_table_name(table);
+        column = idmef_path_get_name(path, idmef_path_get_depth(path) - 1);
+
+        /*
+         * Values stored inline take precedence over the dictionary entry,
+         * so that updated rows read as expected. The dictionary tables are
+         * part of every supported schema, and whether rows reference them
+         * depends on the setting of the writer, not of this client.
+         */
+        if ( classic_dict_has_column(table_name, column) )
+                return prelude_string_sprintf(output, "COALESCE(%s.%s, %s.%s)", alias, column,
+                                              classic_sql_joined_table_get_dict_name(table, classic_dict_get_table(table_name)),
+                                              column);
+
+        return class->resolve_field_name(path, field_context, alias, output);
+}
+
+
+/*
+ * Resolve @path to the table holding it, and to the comma separated list
+ * of its columns, unqualified, as expected by an UPDATE statement. @table
+ * is set to NULL if @path is stored in the top level message table.
+ */
+int classic_path_resolve_update(const idmef_path_t *path, classic_sql_join_t *join,
+                                classic_sql_joined_table_t **table, prelude_string_t *output)
+{
+        int ret;
+        size_t len;
+        const char *ptr, *alias;
+        prelude_string_t *fields;
+        const classic_idmef_class_t *class;
+
+        if ( idmef_path_get_depth(path) == 2 && idmef_path_get_value_type(path, 1) != IDMEF_VALUE_TYPE_TIME ) {
+                *table = NULL;
+                return prelude_string_cat(output, idmef_path_get_name(path, 1));
+        }
+
+        class = search_path(path);
+
+        ret = get_joined_table(join, path, class, table);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_new(&fields);
+        if ( ret < 0 )
+                return ret;
+
+        alias = classic_sql_joined_table_get_name(*table);
+
+        ret = class->resolve_field_name(path, FIELD_CONTEXT_SELECT, alias, fields);
+        if ( ret < 0 )
+                goto error;
+
+        len = strlen(alias);
+        ptr = prelude_string_get_string(fields);
+
+        while ( *ptr ) {
+                if ( strncmp(ptr, alias, len) == 0 && ptr[len] == '.' ) {
+                        ptr += len + 1;
+                        continue;
+                }
 
-                ret = classic_sql_join_new_table(join, &table, path, table_name);
+                ret = prelude_string_ncat(output, ptr++, 1);
                 if ( ret < 0 )
-                        return ret;
+                        goto error;
         }
 
-        return class->resolve_field_name(path, field_context,
-                                         classic_sql_joined_table_get_name(table), output);
+ error:
+        prelude_string_destroy(fields);
+        return ret;
 }
 
 
+
 int classic_path_resolve(preludedb_selected_path_t *selpath, preludedb_selected_object_t *object, void *data, prelude_string_t *output)
 {
         const idmef_path_t *path = preludedb_selected_object_get_data(object);
@@ -350,18 +434,160 @@ int classic_path_resolve(preludedb_selected_path_t *selpath, preludedb_selected_
 
 
 
+/*
+ * Subnet and ordering criteria on an address are resolved against its
+ * packed form, which unlike the textual one sorts numerically.
+ */
+static int resolve_address_criterion(preludedb_sql_t *sql, idmef_criterion_t *criterion,
+                                     classic_sql_join_t *join, classic_advisor_shape_t *shape,
+                                     prelude_string_t *output)
+{
+        int ret;
+        prelude_string_t *field_name;
+        classic_sql_joined_table_t *table;
+        const idmef_path_t *path = idmef_criterion_get_path(criterion);
+
+        ret = get_joined_table(join, path, search_path(path), &table);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_new(&field_name);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_sprintf(field_name, "%s._address_bin", classic_sql_joined_table_get_name(table));
+        if ( ret < 0 )
+                goto error;
+
+        ret = classic_address_build_criterion_string(sql, output, prelude_string_get_string(field_name),
+                                                     idmef_criterion_get_operator(criterion),
+                                                     idmef_criterion_get_value(criterion));
+
+        /*
+         * Whatever the operator, the packed column is scanned as a range.
+         */
+        if ( ret > 0 )
+                classic_advisor_shape_add_criterion(shape, path, table, prelude_string_get_string(field_name),
+                                                    IDMEF_CRITERION_OPERATOR_GREATER_OR_EQUAL,
+                                                    idmef_criterion_get_value(criterion));
+
+ error:
+        prelude_string_destroy(field_name);
+
+        return ret;
+}
+
+
+
+/*
+ * Equality and substring criteria on a dictionary column are resolved
+ * against the inline column, or the matching dictionary entries, so that
+ * the indexes of both tables remain usable. Returns 0 if @criterion does
+ * not apply.
+ */
+static int resolve_dict_criterion(preludedb_sql_t *sql, idmef_criterion_t *criterion,
+                                  classic_sql_join_t *join, classic_advisor_shape_t *shape,
+                                  prelude_string_t *output)
+{
+        int ret;
+        prelude_string_t *field_name;
+        classic_sql_joined_table_t *table;
+        const char *table_name, *dict_table, *column;
+        const idmef_path_t *path = idmef_criterion_get_path(criterion);
+        idmef_criterion_operator_t operator = idmef_criterion_get_operator(criterion);
+
+        if ( idmef_path_get_depth(path) == 2 )
+                return 0;
+
+        if ( operator != IDMEF_CRITERION_OPERATOR_EQUAL && operator != IDMEF_CRITERION_OPERATOR_EQUAL_NOCASE &&
+             operator != IDMEF_CRITERION_OPERATOR_SUBSTR && operator != IDMEF_CRITERION_OPERATOR_SUBSTR_NOCASE )
+                return 0;
+
+        ret = get_joined_table(join, path, search_path(path), &table);
+        if ( ret < 0 )
+                return ret;
+
+        table_name = classic_sql_joined_table_get_table_name(table);
+        column = idmef_path_get_name(path, idmef_path_get_depth(path) - 1);
+        if ( ! classic_dict_has_column(table_name, column) )
+                return 0;
+
+        dict_table = classic_dict_get_table(table_name);
+
+        ret = prelude_string_new(&field_name);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_sprintf(field_name, "%s.%s", classic_sql_joined_table_get_name(table), column);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(output, "(");
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_build_criterion_string(sql, output, prelude_string_get_string(field_name),
+                                                   operator, idmef_criterion_get_value(criterion));
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_sprintf(output, " OR (%s IS NULL AND %s._dict_ident IN (SELECT _ident FROM %s WHERE ",
+                                     prelude_string_get_string(field_name),
+                                     classic_sql_joined_table_get_name(table), dict_table);
+        if ( ret < 0 )
+                goto error;
+
+        classic_advisor_shape_add_criterion(shape, path, table, prelude_string_get_string(field_name),
+                                            operator, idmef_criterion_get_value(criterion));
+
+        prelude_string_clear(field_name);
+
+        ret = prelude_string_sprintf(field_name, "%s.%s", dict_table, column);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_build_criterion_string(sql, output, prelude_string_get_string(field_name),
+                                                   operator, idmef_criterion_get_value(criterion));
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(output, ")))");
+        if ( ret >= 0 )
+                ret = 1;
+
+ error:
+        prelude_string_destroy(field_name);
+
+        return ret;
+}
+
+
+
 static int classic_path_resolve_criterion(preludedb_sql_t *sql,
                                           idmef_criterion_t *criterion,
-                                          classic_sql_join_t *join, prelude_string_t *output)
+                                          classic_sql_join_t *join, classic_advisor_shape_t *shape,
+                                          prelude_string_t *output)
 {
         prelude_string_t *field_name;
+        classic_sql_joined_table_t *table = NULL;
+        const idmef_path_t *path = idmef_criterion_get_path(criterion);
         int ret;
 
+        if ( classic_address_is_address_path(path) ) {
+                ret = resolve_address_criterion(sql, criterion, join, shape, output);
+                if ( ret != 0 )
+                        return (ret < 0) ? ret : 0;
+        }
+
+        ret = resolve_dict_criterion(sql, criterion, join, shape, output);
+        if ( ret != 0 )
+                return (ret < 0) ? ret : 0;
+
         ret = prelude_string_new(&field_name);
         if ( ret < 0 )
                 return ret;
 
-        ret = _classic_path_resolve(idmef_criterion_get_path(criterion), FIELD_CONTEXT_WHERE, join, field_name);
+        ret = _classic_path_resolve(path, FIELD_CONTEXT_WHERE, join, field_name);
         if ( ret < 0 )
                 goto error;
 
@@ -369,6 +595,15 @@ static int classic_path_resolve_criterion(preludedb_sql_t *sql,
                                                    prelude_string_get_string(field_name),
                                                    idmef_criterion_get_operator(criterion),
                                                    idmef_criterion_get_value(criterion));
+        if ( ret < 0 )
+                goto error;
+
+        if ( idmef_path_get_depth(path) != 2 || idmef_path_get_value_type(path, 1) == IDMEF_VALUE_TYPE_TIME )
+                table = classic_sql_join_lookup_table(join, path);
+
+        classic_advisor_shape_add_criterion(shape, path, table, prelude_string_get_string(field_name),
+                                            idmef_criterion_get_operator(criterion),
+                                            idmef_criterion_get_value(criterion));
 
  error:
         prelude_string_destroy(field_name);
@@ -378,9 +613,10 @@ static int classic_path_resolve_criterion(preludedb_sql_t *sql,
 
 
 
-int classic_path_resolve_criteria(preludedb_sql_t *sql,
-                                  idmef_criteria_t *criteria,
-                                  classic_sql_join_t *join, prelude_string_t *output)
+static int resolve_criteria(preludedb_sql_t *sql,
+                            idmef_criteria_t *criteria,
+                            classic_sql_join_t *join, classic_advisor_shape_t *shape,
+                            prelude_string_t *output)
 {
         int ret;
         idmef_criteria_t *or, *and;
@@ -389,12 +625,14 @@ int classic_path_resolve_criteria(preludedb_sql_t *sql,
         and = idmef_criteria_get_and(criteria);
 
         if ( or ) {
+                classic_advisor_shape_set_disjunctive(shape);
+
                 ret = prelude_string_cat(output, "((");
                 if ( ret < 0 )
                         return ret;
         }
 
-        ret = classic_path_resolve_criterion(sql, idmef_criteria_get_criterion(criteria), join, output);
+        ret = classic_path_resolve_criterion(sql, idmef_criteria_get_criterion(criteria), join, shape, output);
         if ( ret < 0 )
                 return ret;
 
@@ -403,7 +641,7 @@ int classic_path_resolve_criteria(preludedb_sql_t *sql,
                 if ( ret < 0 )
                         return ret;
 
-                ret = classic_path_resolve_criteria(sql, and, join, output);
+                ret = resolve_criteria(sql, and, join, shape, output);
                 if ( ret < 0 )
                         return ret;
         }
@@ -413,7 +651,7 @@ int classic_path_resolve_criteria(preludedb_sql_t *sql,
                 if ( ret < 0 )
                         return ret;
 
-                ret = classic_path_resolve_criteria(sql, or, join, output);
+                ret = resolve_criteria(sql, or, join, shape, output);
                 if ( ret < 0 )
                         return ret;
 
@@ -425,3 +663,29 @@ int classic_path_resolve_criteria(preludedb_sql_t *sql,
         return 0;
 
 }
+
+
+
+/*
+ * Resolve @criteria into a WHERE clause, recording its shape for the
+ * index advisor.
+ */
+int classic_path_resolve_criteria(preludedb_sql_t *sql,
+                                  idmef_criteria_t *criteria,
+                                  classic_sql_join_t *join, prelude_string_t *output)
+{
+        int ret;
+        classic_advisor_shape_t *shape;
+
+        ret = classic_advisor_shape_new(&shape);
+        if ( ret < 0 )
+                return ret;
+
+        ret = resolve_criteria(sql, criteria, join, shape, output);
+        if ( ret == 0 )
+                classic_advisor_shape_commit(shape);
+
+        classic_advisor_shape_destroy(shape);
+
+        return ret;
+}
@@ -0,0 +1,251 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb-error.h"
+
+#include "classic-sketch.h"
+
+
+/*
+ * Estimators computing aggregates in a single pass and in bounded memory:
+ * a HyperLogLog sketch for the number of distinct values, and the
+ * P-square estimator of Jain and Chlamtac for a quantile.
+ */
+#define HLL_PRECISION 12
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+
+
+uint64_t classic_sketch_hash(const void *buf, size_t len)
+{
+        size_t i;
+        const unsigned char *ptr = buf;
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for ( i = 0; i < len; i++ ) {
+                hash ^= ptr[i];
+                hash *= 0x100000001b3ULL;
+        }
+
+        /*
+         * FNV-1a has poor avalanche on its high bits, which HyperLogLog
+         * relies on: mix it with the MurmurHash3 finalizer.
+         */
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+
+        return hash;
+}
+
+
+
+/*
+ * Adds @value to the HyperLogLog registers pointed to by @registers,
+ * which are allocated on first use.
+ */
+int classic_hll_add(uint8_t **registers, const void *value, size_t len)
+{
+        uint8_t rank = 1;
+        uint64_t hash, rest;
+
+        if ( ! *registers ) {
+                *registers = calloc(HLL_REGISTERS, sizeof(**registers));
+                if ( ! *registers )
+                        return preludedb_error_from_errno(errno);
+        }
+
+        hash = classic_sketch_hash(value, len);
+        rest = hash >> HLL_PRECISION;
+
+        while ( ! (rest & 1) && rank <= 64 - HLL_PRECISION ) {
+                rank++;
+                rest >>= 1;
+        }
+
+        hash &= HLL_REGISTERS - 1;
+        if ( rank > (*registers)[hash] )
+                (*registers)[hash] = rank;
+
+        return 0;
+}
+
+
+
+/*
+ * Returns the number of distinct values added to @registers, which might
+ * be NULL if none were.
+ */
+double classic_hll_estimate(const uint8_t *registers)
+{
+        unsigned int i, zeros = 0;
+        double sum = 0, estimate, m = HLL_REGISTERS;
+
+        if ( ! registers )
+                return 0;
+
+        for ( i = 0; i < HLL_REGISTERS; i++ ) {
+                sum += ldexp(1.0, - registers[i]);
+                if ( registers[i] == 0 )
+                        zeros++;
+        }
+
+        estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+        /*
+         * Small range correction: linear counting is more accurate while
+         * some registers are still unset.
+         */
+        if ( estimate <= 2.5 * m && zeros )
+                estimate = m * log(m / zeros);
+
+        return estimate;
+}
+
+
+
+static double p2_parabolic(const classic_p2_t *p2, int i, double d)
+{
+        const double *q = p2->height, *n = p2->pos;
+
+        return q[i] + d / (n[i + 1] - n[i - 1]) * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                                                   (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+
+
+static double p2_linear(const classic_p2_t *p2, int i, int d)
+{
+        return p2->height[i] + d * (p2->height[i + d] - p2->height[i]) / (p2->pos[i + d] - p2->pos[i]);
+}
+
+
+
+/*
+ * Adds @value to @p2, which estimates the @quantile of the values added
+ * to it. @p2 must be zeroed before the first value is added.
+ */
+void classic_p2_add(classic_p2_t *p2, double quantile, double value)
+{
+        int i, k, d;
+        double h, delta;
+        const double increment[5] = { 0, quantile / 2, quantile, (1 + quantile) / 2, 1 };
+
+        if ( p2->count < 5 ) {
+                for ( i = p2->count; i > 0 && p2->height[i - 1] > value; i-- )
+                        p2->height[i] = p2->height[i - 1];
+
+                p2->height[i] = value;
+
+                if ( ++p2->count == 5 ) {
+                        for ( i = 0; i < 5; i++ )
+                                p2->pos[i] = i + 1;
+
+                        p2->desired[0] = 1;
+                        p2->desired[1] = 1 + 2 * quantile;
+                        p2->desired[2] = 1 + 4 * quantile;
+                        p2->desired[3] = 3 + 2 * quantile;
+                        p2->desired[4] = 5;
+                }
+
+                return;
+        }
+
+        if ( value < p2->height[0] ) {
+                p2->height[0] = value;
+                k = 0;
+        }
+
+        else if ( value >= p2->height[4] ) {
+                p2->height[4] = value;
+                k = 3;
+        }
+
+        else for ( k = 0; value >= p2->height[k + 1]; k++ );
+
+        p2->count++;
+
+        for ( i = k + 1; i < 5; i++ )
+                p2->pos[i]++;
+
+        for ( i = 0; i < 5; i++ )
+                p2->desired[i] += increment[i];
+
+        for ( i = 1; i < 4; i++ ) {
+                delta = p2->desired[i] - p2->pos[i];
+
+                if ( (delta >= 1 && p2->pos[i + 1] - p2->pos[i] > 1) ||
+                     (delta <= -1 && p2->pos[i - 1] - p2->pos[i] < -1) ) {
+                        d = (delta > 0) ? 1 : -1;
+
+                        h = p2_parabolic(p2, i, d);
+                        if ( ! (p2->height[i - 1] < h && h < p2->height[i + 1]) )
+                                h = p2_linear(p2, i, d);
+
+                        p2->height[i] = h;
+                        p2->pos[i] += d;
+                }
+        }
+}
+
+
+
+/*
+ * Returns the @quantile estimated by @p2, exact while less than 5 values
+ * were added.
+ */
+double classic_p2_get(const classic_p2_t *p2, double quantile)
+{
+        double rank;
+        unsigned int i;
+
+        if ( p2->count >= 5 ) {
+                if ( quantile == 0 )
+                        return p2->height[0];
+
+                if ( quantile == 1 )
+                        return p2->height[4];
+
+                return p2->height[2];
+        }
+
+        /*
+         * Few values: the exact result, interpolated as percentile_cont() does.
+         */
+        rank = quantile * (p2->count - 1);
+        i = (unsigned int) rank;
+
+        if ( i + 1 >= p2->count )
+                return p2->height[p2->count - 1];
+
+        return p2->height[i] + (rank - i) * (p2->height[i + 1] - p2->height[i]);
+}
@@ -43,8 +43,11 @@ struct classic_sql_joined_table {
         const idmef_path_t *path;
         char *table_name;
         char aliased_table_name[16];
+        char aliased_dict_name[17];
+        const char *dict_table_name;
         char parent_type;
         prelude_string_t *index_constraints;
+        prelude_string_t *unqualified_index_constraints;
 };
 
 
@@ -78,6 +81,7 @@ void classic_sql_join_destroy(classic_sql_join_t *join)
                 table = prelude_list_entry(tmp, classic_sql_joined_table_t, list);
                 free(table->table_name);
                 prelude_string_destroy(table->index_constraints);
+                prelude_string_destroy(table->unqualified_index_constraints);
                 prelude_list_del(&table->list);
                 free(table);
         }
@@ -217,17 +221,32 @@ static char resolve_parent_type(const idmef_path_t *path)
 
 
 
-static int add_index_constraint(classic_sql_joined_table_t *table, int parent_level, int index)
+static int _add_index_constraint(prelude_string_t *output, const char *prefix, int parent_level, const char *operator, int index)
 {
         int ret;
-        const char *operator;
 
-        if ( ! prelude_string_is_empty(table->index_constraints) ) {
-                ret = prelude_string_cat(table->index_constraints, " AND ");
+        if ( ! prelude_string_is_empty(output) ) {
+                ret = prelude_string_cat(output, " AND ");
                 if ( ret < 0 )
                         return ret;
         }
 
+        if ( parent_level == -1 )
+                ret = prelude_string_sprintf(output, "%s_index %s %d", prefix, operator, index);
+        else
+                ret = prelude_string_sprintf(output, "%s_parent%d_index %s %d", prefix, parent_level, operator, index);
+
+        return ret;
+}
+
+
+
+static int add_index_constraint(classic_sql_joined_table_t *table, int parent_level, int index)
+{
+        int ret;
+        const char *operator;
+        char prefix[sizeof(table->aliased_table_name) + 1];
+
         if ( index >= -1 )
                 operator = "=";
         else {
@@ -236,14 +255,13 @@ static int add_index_constraint(classic_sql_joined_table_t *table, int parent_le
                 operator = "!=";
         }
 
-        if ( parent_level == -1 )
-                ret = prelude_string_sprintf(table->index_constraints, "%s._index %s %d",
-                                             table->aliased_table_name, operator, index);
-        else
-                ret = prelude_string_sprintf(table->index_constraints, "%s._parent%d_index %s %d",
-                                             table->aliased_table_name, parent_level, operator, index);
+        snprintf(prefix, sizeof(prefix), "%s.", table->aliased_table_name);
 
-        return ret;
+        ret = _add_index_constraint(table->index_constraints, prefix, parent_level, operator, index);
+        if ( ret < 0 )
+                return ret;
+
+        return _add_index_constraint(table->unqualified_index_constraints, "", parent_level, operator, index);
 }
 
 
@@ -312,6 +330,13 @@ int classic_sql_join_new_table(classic_sql_join_t *join, classic_sql_joined_tabl
                 return ret;
         }
 
+        ret = prelude_string_new(&(*table)->unqualified_index_constraints);
+        if ( ret < 0 ) {
+                prelude_string_destroy((*table)->index_constraints);
+                free(*table);
+                return ret;
+        }
+
         (*table)->path = path;
         (*table)->table_name = table_name;
         sprintf((*table)->aliased_table_name, "t%d", join->next_id++);
@@ -321,6 +346,7 @@ int classic_sql_join_new_table(classic_sql_join_t *join, classic_sql_joined_tabl
         ret = resolve_indexes(*table);
         if ( ret < 0 ) {
                 prelude_string_destroy((*table)->index_constraints);
+                prelude_string_destroy((*table)->unqualified_index_constraints);
                 free((*table)->table_name);
                 free(*table);
                 return ret;
@@ -340,6 +366,57 @@ const char *classic_sql_joined_table_get_name(classic_sql_joined_table_t *table)
 
 
 
+const char *classic_sql_joined_table_get_table_name(classic_sql_joined_table_t *table)
+{
+        return table->table_name;
+}
+
+
+
+char classic_sql_joined_table_get_parent_type(classic_sql_joined_table_t *table)
+{
+        return table->parent_type;
+}
+
+
+
+/*
+ * Join the dictionary table @dict_table_name holding the values referenced
+ * by the rows of @table, and return its alias.
+ */
+const char *classic_sql_joined_table_get_dict_name(classic_sql_joined_table_t *table, const char *dict_table_name)
+{
+        table->dict_table_name = dict_table_name;
+        snprintf(table->aliased_dict_name, sizeof(table->aliased_dict_name), "%sd", table->aliased_table_name);
+
+        return table->aliased_dict_name;
+}
+
+
+
+/*
+ * Constraints identifying the rows of @table belonging to the joined
+ * object, with columns not qualified by the table alias, for use in
+ * statements that do not join, such as UPDATE.
+ */
+int classic_sql_joined_table_constraints_to_string(classic_sql_joined_table_t *table, prelude_string_t *output)
+{
+        int ret;
+
+        if ( table->parent_type ) {
+                ret = prelude_string_sprintf(output, " AND _parent_type='%c'", table->parent_type);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        if ( prelude_string_is_empty(table->unqualified_index_constraints) )
+                return 0;
+
+        return prelude_string_sprintf(output, " AND %s", prelude_string_get_string(table->unqualified_index_constraints));
+}
+
+
+
 static int classic_joined_table_to_string(classic_sql_joined_table_t *table, prelude_string_t *output)
 {
         int ret;
@@ -365,7 +442,20 @@ static int classic_joined_table_to_string(classic_sql_joined_table_t *table, pre
                         return ret;
         }
 
-        return prelude_string_cat(output, ")");
+        ret = prelude_string_cat(output, ")");
+        if ( ret < 0 || ! table->dict_table_name )
+                return ret;
+
+        return prelude_string_sprintf(output, " LEFT JOIN %s AS %s ON (%s._ident=%s._dict_ident)",
+                                      table->dict_table_name, table->aliased_dict_name,
+                                      table->aliased_dict_name, table->aliased_table_name);
+}
+
+
+
+const char *classic_sql_join_get_top_table_name(const classic_sql_join_t *join)
+{
+        return (join->top_class == IDMEF_CLASS_ID_ALERT) ? "Prelude_Alert" : "Prelude_Heartbeat";
 }
 
 
@@ -376,8 +466,7 @@ int classic_sql_join_to_string(classic_sql_join_t *join, prelude_string_t *outpu
         classic_sql_joined_table_t *table;
         int ret;
 
-        ret = prelude_string_sprintf(output, "%s AS top_table",
-                                     (join->top_class == IDMEF_CLASS_ID_ALERT) ? "Prelude_Alert" : "Prelude_Heartbeat");
+        ret = prelude_string_sprintf(output, "%s AS top_table", classic_sql_join_get_top_table_name(join));
         if ( ret < 0 )
                 return ret;
 
@@ -0,0 +1,537 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <libprelude/prelude-log.h>
+#include <libprelude/idmef.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+#include "preludedb-path-selection.h"
+#include "preludedb.h"
+
+#include "classic-sql-join.h"
+#include "classic-path-resolve.h"
+#include "classic-delete.h"
+#include "classic-update.h"
+#include "classic-address.h"
+
+
+/*
+ * When an update touches several tables and selects messages through
+ * criteria, the matching idents are stored server side first, so that
+ * every statement applies to the same set of messages even if one of
+ * them modifies a column the criteria depend on.
+ */
+#define UPDATE_IDENTS_TABLE "_preludedb_update_idents"
+
+
+typedef struct {
+        classic_sql_joined_table_t *table;
+        prelude_string_t *set;
+} update_table_t;
+
+
+
+static int value_to_sql(preludedb_sql_t *sql, const idmef_value_t *value, char **out)
+{
+        int ret;
+        prelude_string_t *str;
+
+        if ( ! value ) {
+                *out = strdup("NULL");
+                return *out ? 0 : preludedb_error_from_errno(errno);
+        }
+
+        ret = prelude_string_new(&str);
+        if ( ret < 0 )
+                return ret;
+
+        ret = idmef_value_to_string(value, str);
+        if ( ret >= 0 )
+                ret = preludedb_sql_escape(sql, prelude_string_get_string(str), out);
+
+        prelude_string_destroy(str);
+
+        return ret;
+}
+
+
+
+/*
+ * Append "column = value" assignments for each of the comma separated
+ * @columns: time values span the time, gmtoff and usec columns, in that
+ * order, anything else a single column.
+ */
+static int add_assignment(preludedb_sql_t *sql, const idmef_path_t *path, const idmef_value_t *value,
+                          const char *columns, prelude_string_t *set)
+{
+        int ret;
+        size_t len;
+        unsigned int i;
+        char *escaped = NULL;
+        const char *vals[3], *end;
+        char time_buf[PRELUDEDB_SQL_TIMESTAMP_STRING_SIZE], gmtoff_buf[16], usec_buf[16];
+
+        switch ( idmef_path_get_value_type(path, -1) ) {
+        case IDMEF_VALUE_TYPE_TIME:
+                if ( value && idmef_value_get_type(value) != IDMEF_VALUE_TYPE_TIME )
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_VALUE_TYPE,
+                                                       "'%s' expect a time value", idmef_path_get_name(path, -1));
+
+                ret = preludedb_sql_time_to_timestamp(sql, value ? idmef_value_get_time(value) : NULL,
+                                                      time_buf, sizeof(time_buf), gmtoff_buf, sizeof(gmtoff_buf),
+                                                      usec_buf, sizeof(usec_buf));
+                if ( ret < 0 )
+                        return ret;
+
+                vals[0] = time_buf;
+                vals[1] = gmtoff_buf;
+                vals[2] = usec_buf;
+                break;
+
+        case IDMEF_VALUE_TYPE_DATA:
+        case IDMEF_VALUE_TYPE_CLASS:
+        case IDMEF_VALUE_TYPE_LIST:
+                return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "updating '%s' is not supported",
+                                               idmef_path_get_name(path, -1));
+
+        default:
+                ret = value_to_sql(sql, value, &escaped);
+                if ( ret < 0 )
+                        return ret;
+
+                vals[0] = escaped;
+                break;
+        }
+
+        for ( i = 0; *columns; i++ ) {
+                if ( i == sizeof(vals) / sizeof(*vals) || (i > 0 && escaped) ) {
+                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "unexpected columns for '%s'",
+                                                      idmef_path_get_name(path, -1));
+                        goto out;
+                }
+
+                end = strchr(columns, ',');
+                len = (end) ? (size_t) (end - columns) : strlen(columns);
+
+                ret = prelude_string_sprintf(set, "%s%.*s = %s", prelude_string_is_empty(set) ? "" : ", ",
+                                             (int) len, columns, vals[i]);
+                if ( ret < 0 )
+                        goto out;
+
+                columns += len;
+                while ( *columns == ',' || *columns == ' ' )
+                        columns++;
+        }
+
+        /*
+         * Keep the packed form of an address in sync with its text.
+         */
+        if ( classic_address_is_address_path(path) ) {
+                free(escaped);
+
+                ret = classic_address_escape(sql, (value && idmef_value_get_type(value) == IDMEF_VALUE_TYPE_STRING) ?
+                                             prelude_string_get_string(idmef_value_get_string(value)) : NULL, &escaped);
+                if ( ret < 0 ) {
+                        escaped = NULL;
+                        goto out;
+                }
+
+                ret = prelude_string_sprintf(set, ", _address_bin = %s", escaped);
+                if ( ret < 0 )
+                        goto out;
+        }
+
+        ret = 0;
+
+ out:
+        free(escaped);
+        return ret;
+}
+
+
+
+static int build_assignments(preludedb_sql_t *sql, classic_sql_join_t *join,
+                             const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                             update_table_t *tables, size_t *tcount)
+{
+        int ret;
+        size_t i, j;
+        prelude_string_t *columns;
+        classic_sql_joined_table_t *table;
+
+        ret = prelude_string_new(&columns);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < pvsize; i++ ) {
+                if ( idmef_path_get_class(paths[i], 0) != idmef_path_get_class(paths[0], 0) ) {
+                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "'%s' and '%s' do not refer to the same message type",
+                                                      idmef_path_get_name(paths[0], -1), idmef_path_get_name(paths[i], -1));
+                        break;
+                }
+
+                prelude_string_clear(columns);
+
+                ret = classic_path_resolve_update(paths[i], join, &table, columns);
+                if ( ret < 0 )
+                        break;
+
+                for ( j = 0; j < *tcount; j++ ) {
+                        if ( tables[j].table == table )
+                                break;
+                }
+
+                if ( j == *tcount ) {
+                        ret = prelude_string_new(&tables[j].set);
+                        if ( ret < 0 )
+                                break;
+
+                        tables[j].table = table;
+                        (*tcount)++;
+                }
+
+                ret = add_assignment(sql, paths[i], values[i], prelude_string_get_string(columns), tables[j].set);
+                if ( ret < 0 )
+                        break;
+        }
+
+        prelude_string_destroy(columns);
+
+        return ret;
+}
+
+
+
+static int run_updates(preludedb_sql_t *sql, idmef_class_id_t top_class, update_table_t *tables, size_t tcount, const char *idents)
+{
+        int ret;
+        size_t i;
+        prelude_string_t *constraints;
+
+        ret = prelude_string_new(&constraints);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < tcount; i++ ) {
+                if ( ! tables[i].table ) {
+                        ret = preludedb_sql_query_sprintf(sql, NULL, "UPDATE %s SET %s WHERE _ident %s",
+                                                          (top_class == IDMEF_CLASS_ID_ALERT) ? "Prelude_Alert" : "Prelude_Heartbeat",
+                                                          prelude_string_get_string(tables[i].set), idents);
+                        if ( ret < 0 )
+                                break;
+
+                        continue;
+                }
+
+                prelude_string_clear(constraints);
+
+                ret = classic_sql_joined_table_constraints_to_string(tables[i].table, constraints);
+                if ( ret < 0 )
+                        break;
+
+                ret = preludedb_sql_query_sprintf(sql, NULL, "UPDATE %s SET %s WHERE _message_ident %s%s",
+                                                  classic_sql_joined_table_get_table_name(tables[i].table),
+                                                  prelude_string_get_string(tables[i].set), idents,
+                                                  prelude_string_get_string_or_default(constraints, ""));
+                if ( ret < 0 )
+                        break;
+        }
+
+        prelude_string_destroy(constraints);
+
+        return ret;
+}
+
+
+
+/*
+ * Update the objects designated by @paths within the messages matching
+ * @idents, an SQL "IN" or "=" expression, or @subquery, a query returning
+ * the matching idents in an "_ident" column. Only existing objects are
+ * updated: this never creates new rows.
+ */
+static int do_update(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values,
+                     size_t pvsize, const char *idents, const char *subquery)
+{
+        int ret, tmp;
+        size_t i, tcount = 0;
+        prelude_string_t *buf = NULL;
+        update_table_t *tables;
+        classic_sql_join_t *join;
+        prelude_bool_t have_idents_table = FALSE;
+        preludedb_sql_t *sql = preludedb_get_sql(db);
+
+        if ( pvsize == 0 )
+                return 0;
+
+        tables = calloc(pvsize, sizeof(*tables));
+        if ( ! tables )
+                return preludedb_error_from_errno(errno);
+
+        ret = classic_sql_join_new(&join);
+        if ( ret < 0 ) {
+                free(tables);
+                return ret;
+        }
+
+        classic_sql_join_set_top_class(join, idmef_path_get_class(paths[0], 0));
+
+        ret = build_assignments(sql, join, paths, values, pvsize, tables, &tcount);
+        if ( ret < 0 )
+                goto out;
+
+        ret = preludedb_sql_transaction_start(sql);
+        if ( ret < 0 )
+                goto out;
+
+        if ( subquery ) {
+                ret = prelude_string_new(&buf);
+                if ( ret < 0 )
+                        goto error;
+
+                if ( tcount > 1 ) {
+                        ret = preludedb_sql_query_sprintf(sql, NULL, "CREATE TEMPORARY TABLE " UPDATE_IDENTS_TABLE " AS %s", subquery);
+                        if ( ret < 0 )
+                                goto error;
+
+                        have_idents_table = TRUE;
+                        ret = prelude_string_cat(buf, "IN (SELECT _ident FROM " UPDATE_IDENTS_TABLE ")");
+                } else
+                        ret = prelude_string_sprintf(buf, "IN (%s)", subquery);
+
+                if ( ret < 0 )
+                        goto error;
+
+                idents = prelude_string_get_string(buf);
+        }
+
+        /*
+         * Stored blobs would no longer match the updated alerts. They are
+         * dropped before the update, while @idents still designates them.
+         */
+        if ( idmef_path_get_class(paths[0], 0) == IDMEF_CLASS_ID_ALERT ) {
+                ret = preludedb_sql_query_sprintf(sql, NULL, "DELETE FROM Prelude_MessageBlob WHERE _message_ident %s", idents);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = run_updates(sql, idmef_path_get_class(paths[0], 0), tables, tcount, idents);
+        if ( ret < 0 )
+                goto error;
+
+        if ( have_idents_table ) {
+                ret = preludedb_sql_query(sql, "DROP TABLE " UPDATE_IDENTS_TABLE, NULL);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = preludedb_sql_transaction_end(sql);
+        goto out;
+
+ error:
+        tmp = preludedb_sql_transaction_abort(sql);
+        if ( tmp < 0 )
+                ret = tmp;
+
+        if ( have_idents_table )
+                preludedb_sql_query(sql, "DROP TABLE " UPDATE_IDENTS_TABLE, NULL);
+
+ out:
+        for ( i = 0; i < tcount; i++ )
+                prelude_string_destroy(tables[i].set);
+
+        if ( buf )
+                prelude_string_destroy(buf);
+
+        classic_sql_join_destroy(join);
+        free(tables);
+
+        return ret;
+}
+
+
+
+/*
+ * Build the query selecting the idents of the messages to update. It is
+ * wrapped in a derived table so that it can be used within an UPDATE of
+ * one of the tables it reads from, and with LIMIT, on every backend.
+ */
+static int get_idents_subquery(preludedb_t *db, idmef_class_id_t top_class, idmef_criteria_t *criteria,
+                               preludedb_path_selection_t *order, int limit, int offset, prelude_string_t *output)
+{
+        int ret;
+        classic_sql_join_t *join;
+        preludedb_sql_select_t *select;
+        prelude_string_t *where = NULL;
+        preludedb_sql_t *sql = preludedb_get_sql(db);
+
+        ret = classic_sql_join_new(&join);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_sql_select_new(db, &select);
+        if ( ret < 0 ) {
+                classic_sql_join_destroy(join);
+                return ret;
+        }
+
+        classic_sql_join_set_top_class(join, top_class);
+
+        ret = preludedb_sql_select_add_field(select, "DISTINCT(top_table._ident) AS _ident");
+        if ( ret < 0 )
+                goto error;
+
+        if ( order ) {
+                ret = preludedb_sql_select_add_selection(select, order, join);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        if ( criteria ) {
+                ret = prelude_string_new(&where);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = classic_path_resolve_criteria(sql, criteria, join, where);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = prelude_string_cat(output, "SELECT _ident FROM (SELECT ");
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_select_fields_to_string(select, output);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(output, " FROM ");
+        if ( ret < 0 )
+                goto error;
+
+        ret = classic_sql_join_to_string(join, output);
+        if ( ret < 0 )
+                goto error;
+
+        if ( where ) {
+                ret = prelude_string_sprintf(output, " WHERE %s", prelude_string_get_string(where));
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = preludedb_sql_select_modifiers_to_string(select, output);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_build_limit_offset_string(sql, limit, offset, output);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(output, ") AS idents");
+
+ error:
+        if ( where )
+                prelude_string_destroy(where);
+
+        classic_sql_join_destroy(join);
+        preludedb_sql_select_destroy(select);
+
+        return ret;
+}
+
+
+
+int classic_update(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                   idmef_criteria_t *criteria, preludedb_path_selection_t *order, int limit, int offset)
+{
+        int ret;
+        prelude_string_t *subquery;
+
+        if ( pvsize == 0 )
+                return 0;
+
+        ret = prelude_string_new(&subquery);
+        if ( ret < 0 )
+                return ret;
+
+        ret = get_idents_subquery(db, idmef_path_get_class(paths[0], 0), criteria, order, limit, offset, subquery);
+        if ( ret < 0 )
+                goto error;
+
+        ret = do_update(db, paths, values, pvsize, NULL, prelude_string_get_string(subquery));
+
+ error:
+        prelude_string_destroy(subquery);
+
+        return ret;
+}
+
+
+
+int classic_update_from_list(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                             uint64_t *idents, size_t isize)
+{
+        int ret;
+        ssize_t count;
+        prelude_string_t *buf;
+
+        if ( isize == 0 )
+                return 0;
+
+        count = classic_ident_list_to_string(&buf, idents, isize);
+        if ( count < 0 )
+                return count;
+
+        ret = do_update(db, paths, values, pvsize, prelude_string_get_string(buf), NULL);
+        prelude_string_destroy(buf);
+
+        return (ret < 0) ? ret : count;
+}
+
+
+
+int classic_update_from_result_idents(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                                      preludedb_result_idents_t *results)
+{
+        int ret;
+        ssize_t count;
+        prelude_string_t *buf;
+
+        count = classic_result_idents_to_string(&buf, results);
+        if ( count <= 0 )
+                return count;
+
+        ret = do_update(db, paths, values, pvsize, prelude_string_get_string(buf), NULL);
+        prelude_string_destroy(buf);
+
+        return (ret < 0) ? ret : count;
+}
@@ -28,6 +28,7 @@
 #include <sys/types.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
 
 #include <libprelude/idmef.h>
 
@@ -41,17 +42,24 @@
 #include "classic-insert.h"
 #include "classic-get.h"
 #include "classic-delete.h"
+#include "classic-update.h"
+#include "classic-optimize.h"
 #include "classic-sql-join.h"
 #include "classic-path-resolve.h"
+#include "classic-advisor.h"
+#include "classic-approx.h"
+#include "classic-compress.h"
 
 
-#define CLASSIC_SCHEMA_VERSION "14.7"
+#define CLASSIC_SCHEMA_VERSION "14.11"
 
 
 int classic_LTX_prelude_plugin_version(void);
 int classic_get_path_column_count(preludedb_selected_path_t *selected);
 int classic_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data);
 int classic_get_path_column_count(preludedb_selected_path_t *selected);
+int classic_get_value(preludedb_sql_t *sql, preludedb_sql_row_t *row, int cnt, preludedb_selected_path_t *selected,
+                      preludedb_result_values_get_field_cb_func_t cb, void **out);
 
 
 struct db_value_info {
@@ -65,6 +73,15 @@ struct db_result {
         unsigned int value_count;
 };
 
+/*
+ * Values are either the table returned by the database, or aggregates
+ * computed out of raw values or partial results by classic-approx.c.
+ */
+typedef struct {
+        preludedb_sql_table_t *table;
+        classic_approx_t *approx;
+} classic_values_t;
+
 int classic_unescape_binary_safe(preludedb_sql_t *sql, preludedb_sql_field_t *field,
                                  idmef_additional_data_type_t type, unsigned char **output, size_t *outsize);
 
@@ -75,10 +92,7 @@ int classic_unescape_binary_safe(preludedb_sql_t *sql, preludedb_sql_field_t *fi
         size_t size;
         unsigned char *value;
 
-        ret = preludedb_sql_unescape_binary(sql,
-                                            preludedb_sql_field_get_value(field),
-                                            preludedb_sql_field_get_len(field),
-                                            (unsigned char **) &value, &size);
+        ret = classic_compress_unescape_column(sql, field, &value, &size);
         if ( ret < 0 )
                 return ret;
 
@@ -94,15 +108,14 @@ int classic_unescape_binary_safe(preludedb_sql_t *sql, preludedb_sql_field_t *fi
                 if ( (size + 1) < size )
                         return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Value is too big");
 
-                *output = malloc(size + 1);
-                if ( ! *output )
+                *output = realloc(value, size + 1);
+                if ( ! *output ) {
+                        free(value);
                         return preludedb_error_from_errno(errno);
+                }
 
-                memcpy(*output, value, size);
                 (*output)[size] = 0;
                 *outsize = size;
-
-                free(value);
         }
 
         return 0;
@@ -297,11 +310,47 @@ static void classic_destroy_message_idents_resource(void *res)
 
 
 
-static int classic_get_values(preludedb_t *db, preludedb_path_selection_t *selection,
-                              idmef_criteria_t *criteria, int distinct, int limit, int offset, void **res)
+static int values_new(classic_values_t **values)
+{
+        *values = calloc(1, sizeof(**values));
+        if ( ! *values )
+                return preludedb_error_from_errno(errno);
+
+        return 0;
+}
+
+
+
+static void classic_destroy_values_resource(void *res)
+{
+        classic_values_t *values = res;
+
+        if ( values->approx )
+                classic_approx_destroy(values->approx);
+
+        if ( values->table )
+                preludedb_sql_table_destroy(values->table);
+
+        free(values);
+}
+
+
+
+/*
+ * Builds the query selecting the values of @selection. With the
+ * PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE flag, the raw values of the
+ * aggregates are selected instead, with no grouping nor limit, for them
+ * to be computed by classic_approx_new().
+ *
+ * If @range is given, the query only covers the messages whose ident is
+ * within it. The name of the table these messages are stored in is set
+ * in @top_table if not NULL.
+ */
+static int build_values_query(preludedb_t *db, preludedb_path_selection_t *selection, idmef_criteria_t *criteria,
+                              int distinct, int limit, int offset, preludedb_sql_select_flags_t flags,
+                              const uint64_t *range, const char **top_table, prelude_string_t *query)
 {
         prelude_string_t *where = NULL;
-        prelude_string_t *query;
         classic_sql_join_t *join;
         preludedb_sql_select_t *select;
         int ret;
@@ -316,12 +365,7 @@ static int classic_get_values(preludedb_t *db, preludedb_path_selection_t *selec
                 return ret;
         }
 
-        ret = prelude_string_new(&query);
-        if ( ret < 0 ) {
-                classic_sql_join_destroy(join);
-                preludedb_sql_select_destroy(select);
-                return ret;
-        }
+        preludedb_sql_select_set_flags(select, flags);
 
         ret = preludedb_sql_select_add_selection(select, selection, join);
         if ( ret < 0 )
@@ -359,24 +403,32 @@ static int classic_get_values(preludedb_t *db, preludedb_path_selection_t *selec
         if ( ret < 0 )
                 goto error;
 
+        if ( top_table )
+                *top_table = classic_sql_join_get_top_table_name(join);
+
         if ( where ) {
                 ret = prelude_string_sprintf(query, " WHERE %s", prelude_string_get_string(where));
                 if ( ret < 0 )
                         goto error;
         }
 
-        ret = preludedb_sql_select_modifiers_to_string(select, query);
-        if ( ret < 0 )
+        if ( range ) {
+                ret = prelude_string_sprintf(query, " %s top_table._ident BETWEEN %" PRELUDE_PRIu64 " AND %" PRELUDE_PRIu64,
+                                             (where) ? "AND" : "WHERE", range[0], range[1]);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        if ( flags & PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE )
                 goto error;
 
-        ret = preludedb_sql_build_limit_offset_string(preludedb_get_sql(db), limit, offset, query);
+        ret = preludedb_sql_select_modifiers_to_string(select, query);
         if ( ret < 0 )
                 goto error;
 
-        ret = preludedb_sql_query(preludedb_get_sql(db), prelude_string_get_string(query), (preludedb_sql_table_t **) res);
+        ret = preludedb_sql_build_limit_offset_string(preludedb_get_sql(db), limit, offset, query);
 
  error:
-        prelude_string_destroy(query);
         if ( where )
                 prelude_string_destroy(where);
         classic_sql_join_destroy(join);
@@ -386,6 +438,283 @@ static int classic_get_values(preludedb_t *db, preludedb_path_selection_t *selec
 }
 
 
+
+static int get_parallel_scan(preludedb_sql_t *sql, unsigned long *nranges)
+{
+        char *eptr;
+        const char *str;
+
+        *nranges = 0;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(sql), PRELUDEDB_SQL_SETTING_PARALLEL_SCAN);
+        if ( ! str )
+                return 0;
+
+        *nranges = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                               "invalid value '%s' for setting '%s'", str, PRELUDEDB_SQL_SETTING_PARALLEL_SCAN);
+
+        return 0;
+}
+
+
+
+static int get_ident_bounds(preludedb_sql_t *sql, const char *top_table, uint64_t *min, uint64_t *max)
+{
+        int ret;
+        preludedb_sql_row_t *row;
+        preludedb_sql_table_t *table;
+        preludedb_sql_field_t *field;
+
+        ret = preludedb_sql_query_sprintf(sql, &table, "SELECT MIN(_ident), MAX(_ident) FROM %s", top_table);
+        if ( ret <= 0 )
+                return ret;
+
+        ret = preludedb_sql_table_fetch_row(table, &row);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_row_get_field(row, 0, &field);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_field_to_uint64(field, min);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_row_get_field(row, 1, &field);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = preludedb_sql_field_to_uint64(field, max);
+        if ( ret < 0 )
+                goto error;
+
+        ret = 1;
+
+ error:
+        preludedb_sql_table_destroy(table);
+        return ret;
+}
+
+
+
+/*
+ * With the "parallel_scan" setting, a selection of count(), min() or
+ * max() aggregates is split into that many disjoint ranges of message
+ * idents, which are run concurrently on separate sessions, and the
+ * partial aggregates are merged by classic_approx_new_merged().
+ *
+ * Returns 0 if the selection was not run this way.
+ */
+static int parallel_get_values(preludedb_t *db, preludedb_path_selection_t *selection, idmef_criteria_t *criteria,
+                               int limit, int offset, classic_values_t **values)
+{
+        int ret;
+        unsigned long i, nranges;
+        uint64_t min, max, step, range[2];
+        const char *top_table;
+        char **queries = NULL;
+        prelude_string_t *query;
+        preludedb_sql_table_t **tables = NULL;
+        preludedb_sql_t *sql = preludedb_get_sql(db);
+
+        ret = get_parallel_scan(sql, &nranges);
+        if ( ret < 0 || nranges < 2 )
+                return ret;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        ret = build_values_query(db, selection, criteria, 0, -1, -1, 0, NULL, &top_table, query);
+        if ( ret < 0 )
+                goto error;
+
+        ret = get_ident_bounds(sql, top_table, &min, &max);
+        if ( ret <= 0 )
+                goto error;
+
+        step = (max - min) / nranges + 1;
+        nranges = (max - min) / step + 1;
+
+        queries = calloc(nranges, sizeof(*queries));
+        tables = calloc(nranges, sizeof(*tables));
+        if ( ! queries || ! tables ) {
+                ret = preludedb_error_from_errno(errno);
+                goto error;
+        }
+
+        for ( i = 0; i < nranges; i++ ) {
+                range[0] = min + i * step;
+                range[1] = (i + 1 == nranges) ? max : range[0] + step - 1;
+
+                prelude_string_clear(query);
+
+                ret = build_values_query(db, selection, criteria, 0, -1, -1, 0, range, NULL, query);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = prelude_string_get_string_released(query, &queries[i]);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        ret = preludedb_sql_query_parallel(sql, (const char * const *) queries, nranges, tables);
+        if ( ret < 0 )
+                goto error;
+
+        ret = values_new(values);
+        if ( ret < 0 ) {
+                for ( i = 0; i < nranges; i++ ) {
+                        if ( tables[i] )
+                                preludedb_sql_table_destroy(tables[i]);
+                }
+
+                goto error;
+        }
+
+        ret = classic_approx_new_merged(&(*values)->approx, selection, tables, nranges, limit, offset);
+        if ( ret < 0 ) {
+                free(*values);
+                goto error;
+        }
+
+        ret = 1;
+
+ error:
+        if ( queries ) {
+                for ( i = 0; i < nranges; i++ ) {
+                        if ( queries[i] )
+                                free(queries[i]);
+                }
+
+                free(queries);
+        }
+
+        if ( tables )
+                free(tables);
+
+        prelude_string_destroy(query);
+
+        return ret;
+}
+
+
+
+static int classic_get_values(preludedb_t *db, preludedb_path_selection_t *selection,
+                              idmef_criteria_t *criteria, int distinct, int limit, int offset, void **res)
+{
+        int ret, topk;
+        prelude_string_t *query;
+        classic_values_t *values;
+        preludedb_sql_table_t *table = NULL;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        /*
+         * topk() is computed by the database as a GROUP BY ordered on the
+         * number of rows, limited to the k first groups.
+         */
+        topk = classic_approx_get_topk(selection);
+        if ( topk > 0 ) {
+                if ( offset > 0 )
+                        topk = (offset < topk) ? topk - offset : 0;
+
+                if ( topk == 0 ) {
+                        prelude_string_destroy(query);
+                        return 0;
+                }
+
+                if ( limit < 0 || limit > topk )
+                        limit = topk;
+        }
+
+        if ( ! distinct && classic_approx_can_merge(selection) ) {
+                ret = parallel_get_values(db, selection, criteria, limit, offset, &values);
+                if ( ret < 0 )
+                        goto error;
+
+                if ( ret > 0 ) {
+                        if ( classic_approx_get_row_count(values->approx) == 0 ) {
+                                classic_destroy_values_resource(values);
+                                ret = 0;
+                        }
+
+                        else *res = values;
+
+                        goto error;
+                }
+        }
+
+        ret = build_values_query(db, selection, criteria, distinct, limit, offset, 0, NULL, NULL, query);
+        if ( ret < 0 && prelude_error_get_code(ret) == prelude_error_code_from_errno(ENOSYS) ) {
+                /*
+                 * The backend cannot compute an approximate aggregate:
+                 * select the raw values and compute it here.
+                 */
+                prelude_string_clear(query);
+
+                ret = build_values_query(db, selection, criteria, 0, -1, -1, PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE, NULL, NULL, query);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = preludedb_sql_query(preludedb_get_sql(db), prelude_string_get_string(query), &table);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = values_new(&values);
+                if ( ret < 0 ) {
+                        if ( table )
+                                preludedb_sql_table_destroy(table);
+                        goto error;
+                }
+
+                ret = classic_approx_new(&values->approx, selection, table, limit, offset);
+                if ( ret < 0 ) {
+                        free(values);
+                        goto error;
+                }
+
+                if ( classic_approx_get_row_count(values->approx) == 0 ) {
+                        classic_destroy_values_resource(values);
+                        ret = 0;
+                        goto error;
+                }
+
+                *res = values;
+                ret = 1;
+                goto error;
+        }
+
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_query(preludedb_get_sql(db), prelude_string_get_string(query), &table);
+        if ( ret <= 0 )
+                goto error;
+
+        ret = values_new(&values);
+        if ( ret < 0 ) {
+                preludedb_sql_table_destroy(table);
+                goto error;
+        }
+
+        values->table = table;
+
+        *res = values;
+        ret = 1;
+
+ error:
+        prelude_string_destroy(query);
+
+        return ret;
+}
+
+
 static int get_value_time(preludedb_selected_path_t *selected,
                           preludedb_sql_row_t *row, preludedb_sql_field_t *field, int cnt, idmef_time_t **time)
 {
@@ -491,7 +820,7 @@ static int get_data(preludedb_sql_t *sql, preludedb_sql_row_t *row, preludedb_sq
 }
 
 
-static int get_value(preludedb_sql_t *sql, preludedb_sql_row_t *row, int cnt, preludedb_selected_path_t *selected, preludedb_result_values_get_field_cb_func_t cb, void **out)
+int classic_get_value(preludedb_sql_t *sql, preludedb_sql_row_t *row, int cnt, preludedb_selected_path_t *selected, preludedb_result_values_get_field_cb_func_t cb, void **out)
 {
         char *char_val;
         unsigned char *unescaped = NULL;
@@ -559,31 +888,40 @@ static int get_value(preludedb_sql_t *sql, preludedb_sql_row_t *row, int cnt, pr
 
 static int classic_get_result_values_field(preludedb_result_values_t *results, void *row, preludedb_selected_path_t *selected, preludedb_result_values_get_field_cb_func_t cb, void **out)
 {
-        unsigned int cnum;
+        int cnum;
+        classic_values_t *values = preludedb_result_values_get_data(results);
+        preludedb_sql_t *sql = preludedb_get_sql(preludedb_result_values_get_db(results));
+
+        if ( values->approx )
+                return classic_approx_get_field(values->approx, sql, row, selected, cb, out);
 
         cnum = preludedb_selected_path_get_column_index(selected);
         if ( cnum < 0 )
                 return cnum;
 
-        return get_value(preludedb_get_sql(preludedb_result_values_get_db(results)), row, cnum, selected, cb, out);
+        return classic_get_value(sql, row, cnum, selected, cb, out);
 }
 
 
 static int classic_get_result_values_row(preludedb_result_values_t *results, unsigned int rnum, void **row)
 {
-        return preludedb_sql_table_get_row(preludedb_result_values_get_data(results), rnum, (preludedb_sql_row_t **) row);
+        classic_values_t *values = preludedb_result_values_get_data(results);
+
+        if ( values->approx )
+                return classic_approx_get_row(values->approx, rnum, row);
+
+        return preludedb_sql_table_get_row(values->table, rnum, (preludedb_sql_row_t **) row);
 }
 
 
 static int classic_get_result_values_count(preludedb_result_values_t *results)
 {
-        return preludedb_sql_table_get_row_count(preludedb_result_values_get_data(results));
-}
+        classic_values_t *values = preludedb_result_values_get_data(results);
 
+        if ( values->approx )
+                return classic_approx_get_row_count(values->approx);
 
-static void classic_destroy_values_resource(void *res)
-{
-        preludedb_sql_table_destroy(res);
+        return preludedb_sql_table_get_row_count(values->table);
 }
 
 
@@ -667,6 +1005,8 @@ int classic_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_format_set_destroy_message_idents_resource_func(plugin,
                                                                          classic_destroy_message_idents_resource);
         preludedb_plugin_format_set_get_alert_func(plugin, classic_get_alert);
+        preludedb_plugin_format_set_get_alert_paths_func(plugin, classic_get_alert_paths);
+        preludedb_plugin_format_set_get_alerts_func(plugin, classic_get_alerts);
         preludedb_plugin_format_set_get_heartbeat_func(plugin, classic_get_heartbeat);
         preludedb_plugin_format_set_delete_alert_func(plugin, classic_delete_alert);
         preludedb_plugin_format_set_delete_alert_from_list_func(plugin, classic_delete_alert_from_list);
@@ -675,6 +1015,10 @@ int classic_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_format_set_delete_heartbeat_from_list_func(plugin, classic_delete_heartbeat_from_list);
         preludedb_plugin_format_set_delete_heartbeat_from_result_idents_func(plugin, classic_delete_heartbeat_from_result_idents);
 
+        preludedb_plugin_format_set_update_func(plugin, classic_update);
+        preludedb_plugin_format_set_update_from_list_func(plugin, classic_update_from_list);
+        preludedb_plugin_format_set_update_from_result_idents_func(plugin, classic_update_from_result_idents);
+
         preludedb_plugin_format_set_insert_message_func(plugin, classic_insert);
         preludedb_plugin_format_set_get_values_func(plugin, classic_get_values);
         preludedb_plugin_format_set_get_result_values_row_func(plugin, classic_get_result_values_row);
@@ -684,6 +1028,8 @@ int classic_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_format_set_destroy_values_resource_func(plugin, classic_destroy_values_resource);
         preludedb_plugin_format_set_get_path_column_count_func(plugin, classic_get_path_column_count);
         preludedb_plugin_format_set_path_resolve_func(plugin, classic_path_resolve);
+        preludedb_plugin_format_set_optimize_func(plugin, classic_optimize);
+        preludedb_plugin_format_set_get_index_advice_func(plugin, classic_advisor_get_index_advice);
 
         return 0;
 }
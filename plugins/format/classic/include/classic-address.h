@@ -0,0 +1,39 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_ADDRESS_H
+#define _LIBPRELUDEDB_CLASSIC_ADDRESS_H
+
+#define CLASSIC_ADDRESS_SIZE 16
+
+int classic_address_parse(const char *str, unsigned char *low, unsigned char *high);
+
+prelude_bool_t classic_address_is_address_path(const idmef_path_t *path);
+
+int classic_address_escape(preludedb_sql_t *sql, const char *str, char **output);
+
+int classic_address_build_criterion_string(preludedb_sql_t *sql, prelude_string_t *output, const char *field,
+                                           idmef_criterion_operator_t operator, idmef_criterion_value_t *value);
+
+int classic_address_backfill(preludedb_sql_t *sql, uint64_t *cursor, unsigned int count);
+
+#endif /* _LIBPRELUDEDB_CLASSIC_ADDRESS_H */
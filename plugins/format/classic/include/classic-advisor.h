@@ -0,0 +1,41 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_ADVISOR_H
+#define _LIBPRELUDEDB_CLASSIC_ADVISOR_H
+
+
+typedef struct classic_advisor_shape classic_advisor_shape_t;
+
+
+int classic_advisor_shape_new(classic_advisor_shape_t **shape);
+void classic_advisor_shape_destroy(classic_advisor_shape_t *shape);
+void classic_advisor_shape_set_disjunctive(classic_advisor_shape_t *shape);
+void classic_advisor_shape_add_criterion(classic_advisor_shape_t *shape, const idmef_path_t *path,
+                                         classic_sql_joined_table_t *table, const char *field,
+                                         idmef_criterion_operator_t operator, idmef_criterion_value_t *value);
+void classic_advisor_shape_commit(classic_advisor_shape_t *shape);
+
+int classic_advisor_get_index_advice(preludedb_t *db, unsigned int max, prelude_string_t *output);
+
+
+#endif /* _LIBPRELUDEDB_CLASSIC_ADVISOR_H */
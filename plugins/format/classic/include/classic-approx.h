@@ -0,0 +1,45 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_APPROX_H
+#define _LIBPRELUDEDB_CLASSIC_APPROX_H
+
+
+typedef struct classic_approx classic_approx_t;
+
+
+int classic_approx_get_topk(preludedb_path_selection_t *selection);
+prelude_bool_t classic_approx_can_merge(preludedb_path_selection_t *selection);
+
+int classic_approx_new(classic_approx_t **approx, preludedb_path_selection_t *selection,
+                       preludedb_sql_table_t *table, int limit, int offset);
+int classic_approx_new_merged(classic_approx_t **approx, preludedb_path_selection_t *selection,
+                              preludedb_sql_table_t **tables, unsigned int ntables, int limit, int offset);
+void classic_approx_destroy(classic_approx_t *approx);
+
+int classic_approx_get_row_count(classic_approx_t *approx);
+int classic_approx_get_row(classic_approx_t *approx, unsigned int rnum, void **row);
+int classic_approx_get_field(classic_approx_t *approx, preludedb_sql_t *sql, void *row, preludedb_selected_path_t *selected,
+                             preludedb_result_values_get_field_cb_func_t cb, void **out);
+
+
+#endif /* _LIBPRELUDEDB_CLASSIC_APPROX_H */
@@ -0,0 +1,89 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_ASSEMBLE_H
+#define _LIBPRELUDEDB_CLASSIC_ASSEMBLE_H
+
+
+typedef enum {
+        CLASSIC_ASSEMBLY_ALERT,
+        CLASSIC_ASSEMBLY_HEARTBEAT,
+        CLASSIC_ASSEMBLY_ANALYZER,
+        CLASSIC_ASSEMBLY_ANALYZER_TIME,
+        CLASSIC_ASSEMBLY_CREATE_TIME,
+        CLASSIC_ASSEMBLY_DETECT_TIME,
+        CLASSIC_ASSEMBLY_NODE,
+        CLASSIC_ASSEMBLY_ADDRESS,
+        CLASSIC_ASSEMBLY_USER,
+        CLASSIC_ASSEMBLY_USER_ID,
+        CLASSIC_ASSEMBLY_PROCESS,
+        CLASSIC_ASSEMBLY_PROCESS_ARG,
+        CLASSIC_ASSEMBLY_PROCESS_ENV,
+        CLASSIC_ASSEMBLY_SERVICE,
+        CLASSIC_ASSEMBLY_WEB_SERVICE,
+        CLASSIC_ASSEMBLY_WEB_SERVICE_ARG,
+        CLASSIC_ASSEMBLY_SNMP_SERVICE,
+        CLASSIC_ASSEMBLY_ASSESSMENT,
+        CLASSIC_ASSEMBLY_IMPACT,
+        CLASSIC_ASSEMBLY_CONFIDENCE,
+        CLASSIC_ASSEMBLY_ACTION,
+        CLASSIC_ASSEMBLY_SOURCE,
+        CLASSIC_ASSEMBLY_TARGET,
+        CLASSIC_ASSEMBLY_FILE,
+        CLASSIC_ASSEMBLY_FILE_ACCESS,
+        CLASSIC_ASSEMBLY_FILE_ACCESS_PERMISSION,
+        CLASSIC_ASSEMBLY_LINKAGE,
+        CLASSIC_ASSEMBLY_INODE,
+        CLASSIC_ASSEMBLY_CHECKSUM,
+        CLASSIC_ASSEMBLY_CLASSIFICATION,
+        CLASSIC_ASSEMBLY_REFERENCE,
+        CLASSIC_ASSEMBLY_ADDITIONAL_DATA,
+        CLASSIC_ASSEMBLY_TOOL_ALERT,
+        CLASSIC_ASSEMBLY_CORRELATION_ALERT,
+        CLASSIC_ASSEMBLY_ALERTIDENT,
+        CLASSIC_ASSEMBLY_OVERFLOW_ALERT,
+        CLASSIC_ASSEMBLY_TABLE_COUNT
+} classic_assembly_table_t;
+
+
+typedef struct classic_assembly classic_assembly_t;
+typedef struct classic_assembly_row classic_assembly_row_t;
+
+typedef struct {
+        const classic_assembly_row_t *next;
+        const classic_assembly_row_t *end;
+} classic_assembly_rows_t;
+
+
+int classic_assembly_new(classic_assembly_t **assembly, preludedb_sql_t *sql, const uint64_t *idents, size_t count);
+void classic_assembly_destroy(classic_assembly_t *assembly);
+
+preludedb_sql_t *classic_assembly_get_sql(classic_assembly_t *assembly);
+
+int classic_assembly_get_rows(classic_assembly_t *assembly, classic_assembly_table_t table,
+                              uint64_t message_ident, char parent_type,
+                              int parent0_index, int parent1_index, int parent2_index,
+                              classic_assembly_rows_t *rows);
+int classic_assembly_rows_next(classic_assembly_rows_t *rows, preludedb_sql_row_t **row);
+
+
+#endif /* _LIBPRELUDEDB_CLASSIC_ASSEMBLE_H */
@@ -0,0 +1,30 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_BLOB_H
+#define _LIBPRELUDEDB_CLASSIC_BLOB_H
+
+int classic_blob_insert(preludedb_sql_t *sql, uint64_t ident, idmef_message_t *message);
+
+int classic_blob_get_alerts(preludedb_sql_t *sql, const uint64_t *idents, size_t count, idmef_message_t **messages);
+
+#endif /* _LIBPRELUDEDB_CLASSIC_BLOB_H */
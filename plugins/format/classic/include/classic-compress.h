@@ -0,0 +1,57 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_COMPRESS_H
+#define _LIBPRELUDEDB_CLASSIC_COMPRESS_H
+
+
+typedef enum {
+        CLASSIC_COMPRESS_NONE      = 0,
+        CLASSIC_COMPRESS_LZ4       = 1,
+        CLASSIC_COMPRESS_ZSTD      = 2,
+        CLASSIC_COMPRESS_ZSTD_DICT = 3
+} classic_compress_algorithm_t;
+
+
+typedef enum {
+        CLASSIC_COMPRESS_COLUMN_ADDITIONAL_DATA = 0,
+        CLASSIC_COMPRESS_COLUMN_OVERFLOW_BUFFER = 1
+} classic_compress_column_t;
+
+
+typedef struct classic_compress_dict classic_compress_dict_t;
+
+
+int classic_compress_algorithm_from_string(const char *str, classic_compress_algorithm_t *algorithm);
+
+int classic_compress(classic_compress_algorithm_t algorithm, const classic_compress_dict_t *dict,
+                     const unsigned char *input, size_t size, unsigned char **output, size_t *outsize);
+int classic_decompress(const classic_compress_dict_t *dict, const unsigned char *input, size_t size,
+                       unsigned char **output, size_t *outsize);
+
+int classic_compress_escape_column(preludedb_sql_t *sql, classic_compress_column_t column,
+                                   const unsigned char *input, size_t size, char **output);
+int classic_compress_unescape_column(preludedb_sql_t *sql, preludedb_sql_field_t *field,
+                                     unsigned char **output, size_t *outsize);
+
+
+#endif /* _LIBPRELUDEDB_CLASSIC_COMPRESS_H */
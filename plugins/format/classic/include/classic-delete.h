@@ -24,6 +24,10 @@
 #ifndef _LIBPRELUDEDB_CLASSIC_DELETE_H
 #define _LIBPRELUDEDB_CLASSIC_DELETE_H
 
+ssize_t classic_ident_list_to_string(prelude_string_t **out, uint64_t *ident, size_t size);
+
+ssize_t classic_result_idents_to_string(prelude_string_t **out, preludedb_result_idents_t *res);
+
 int classic_delete_alert(preludedb_t *db, uint64_t ident);
 
 ssize_t classic_delete_alert_from_list(preludedb_t *db, uint64_t *ident, size_t size);
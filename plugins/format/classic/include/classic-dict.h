@@ -0,0 +1,39 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_DICT_H
+#define _LIBPRELUDEDB_CLASSIC_DICT_H
+
+typedef enum {
+        CLASSIC_DICT_ANALYZER       = 0,
+        CLASSIC_DICT_NODE           = 1,
+        CLASSIC_DICT_CLASSIFICATION = 2
+} classic_dict_type_t;
+
+
+int classic_dict_intern(preludedb_sql_t *sql, classic_dict_type_t type, const char * const *values, uint64_t *ident);
+
+const char *classic_dict_get_table(const char *table);
+
+prelude_bool_t classic_dict_has_column(const char *table, const char *column);
+
+#endif /* _LIBPRELUDEDB_CLASSIC_DICT_H */
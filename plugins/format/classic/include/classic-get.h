@@ -26,6 +26,11 @@
 
 int classic_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message);
 
+int classic_get_alert_paths(preludedb_t *db, uint64_t ident, const idmef_path_t * const *paths, size_t npaths,
+                            idmef_message_t **message, unsigned int *fetched);
+
+int classic_get_alerts(preludedb_t *db, const uint64_t *idents, size_t count, idmef_message_t **messages);
+
 int classic_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **message);
 
 #endif /* ! _LIBPRELUDEDB_CLASSIC_GET_H  */
@@ -27,6 +27,9 @@
 
 int classic_path_resolve(preludedb_selected_path_t *selpath, preludedb_selected_object_t *object, void *data, prelude_string_t *output);
 
+int classic_path_resolve_update(const idmef_path_t *path, classic_sql_join_t *join,
+                                classic_sql_joined_table_t **table, prelude_string_t *output);
+
 int classic_path_resolve_criteria(preludedb_sql_t *sql,
 				  idmef_criteria_t *criteria,
 				  classic_sql_join_t *join, prelude_string_t *output);
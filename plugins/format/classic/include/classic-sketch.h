@@ -0,0 +1,44 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_SKETCH_H
+#define _LIBPRELUDEDB_CLASSIC_SKETCH_H
+
+
+typedef struct {
+        uint64_t count;
+        double height[5];
+        double pos[5];
+        double desired[5];
+} classic_p2_t;
+
+
+uint64_t classic_sketch_hash(const void *buf, size_t len);
+
+int classic_hll_add(uint8_t **registers, const void *value, size_t len);
+double classic_hll_estimate(const uint8_t *registers);
+
+void classic_p2_add(classic_p2_t *p2, double quantile, double value);
+double classic_p2_get(const classic_p2_t *p2, double quantile);
+
+
+#endif /* _LIBPRELUDEDB_CLASSIC_SKETCH_H */
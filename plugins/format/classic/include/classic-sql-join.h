@@ -33,11 +33,16 @@ int classic_sql_join_new(classic_sql_join_t **join);
 void classic_sql_join_destroy(classic_sql_join_t *join);
 void classic_sql_join_set_top_class(classic_sql_join_t *join, idmef_class_id_t top_class);
 classic_sql_joined_table_t *classic_sql_join_lookup_table(const classic_sql_join_t *join, const idmef_path_t *path);
+const char *classic_sql_join_get_top_table_name(const classic_sql_join_t *join);
 int classic_sql_join_to_string(classic_sql_join_t *join, prelude_string_t *output);
 
 int classic_sql_join_new_table(classic_sql_join_t *join, classic_sql_joined_table_t **table,
 			       const idmef_path_t *path, char *table_name);
 const char *classic_sql_joined_table_get_name(classic_sql_joined_table_t *table);
+const char *classic_sql_joined_table_get_table_name(classic_sql_joined_table_t *table);
+char classic_sql_joined_table_get_parent_type(classic_sql_joined_table_t *table);
+const char *classic_sql_joined_table_get_dict_name(classic_sql_joined_table_t *table, const char *dict_table_name);
+int classic_sql_joined_table_constraints_to_string(classic_sql_joined_table_t *table, prelude_string_t *output);
 
 
 #endif /* _LIBPRELUDEDB_CLASSIC_SQL_JOIN_H */
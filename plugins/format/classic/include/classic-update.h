@@ -0,0 +1,35 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_CLASSIC_UPDATE_H
+#define _LIBPRELUDEDB_CLASSIC_UPDATE_H
+
+int classic_update(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                   idmef_criteria_t *criteria, preludedb_path_selection_t *order, int limit, int offset);
+
+int classic_update_from_list(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                             uint64_t *idents, size_t isize);
+
+int classic_update_from_result_idents(preludedb_t *db, const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
+                                      preludedb_result_idents_t *results);
+
+#endif /* _LIBPRELUDEDB_CLASSIC_UPDATE_H */
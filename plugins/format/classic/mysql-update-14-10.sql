@@ -0,0 +1,49 @@
+BEGIN;
+
+UPDATE _format SET version="14.10";
+ALTER TABLE Prelude_Analyzer ADD COLUMN _dict_ident BIGINT NULL;
+ALTER TABLE Prelude_Node ADD COLUMN _dict_ident BIGINT NULL;
+ALTER TABLE Prelude_Classification MODIFY text VARCHAR(255) NULL;
+ALTER TABLE Prelude_Classification ADD COLUMN _dict_ident BIGINT NULL;
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ name VARCHAR(255) NULL,
+ manufacturer VARCHAR(255) NULL,
+ model VARCHAR(255) NULL,
+ version VARCHAR(255) NULL,
+ class VARCHAR(255) NULL,
+ ostype VARCHAR(255) NULL,
+ osversion VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name(20));
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer(20));
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model(20));
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version(20));
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class(20));
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype(20));
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion(20));
+
+CREATE TABLE Prelude_NodeDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ category ENUM("unknown","ads","afs","coda","dfs","dns","hosts","kerberos","nds","nis","nisplus","nt","wfw") NULL,
+ location VARCHAR(255) NULL,
+ name VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location(20));
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name(20));
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ text VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text(40));
+
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
+
+COMMIT;
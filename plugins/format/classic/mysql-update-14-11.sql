@@ -0,0 +1,10 @@
+BEGIN;
+
+UPDATE _format SET version="14.11";
+
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident BIGINT UNSIGNED NOT NULL PRIMARY KEY,
+ data MEDIUMBLOB NOT NULL
+) ENGINE=InnoDB;
+
+COMMIT;
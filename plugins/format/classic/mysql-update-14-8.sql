@@ -0,0 +1,9 @@
+BEGIN;
+
+UPDATE _format SET version="14.8";
+ALTER TABLE Prelude_Address ADD COLUMN _address_bin VARBINARY(16) NULL;
+UPDATE Prelude_Address SET _address_bin = CONCAT(X'00000000000000000000FFFF', INET6_ATON(address)) WHERE IS_IPV4(address);
+UPDATE Prelude_Address SET _address_bin = INET6_ATON(address) WHERE IS_IPV6(address);
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
+
+COMMIT;
@@ -0,0 +1,16 @@
+BEGIN;
+
+UPDATE _format SET version="14.9";
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid VARCHAR(255) NOT NULL PRIMARY KEY,
+ _message_ident BIGINT UNSIGNED NOT NULL,
+ _history_time BIGINT NOT NULL,
+ messageid VARCHAR(255) NULL,
+ heartbeat_interval INTEGER NULL,
+ status VARCHAR(255) NULL,
+ create_time DATETIME NOT NULL,
+ create_time_usec INTEGER UNSIGNED NOT NULL,
+ create_time_gmtoff INTEGER NOT NULL
+) ENGINE=InnoDB;
+
+COMMIT;
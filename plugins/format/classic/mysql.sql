@@ -4,7 +4,7 @@ CREATE TABLE _format (
  name VARCHAR(255) NOT NULL,
  version VARCHAR(255) NOT NULL
 );
-INSERT INTO _format (name, version) VALUES('classic', '14.7');
+INSERT INTO _format (name, version) VALUES('classic', '14.11');
 
 DROP TABLE IF EXISTS Prelude_Alert;
 
@@ -16,6 +16,14 @@ CREATE TABLE Prelude_Alert (
 CREATE INDEX prelude_alert_messageid ON Prelude_Alert (messageid);
 
 
+DROP TABLE IF EXISTS Prelude_MessageBlob;
+
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident BIGINT UNSIGNED NOT NULL PRIMARY KEY,
+ data MEDIUMBLOB NOT NULL # binary IDMEF encoding of the whole message, possibly compressed
+) ENGINE=InnoDB;
+
+
 DROP TABLE IF EXISTS Prelude_Alertident;
 
 CREATE TABLE Prelude_Alertident (
@@ -69,6 +77,22 @@ CREATE TABLE Prelude_Heartbeat (
 
 
 
+DROP TABLE IF EXISTS Prelude_HeartbeatState;
+
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid VARCHAR(255) NOT NULL PRIMARY KEY,
+ _message_ident BIGINT UNSIGNED NOT NULL, # last heartbeat kept in Prelude_Heartbeat
+ _history_time BIGINT NOT NULL, # its creation time, in seconds since the epoch
+ messageid VARCHAR(255) NULL,
+ heartbeat_interval INTEGER NULL,
+ status VARCHAR(255) NULL,
+ create_time DATETIME NOT NULL,
+ create_time_usec INTEGER UNSIGNED NOT NULL,
+ create_time_gmtoff INTEGER NOT NULL
+) ENGINE=InnoDB;
+
+
+
 DROP TABLE IF EXISTS Prelude_Analyzer;
 
 CREATE TABLE Prelude_Analyzer (
@@ -83,11 +107,36 @@ CREATE TABLE Prelude_Analyzer (
  class VARCHAR(255) NULL,
  ostype VARCHAR(255) NULL,
  osversion VARCHAR(255) NULL,
+ _dict_ident BIGINT NULL,
  PRIMARY KEY (_parent_type,_message_ident,_index)
 ) ENGINE=InnoDB;
 
 CREATE INDEX prelude_analyzer_analyzerid ON Prelude_Analyzer (_parent_type,_index,analyzerid);
 CREATE INDEX prelude_analyzer_index_model ON Prelude_Analyzer (_parent_type,_index,model);
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+
+
+
+DROP TABLE IF EXISTS Prelude_AnalyzerDict;
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ name VARCHAR(255) NULL,
+ manufacturer VARCHAR(255) NULL,
+ model VARCHAR(255) NULL,
+ version VARCHAR(255) NULL,
+ class VARCHAR(255) NULL,
+ ostype VARCHAR(255) NULL,
+ osversion VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name(20));
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer(20));
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model(20));
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version(20));
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class(20));
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype(20));
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion(20));
 
 
 
@@ -96,10 +145,23 @@ DROP TABLE IF EXISTS Prelude_Classification;
 CREATE TABLE Prelude_Classification (
  _message_ident BIGINT UNSIGNED NOT NULL PRIMARY KEY,
  ident VARCHAR(255) NULL,
- text VARCHAR(255) NOT NULL
+ text VARCHAR(255) NULL,
+ _dict_ident BIGINT NULL
 ) ENGINE=InnoDB;
 
 CREATE INDEX prelude_classification_index_text ON Prelude_Classification (text(40));
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
+
+
+
+DROP TABLE IF EXISTS Prelude_ClassificationDict;
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ text VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text(40));
 
 
 
@@ -354,11 +416,27 @@ CREATE TABLE Prelude_Node (
  category ENUM("unknown","ads","afs","coda","dfs","dns","hosts","kerberos","nds","nis","nisplus","nt","wfw") NULL,
  location VARCHAR(255) NULL,
  name VARCHAR(255) NULL,
+ _dict_ident BIGINT NULL,
  PRIMARY KEY(_parent_type, _message_ident, _parent0_index)
 ) ENGINE=InnoDB;
 
 CREATE INDEX prelude_node_index_location ON Prelude_Node (_parent_type,_parent0_index,location(20));
 CREATE INDEX prelude_node_index_name ON Prelude_Node (_parent_type,_parent0_index,name(20));
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+
+
+
+DROP TABLE IF EXISTS Prelude_NodeDict;
+
+CREATE TABLE Prelude_NodeDict (
+ _ident BIGINT NOT NULL PRIMARY KEY,
+ category ENUM("unknown","ads","afs","coda","dfs","dns","hosts","kerberos","nds","nis","nisplus","nt","wfw") NULL,
+ location VARCHAR(255) NULL,
+ name VARCHAR(255) NULL
+) ENGINE=InnoDB;
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location(20));
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name(20));
 
 
 
@@ -375,10 +453,12 @@ CREATE TABLE Prelude_Address (
  vlan_num INTEGER UNSIGNED NULL,
  address VARCHAR(255) NOT NULL,
  netmask VARCHAR(255) NULL,
+ _address_bin VARBINARY(16) NULL, # address packed as 16 bytes, IPv4 mapped to ::ffff:0:0/96
  PRIMARY KEY (_parent_type, _message_ident, _parent0_index, _index)
 ) ENGINE=InnoDB;
 
 CREATE INDEX prelude_address_index_address ON Prelude_Address (_parent_type,_parent0_index,_index,address(10));
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
 
 
 
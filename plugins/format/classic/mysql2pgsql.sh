@@ -4,7 +4,9 @@ sed \
 	-e 's/ INT UNSIGNED NOT NULL PRIMARY KEY AUTO_INCREMENT/ SERIAL PRIMARY KEY/' \
 	-e 's/BIGINT UNSIGNED NOT NULL PRIMARY KEY AUTO_INCREMENT/BIGSERIAL PRIMARY KEY/' \
 	-e 's/DROP TABLE IF EXISTS/DROP TABLE/' \
+	-e 's/MEDIUMBLOB/BLOB/' \
 	-e 's/BLOB/BYTEA/' \
+	-e 's/VARBINARY([0-9]*)/BYTEA/' \
         -e 's/ TINYINT UNSIGNED / INT2 /g' \
         -e 's/ TINYINT / INT2 /g' \
         -e 's/ SMALLINT UNSIGNED / INT4 /g' \
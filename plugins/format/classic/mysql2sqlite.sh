@@ -6,6 +6,8 @@ sed \
 	-e 's/UNSIGNED //' \
 	-e 's/ENUM([^)]\{1,\})/TEXT/' \
 	-e 's/VARCHAR([^)]\{1,\})/TEXT/' \
+	-e 's/MEDIUMBLOB/BLOB/' \
+	-e 's/VARBINARY([0-9]*)/BLOB/' \
 	-e 's/AUTO_INCREMENT/AUTOINCREMENT/' \
 	-e 's/ENGINE=InnoDB//' \
 	-e 's/([0-9]\{1,\})//g' \
@@ -0,0 +1,49 @@
+BEGIN;
+
+UPDATE _format SET version='14.10';
+ALTER TABLE Prelude_Analyzer ADD COLUMN _dict_ident INT8 NULL;
+ALTER TABLE Prelude_Node ADD COLUMN _dict_ident INT8 NULL;
+ALTER TABLE Prelude_Classification ALTER COLUMN text DROP NOT NULL;
+ALTER TABLE Prelude_Classification ADD COLUMN _dict_ident INT8 NULL;
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ name VARCHAR(255) NULL,
+ manufacturer VARCHAR(255) NULL,
+ model VARCHAR(255) NULL,
+ version VARCHAR(255) NULL,
+ class VARCHAR(255) NULL,
+ ostype VARCHAR(255) NULL,
+ osversion VARCHAR(255) NULL
+);
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name);
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer);
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model);
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version);
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class);
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype);
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion);
+
+CREATE TABLE Prelude_NodeDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ category VARCHAR(32) CHECK ( category IN ('unknown','ads','afs','coda','dfs','dns','hosts','kerberos','nds','nis','nisplus','nt','wfw')) NULL,
+ location VARCHAR(255) NULL,
+ name VARCHAR(255) NULL
+);
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location);
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name);
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ text VARCHAR(255) NULL
+);
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text);
+
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
+
+COMMIT;
@@ -0,0 +1,10 @@
+BEGIN;
+
+UPDATE _format SET version='14.11';
+
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident INT8 NOT NULL PRIMARY KEY,
+ data BYTEA NOT NULL
+);
+
+COMMIT;
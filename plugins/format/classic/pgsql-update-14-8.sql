@@ -0,0 +1,9 @@
+BEGIN;
+
+UPDATE _format SET version='14.8';
+ALTER TABLE Prelude_Address ADD COLUMN _address_bin BYTEA NULL;
+UPDATE Prelude_Address SET _address_bin = decode('00000000000000000000ffff' || lpad(to_hex(address::inet - '0.0.0.0'::inet), 8, '0'), 'hex')
+ WHERE address ~ '^((25[0-5]|2[0-4][0-9]|1?[0-9]?[0-9])[.]){3}(25[0-5]|2[0-4][0-9]|1?[0-9]?[0-9])$';
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
+
+COMMIT;
@@ -0,0 +1,16 @@
+BEGIN;
+
+UPDATE _format SET version='14.9';
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid VARCHAR(255) NOT NULL PRIMARY KEY,
+ _message_ident INT8 NOT NULL,
+ _history_time INT8 NOT NULL,
+ messageid VARCHAR(255) NULL,
+ heartbeat_interval INT4 NULL,
+ status VARCHAR(255) NULL,
+ create_time TIMESTAMP NOT NULL,
+ create_time_usec INT8 NOT NULL,
+ create_time_gmtoff INT4 NOT NULL
+);
+
+COMMIT;
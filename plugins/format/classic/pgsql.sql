@@ -4,7 +4,7 @@ CREATE TABLE _format (
  name VARCHAR(255) NOT NULL,
  version VARCHAR(255) NOT NULL
 );
-INSERT INTO _format (name, version) VALUES('classic', '14.7');
+INSERT INTO _format (name, version) VALUES('classic', '14.11');
 
 DROP TABLE Prelude_Alert;
 
@@ -16,6 +16,14 @@ CREATE TABLE Prelude_Alert (
 CREATE INDEX prelude_alert_messageid ON Prelude_Alert (messageid);
 
 
+DROP TABLE Prelude_MessageBlob;
+
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident INT8 NOT NULL PRIMARY KEY,
+ data BYTEA NOT NULL 
+) ;
+
+
 DROP TABLE Prelude_Alertident;
 
 CREATE TABLE Prelude_Alertident (
@@ -69,6 +77,22 @@ CREATE TABLE Prelude_Heartbeat (
 
 
 
+DROP TABLE Prelude_HeartbeatState;
+
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid VARCHAR(255) NOT NULL PRIMARY KEY,
+ _message_ident INT8 NOT NULL, 
+ _history_time INT8 NOT NULL, 
+ messageid VARCHAR(255) NULL,
+ heartbeat_interval INT4 NULL,
+ status VARCHAR(255) NULL,
+ create_time TIMESTAMP NOT NULL,
+ create_time_usec INT8 NOT NULL,
+ create_time_gmtoff INT4 NOT NULL
+) ;
+
+
+
 DROP TABLE Prelude_Analyzer;
 
 CREATE TABLE Prelude_Analyzer (
@@ -83,11 +107,36 @@ CREATE TABLE Prelude_Analyzer (
  class VARCHAR(255) NULL,
  ostype VARCHAR(255) NULL,
  osversion VARCHAR(255) NULL,
+ _dict_ident INT8 NULL,
  PRIMARY KEY (_parent_type,_message_ident,_index)
 ) ;
 
 CREATE INDEX prelude_analyzer_analyzerid ON Prelude_Analyzer (_parent_type,_index,analyzerid);
 CREATE INDEX prelude_analyzer_index_model ON Prelude_Analyzer (_parent_type,_index,model);
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+
+
+
+DROP TABLE Prelude_AnalyzerDict;
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ name VARCHAR(255) NULL,
+ manufacturer VARCHAR(255) NULL,
+ model VARCHAR(255) NULL,
+ version VARCHAR(255) NULL,
+ class VARCHAR(255) NULL,
+ ostype VARCHAR(255) NULL,
+ osversion VARCHAR(255) NULL
+) ;
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name);
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer);
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model);
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version);
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class);
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype);
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion);
 
 
 
@@ -96,10 +145,23 @@ DROP TABLE Prelude_Classification;
 CREATE TABLE Prelude_Classification (
  _message_ident INT8 NOT NULL PRIMARY KEY,
  ident VARCHAR(255) NULL,
- text VARCHAR(255) NOT NULL
+ text VARCHAR(255) NULL,
+ _dict_ident INT8 NULL
 ) ;
 
 CREATE INDEX prelude_classification_index_text ON Prelude_Classification (text);
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
+
+
+
+DROP TABLE Prelude_ClassificationDict;
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ text VARCHAR(255) NULL
+) ;
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text);
 
 
 
@@ -354,11 +416,27 @@ CREATE TABLE Prelude_Node (
  category VARCHAR(32) CHECK ( category IN ('unknown','ads','afs','coda','dfs','dns','hosts','kerberos','nds','nis','nisplus','nt','wfw')) NULL,
  location VARCHAR(255) NULL,
  name VARCHAR(255) NULL,
+ _dict_ident INT8 NULL,
  PRIMARY KEY(_parent_type, _message_ident, _parent0_index)
 ) ;
 
 CREATE INDEX prelude_node_index_location ON Prelude_Node (_parent_type,_parent0_index,location);
 CREATE INDEX prelude_node_index_name ON Prelude_Node (_parent_type,_parent0_index,name);
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+
+
+
+DROP TABLE Prelude_NodeDict;
+
+CREATE TABLE Prelude_NodeDict (
+ _ident INT8 NOT NULL PRIMARY KEY,
+ category VARCHAR(32) CHECK ( category IN ('unknown','ads','afs','coda','dfs','dns','hosts','kerberos','nds','nis','nisplus','nt','wfw')) NULL,
+ location VARCHAR(255) NULL,
+ name VARCHAR(255) NULL
+) ;
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location);
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name);
 
 
 
@@ -375,10 +453,12 @@ CREATE TABLE Prelude_Address (
  vlan_num INT8 NULL,
  address VARCHAR(255) NOT NULL,
  netmask VARCHAR(255) NULL,
+ _address_bin BYTEA NULL, 
  PRIMARY KEY (_parent_type, _message_ident, _parent0_index, _index)
 ) ;
 
 CREATE INDEX prelude_address_index_address ON Prelude_Address (_parent_type,_parent0_index,_index,address);
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
 
 
 
@@ -0,0 +1,57 @@
+UPDATE _format SET version="14.10";
+ALTER TABLE Prelude_Analyzer ADD COLUMN _dict_ident INTEGER NULL;
+ALTER TABLE Prelude_Node ADD COLUMN _dict_ident INTEGER NULL;
+
+ALTER TABLE Prelude_Classification RENAME TO Prelude_ClassificationOld;
+
+CREATE TABLE Prelude_Classification (
+ _message_ident INTEGER NOT NULL PRIMARY KEY,
+ ident TEXT NULL,
+ text TEXT NULL,
+ _dict_ident INTEGER NULL
+);
+
+INSERT INTO Prelude_Classification (_message_ident, ident, text) SELECT _message_ident, ident, text FROM Prelude_ClassificationOld;
+DROP TABLE Prelude_ClassificationOld;
+
+CREATE INDEX prelude_classification_index_text ON Prelude_Classification (text);
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ name TEXT NULL,
+ manufacturer TEXT NULL,
+ model TEXT NULL,
+ version TEXT NULL,
+ class TEXT NULL,
+ ostype TEXT NULL,
+ osversion TEXT NULL
+);
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name);
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer);
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model);
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version);
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class);
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype);
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion);
+
+CREATE TABLE Prelude_NodeDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ category TEXT NULL,
+ location TEXT NULL,
+ name TEXT NULL
+);
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location);
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name);
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ text TEXT NULL
+);
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text);
+
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
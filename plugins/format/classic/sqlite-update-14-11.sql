@@ -0,0 +1,6 @@
+UPDATE _format SET version="14.11";
+
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident INTEGER NOT NULL PRIMARY KEY,
+ data BLOB NOT NULL
+);
@@ -0,0 +1,3 @@
+UPDATE _format SET version="14.8";
+ALTER TABLE Prelude_Address ADD COLUMN _address_bin BLOB NULL;
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
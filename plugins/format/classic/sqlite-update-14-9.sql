@@ -0,0 +1,12 @@
+UPDATE _format SET version="14.9";
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid TEXT NOT NULL PRIMARY KEY,
+ _message_ident INTEGER NOT NULL,
+ _history_time INTEGER NOT NULL,
+ messageid TEXT NULL,
+ heartbeat_interval INTEGER NULL,
+ status TEXT NULL,
+ create_time DATETIME NOT NULL,
+ create_time_usec INTEGER NOT NULL,
+ create_time_gmtoff INTEGER NOT NULL
+);
@@ -3,7 +3,7 @@ CREATE TABLE _format (
  name TEXT NOT NULL,
  version TEXT NOT NULL
 );
-INSERT INTO _format (name, version) VALUES('classic', '14.7');
+INSERT INTO _format (name, version) VALUES('classic', '14.11');
 
 
 CREATE TABLE Prelude_Alert (
@@ -15,6 +15,13 @@ CREATE INDEX prelude_alert_messageid ON Prelude_Alert (messageid);
 
 
 
+CREATE TABLE Prelude_MessageBlob (
+ _message_ident INTEGER NOT NULL PRIMARY KEY,
+ data BLOB NOT NULL 
+) ;
+
+
+
 CREATE TABLE Prelude_Alertident (
  _message_ident INTEGER NOT NULL,
  _index INTEGER NOT NULL,
@@ -63,6 +70,21 @@ CREATE TABLE Prelude_Heartbeat (
 
 
 
+CREATE TABLE Prelude_HeartbeatState (
+ analyzerid TEXT NOT NULL PRIMARY KEY,
+ _message_ident INTEGER NOT NULL, 
+ _history_time INTEGER NOT NULL, 
+ messageid TEXT NULL,
+ heartbeat_interval INTEGER NULL,
+ status TEXT NULL,
+ create_time DATETIME NOT NULL,
+ create_time_usec INTEGER NOT NULL,
+ create_time_gmtoff INTEGER NOT NULL
+) ;
+
+
+
+
 CREATE TABLE Prelude_Analyzer (
  _message_ident INTEGER NOT NULL,
  _parent_type TEXT NOT NULL, 
@@ -75,11 +97,35 @@ CREATE TABLE Prelude_Analyzer (
  class TEXT NULL,
  ostype TEXT NULL,
  osversion TEXT NULL,
+ _dict_ident INTEGER NULL,
  PRIMARY KEY (_parent_type,_message_ident,_index)
 ) ;
 
 CREATE INDEX prelude_analyzer_analyzerid ON Prelude_Analyzer (_parent_type,_index,analyzerid);
 CREATE INDEX prelude_analyzer_index_model ON Prelude_Analyzer (_parent_type,_index,model);
+CREATE INDEX prelude_analyzer_index_dict ON Prelude_Analyzer (_dict_ident);
+
+
+
+
+CREATE TABLE Prelude_AnalyzerDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ name TEXT NULL,
+ manufacturer TEXT NULL,
+ model TEXT NULL,
+ version TEXT NULL,
+ class TEXT NULL,
+ ostype TEXT NULL,
+ osversion TEXT NULL
+) ;
+
+CREATE INDEX prelude_analyzerdict_index_name ON Prelude_AnalyzerDict (name);
+CREATE INDEX prelude_analyzerdict_index_manufacturer ON Prelude_AnalyzerDict (manufacturer);
+CREATE INDEX prelude_analyzerdict_index_model ON Prelude_AnalyzerDict (model);
+CREATE INDEX prelude_analyzerdict_index_version ON Prelude_AnalyzerDict (version);
+CREATE INDEX prelude_analyzerdict_index_class ON Prelude_AnalyzerDict (class);
+CREATE INDEX prelude_analyzerdict_index_ostype ON Prelude_AnalyzerDict (ostype);
+CREATE INDEX prelude_analyzerdict_index_osversion ON Prelude_AnalyzerDict (osversion);
 
 
 
@@ -87,10 +133,22 @@ CREATE INDEX prelude_analyzer_index_model ON Prelude_Analyzer (_parent_type,_ind
 CREATE TABLE Prelude_Classification (
  _message_ident INTEGER NOT NULL PRIMARY KEY,
  ident TEXT NULL,
- text TEXT NOT NULL
+ text TEXT NULL,
+ _dict_ident INTEGER NULL
 ) ;
 
 CREATE INDEX prelude_classification_index_text ON Prelude_Classification (text);
+CREATE INDEX prelude_classification_index_dict ON Prelude_Classification (_dict_ident);
+
+
+
+
+CREATE TABLE Prelude_ClassificationDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ text TEXT NULL
+) ;
+
+CREATE INDEX prelude_classificationdict_index_text ON Prelude_ClassificationDict (text);
 
 
 
@@ -327,11 +385,26 @@ CREATE TABLE Prelude_Node (
  category TEXT NULL,
  location TEXT NULL,
  name TEXT NULL,
+ _dict_ident INTEGER NULL,
  PRIMARY KEY(_parent_type, _message_ident, _parent0_index)
 ) ;
 
 CREATE INDEX prelude_node_index_location ON Prelude_Node (_parent_type,_parent0_index,location);
 CREATE INDEX prelude_node_index_name ON Prelude_Node (_parent_type,_parent0_index,name);
+CREATE INDEX prelude_node_index_dict ON Prelude_Node (_dict_ident);
+
+
+
+
+CREATE TABLE Prelude_NodeDict (
+ _ident INTEGER NOT NULL PRIMARY KEY,
+ category TEXT NULL,
+ location TEXT NULL,
+ name TEXT NULL
+) ;
+
+CREATE INDEX prelude_nodedict_index_location ON Prelude_NodeDict (location);
+CREATE INDEX prelude_nodedict_index_name ON Prelude_NodeDict (name);
 
 
 
@@ -347,10 +420,12 @@ CREATE TABLE Prelude_Address (
  vlan_num INTEGER NULL,
  address TEXT NOT NULL,
  netmask TEXT NULL,
+ _address_bin BLOB NULL, 
  PRIMARY KEY (_parent_type, _message_ident, _parent0_index, _index)
 ) ;
 
 CREATE INDEX prelude_address_index_address ON Prelude_Address (_parent_type,_parent0_index,_index,address);
+CREATE INDEX prelude_address_index_bin ON Prelude_Address (_parent_type,_address_bin);
 
 
 
@@ -143,7 +143,7 @@ static void sql_close(void *session)
 }
 
 
-static int sql_escape_binary(void *session, const unsigned char *input, size_t input_size, char **output)
+static int sql_escape(void *session, const char *input, size_t input_size, char **output)
 {
         size_t rsize;
 
@@ -165,9 +165,9 @@ static int sql_escape_binary(void *session, const unsigned char *input, size_t i
         (*output)[0] = '\'';
 
 #ifdef HAVE_MYSQL_REAL_ESCAPE_STRING
-        rsize = mysql_real_escape_string((MYSQL *) session, (*output) + 1, (const char *) input, input_size);
+        rsize = mysql_real_escape_string((MYSQL *) session, (*output) + 1, input, input_size);
 #else
-        rsize = mysql_escape_string((*output) + 1, (const char *) input, input_size);
+        rsize = mysql_escape_string((*output) + 1, input, input_size);
 #endif
 
         (*output)[rsize + 1] = '\'';
@@ -196,6 +196,69 @@ static int sql_build_limit_offset_string(void *session, int limit, int offset, p
 
 
 
+static int sql_build_optimize_string(void *session, const char *table, preludedb_sql_optimize_flags_t flag, prelude_string_t *output)
+{
+        /*
+         * MySQL has no database wide maintenance statement.
+         */
+        if ( ! table )
+                return 0;
+
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_ANALYZE )
+                return prelude_string_sprintf(output, "ANALYZE TABLE %s", table);
+
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_RECLAIM )
+                return prelude_string_sprintf(output, "OPTIMIZE TABLE %s", table);
+
+        return 0;
+}
+
+
+
+
+static int sql_build_create_index_string(void *session, const char *name, const char *table, const char *columns,
+                                         const char *partial_column, const char *partial_value, prelude_string_t *output)
+{
+        /*
+         * InnoDB builds secondary indexes in place, without blocking
+         * writers, but has no partial index.
+         */
+        if ( partial_column )
+                return prelude_string_sprintf(output, "CREATE INDEX %s ON %s (%s, %s)", name, table, partial_column, columns);
+
+        return prelude_string_sprintf(output, "CREATE INDEX %s ON %s (%s)", name, table, columns);
+}
+
+
+
+static int sql_build_upsert_string(void *session, const char *table, const char *fields, const char *values, const char *key,
+                                   const char * const *columns, size_t size, prelude_string_t *output)
+{
+        int ret;
+        size_t i;
+
+        /*
+         * The update applies to the row conflicting on any unique key,
+         * @key is implied by the table definition.
+         */
+        if ( size == 0 )
+                return prelude_string_sprintf(output, "INSERT IGNORE INTO %s (%s) VALUES(%s)", table, fields, values);
+
+        ret = prelude_string_sprintf(output, "INSERT INTO %s (%s) VALUES(%s) ON DUPLICATE KEY UPDATE ", table, fields, values);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < size; i++ ) {
+                ret = prelude_string_sprintf(output, "%s%s = VALUES(%s)", (i > 0) ? ", " : "", columns[i], columns[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
 static int sql_query(void *session, const char *query, preludedb_sql_table_t **table)
 {
         int ret;
@@ -591,7 +654,7 @@ int mysql_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
 
         preludedb_plugin_sql_set_open_func(plugin, sql_open);
         preludedb_plugin_sql_set_close_func(plugin, sql_close);
-        preludedb_plugin_sql_set_escape_binary_func(plugin, sql_escape_binary);
+        preludedb_plugin_sql_set_escape_func(plugin, sql_escape);
         preludedb_plugin_sql_set_query_func(plugin, sql_query);
         preludedb_plugin_sql_set_get_server_version_func(plugin, sql_get_server_version);
         preludedb_plugin_sql_set_table_destroy_func(plugin, sql_table_destroy);
@@ -609,6 +672,9 @@ int mysql_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_sql_set_build_time_interval_string_func(plugin, sql_build_time_interval_string);
         preludedb_plugin_sql_set_build_time_timezone_string_func(plugin, sql_build_time_timezone_string);
         preludedb_plugin_sql_set_build_limit_offset_string_func(plugin, sql_build_limit_offset_string);
+        preludedb_plugin_sql_set_build_optimize_string_func(plugin, sql_build_optimize_string);
+        preludedb_plugin_sql_set_build_create_index_string_func(plugin, sql_build_create_index_string);
+        preludedb_plugin_sql_set_build_upsert_string_func(plugin, sql_build_upsert_string);
         preludedb_plugin_sql_set_get_last_insert_ident_func(plugin, sql_get_last_insert_ident);
 
         return 0;
@@ -48,6 +48,17 @@ int pgsql_LTX_prelude_plugin_version(void);
 int pgsql_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data);
 
 
+typedef struct {
+        PGconn *conn;
+
+        /*
+         * approx_count_distinct() is computed server side when the
+         * HyperLogLog extension is installed in the database.
+         */
+        prelude_bool_t have_hll_extension;
+} pgsql_session_t;
+
+
 static int handle_error(prelude_error_code_t code, PGconn *conn)
 {
         int ret;
@@ -80,13 +91,13 @@ static int handle_error(prelude_error_code_t code, PGconn *conn)
 }
 
 
-static int _sql_query(void *session, const char *query, PGresult **result)
+static int _sql_query(PGconn *conn, const char *query, PGresult **result)
 {
         int status, ntuple;
 
-        *result = PQexec(session, query);
+        *result = PQexec(conn, query);
         if ( ! *result )
-                return handle_error(PRELUDEDB_ERROR_QUERY, session);
+                return handle_error(PRELUDEDB_ERROR_QUERY, conn);
 
         status = PQresultStatus(*result);
         if ( status == PGRES_TUPLES_OK ) {
@@ -101,7 +112,7 @@ static int _sql_query(void *session, const char *query, PGresult **result)
         if ( status == PGRES_COMMAND_OK )
                 return 0;
 
-        return handle_error(PRELUDEDB_ERROR_QUERY, session);
+        return handle_error(PRELUDEDB_ERROR_QUERY, conn);
 }
 
 
@@ -110,8 +121,9 @@ static int sql_query(void *session, const char *query, preludedb_sql_table_t **t
 {
         int ret;
         PGresult *result;
+        pgsql_session_t *s = session;
 
-        ret = _sql_query(session, query, &result);
+        ret = _sql_query(s->conn, query, &result);
         if ( ret <= 0 )
                 return ret;
 
@@ -135,8 +147,9 @@ static int sql_get_last_insert_ident(void *session, uint64_t *ident)
         int ret;
         char *value;
         PGresult *result;
+        pgsql_session_t *s = session;
 
-        ret = _sql_query(session, "SELECT lastval();", &result);
+        ret = _sql_query(s->conn, "SELECT lastval();", &result);
         if ( ret < 0 )
                 return ret;
 
@@ -157,7 +170,7 @@ static int sql_get_last_insert_ident(void *session, uint64_t *ident)
 
 
 
-static int check_settings(PGconn *session)
+static int check_settings(PGconn *conn)
 {
         int ret;
         size_t size;
@@ -186,7 +199,7 @@ static int check_settings(PGconn *session)
          * libpq < 9.0 cannot handle hexadecimal bytea output, which is the default for PostgreSQL 9.0 server.
          * Check the setting value.
          */
-        ret = _sql_query(session, "SELECT setting FROM pg_settings WHERE name = 'bytea_output' AND setting = 'hex';", &result);
+        ret = _sql_query(conn, "SELECT setting FROM pg_settings WHERE name = 'bytea_output' AND setting = 'hex';", &result);
         if ( ret <= 0 )
                 return ret;
 
@@ -197,10 +210,21 @@ static int check_settings(PGconn *session)
 
 
 
+static void sql_close(void *session)
+{
+        pgsql_session_t *s = session;
+
+        PQfinish(s->conn);
+        free(s);
+}
+
+
+
 static int sql_open(preludedb_sql_settings_t *settings, void **session)
 {
         int ret;
         PGconn *conn;
+        pgsql_session_t *s;
 
         conn = PQsetdbLogin(preludedb_sql_settings_get_host(settings),
                             preludedb_sql_settings_get_port(settings),
@@ -222,20 +246,36 @@ static int sql_open(preludedb_sql_settings_t *settings, void **session)
                 return ret;
         }
 
-        *session = conn;
+        s = calloc(1, sizeof(*s));
+        if ( ! s ) {
+                PQfinish(conn);
+                return preludedb_error_from_errno(errno);
+        }
 
-        ret = sql_query(conn, "SET standard_conforming_strings=on", NULL);
-        if ( ret < 0 )
-                return ret;
+        s->conn = conn;
 
-        return sql_query(conn, "SET DATESTYLE TO 'ISO'", NULL);
-}
+        if ( PQserverVersion(conn) >= 90100 ) {
+                PGresult *result;
 
+                ret = _sql_query(conn, "SELECT 1 FROM pg_extension WHERE extname = 'hll'", &result);
+                if ( ret > 0 )
+                        PQclear(result);
 
+                s->have_hll_extension = (ret > 0) ? TRUE : FALSE;
+        }
 
-static void sql_close(void *session)
-{
-        PQfinish(session);
+        ret = sql_query(s, "SET standard_conforming_strings=on", NULL);
+        if ( ret >= 0 )
+                ret = sql_query(s, "SET DATESTYLE TO 'ISO'", NULL);
+
+        if ( ret < 0 ) {
+                sql_close(s);
+                return ret;
+        }
+
+        *session = s;
+
+        return ret;
 }
 
 
@@ -243,6 +283,7 @@ static int sql_escape(void *session, const char *input, size_t input_size, char
 {
 #ifdef HAVE_PQESCAPESTRINGCONN
         int error;
+        PGconn *conn;
 #endif
         size_t rsize;
 
@@ -257,9 +298,13 @@ static int sql_escape(void *session, const char *input, size_t input_size, char
         (*output)[0] = '\'';
 
 #ifdef HAVE_PQESCAPESTRINGCONN
-        rsize = PQescapeStringConn(session, (*output) + 1, input, input_size, &error);
+        conn = ((pgsql_session_t *) session)->conn;
+#endif
+
+#ifdef HAVE_PQESCAPESTRINGCONN
+        rsize = PQescapeStringConn(conn, (*output) + 1, input, input_size, &error);
         if ( error )
-                return handle_error(PRELUDEDB_ERROR_GENERIC, session);
+                return handle_error(PRELUDEDB_ERROR_GENERIC, conn);
 #else
         rsize = PQescapeString((*output) + 1, input, input_size);
 #endif
@@ -282,7 +327,7 @@ static int sql_escape_binary(void *session, const unsigned char *input, size_t i
                 return ret;
 
 #ifdef HAVE_PQESCAPEBYTEACONN
-        ptr = PQescapeByteaConn(session, input, input_size, &dummy);
+        ptr = PQescapeByteaConn(((pgsql_session_t *) session)->conn, input, input_size, &dummy);
 #else
         ptr = PQescapeBytea(input, input_size, &dummy);
 #endif
@@ -335,6 +380,103 @@ static int sql_build_limit_offset_string(void *session, int limit, int offset, p
 
 
 
+static int sql_build_optimize_string(void *session, const char *table, preludedb_sql_optimize_flags_t flag, prelude_string_t *output)
+{
+        /*
+         * Per table VACUUM and ANALYZE already cover everything.
+         */
+        if ( ! table )
+                return 0;
+
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_ANALYZE )
+                return prelude_string_sprintf(output, "ANALYZE %s", table);
+
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_RECLAIM )
+                return prelude_string_sprintf(output, "VACUUM %s", table);
+
+        return 0;
+}
+
+
+
+static int sql_build_create_index_string(void *session, const char *name, const char *table, const char *columns,
+                                         const char *partial_column, const char *partial_value, prelude_string_t *output)
+{
+        int ret;
+
+        /*
+         * CONCURRENTLY does not block writers, but cannot be used within
+         * a transaction block.
+         */
+        ret = prelude_string_sprintf(output, "CREATE INDEX CONCURRENTLY %s ON %s (%s)", name, table, columns);
+        if ( ret < 0 || ! partial_column )
+                return ret;
+
+        return prelude_string_sprintf(output, " WHERE %s = %s", partial_column, partial_value);
+}
+
+
+
+static int sql_build_upsert_string(void *session, const char *table, const char *fields, const char *values, const char *key,
+                                   const char * const *columns, size_t size, prelude_string_t *output)
+{
+        int ret;
+        size_t i;
+
+        /*
+         * ON CONFLICT is available since PostgreSQL 9.5.
+         */
+        if ( PQserverVersion(((pgsql_session_t *) session)->conn) < 90500 )
+                return preludedb_error_verbose(prelude_error_code_from_errno(ENOSYS),
+                                               "upsert requires PostgreSQL 9.5 or later");
+
+        ret = prelude_string_sprintf(output, "INSERT INTO %s (%s) VALUES(%s) ON CONFLICT (%s) ", table, fields, values, key);
+        if ( ret < 0 )
+                return ret;
+
+        if ( size == 0 )
+                return prelude_string_cat(output, "DO NOTHING");
+
+        ret = prelude_string_cat(output, "DO UPDATE SET ");
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < size; i++ ) {
+                ret = prelude_string_sprintf(output, "%s%s = EXCLUDED.%s", (i > 0) ? ", " : "", columns[i], columns[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int sql_build_aggregate_string(void *session, prelude_string_t *output, const char *field,
+                                      preludedb_sql_aggregate_type_t type, int param)
+{
+        switch ( type ) {
+        case PRELUDEDB_SQL_AGGREGATE_APPROX_COUNT_DISTINCT:
+                if ( ! ((pgsql_session_t *) session)->have_hll_extension )
+                        break;
+
+                return prelude_string_sprintf(output, "CAST(hll_cardinality(hll_add_agg(hll_hash_any(%s))) AS BIGINT)", field);
+
+        case PRELUDEDB_SQL_AGGREGATE_PERCENTILE:
+                /*
+                 * Ordered-set aggregates are available since PostgreSQL 9.4.
+                 */
+                if ( PQserverVersion(((pgsql_session_t *) session)->conn) < 90400 )
+                        break;
+
+                return prelude_string_sprintf(output, "percentile_cont(%d / 100.0) WITHIN GROUP (ORDER BY %s)", param, field);
+        }
+
+        return preludedb_error_verbose(prelude_error_code_from_errno(ENOSYS), "aggregate '%d' is not available on this server", type);
+}
+
+
+
 static void sql_table_destroy(void *session, preludedb_sql_table_t *table)
 {
         PQclear(preludedb_sql_table_get_data(table));
@@ -622,7 +764,25 @@ static int sql_build_time_interval_string(prelude_string_t *output, const char *
 
 static long sql_get_server_version(void *session)
 {
-        return PQserverVersion(session);
+        pgsql_session_t *s = session;
+
+        return PQserverVersion(s->conn);
+}
+
+
+
+/*
+ * The hex bytea input format requires PostgreSQL >= 9.0: let libpq
+ * escape binary buffers otherwise.
+ */
+static preludedb_plugin_sql_escape_flags_t sql_get_escape_flags(void *session)
+{
+        pgsql_session_t *s = session;
+
+        if ( PQserverVersion(s->conn) < 90000 )
+                return PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY;
+
+        return PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY|PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_BYTEA_HEX;
 }
 
 
@@ -660,8 +820,19 @@ int pgsql_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_sql_set_build_time_constraint_string_func(plugin, sql_build_time_constraint_string);
         preludedb_plugin_sql_set_build_time_interval_string_func(plugin, sql_build_time_interval_string);
         preludedb_plugin_sql_set_build_limit_offset_string_func(plugin, sql_build_limit_offset_string);
+        preludedb_plugin_sql_set_build_optimize_string_func(plugin, sql_build_optimize_string);
+        preludedb_plugin_sql_set_build_create_index_string_func(plugin, sql_build_create_index_string);
+        preludedb_plugin_sql_set_build_upsert_string_func(plugin, sql_build_upsert_string);
+        preludedb_plugin_sql_set_build_aggregate_string_func(plugin, sql_build_aggregate_string);
         preludedb_plugin_sql_set_get_last_insert_ident_func(plugin, sql_get_last_insert_ident);
 
+        /*
+         * Sessions are opened with standard_conforming_strings on, and
+         * bytea values are exchanged in hex format.
+         */
+        preludedb_plugin_sql_set_escape_flags(plugin, PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY|PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_BYTEA_HEX);
+        preludedb_plugin_sql_set_get_escape_flags_func(plugin, sql_get_escape_flags);
+
         return 0;
 }
 
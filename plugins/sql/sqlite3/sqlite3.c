@@ -37,11 +37,42 @@
 #include <sqlite3.h>
 #include <libprelude/prelude.h>
 
+#include "glthread/lock.h"
+
 #include "preludedb.h"
 #include "preludedb-plugin-sql.h"
 
 
 #define SQLITE_BUSY_TIMEOUT INT_MAX
+#define SQLITE_SETTING_READERS "readers"
+#define SQLITE_SETTING_SCHEMA "schema"
+
+
+/*
+ * This file is also compiled as the "memory" plugin: a private SQLite
+ * ":memory:" database, created from the classic SQLite schema on
+ * connection, and discarded when the connection is closed.
+ */
+#ifdef SQLITE_MEMORY_PLUGIN
+# define SQLITE_PLUGIN_NAME "memory"
+# define SQLITE_PLUGIN_SYMBOL(sym) memory_LTX_ ## sym
+# define SQLITE_DEFAULT_SCHEMA FORMAT_SCHEMA_DIR "/classic/sqlite.sql"
+#else
+# define SQLITE_PLUGIN_NAME "sqlite3"
+# define SQLITE_PLUGIN_SYMBOL(sym) sqlite3_LTX_ ## sym
+#endif
+
+
+/*
+ * Concurrent readers require WAL journaling, which appeared in SQLite 3.7.0.
+ * With older library, every query goes through the writer connection.
+ * An in-memory database is private to its connection, and cannot be shared.
+ */
+#if SQLITE_VERSION_NUMBER >= 3007000 && ! defined(SQLITE_MEMORY_PLUGIN)
+# define SQLITE_DEFAULT_READERS 4
+#else
+# define SQLITE_DEFAULT_READERS 0
+#endif
 
 
 /*
@@ -60,8 +91,47 @@
 
 
 
-int sqlite3_LTX_prelude_plugin_version(void);
-int sqlite3_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data);
+int SQLITE_PLUGIN_SYMBOL(prelude_plugin_version)(void);
+int SQLITE_PLUGIN_SYMBOL(preludedb_plugin_init)(prelude_plugin_entry_t *pe, void *data);
+
+
+typedef struct {
+        sqlite3 *db;
+        prelude_bool_t busy;
+} sqlite_reader_t;
+
+
+/*
+ * A session is made of a single writer connection, plus a pool of
+ * read-only connections used for SELECT issued outside of a transaction.
+ * Readers are opened on demand. A reader is held while the rows of its
+ * query are stepped through, and returns to the pool as soon as the last
+ * one is fetched, so that a table kept once read does not keep a WAL
+ * snapshot and block checkpoints, and without holding rows in memory.
+ */
+typedef struct {
+        sqlite3 *writer;
+        char *dbfile;
+
+        gl_lock_t readers_lock;
+        unsigned int max_readers;
+        unsigned int nreaders;
+        sqlite_reader_t *readers;
+} sqlite_session_t;
+
+
+/*
+ * Result of a SELECT, whose rows are stepped through as they are fetched.
+ * Once done, statement is finalized and set to NULL, and the connection
+ * it ran on released: column names are copied to outlive it.
+ */
+typedef struct {
+        sqlite_session_t *session;
+        sqlite3 *db;
+        sqlite3_stmt *statement;
+        unsigned int ncolumns;
+        char **names;
+} sqlite_result_t;
 
 
 
@@ -89,43 +159,305 @@ static void sqlite3_regexp(sqlite3_context *context, int argc, sqlite3_value **a
 
 
 
-static int sql_open(preludedb_sql_settings_t *settings, void **session)
+static int open_connection(const char *dbfile, prelude_bool_t readonly, sqlite3 **db)
 {
         int ret;
-        const char *dbfile;
 
-        dbfile = preludedb_sql_settings_get_file(settings);
-        if ( ! dbfile || ! *dbfile )
-                return preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "no database file specified");
-
-        ret = access(dbfile, F_OK);
-        if ( ret != 0 )
-                return preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "database file '%s' does not exist", dbfile);
+#if SQLITE_VERSION_NUMBER >= 3007000
+        ret = sqlite3_open_v2(dbfile, db, (readonly) ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+#else
+        ret = sqlite3_open(dbfile, db);
+#endif
+        if ( ret != SQLITE_OK ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "%s", sqlite3_errmsg(*db));
+                sqlite3_close(*db);
+                return ret;
+        }
 
-        ret = sqlite3_open(dbfile, (sqlite3 **) session);
+        ret = sqlite3_create_function(*db, SQLITE_REGEX_BIND_OPERATOR, 2, SQLITE_ANY, NULL, sqlite3_regexp, NULL, NULL);
         if ( ret != SQLITE_OK ) {
-                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "%s", sqlite3_errmsg(*session));
-                sqlite3_close(*session);
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "%s", sqlite3_errmsg(*db));
+                sqlite3_close(*db);
+                return ret;
+        }
+
+        sqlite3_busy_timeout(*db, SQLITE_BUSY_TIMEOUT);
+
+        return 0;
+}
+
+
+
+static prelude_bool_t enable_wal(sqlite3 *db)
+{
+        int ret;
+        const char *mode;
+        sqlite3_stmt *statement;
+        prelude_bool_t enabled = FALSE;
+
+        ret = sqlite3_prepare(db, "PRAGMA journal_mode=WAL", -1, &statement, NULL);
+        if ( ret != SQLITE_OK )
+                return FALSE;
+
+        if ( sqlite3_step(statement) == SQLITE_ROW ) {
+                mode = (const char *) sqlite3_column_text(statement, 0);
+                enabled = (mode && strcasecmp(mode, "wal") == 0);
+        }
+
+        sqlite3_finalize(statement);
+
+        return enabled;
+}
+
+
+
+static unsigned int get_max_readers(preludedb_sql_settings_t *settings)
+{
+        long value;
+        char *eptr = NULL;
+        const char *readers;
+
+        readers = preludedb_sql_settings_get(settings, SQLITE_SETTING_READERS);
+        if ( ! readers || SQLITE_DEFAULT_READERS == 0 )
+                return SQLITE_DEFAULT_READERS;
+
+        value = strtol(readers, &eptr, 10);
+        if ( *eptr || value < 0 ) {
+                prelude_log(PRELUDE_LOG_WARN, "invalid '%s' value '%s', using default.\n", SQLITE_SETTING_READERS, readers);
+                return SQLITE_DEFAULT_READERS;
+        }
+
+        return value;
+}
+
+
+
+static void session_destroy(sqlite_session_t *session)
+{
+        unsigned int i;
+
+        for ( i = 0; i < session->nreaders; i++ )
+                sqlite3_close(session->readers[i].db);
+
+        if ( session->writer )
+                sqlite3_close(session->writer);
+
+        gl_lock_destroy(session->readers_lock);
+
+        free(session->readers);
+        free(session->dbfile);
+        free(session);
+}
+
+
+
+#ifdef SQLITE_MEMORY_PLUGIN
+static int load_schema(sqlite3 *db, const char *filename)
+{
+        int ret;
+        FILE *fd;
+        long size;
+        char *buf, *errmsg = NULL;
+
+        fd = fopen(filename, "r");
+        if ( ! fd )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "could not open schema '%s': %s", filename, strerror(errno));
+
+        ret = fseek(fd, 0, SEEK_END);
+        if ( ret < 0 || (size = ftell(fd)) < 0 || fseek(fd, 0, SEEK_SET) < 0 ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "could not read schema '%s': %s", filename, strerror(errno));
+                fclose(fd);
                 return ret;
         }
 
-        ret = sqlite3_create_function(*session, SQLITE_REGEX_BIND_OPERATOR, 2, SQLITE_ANY, NULL, sqlite3_regexp, NULL, NULL);
+        buf = malloc(size + 1);
+        if ( ! buf ) {
+                fclose(fd);
+                return preludedb_error_from_errno(errno);
+        }
+
+        if ( fread(buf, 1, size, fd) != (size_t) size ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "could not read schema '%s'", filename);
+                goto out;
+        }
+
+        buf[size] = '\0';
+
+        ret = sqlite3_exec(db, buf, NULL, NULL, &errmsg);
         if ( ret != SQLITE_OK ) {
-                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "%s", sqlite3_errmsg(*session));
-                sqlite3_close(*session);
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "error loading schema '%s': %s", filename, errmsg ? errmsg : sqlite3_errmsg(db));
+                sqlite3_free(errmsg);
+                goto out;
+        }
+
+        ret = 0;
+
+ out:
+        free(buf);
+        fclose(fd);
+
+        return ret;
+}
+
+
+
+static int get_database_file(preludedb_sql_settings_t *settings, const char **dbfile)
+{
+        *dbfile = ":memory:";
+        return 0;
+}
+#else
+static int get_database_file(preludedb_sql_settings_t *settings, const char **dbfile)
+{
+        int ret;
+
+        *dbfile = preludedb_sql_settings_get_file(settings);
+        if ( ! *dbfile || ! **dbfile )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "no database file specified");
+
+        ret = access(*dbfile, F_OK);
+        if ( ret != 0 )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_CONNECTION, "database file '%s' does not exist", *dbfile);
+
+        return 0;
+}
+#endif
+
+
+
+static int sql_open(preludedb_sql_settings_t *settings, void **session)
+{
+        int ret;
+        const char *dbfile;
+        sqlite_session_t *new;
+
+        ret = get_database_file(settings, &dbfile);
+        if ( ret < 0 )
                 return ret;
+
+        new = calloc(1, sizeof(*new));
+        if ( ! new )
+                return preludedb_error_from_errno(errno);
+
+        gl_lock_init(new->readers_lock);
+
+        new->dbfile = strdup(dbfile);
+        if ( ! new->dbfile ) {
+                ret = preludedb_error_from_errno(errno);
+                goto error;
+        }
+
+        ret = open_connection(dbfile, FALSE, &new->writer);
+        if ( ret < 0 ) {
+                new->writer = NULL;
+                goto error;
+        }
+
+#ifdef SQLITE_MEMORY_PLUGIN
+        {
+                const char *schema = preludedb_sql_settings_get(settings, SQLITE_SETTING_SCHEMA);
+
+                ret = load_schema(new->writer, (schema) ? schema : SQLITE_DEFAULT_SCHEMA);
+                if ( ret < 0 )
+                        goto error;
         }
+#endif
 
-        sqlite3_busy_timeout(*session, SQLITE_BUSY_TIMEOUT);
+        new->max_readers = get_max_readers(settings);
+        if ( new->max_readers > 0 && ! enable_wal(new->writer) ) {
+                prelude_log(PRELUDE_LOG_WARN, "could not enable WAL journaling on '%s': read-only connections disabled.\n", dbfile);
+                new->max_readers = 0;
+        }
+
+        if ( new->max_readers > 0 ) {
+                new->readers = calloc(new->max_readers, sizeof(*new->readers));
+                if ( ! new->readers ) {
+                        ret = preludedb_error_from_errno(errno);
+                        goto error;
+                }
+        }
+
+        *session = new;
 
         return 0;
+
+ error:
+        session_destroy(new);
+        return ret;
 }
 
 
 
 static void sql_close(void *session)
 {
-        sqlite3_close(session);
+        session_destroy(session);
+}
+
+
+
+/*
+ * Return a free read-only connection, opening a new one if the pool
+ * is not yet full. NULL is returned when the caller should fallback
+ * to the writer connection.
+ */
+static sqlite3 *reader_acquire(sqlite_session_t *session)
+{
+        int ret;
+        unsigned int i;
+        sqlite3 *db = NULL;
+
+        if ( session->max_readers == 0 )
+                return NULL;
+
+        gl_lock_lock(session->readers_lock);
+
+        for ( i = 0; i < session->nreaders; i++ ) {
+                if ( ! session->readers[i].busy ) {
+                        session->readers[i].busy = TRUE;
+                        db = session->readers[i].db;
+                        goto out;
+                }
+        }
+
+        if ( session->nreaders == session->max_readers )
+                goto out;
+
+        ret = open_connection(session->dbfile, TRUE, &db);
+        if ( ret < 0 ) {
+                prelude_log(PRELUDE_LOG_WARN, "could not open read-only connection: %s.\n", preludedb_strerror(ret));
+                db = NULL;
+                goto out;
+        }
+
+        session->readers[session->nreaders].db = db;
+        session->readers[session->nreaders].busy = TRUE;
+        session->nreaders++;
+
+ out:
+        gl_lock_unlock(session->readers_lock);
+
+        return db;
+}
+
+
+
+static void reader_release(sqlite_session_t *session, sqlite3 *db)
+{
+        unsigned int i;
+
+        if ( db == session->writer )
+                return;
+
+        gl_lock_lock(session->readers_lock);
+
+        for ( i = 0; i < session->nreaders; i++ ) {
+                if ( session->readers[i].db == db ) {
+                        session->readers[i].busy = FALSE;
+                        break;
+                }
+        }
+
+        gl_lock_unlock(session->readers_lock);
 }
 
 
@@ -170,29 +502,181 @@ static int sql_build_limit_offset_string(void *session, int limit, int offset, p
 
 
 
-static int sql_table_field_copy(preludedb_sql_row_t *row, sqlite3_stmt *statement, unsigned int col)
+static int sql_build_optimize_string(void *session, const char *table, preludedb_sql_optimize_flags_t flag, prelude_string_t *output)
 {
-        char *data = NULL;
-        preludedb_sql_field_t *field;
-        size_t len;
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_ANALYZE ) {
+                if ( table )
+                        return prelude_string_sprintf(output, "ANALYZE %s", table);
+
+                /*
+                 * PRAGMA optimize (SQLite >= 3.18.0) analyzes the tables
+                 * the query planner found lacking statistics.
+                 */
+                if ( sqlite3_libversion_number() >= 3018000 )
+                        return prelude_string_cat(output, "PRAGMA optimize");
+
+                return 0;
+        }
+
+        /*
+         * Free pages can only be released database wide, and only when
+         * the database uses auto_vacuum=INCREMENTAL. A full VACUUM rewrites
+         * the whole file and is left to the administrator.
+         */
+        if ( flag == PRELUDEDB_SQL_OPTIMIZE_RECLAIM && ! table )
+                return prelude_string_cat(output, "PRAGMA incremental_vacuum");
 
-        len = sqlite3_column_bytes(statement, col);
-        if ( len ) {
-                if ( len + 1 < len )
+        return 0;
+}
+
+
+
+static int sql_build_create_index_string(void *session, const char *name, const char *table, const char *columns,
+                                         const char *partial_column, const char *partial_value, prelude_string_t *output)
+{
+        int ret;
+
+        /*
+         * Partial indexes are available since SQLite 3.8.0.
+         */
+        if ( partial_column && sqlite3_libversion_number() < 3008000 )
+                return prelude_string_sprintf(output, "CREATE INDEX %s ON %s (%s, %s)", name, table, partial_column, columns);
+
+        ret = prelude_string_sprintf(output, "CREATE INDEX %s ON %s (%s)", name, table, columns);
+        if ( ret < 0 || ! partial_column )
+                return ret;
+
+        return prelude_string_sprintf(output, " WHERE %s = %s", partial_column, partial_value);
+}
+
+
+
+static int sql_build_upsert_string(void *session, const char *table, const char *fields, const char *values, const char *key,
+                                   const char * const *columns, size_t size, prelude_string_t *output)
+{
+        int ret;
+        size_t i;
+
+        /*
+         * UPSERT is available since SQLite 3.24.0. Earlier versions
+         * replace the whole conflicting row, which only differs for
+         * columns missing from @fields.
+         */
+        if ( sqlite3_libversion_number() < 3024000 )
+                return prelude_string_sprintf(output, "INSERT OR %s INTO %s (%s) VALUES(%s)",
+                                              (size == 0) ? "IGNORE" : "REPLACE", table, fields, values);
+
+        ret = prelude_string_sprintf(output, "INSERT INTO %s (%s) VALUES(%s) ON CONFLICT (%s) ", table, fields, values, key);
+        if ( ret < 0 )
+                return ret;
+
+        if ( size == 0 )
+                return prelude_string_cat(output, "DO NOTHING");
+
+        ret = prelude_string_cat(output, "DO UPDATE SET ");
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < size; i++ ) {
+                ret = prelude_string_sprintf(output, "%s%s = excluded.%s", (i > 0) ? ", " : "", columns[i], columns[i]);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int copy_value(sqlite3_stmt *statement, unsigned int col, char **data, size_t *len)
+{
+        *data = NULL;
+        *len = sqlite3_column_bytes(statement, col);
+
+        if ( *len ) {
+                if ( *len + 1 < *len )
                         return -1;
 
-                data = malloc(len + 1);
-                if ( ! data )
+                *data = malloc(*len + 1);
+                if ( ! *data )
                         return preludedb_error_from_errno(errno);
 
-                memcpy(data, sqlite3_column_blob(statement, col), len);
-                data[len] = '\0';
+                memcpy(*data, sqlite3_column_blob(statement, col), *len);
+                (*data)[*len] = '\0';
+        }
+
+        return 0;
+}
+
+
+
+static void result_finish(sqlite_result_t *result)
+{
+        if ( ! result->statement )
+                return;
+
+        sqlite3_finalize(result->statement);
+        result->statement = NULL;
+
+        reader_release(result->session, result->db);
+}
+
+
+
+static void result_destroy(sqlite_result_t *result)
+{
+        unsigned int i;
+
+        result_finish(result);
+
+        for ( i = 0; i < result->ncolumns; i++ )
+                free(result->names[i]);
+
+        free(result->names);
+        free(result);
+}
+
+
+
+/*
+ * @result takes @statement, and the connection @db it runs on, over.
+ */
+static int result_new(sqlite_result_t **result, sqlite_session_t *session, sqlite3 *db, sqlite3_stmt *statement)
+{
+        unsigned int i;
+
+        *result = calloc(1, sizeof(**result));
+        if ( ! *result ) {
+                sqlite3_finalize(statement);
+                reader_release(session, db);
+                return preludedb_error_from_errno(errno);
+        }
+
+        (*result)->session = session;
+        (*result)->db = db;
+        (*result)->statement = statement;
+        (*result)->ncolumns = sqlite3_column_count(statement);
+
+        (*result)->names = calloc((*result)->ncolumns, sizeof(*(*result)->names));
+        if ( ! (*result)->names ) {
+                (*result)->ncolumns = 0;
+                result_destroy(*result);
+                return preludedb_error_from_errno(errno);
+        }
+
+        for ( i = 0; i < (*result)->ncolumns; i++ ) {
+                (*result)->names[i] = strdup(sqlite3_column_name(statement, i));
+                if ( ! (*result)->names[i] ) {
+                        result_destroy(*result);
+                        return preludedb_error_from_errno(errno);
+                }
         }
 
-        return preludedb_sql_row_new_field(row, &field, col, data, len);
+        return 0;
 }
 
 
+
 static void sql_field_destroy(void *session, preludedb_sql_table_t *table, preludedb_sql_row_t *row, preludedb_sql_field_t *field)
 {
         free(preludedb_sql_field_get_value(field));
@@ -201,37 +685,71 @@ static void sql_field_destroy(void *session, preludedb_sql_table_t *table, prelu
 
 static void sql_table_destroy(void *session, preludedb_sql_table_t *table)
 {
-        sqlite3_finalize(preludedb_sql_table_get_data(table));
+        result_destroy(preludedb_sql_table_get_data(table));
 }
 
 
 static int sql_query(void *session, const char *query, preludedb_sql_table_t **table)
 {
         int ret;
+        sqlite3 *db = NULL;
         sqlite3_stmt *statement;
+        sqlite_result_t *result;
         const char *unparsed = NULL;
+        sqlite_session_t *s = session;
 
         /*
          * FIXME: we need a better way to know the kind of operation performed.
          */
         if ( strncasecmp(query, "SELECT", 6) != 0 ) {
-
-                ret = sqlite3_exec(session, query, NULL, NULL, 0);
+                /*
+                 * A deferred transaction that reads before writing fails
+                 * with SQLITE_BUSY, which the busy timeout does not retry,
+                 * when another one wrote in the meantime. Taking the write
+                 * lock upfront makes concurrent sessions wait on the busy
+                 * timeout instead.
+                 */
+                if ( strcasecmp(query, "BEGIN") == 0 )
+                        query = "BEGIN IMMEDIATE";
+
+                ret = sqlite3_exec(s->writer, query, NULL, NULL, 0);
                 if ( ret != SQLITE_OK )
-                        return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, sqlite3_errmsg(session));
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s", sqlite3_errmsg(s->writer));
 
         } else {
-                ret = sqlite3_prepare(session, query, strlen(query), &statement, &unparsed);
-                if ( ret != SQLITE_OK )
-                        return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, sqlite3_errmsg(session));
+                /*
+                 * Within a transaction, the SELECT must see the uncommitted
+                 * changes, thus only the writer connection can be used.
+                 */
+                if ( sqlite3_get_autocommit(s->writer) )
+                        db = reader_acquire(s);
+
+                if ( ! db )
+                        db = s->writer;
+
+                ret = sqlite3_prepare(db, query, strlen(query), &statement, &unparsed);
+                if ( ret != SQLITE_OK ) {
+                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s", sqlite3_errmsg(db));
+                        reader_release(s, db);
+                        return ret;
+                }
 
-                if ( sqlite3_column_count(statement) == 0 )
+                if ( sqlite3_column_count(statement) == 0 ) {
+                        sqlite3_finalize(statement);
+                        reader_release(s, db);
                         return 0;
+                }
 
-                ret = preludedb_sql_table_new(table, statement);
+                ret = result_new(&result, s, db, statement);
                 if ( ret < 0 )
                         return ret;
 
+                ret = preludedb_sql_table_new(table, result);
+                if ( ret < 0 ) {
+                        result_destroy(result);
+                        return ret;
+                }
+
                 ret = 1;
         }
 
@@ -242,10 +760,12 @@ static int sql_query(void *session, const char *query, preludedb_sql_table_t **t
 
 static const char *sql_get_column_name(void *session, preludedb_sql_table_t *table, unsigned int column_num)
 {
-        if ( column_num >= preludedb_sql_table_get_column_count(table) )
+        sqlite_result_t *result = preludedb_sql_table_get_data(table);
+
+        if ( column_num >= result->ncolumns )
                 return NULL;
 
-        return sqlite3_column_name(preludedb_sql_table_get_data(table), column_num);
+        return result->names[column_num];
 }
 
 
@@ -253,9 +773,10 @@ static int sql_get_column_num(void *session, preludedb_sql_table_t *table, const
 {
         int ret;
         unsigned int i;
+        sqlite_result_t *result = preludedb_sql_table_get_data(table);
 
-        for ( i = 0; i < preludedb_sql_table_get_column_count(table); i++ ) {
-                ret = strcmp(column_name, sqlite3_column_name(preludedb_sql_table_get_data(table), i));
+        for ( i = 0; i < result->ncolumns; i++ ) {
+                ret = strcmp(column_name, result->names[i]);
                 if ( ret == 0 )
                         return i;
         }
@@ -267,23 +788,34 @@ static int sql_get_column_num(void *session, preludedb_sql_table_t *table, const
 
 static unsigned int sql_get_column_count(void *session, preludedb_sql_table_t *table)
 {
-        return sqlite3_column_count(preludedb_sql_table_get_data(table));
+        sqlite_result_t *result = preludedb_sql_table_get_data(table);
+
+        return result->ncolumns;
 }
 
 
 
 static int sql_fetch_row(void *session, preludedb_sql_table_t *table, unsigned int row_index, preludedb_sql_row_t **row)
 {
-        int ret, i;
-        sqlite3_stmt *statement = preludedb_sql_table_get_data(table);
+        int ret;
+        size_t len;
+        char *data;
+        unsigned int i;
+        preludedb_sql_field_t *field;
+        sqlite_result_t *result = preludedb_sql_table_get_data(table);
 
         while ( preludedb_sql_table_get_fetched_row_count(table) <= row_index ) {
-                ret = sqlite3_step(statement);
+                if ( ! result->statement )
+                        return 0;
+
+                ret = sqlite3_step(result->statement);
                 if ( ret == SQLITE_ERROR || ret == SQLITE_MISUSE || ret == SQLITE_BUSY )
-                        return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s", sqlite3_errmsg(session));
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s", sqlite3_errmsg(result->db));
 
-                else if ( ret == SQLITE_DONE )
+                else if ( ret == SQLITE_DONE ) {
+                        result_finish(result);
                         return 0;
+                }
 
                 assert(ret == SQLITE_ROW);
 
@@ -291,10 +823,16 @@ static int sql_fetch_row(void *session, preludedb_sql_table_t *table, unsigned i
                 if ( ret < 0 )
                         return ret;
 
-                for ( i = 0; i < sqlite3_column_count(statement); i++ ) {
-                        ret = sql_table_field_copy(*row, statement, i);
+                for ( i = 0; i < result->ncolumns; i++ ) {
+                        ret = copy_value(result->statement, i, &data, &len);
                         if ( ret < 0 )
                                 return preludedb_error_from_errno(errno);
+
+                        ret = preludedb_sql_row_new_field(*row, &field, i, data, len);
+                        if ( ret < 0 ) {
+                                free(data);
+                                return ret;
+                        }
                 }
         }
 
@@ -484,7 +1022,7 @@ static long sql_get_server_version(void *session)
 
 
 
-int sqlite3_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
+int SQLITE_PLUGIN_SYMBOL(preludedb_plugin_init)(prelude_plugin_entry_t *pe, void *data)
 {
         int ret;
         preludedb_plugin_sql_t *plugin;
@@ -493,7 +1031,7 @@ int sqlite3_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         if ( ret < 0 )
                 return ret;
 
-        prelude_plugin_set_name((prelude_plugin_generic_t *) plugin, "sqlite3");
+        prelude_plugin_set_name((prelude_plugin_generic_t *) plugin, SQLITE_PLUGIN_NAME);
         prelude_plugin_entry_set_plugin(pe, (void *) plugin);
 
         preludedb_plugin_sql_set_open_func(plugin, sql_open);
@@ -513,13 +1051,25 @@ int sqlite3_LTX_preludedb_plugin_init(prelude_plugin_entry_t *pe, void *data)
         preludedb_plugin_sql_set_build_time_constraint_string_func(plugin, sql_build_time_constraint_string);
         preludedb_plugin_sql_set_build_time_interval_string_func(plugin, sql_build_time_interval_string);
         preludedb_plugin_sql_set_build_limit_offset_string_func(plugin, sql_build_limit_offset_string);
+        preludedb_plugin_sql_set_build_optimize_string_func(plugin, sql_build_optimize_string);
+        preludedb_plugin_sql_set_build_create_index_string_func(plugin, sql_build_create_index_string);
+        preludedb_plugin_sql_set_build_upsert_string_func(plugin, sql_build_upsert_string);
+
+#ifdef SQLITE_MEMORY_PLUGIN
+        /*
+         * Each connection to a memory database opens a new database.
+         */
+        preludedb_plugin_sql_set_max_sessions(plugin, 1);
+#endif
+
+        preludedb_plugin_sql_set_escape_flags(plugin, PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY);
 
         return 0;
 }
 
 
 
-int sqlite3_LTX_prelude_plugin_version(void)
+int SQLITE_PLUGIN_SYMBOL(prelude_plugin_version)(void)
 {
         return PRELUDE_PLUGIN_API_VERSION;
 }
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <errno.h>
 
 #include <libprelude/idmef.h>
 #include <libprelude/prelude.h>
@@ -50,6 +51,9 @@ static sig_atomic_t stop_processing = 0;
 static const char *query_logging = NULL;
 static prelude_bool_t delete_run_optimize = FALSE;
 static prelude_bool_t have_query_logging = FALSE;
+static prelude_bool_t have_query_statistics = FALSE;
+static prelude_bool_t advisor_create = FALSE;
+static unsigned int advisor_max_indexes = 5;
 
 static uint64_t cur_count = 0;
 static int64_t limit = -1, offset = 0, offset_copy, limit_copy = -1;
@@ -343,6 +347,13 @@ static int set_query_logging(prelude_option_t *opt, const char *optarg, prelude_
 }
 
 
+static int set_query_statistics(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        have_query_statistics = TRUE;
+        return 0;
+}
+
+
 static int set_count(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
 {
         limit = strtoll(optarg, NULL, 0);
@@ -379,6 +390,20 @@ static int set_events_per_transaction(prelude_option_t *opt, const char *optarg,
 }
 
 
+static int set_advisor_create(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        advisor_create = TRUE;
+        return 0;
+}
+
+
+static int set_advisor_max_indexes(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        advisor_max_indexes = strtoul(optarg, NULL, 0);
+        return 0;
+}
+
+
 static int set_help(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
 {
         return prelude_error(PRELUDE_ERROR_EOF);
@@ -401,6 +426,7 @@ static void cmd_generic_help(void)
         fprintf(stderr, "  --offset <offset>               : Skip processing until 'offset' events.\n");
         fprintf(stderr, "  --count <count>                 : Process at most count events.\n");
         fprintf(stderr, "  --query-logging [filename]      : Log SQL query to the specified file.\n");
+        fprintf(stderr, "  --query-statistics              : Dump per query statistics on exit.\n");
         fprintf(stderr, "  --criteria <criteria>           : Only process events matching criteria.\n");
         fprintf(stderr, "  --events-per-transaction        : Maximum number of event to process per transaction (default %d).\n",
                 events_per_transaction);
@@ -427,13 +453,30 @@ static void cmd_optimize_help(void)
         fprintf(stderr, "Usage  : optimize <database>\n");
         fprintf(stderr, "Example: preludedb-admin optimize \"type=mysql name=dbname user=prelude\"\n\n");
 
-        fprintf(stderr, "Perform optimization operation on <database>.\n\n");
+        fprintf(stderr, "Perform optimization operation on <database>.\n");
+        fprintf(stderr, "Addresses stored before schema 14.8 are packed first, in batches.\n");
+        fprintf(stderr, "Set optimize_budget=<seconds> in <database> to stop starting new tables once the budget is spent.\n\n");
 
         cmd_generic_help();
 }
 
 
 
+static void cmd_index_advisor_help(void)
+{
+        fprintf(stderr, "Usage  : index-advisor <database> <workload> [options]\n");
+        fprintf(stderr, "Example: preludedb-admin index-advisor \"type=pgsql name=dbname user=prelude\" workload.txt --create\n\n");
+
+        fprintf(stderr, "Run the criteria listed in <workload>, one per line, against <database>, and\n");
+        fprintf(stderr, "recommend indexes for the most frequent criteria shapes.\n\n");
+
+        cmd_generic_help();
+        fprintf(stderr, "  --create                        : Create the recommended indexes, and run <workload> again.\n");
+        fprintf(stderr, "  --max-indexes <count>           : Recommend at most count indexes (default %u).\n", advisor_max_indexes);
+}
+
+
+
 static void cmd_save_help(void)
 {
         fprintf(stderr, "Usage  : save <alert|heartbeat> <database> [filename] [options]\n");
@@ -498,7 +541,7 @@ static void cmd_count_help(void)
 
 static void print_help(char **argv)
 {
-        fprintf(stderr, "Usage: %s <count|copy|delete|load|move|print|save|optimize> <arguments>\n\n", argv[0]);
+        fprintf(stderr, "Usage: %s <count|copy|delete|load|move|print|save|optimize|index-advisor> <arguments>\n\n", argv[0]);
 
         fprintf(stderr, "\tcount    - Retrieve event count from the database.\n");
         fprintf(stderr, "\tcopy     - Make a copy of a Prelude database to another database.\n");
@@ -507,7 +550,8 @@ static void print_help(char **argv)
         fprintf(stderr, "\tmove     - Move content of a Prelude database to another database.\n");
         fprintf(stderr, "\tprint    - Print message from a Prelude database.\n");
         fprintf(stderr, "\tsave     - Save a Prelude database to a file.\n");
-        fprintf(stderr, "\toptimize - Optimize a Prelude database.\n\n");
+        fprintf(stderr, "\toptimize - Optimize a Prelude database.\n");
+        fprintf(stderr, "\tindex-advisor - Recommend indexes for a query workload.\n\n");
 }
 
 
@@ -528,6 +572,9 @@ static int setup_generic_options(int *argc, char **argv)
         prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, "query-logging",
                            NULL, PRELUDE_OPTION_ARGUMENT_OPTIONAL, set_query_logging, NULL);
 
+        prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, "query-statistics",
+                           NULL, PRELUDE_OPTION_ARGUMENT_NONE, set_query_statistics, NULL);
+
         prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, "criteria",
                            NULL, PRELUDE_OPTION_ARGUMENT_REQUIRED, set_criteria, NULL);
 
@@ -601,11 +648,43 @@ static int db_new_from_string(preludedb_t **db, const char *str)
         if ( have_query_logging )
                 preludedb_sql_enable_query_logging(sql, query_logging);
 
+        if ( have_query_statistics ) {
+                ret = preludedb_sql_enable_statistics(sql);
+                if ( ret < 0 )
+                        fprintf(stderr, "could not enable query statistics: %s.\n", preludedb_strerror(ret));
+        }
+
         return 0;
 }
 
 
 
+static void db_destroy(preludedb_t *db)
+{
+        int ret;
+        prelude_string_t *out;
+
+        if ( ! have_query_statistics )
+                goto out;
+
+        ret = prelude_string_new(&out);
+        if ( ret < 0 )
+                goto out;
+
+        ret = preludedb_sql_get_statistics_string(preludedb_get_sql(db), out);
+        if ( ret < 0 )
+                fprintf(stderr, "could not retrieve query statistics: %s.\n", preludedb_strerror(ret));
+        else
+                fprintf(stderr, "\nQuery statistics:\n%s", prelude_string_get_string_or_default(out, ""));
+
+        prelude_string_destroy(out);
+
+ out:
+        preludedb_destroy(db);
+}
+
+
+
 static int do_delete(preludedb_t *db, preludedb_result_idents_t *idents,
                      ssize_t (*dfunc)(preludedb_t *db, preludedb_result_idents_t *idents),
                      stat_item_t *stat_delete)
@@ -733,8 +812,8 @@ static int do_cmd_copy_move(int argc, char **argv, prelude_bool_t delete_copied)
 
         transaction_end(dst, ret, dst_event_no);
 
-        preludedb_destroy(src);
-        preludedb_destroy(dst);
+        db_destroy(src);
+        db_destroy(dst);
 
         return ret;
 }
@@ -818,7 +897,7 @@ static int cmd_delete(int argc, char **argv)
                 }
         }
 
-        preludedb_destroy(db);
+        db_destroy(db);
         return ret;
 }
 
@@ -844,12 +923,200 @@ static int cmd_optimize(int argc, char **argv)
         if ( ret < 0 )
                 db_error(db, ret, "error running optimize");
 
-        preludedb_destroy(db);
+        db_destroy(db);
+        return ret;
+}
+
+
+
+
+static int run_workload_criteria(preludedb_t *db, idmef_criteria_t *wcriteria, stat_item_t *stat)
+{
+        int ret;
+        idmef_criterion_t *criterion;
+        preludedb_result_idents_t *result;
+        int (*get_idents)(preludedb_t *db, idmef_criteria_t *criteria, int limit, int offset,
+                          preludedb_result_idents_order_t order, preludedb_result_idents_t **result);
+
+        criterion = idmef_criteria_get_criterion(wcriteria);
+        if ( idmef_path_get_class(idmef_criterion_get_path(criterion), 0) == IDMEF_CLASS_ID_HEARTBEAT )
+                get_idents = preludedb_get_heartbeat_idents;
+        else
+                get_idents = preludedb_get_alert_idents;
+
+        stat_compute(stat, ret = get_idents(db, wcriteria, (int) limit, (int) offset, 0, &result), 1);
+        if ( ret < 0 )
+                return db_error(db, ret, "error running workload criteria");
+
+        if ( ret > 0 )
+                preludedb_result_idents_destroy(result);
+
+        return 0;
+}
+
+
+
+static int run_workload(preludedb_t *db, const char *filename, stat_item_t *stat)
+{
+        FILE *fd;
+        int ret = 0;
+        size_t len;
+        char buf[8192];
+        unsigned int line = 0;
+        idmef_criteria_t *wcriteria;
+
+        fd = fopen(filename, "r");
+        if ( ! fd ) {
+                fprintf(stderr, "could not open workload '%s': %s.\n", filename, strerror(errno));
+                return -1;
+        }
+
+        while ( ! stop_processing && fgets(buf, sizeof(buf), fd) ) {
+                line++;
+
+                len = strcspn(buf, "\r\n");
+                buf[len] = 0;
+
+                if ( len == 0 || *buf == '#' )
+                        continue;
+
+                ret = idmef_criteria_new_from_string(&wcriteria, buf);
+                if ( ret < 0 ) {
+                        fprintf(stderr, "%s:%u: invalid criteria: %s.\n", filename, line, prelude_strerror(ret));
+                        break;
+                }
+
+                ret = run_workload_criteria(db, wcriteria, stat);
+                idmef_criteria_destroy(wcriteria);
+
+                if ( ret < 0 )
+                        break;
+        }
+
+        fclose(fd);
+
         return ret;
 }
 
 
 
+static int create_advised_indexes(preludedb_t *db, const char *advice)
+{
+        int ret;
+        preludedb_sql_table_t *res;
+        char *ptr, *copy, *statement, *end;
+
+        copy = strdup(advice);
+        if ( ! copy )
+                return prelude_error_from_errno(errno);
+
+        ptr = copy;
+        while ( (statement = strsep(&ptr, "\n")) ) {
+                if ( ! *statement || strncmp(statement, "--", 2) == 0 )
+                        continue;
+
+                end = strrchr(statement, ';');
+                if ( end )
+                        *end = 0;
+
+                /*
+                 * Indexes are created one at a time, and a failure, such as
+                 * an index left over from a previous run, does not prevent
+                 * the others from being created.
+                 */
+                ret = preludedb_sql_query(preludedb_get_sql(db), statement, &res);
+                if ( ret < 0 ) {
+                        db_error(db, ret, "error creating index '%s'", statement);
+                        continue;
+                }
+
+                if ( ret > 0 )
+                        preludedb_sql_table_destroy(res);
+
+                fprintf(stderr, "Created: %s\n", statement);
+        }
+
+        free(copy);
+
+        return 0;
+}
+
+
+
+static int cmd_index_advisor(int argc, char **argv)
+{
+        int ret, idx;
+        preludedb_t *db;
+        prelude_string_t *advice;
+        stat_item_t *before, *after;
+
+        prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, "create",
+                           NULL, PRELUDE_OPTION_ARGUMENT_NONE, set_advisor_create, NULL);
+
+        prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, "max-indexes",
+                           NULL, PRELUDE_OPTION_ARGUMENT_REQUIRED, set_advisor_max_indexes, NULL);
+
+        idx = setup_generic_options(&argc, argv);
+        if ( idx < 0 || argc != 3 ) {
+                cmd_index_advisor_help();
+                exit(1);
+        }
+
+        ret = db_new_from_string(&db, argv[idx]);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_new(&advice);
+        if ( ret < 0 ) {
+                db_destroy(db);
+                return ret;
+        }
+
+        before = stat_item_new("workload query");
+
+        ret = run_workload(db, argv[idx + 1], before);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_get_index_advice(db, advisor_max_indexes, advice);
+        if ( ret < 0 ) {
+                db_error(db, ret, "error retrieving index advice");
+                goto error;
+        }
+
+        if ( ret == 0 ) {
+                fprintf(stderr, "No index to recommend for this workload.\n");
+                goto error;
+        }
+
+        printf("%s", prelude_string_get_string(advice));
+
+        if ( ! advisor_create )
+                goto error;
+
+        ret = create_advised_indexes(db, prelude_string_get_string(advice));
+        if ( ret < 0 )
+                goto error;
+
+        after = stat_item_new("workload query with advised indexes");
+
+        ret = run_workload(db, argv[idx + 1], after);
+        if ( ret < 0 )
+                goto error;
+
+        if ( before->processed && after->processed )
+                fprintf(stderr, "Average workload query latency: %f seconds before, %f seconds after.\n",
+                        before->elapsed / before->processed, after->elapsed / after->processed);
+
+ error:
+        prelude_string_destroy(advice);
+        db_destroy(db);
+
+        return (ret < 0) ? ret : 0;
+}
+
+
+
 
 static int save_msg(prelude_msgbuf_t *msgbuf, prelude_msg_t *msg)
 {
@@ -959,7 +1226,7 @@ static int cmd_save(int argc, char **argv)
         if ( fd != stdout )
                 prelude_io_close(io);
 
-        preludedb_destroy(db);
+        db_destroy(db);
 
         return ret;
 }
@@ -1104,7 +1371,7 @@ static int cmd_load(int argc, char **argv)
         transaction_end(db, ret, event_no);
 
         prelude_io_destroy(io);
-        preludedb_destroy(db);
+        db_destroy(db);
 
         return ret;
 }
@@ -1190,7 +1457,7 @@ static int cmd_print(int argc, char **argv)
                 prelude_io_close(io);
 
         prelude_io_destroy(io);
-        preludedb_destroy(db);
+        db_destroy(db);
 
         return ret;
 }
@@ -1228,13 +1495,13 @@ static int cmd_count(int argc, char **argv)
 
         ret = preludedb_path_selection_new(db, &ps);
         if ( ret < 0 ) {
-                preludedb_destroy(db);
+                db_destroy(db);
                 return ret;
         }
 
         ret = preludedb_selected_path_new_string(&sp, buf);
         if ( ret < 0 ) {
-                preludedb_destroy(db);
+                db_destroy(db);
                 preludedb_path_selection_destroy(ps);
                 return ret;
         }
@@ -1265,7 +1532,7 @@ err:
         if ( results )
                 preludedb_result_values_destroy(results);
 
-        preludedb_destroy(db);
+        db_destroy(db);
 
         return ret;
 }
@@ -1352,7 +1619,7 @@ static int cmd_update(int argc, char **argv)
         }
 
 err:
-        preludedb_destroy(db);
+        db_destroy(db);
         return ret;
 }
 
@@ -1375,6 +1642,7 @@ int main(int argc, char **argv)
                 { "save", cmd_save         },
                 { "update", cmd_update     },
                 { "optimize", cmd_optimize },
+                { "index-advisor", cmd_index_advisor },
         };
 
         signal(SIGINT, handle_signal);
@@ -0,0 +1,662 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <libprelude/idmef.h>
+#include <libprelude/prelude.h>
+
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+#include "preludedb-error.h"
+#include "preludedb-path-selection.h"
+#include "preludedb.h"
+
+
+#define DEFAULT_ALERT_COUNT 1000
+#define DEFAULT_QUERY_COUNT 100
+#define DEFAULT_EVENTS_PER_TRANSACTION 100
+#define DELETE_BATCH_SIZE 100
+
+
+/*
+ * Synthetic alert shape, see --sources, --targets, --additional-data and --files.
+ */
+static unsigned int alert_count = DEFAULT_ALERT_COUNT;
+static unsigned int query_count = DEFAULT_QUERY_COUNT;
+static unsigned int events_per_transaction = DEFAULT_EVENTS_PER_TRANSACTION;
+static unsigned int source_count = 1, target_count = 1, additional_data_count = 2, file_count = 0;
+
+static FILE *output = NULL;
+
+
+typedef struct {
+        const char *opname;
+        size_t processed;
+        double elapsed;
+
+        size_t nsample;
+        size_t sample_size;
+        double *samples;
+} bench_stat_t;
+
+
+
+static double timeval_diff(struct timeval *end, struct timeval *start)
+{
+        return (end->tv_sec - start->tv_sec) + (double) (end->tv_usec - start->tv_usec) / 1000000;
+}
+
+
+
+static int bench_stat_add_sample(bench_stat_t *stat, double elapsed, size_t processed)
+{
+        double *ptr;
+
+        stat->elapsed += elapsed;
+        stat->processed += processed;
+
+        if ( stat->nsample == stat->sample_size ) {
+                ptr = realloc(stat->samples, (stat->sample_size + 1024) * sizeof(*stat->samples));
+                if ( ! ptr )
+                        return prelude_error_from_errno(errno);
+
+                stat->samples = ptr;
+                stat->sample_size += 1024;
+        }
+
+        stat->samples[stat->nsample++] = elapsed;
+
+        return 0;
+}
+
+
+
+static int cmp_double(const void *a, const void *b)
+{
+        double x = *(const double *) a, y = *(const double *) b;
+        return (x > y) - (x < y);
+}
+
+
+
+static double bench_stat_percentile(bench_stat_t *stat, unsigned int percentile)
+{
+        size_t idx;
+
+        if ( ! stat->nsample )
+                return 0;
+
+        idx = (stat->nsample * percentile) / 100;
+        if ( idx >= stat->nsample )
+                idx = stat->nsample - 1;
+
+        return stat->samples[idx];
+}
+
+
+
+/*
+ * One JSON object per line, so that results can be appended to a file
+ * and processed by regression tracking tools.
+ */
+static void bench_stat_dump(bench_stat_t *stat, const char *dbstr, const char *type)
+{
+        qsort(stat->samples, stat->nsample, sizeof(*stat->samples), cmp_double);
+
+        fprintf(output, "{\"database\": \"%s\", \"operation\": \"%s\", \"processed\": %" PRELUDE_PRIu64 ", "
+                "\"elapsed\": %f, \"rate\": %f, \"p50\": %f, \"p90\": %f, \"p99\": %f}\n",
+                type, stat->opname, (uint64_t) stat->processed, stat->elapsed,
+                (stat->elapsed > 0) ? stat->processed / stat->elapsed : 0,
+                bench_stat_percentile(stat, 50), bench_stat_percentile(stat, 90), bench_stat_percentile(stat, 99));
+
+        fflush(output);
+
+        fprintf(stderr, "%s: %" PRELUDE_PRIu64 " '%s' processed in %f seconds (%f/sec, p50=%fs p99=%fs).\n",
+                dbstr, (uint64_t) stat->processed, stat->opname, stat->elapsed,
+                (stat->elapsed > 0) ? stat->processed / stat->elapsed : 0,
+                bench_stat_percentile(stat, 50), bench_stat_percentile(stat, 99));
+
+        free(stat->samples);
+        stat->samples = NULL;
+        stat->nsample = stat->sample_size = 0;
+}
+
+
+
+static int set_path(idmef_message_t *msg, const char *value, const char *fmt, ...)
+{
+        int ret;
+        va_list ap;
+        char buf[256];
+
+        va_start(ap, fmt);
+        ret = vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+
+        if ( ret < 0 || (size_t) ret >= sizeof(buf) )
+                return prelude_error(PRELUDE_ERROR_GENERIC);
+
+        return idmef_message_set_string(msg, buf, value);
+}
+
+
+
+static int generate_alert(idmef_message_t **msg, unsigned int seq)
+{
+        int ret;
+        char buf[64];
+        unsigned int i, j;
+        static const char *severities[] = { "info", "low", "medium", "high" };
+
+        ret = idmef_message_new(msg);
+        if ( ret < 0 )
+                return ret;
+
+        snprintf(buf, sizeof(buf), "bench-%u", seq);
+        ret = set_path(*msg, buf, "alert.messageid");
+        if ( ret < 0 )
+                goto error;
+
+        ret = set_path(*msg, "preludedb-bench", "alert.analyzer(0).name");
+        if ( ret < 0 )
+                goto error;
+
+        ret = set_path(*msg, "1234567890", "alert.analyzer(0).analyzerid");
+        if ( ret < 0 )
+                goto error;
+
+        ret = set_path(*msg, "bench-host", "alert.analyzer(0).node.name");
+        if ( ret < 0 )
+                goto error;
+
+        snprintf(buf, sizeof(buf), "Synthetic classification %u", seq % 32);
+        ret = set_path(*msg, buf, "alert.classification.text");
+        if ( ret < 0 )
+                goto error;
+
+        ret = set_path(*msg, severities[seq % 4], "alert.assessment.impact.severity");
+        if ( ret < 0 )
+                goto error;
+
+        for ( i = 0; i < source_count; i++ ) {
+                snprintf(buf, sizeof(buf), "10.%u.%u.%u", (seq >> 16) & 0xff, (seq >> 8) & 0xff, i & 0xff);
+                ret = set_path(*msg, buf, "alert.source(%u).node.address(0).address", i);
+                if ( ret < 0 )
+                        goto error;
+
+                snprintf(buf, sizeof(buf), "%u", 1024 + (seq + i) % 60000);
+                ret = set_path(*msg, buf, "alert.source(%u).service.port", i);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        for ( i = 0; i < target_count; i++ ) {
+                snprintf(buf, sizeof(buf), "192.168.%u.%u", (seq >> 8) & 0xff, i & 0xff);
+                ret = set_path(*msg, buf, "alert.target(%u).node.address(0).address", i);
+                if ( ret < 0 )
+                        goto error;
+
+                ret = set_path(*msg, "80", "alert.target(%u).service.port", i);
+                if ( ret < 0 )
+                        goto error;
+
+                for ( j = 0; j < file_count; j++ ) {
+                        snprintf(buf, sizeof(buf), "file-%u", j);
+                        ret = set_path(*msg, buf, "alert.target(%u).file(%u).name", i, j);
+                        if ( ret < 0 )
+                                goto error;
+
+                        ret = set_path(*msg, "/var/tmp", "alert.target(%u).file(%u).path", i, j);
+                        if ( ret < 0 )
+                                goto error;
+
+                        ret = set_path(*msg, "current", "alert.target(%u).file(%u).category", i, j);
+                        if ( ret < 0 )
+                                goto error;
+                }
+        }
+
+        for ( i = 0; i < additional_data_count; i++ ) {
+                snprintf(buf, sizeof(buf), "meaning-%u", i);
+                ret = set_path(*msg, buf, "alert.additional_data(%u).meaning", i);
+                if ( ret < 0 )
+                        goto error;
+
+                snprintf(buf, sizeof(buf), "payload %u for alert %u", i, seq);
+                ret = set_path(*msg, buf, "alert.additional_data(%u).data", i);
+                if ( ret < 0 )
+                        goto error;
+        }
+
+        return 0;
+
+ error:
+        idmef_message_destroy(*msg);
+        return ret;
+}
+
+
+
+static int bench_insert(preludedb_t *db, bench_stat_t *stat)
+{
+        int ret = 0;
+        unsigned int i;
+        idmef_message_t *msg;
+        struct timeval start, end;
+
+        for ( i = 0; i < alert_count; i++ ) {
+                ret = generate_alert(&msg, i);
+                if ( ret < 0 )
+                        return ret;
+
+                gettimeofday(&start, NULL);
+
+                if ( events_per_transaction > 1 && i % events_per_transaction == 0 )
+                        preludedb_transaction_start(db);
+
+                ret = preludedb_insert_message(db, msg);
+
+                if ( events_per_transaction > 1 && (ret < 0 || (i + 1) % events_per_transaction == 0 || i + 1 == alert_count) ) {
+                        if ( ret < 0 )
+                                preludedb_transaction_abort(db);
+                        else
+                                ret = preludedb_transaction_end(db);
+                }
+
+                gettimeofday(&end, NULL);
+                idmef_message_destroy(msg);
+
+                if ( ret < 0 )
+                        return ret;
+
+                bench_stat_add_sample(stat, timeval_diff(&end, &start), 1);
+        }
+
+        return 0;
+}
+
+
+
+static int bench_get_alert(preludedb_t *db, bench_stat_t *stat)
+{
+        int ret;
+        uint64_t ident;
+        unsigned int i = 0;
+        idmef_message_t *msg;
+        struct timeval start, end;
+        preludedb_result_idents_t *idents;
+
+        ret = preludedb_get_alert_idents(db, NULL, query_count, -1, PRELUDEDB_RESULT_IDENTS_ORDER_BY_CREATE_TIME_DESC, &idents);
+        if ( ret <= 0 )
+                return ret;
+
+        while ( (ret = preludedb_result_idents_get(idents, i++, &ident)) > 0 ) {
+                gettimeofday(&start, NULL);
+                ret = preludedb_get_alert(db, ident, &msg);
+                gettimeofday(&end, NULL);
+
+                if ( ret < 0 )
+                        break;
+
+                idmef_message_destroy(msg);
+                bench_stat_add_sample(stat, timeval_diff(&end, &start), 1);
+        }
+
+        preludedb_result_idents_destroy(idents);
+
+        return ret;
+}
+
+
+
+static int bench_get_values(preludedb_t *db, bench_stat_t *stat)
+{
+        int ret;
+        void *row;
+        unsigned int i;
+        struct timeval start, end;
+        idmef_criteria_t *criteria;
+        preludedb_selected_path_t *selected;
+        preludedb_path_selection_t *selection;
+        preludedb_result_values_t *results;
+        const char *paths[] = { "alert.classification.text/group_by", "count(alert.create_time)/order_desc" };
+
+        ret = idmef_criteria_new_from_string(&criteria, "alert.assessment.impact.severity == 'high' && alert.source.node.address.address");
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_path_selection_new(db, &selection);
+        if ( ret < 0 )
+                goto out_criteria;
+
+        for ( i = 0; i < sizeof(paths) / sizeof(*paths); i++ ) {
+                ret = preludedb_selected_path_new_string(&selected, paths[i]);
+                if ( ret < 0 )
+                        goto out;
+
+                preludedb_path_selection_add(selection, selected);
+        }
+
+        for ( i = 0; i < query_count; i++ ) {
+                gettimeofday(&start, NULL);
+
+                ret = preludedb_get_values(db, selection, criteria, FALSE, -1, -1, &results);
+                if ( ret > 0 ) {
+                        while ( preludedb_result_values_get_row(results, -1, &row) > 0 );
+                        preludedb_result_values_destroy(results);
+                }
+
+                gettimeofday(&end, NULL);
+
+                if ( ret < 0 )
+                        goto out;
+
+                bench_stat_add_sample(stat, timeval_diff(&end, &start), 1);
+        }
+
+        ret = 0;
+
+ out:
+        preludedb_path_selection_destroy(selection);
+ out_criteria:
+        idmef_criteria_destroy(criteria);
+
+        return ret;
+}
+
+
+
+static int bench_delete(preludedb_t *db, bench_stat_t *stat)
+{
+        ssize_t ret;
+        uint64_t ident;
+        unsigned int i, count;
+        struct timeval start, end;
+        uint64_t idents[DELETE_BATCH_SIZE];
+        preludedb_result_idents_t *result;
+
+        do {
+                ret = preludedb_get_alert_idents(db, NULL, DELETE_BATCH_SIZE, -1, 0, &result);
+                if ( ret <= 0 )
+                        return ret;
+
+                for ( count = 0, i = 0; preludedb_result_idents_get(result, i, &ident) > 0; i++ )
+                        idents[count++] = ident;
+
+                preludedb_result_idents_destroy(result);
+
+                gettimeofday(&start, NULL);
+                ret = preludedb_delete_alert_from_list(db, idents, count);
+                gettimeofday(&end, NULL);
+
+                if ( ret < 0 )
+                        return ret;
+
+                bench_stat_add_sample(stat, timeval_diff(&end, &start), count);
+
+        } while ( count == DELETE_BATCH_SIZE );
+
+        return 0;
+}
+
+
+
+static int db_new_from_string(preludedb_t **db, const char *str)
+{
+        int ret;
+        preludedb_sql_t *sql;
+        preludedb_sql_settings_t *sql_settings;
+
+        ret = preludedb_sql_settings_new_from_string(&sql_settings, str);
+        if ( ret < 0 ) {
+                fprintf(stderr, "Error loading database settings: %s.\n", preludedb_strerror(ret));
+                return ret;
+        }
+
+        ret = preludedb_sql_new(&sql, NULL, sql_settings);
+        if ( ret < 0 ) {
+                fprintf(stderr, "Error creating database interface: %s.\n", preludedb_strerror(ret));
+                preludedb_sql_settings_destroy(sql_settings);
+                return ret;
+        }
+
+        ret = preludedb_new(db, sql, NULL, NULL, 0);
+        if ( ret < 0 ) {
+                fprintf(stderr, "could not initialize database '%s': %s\n", str, preludedb_strerror(ret));
+                preludedb_sql_destroy(sql);
+                return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int run_benchmark(const char *dbstr)
+{
+        int ret;
+        size_t i;
+        preludedb_t *db;
+        const char *type;
+        struct {
+                bench_stat_t stat;
+                int (*run)(preludedb_t *db, bench_stat_t *stat);
+        } benchs[] = {
+                { { "insert" }, bench_insert         },
+                { { "get_alert" }, bench_get_alert   },
+                { { "get_values" }, bench_get_values },
+                { { "delete" }, bench_delete         },
+        };
+
+        ret = db_new_from_string(&db, dbstr);
+        if ( ret < 0 )
+                return ret;
+
+        type = preludedb_sql_get_type(preludedb_get_sql(db));
+
+        for ( i = 0; i < sizeof(benchs) / sizeof(*benchs); i++ ) {
+                ret = benchs[i].run(db, &benchs[i].stat);
+                if ( ret < 0 ) {
+                        fprintf(stderr, "%s: '%s' benchmark failed: %s.\n", dbstr, benchs[i].stat.opname, preludedb_strerror(ret));
+                        free(benchs[i].stat.samples);
+                        break;
+                }
+
+                bench_stat_dump(&benchs[i].stat, dbstr, type);
+        }
+
+        preludedb_destroy(db);
+
+        return ret;
+}
+
+
+
+static int set_uint(const char *optarg, unsigned int *value)
+{
+        char *eptr;
+        unsigned long tmp;
+
+        tmp = strtoul(optarg, &eptr, 10);
+        if ( *eptr || tmp > PRELUDE_UINT32_MAX ) {
+                fprintf(stderr, "Invalid value: '%s'.\n", optarg);
+                return -1;
+        }
+
+        *value = tmp;
+        return 0;
+}
+
+
+static int set_count(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &alert_count);
+}
+
+
+static int set_queries(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &query_count);
+}
+
+
+static int set_sources(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &source_count);
+}
+
+
+static int set_targets(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &target_count);
+}
+
+
+static int set_additional_data(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &additional_data_count);
+}
+
+
+static int set_files(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &file_count);
+}
+
+
+static int set_events_per_transaction(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return set_uint(optarg, &events_per_transaction);
+}
+
+
+static int set_output(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        output = fopen(optarg, "a");
+        if ( ! output ) {
+                fprintf(stderr, "could not open '%s' for writing: %s.\n", optarg, strerror(errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+
+static int set_help(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context)
+{
+        return prelude_error(PRELUDE_ERROR_EOF);
+}
+
+
+
+static void print_help(char **argv)
+{
+        fprintf(stderr, "Usage  : %s <database> [database...] [options]\n", argv[0]);
+        fprintf(stderr, "Example: %s \"type=memory\" \"type=sqlite3 file=/tmp/bench.db\"\n\n", argv[0]);
+
+        fprintf(stderr, "Insert synthetic alerts into each <database>, then measure alert retrieval,\n");
+        fprintf(stderr, "value queries and deletion. The database should be empty.\n");
+        fprintf(stderr, "Results are written to standard output, one JSON object per operation.\n\n");
+
+        fprintf(stderr, "Valid options:\n");
+        fprintf(stderr, "  --count <count>                 : Number of alerts to insert (default %d).\n", DEFAULT_ALERT_COUNT);
+        fprintf(stderr, "  --queries <count>               : Number of get_alert/get_values queries (default %d).\n", DEFAULT_QUERY_COUNT);
+        fprintf(stderr, "  --sources <count>               : Number of sources per alert (default 1).\n");
+        fprintf(stderr, "  --targets <count>               : Number of targets per alert (default 1).\n");
+        fprintf(stderr, "  --additional-data <count>       : Number of additional data per alert (default 2).\n");
+        fprintf(stderr, "  --files <count>                 : Number of files per target (default 0).\n");
+        fprintf(stderr, "  --events-per-transaction        : Number of alerts inserted per transaction (default %d).\n", DEFAULT_EVENTS_PER_TRANSACTION);
+        fprintf(stderr, "  --output <filename>             : Append results to the specified file.\n");
+}
+
+
+
+static int setup_options(int *argc, char **argv)
+{
+        int ret;
+        size_t i;
+        prelude_string_t *err;
+        const struct {
+                const char *name;
+                int (*set)(prelude_option_t *opt, const char *optarg, prelude_string_t *err, void *context);
+        } options[] = {
+                { "count", set_count                                   },
+                { "queries", set_queries                               },
+                { "sources", set_sources                               },
+                { "targets", set_targets                               },
+                { "additional-data", set_additional_data               },
+                { "files", set_files                                   },
+                { "events-per-transaction", set_events_per_transaction },
+                { "output", set_output                                 },
+        };
+
+        for ( i = 0; i < sizeof(options) / sizeof(*options); i++ )
+                prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 0, options[i].name,
+                                   NULL, PRELUDE_OPTION_ARGUMENT_REQUIRED, options[i].set, NULL);
+
+        prelude_option_add(NULL, NULL, PRELUDE_OPTION_TYPE_CLI, 'h', "help",
+                           NULL, PRELUDE_OPTION_ARGUMENT_NONE, set_help, NULL);
+
+        ret = prelude_option_read(NULL, NULL, argc, argv, &err, NULL);
+        if ( ret < 0 && prelude_error_get_code(ret) != PRELUDE_ERROR_EOF )
+                fprintf(stderr, "Option error: %s.\n", prelude_strerror(ret));
+
+        return ret;
+}
+
+
+
+int main(int argc, char **argv)
+{
+        int ret, i;
+
+        ret = preludedb_init();
+        if ( ret < 0 ) {
+                prelude_perror(ret, "error initializing libpreludedb");
+                return ret;
+        }
+
+        output = stdout;
+
+        ret = setup_options(&argc, argv);
+        if ( ret < 0 || ret >= argc ) {
+                print_help(argv);
+                preludedb_deinit();
+                return 1;
+        }
+
+        for ( i = ret; i < argc && ret >= 0; i++ )
+                ret = run_benchmark(argv[i]);
+
+        if ( output != stdout )
+                fclose(output);
+
+        preludedb_deinit();
+
+        return (ret < 0) ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_INGEST_H
+#define _LIBPRELUDEDB_INGEST_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+typedef struct preludedb_ingest preludedb_ingest_t;
+
+typedef void (*preludedb_ingest_callback_t)(idmef_message_t *message, int error, void *data);
+
+int preludedb_ingest_new(preludedb_ingest_t **ingest, preludedb_t *db, unsigned int max_messages, unsigned int max_delay);
+void preludedb_ingest_destroy(preludedb_ingest_t *ingest);
+
+int preludedb_ingest_submit(preludedb_ingest_t *ingest, idmef_message_t *message,
+                            preludedb_ingest_callback_t callback, void *data);
+int preludedb_ingest_insert_message(preludedb_ingest_t *ingest, idmef_message_t *message);
+int preludedb_ingest_flush(preludedb_ingest_t *ingest);
+
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif /* _LIBPRELUDEDB_INGEST_H */
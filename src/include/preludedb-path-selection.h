@@ -42,6 +42,9 @@ typedef enum {
         PRELUDEDB_SELECTED_OBJECT_TYPE_IDMEFPATH = 8,
         PRELUDEDB_SELECTED_OBJECT_TYPE_INT = 9,
         PRELUDEDB_SELECTED_OBJECT_TYPE_TIMEZONE = 10,
+        PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT = 11,
+        PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK = 12,
+        PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE = 13,
 } preludedb_selected_object_type_t;
 
 
@@ -36,6 +36,8 @@ struct preludedb_plugin_format {
         preludedb_plugin_format_get_message_ident_func_t get_message_ident;
         preludedb_plugin_format_destroy_message_idents_resource_func_t destroy_message_idents_resource;
         preludedb_plugin_format_get_alert_func_t get_alert;
+        preludedb_plugin_format_get_alert_paths_func_t get_alert_paths;
+        preludedb_plugin_format_get_alerts_func_t get_alerts;
         preludedb_plugin_format_get_heartbeat_func_t get_heartbeat;
         preludedb_plugin_format_delete_alert_func_t delete_alert;
         preludedb_plugin_format_delete_alert_from_list_func_t delete_alert_from_list;
@@ -56,6 +58,7 @@ struct preludedb_plugin_format {
         preludedb_plugin_format_path_resolve_func_t path_resolve;
         preludedb_plugin_format_init_func_t init;
         preludedb_plugin_format_init_func_t optimize;
+        preludedb_plugin_format_get_index_advice_func_t get_index_advice;
 };
 
 #endif
@@ -48,6 +48,11 @@ typedef size_t (*preludedb_plugin_format_get_message_ident_count_func_t)(void *r
 typedef int (*preludedb_plugin_format_get_message_ident_func_t)(void *res, unsigned int row_index, uint64_t *ident);
 typedef void (*preludedb_plugin_format_destroy_message_idents_resource_func_t)(void *res);
 typedef int (*preludedb_plugin_format_get_alert_func_t)(preludedb_t *db, uint64_t ident, idmef_message_t **message);
+typedef int (*preludedb_plugin_format_get_alert_paths_func_t)(preludedb_t *db, uint64_t ident,
+                                                              const idmef_path_t * const *paths, size_t size,
+                                                              idmef_message_t **message, unsigned int *fetched);
+typedef int (*preludedb_plugin_format_get_alerts_func_t)(preludedb_t *db, const uint64_t *idents, size_t count,
+                                                         idmef_message_t **messages);
 typedef int (*preludedb_plugin_format_get_heartbeat_func_t)(preludedb_t *db, uint64_t ident, idmef_message_t **message);
 typedef int (*preludedb_plugin_format_delete_alert_func_t)(preludedb_t *db, uint64_t ident);
 typedef ssize_t (*preludedb_plugin_format_delete_alert_from_list_func_t)(preludedb_t *db, uint64_t *idents, size_t size);
@@ -87,6 +92,8 @@ typedef int (*preludedb_plugin_format_init_func_t)(preludedb_t *db);
 
 typedef int (*preludedb_plugin_format_optimize_func_t)(preludedb_t *db);
 
+typedef int (*preludedb_plugin_format_get_index_advice_func_t)(preludedb_t *db, unsigned int max, prelude_string_t *output);
+
 
 void preludedb_plugin_format_set_check_schema_version_func(preludedb_plugin_format_t *plugin,
                                                            preludedb_plugin_format_check_schema_version_func_t func);
@@ -108,6 +115,12 @@ void preludedb_plugin_format_set_destroy_message_idents_resource_func(preludedb_
 
 void preludedb_plugin_format_set_get_alert_func(preludedb_plugin_format_t *plugin, preludedb_plugin_format_get_alert_func_t func);
 
+void preludedb_plugin_format_set_get_alert_paths_func(preludedb_plugin_format_t *plugin,
+                                                      preludedb_plugin_format_get_alert_paths_func_t func);
+
+void preludedb_plugin_format_set_get_alerts_func(preludedb_plugin_format_t *plugin,
+                                                 preludedb_plugin_format_get_alerts_func_t func);
+
 void preludedb_plugin_format_set_get_heartbeat_func(preludedb_plugin_format_t *plugin, preludedb_plugin_format_get_heartbeat_func_t func);
 
 void preludedb_plugin_format_set_delete_alert_func(preludedb_plugin_format_t *plugin, preludedb_plugin_format_delete_alert_func_t func);
@@ -176,6 +189,9 @@ void preludedb_plugin_format_set_init_func(preludedb_plugin_format_t *plugin, pr
 
 void preludedb_plugin_format_set_optimize_func(preludedb_plugin_format_t *plugin, preludedb_plugin_format_optimize_func_t func);
 
+void preludedb_plugin_format_set_get_index_advice_func(preludedb_plugin_format_t *plugin,
+                                                       preludedb_plugin_format_get_index_advice_func_t func);
+
 int preludedb_plugin_format_new(preludedb_plugin_format_t **ret);
 
 #ifdef __cplusplus
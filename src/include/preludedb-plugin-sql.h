@@ -32,6 +32,11 @@
 
 typedef struct preludedb_plugin_sql preludedb_plugin_sql_t;
 
+typedef enum {
+        PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY = 0x01,
+        PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_BYTEA_HEX = 0x02
+} preludedb_plugin_sql_escape_flags_t;
+
 
 typedef int (*preludedb_plugin_sql_open_func_t)(preludedb_sql_settings_t *settings, void **session);
 typedef void (*preludedb_plugin_sql_close_func_t)(void *session);
@@ -69,6 +74,18 @@ typedef const char *(*preludedb_plugin_sql_get_operator_string_func_t)(idmef_cri
 typedef int (*preludedb_plugin_sql_build_timestamp_string_func_t)(const struct tm *t, char *out, size_t size);
 typedef long (*preludedb_plugin_sql_get_server_version_func_t)(void *session);
 typedef int (*preludedb_plugin_sql_get_last_insert_ident_func_t)(void *session, uint64_t *ident);
+typedef int (*preludedb_plugin_sql_build_optimize_string_func_t)(void *session, const char *table,
+                                                               preludedb_sql_optimize_flags_t flag, prelude_string_t *output);
+typedef int (*preludedb_plugin_sql_build_create_index_string_func_t)(void *session, const char *name, const char *table, const char *columns,
+                                                                   const char *partial_column, const char *partial_value,
+                                                                   prelude_string_t *output);
+typedef int (*preludedb_plugin_sql_build_upsert_string_func_t)(void *session, const char *table, const char *fields,
+                                                             const char *values, const char *key,
+                                                             const char * const *columns, size_t size,
+                                                             prelude_string_t *output);
+typedef int (*preludedb_plugin_sql_build_aggregate_string_func_t)(void *session, prelude_string_t *output, const char *field,
+                                                                preludedb_sql_aggregate_type_t type, int param);
+typedef preludedb_plugin_sql_escape_flags_t (*preludedb_plugin_sql_get_escape_flags_func_t)(void *session);
 
 
 void preludedb_plugin_sql_set_open_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_open_func_t func);
@@ -86,11 +103,15 @@ int _preludedb_plugin_sql_escape(preludedb_plugin_sql_t *plugin, void *session,
 
 void preludedb_plugin_sql_set_escape_binary_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_escape_binary_func_t func);
 
-int _preludedb_plugin_sql_escape_binary(preludedb_plugin_sql_t *plugin, void *session,
+const char *_preludedb_plugin_sql_get_binary_hex_prefix(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_escape_flags_t flags);
+
+int _preludedb_plugin_sql_escape_binary(preludedb_plugin_sql_t *plugin, void *session, preludedb_plugin_sql_escape_flags_t flags,
                                         const unsigned char *input, size_t input_size, char **output);
 
 void preludedb_plugin_sql_set_unescape_binary_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_unescape_binary_func_t func);
 
+prelude_bool_t _preludedb_plugin_sql_is_binary_hex(preludedb_plugin_sql_t *plugin, const char *input, size_t input_size);
+
 int _preludedb_plugin_sql_unescape_binary(preludedb_plugin_sql_t *plugin, void *session, const char *input,
                                           size_t input_size, unsigned char **output, size_t *output_size);
 
@@ -198,6 +219,45 @@ void preludedb_plugin_sql_set_get_last_insert_ident_func(preludedb_plugin_sql_t
 
 int _preludedb_plugin_sql_get_last_insert_ident(preludedb_plugin_sql_t *plugin, void *session, uint64_t *ident);
 
+void preludedb_plugin_sql_set_build_optimize_string_func(preludedb_plugin_sql_t *plugin,
+                                                         preludedb_plugin_sql_build_optimize_string_func_t func);
+
+int _preludedb_plugin_sql_build_optimize_string(preludedb_plugin_sql_t *plugin, void *session, const char *table,
+                                                preludedb_sql_optimize_flags_t flag, prelude_string_t *output);
+
+void preludedb_plugin_sql_set_build_create_index_string_func(preludedb_plugin_sql_t *plugin,
+                                                             preludedb_plugin_sql_build_create_index_string_func_t func);
+
+int _preludedb_plugin_sql_build_create_index_string(preludedb_plugin_sql_t *plugin, void *session,
+                                                    const char *name, const char *table, const char *columns,
+                                                    const char *partial_column, const char *partial_value,
+                                                    prelude_string_t *output);
+
+void preludedb_plugin_sql_set_build_upsert_string_func(preludedb_plugin_sql_t *plugin,
+                                                       preludedb_plugin_sql_build_upsert_string_func_t func);
+
+int _preludedb_plugin_sql_build_upsert_string(preludedb_plugin_sql_t *plugin, void *session, const char *table,
+                                              const char *fields, const char *values, const char *key,
+                                              const char * const *columns, size_t size, prelude_string_t *output);
+
+void preludedb_plugin_sql_set_build_aggregate_string_func(preludedb_plugin_sql_t *plugin,
+                                                          preludedb_plugin_sql_build_aggregate_string_func_t func);
+
+int _preludedb_plugin_sql_build_aggregate_string(preludedb_plugin_sql_t *plugin, void *session, prelude_string_t *output,
+                                                 const char *field, preludedb_sql_aggregate_type_t type, int param);
+
+void preludedb_plugin_sql_set_max_sessions(preludedb_plugin_sql_t *plugin, unsigned int max);
+
+unsigned int _preludedb_plugin_sql_get_max_sessions(preludedb_plugin_sql_t *plugin);
+
+void preludedb_plugin_sql_set_escape_flags(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_escape_flags_t flags);
+
+preludedb_plugin_sql_escape_flags_t _preludedb_plugin_sql_get_escape_flags(preludedb_plugin_sql_t *plugin);
+
+void preludedb_plugin_sql_set_get_escape_flags_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_get_escape_flags_func_t func);
+
+preludedb_plugin_sql_escape_flags_t _preludedb_plugin_sql_get_session_escape_flags(preludedb_plugin_sql_t *plugin, void *session);
+
 int preludedb_plugin_sql_new(preludedb_plugin_sql_t **plugin);
 
 #ifdef __cplusplus
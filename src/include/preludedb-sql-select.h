@@ -30,6 +30,7 @@
 
 typedef enum {
         PRELUDEDB_SQL_SELECT_FLAGS_ALIAS_FUNCTION = 0x01,
+        PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE = 0x02,
 } preludedb_sql_select_flags_t;
 
 typedef struct preludedb_sql_select preludedb_sql_select_t;
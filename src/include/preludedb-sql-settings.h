@@ -36,6 +36,29 @@
 #define PRELUDEDB_SQL_SETTING_TYPE "type"
 #define PRELUDEDB_SQL_SETTING_FILE "file"
 #define PRELUDEDB_SQL_SETTING_LOG "log"
+#define PRELUDEDB_SQL_SETTING_LOG_SAMPLE "log_sample"
+#define PRELUDEDB_SQL_SETTING_LOG_THRESHOLD "log_threshold"
+#define PRELUDEDB_SQL_SETTING_LOG_MAX_SIZE "log_max_size"
+#define PRELUDEDB_SQL_SETTING_LOG_MAX_FILES "log_max_files"
+#define PRELUDEDB_SQL_SETTING_LOG_FORMAT "log_format"
+#define PRELUDEDB_SQL_SETTING_OPTIMIZE_THRESHOLD "optimize_threshold"
+#define PRELUDEDB_SQL_SETTING_OPTIMIZE_BUDGET "optimize_budget"
+#define PRELUDEDB_SQL_SETTING_MAX_SESSIONS "max_sessions"
+#define PRELUDEDB_SQL_SETTING_ALERT_CACHE_SIZE "alert_cache_size"
+#define PRELUDEDB_SQL_SETTING_HEARTBEAT_HISTORY "heartbeat_history"
+#define PRELUDEDB_SQL_SETTING_DICTIONARY "dictionary"
+#define PRELUDEDB_SQL_SETTING_PARALLEL_SCAN "parallel_scan"
+#define PRELUDEDB_SQL_SETTING_MESSAGE_BLOB "message_blob"
+#define PRELUDEDB_SQL_SETTING_MESSAGE_BLOB_COMPRESSION "message_blob_compression"
+#define PRELUDEDB_SQL_SETTING_ADDITIONAL_DATA_COMPRESSION "additional_data_compression"
+#define PRELUDEDB_SQL_SETTING_OVERFLOW_ALERT_COMPRESSION "overflow_alert_compression"
+#define PRELUDEDB_SQL_SETTING_COMPRESSION_THRESHOLD "compression_threshold"
+#define PRELUDEDB_SQL_SETTING_COMPRESSION_DICTIONARY "compression_dictionary"
+#define PRELUDEDB_SQL_SETTING_RECONNECT_ATTEMPTS "reconnect_attempts"
+#define PRELUDEDB_SQL_SETTING_RECONNECT_DELAY "reconnect_delay"
+#define PRELUDEDB_SQL_SETTING_READ_REPLICAS "read_replicas"
+#define PRELUDEDB_SQL_SETTING_READ_POLICY "read_policy"
+#define PRELUDEDB_SQL_SETTING_READ_YOUR_WRITES "read_your_writes"
 
 typedef struct preludedb_sql_settings preludedb_sql_settings_t;
 
@@ -75,11 +75,25 @@ typedef enum {
 } preludedb_selected_object_interval_t;
 
 
+typedef enum {
+        PRELUDEDB_SQL_AGGREGATE_APPROX_COUNT_DISTINCT = 1,
+        PRELUDEDB_SQL_AGGREGATE_PERCENTILE = 2
+} preludedb_sql_aggregate_type_t;
+
+
+typedef enum {
+        PRELUDEDB_SQL_OPTIMIZE_ANALYZE = 0x01,
+        PRELUDEDB_SQL_OPTIMIZE_RECLAIM = 0x02
+} preludedb_sql_optimize_flags_t;
+
+
 typedef struct preludedb_sql preludedb_sql_t;
 
 typedef struct preludedb_sql_table preludedb_sql_table_t;
 typedef struct preludedb_sql_row preludedb_sql_row_t;
 typedef struct preludedb_sql_field preludedb_sql_field_t;
+typedef struct preludedb_sql_query_stats preludedb_sql_query_stats_t;
+typedef struct preludedb_sql_transaction preludedb_sql_transaction_t;
 
 int preludedb_sql_row_new_field(preludedb_sql_row_t *row, preludedb_sql_field_t **field, int num, char *value, size_t len);
 
@@ -112,14 +126,40 @@ void preludedb_sql_destroy(preludedb_sql_t *sql);
 int preludedb_sql_enable_query_logging(preludedb_sql_t *sql, const char *filename);
 void preludedb_sql_disable_query_logging(preludedb_sql_t *sql);
 
+int preludedb_sql_enable_statistics(preludedb_sql_t *sql);
+void preludedb_sql_disable_statistics(preludedb_sql_t *sql);
+void preludedb_sql_reset_statistics(preludedb_sql_t *sql);
+int preludedb_sql_get_statistics_string(preludedb_sql_t *sql, prelude_string_t *output);
+preludedb_sql_query_stats_t *preludedb_sql_get_next_query_stats(preludedb_sql_t *sql, preludedb_sql_query_stats_t *prev);
+double preludedb_sql_get_escape_time(preludedb_sql_t *sql);
+double preludedb_sql_get_format_time(preludedb_sql_t *sql);
+
+const char *preludedb_sql_query_stats_get_shape(const preludedb_sql_query_stats_t *stats);
+uint64_t preludedb_sql_query_stats_get_count(const preludedb_sql_query_stats_t *stats);
+uint64_t preludedb_sql_query_stats_get_error_count(const preludedb_sql_query_stats_t *stats);
+uint64_t preludedb_sql_query_stats_get_row_count(const preludedb_sql_query_stats_t *stats);
+uint64_t preludedb_sql_query_stats_get_bytes_sent(const preludedb_sql_query_stats_t *stats);
+uint64_t preludedb_sql_query_stats_get_bytes_received(const preludedb_sql_query_stats_t *stats);
+double preludedb_sql_query_stats_get_query_time(const preludedb_sql_query_stats_t *stats);
+double preludedb_sql_query_stats_get_fetch_time(const preludedb_sql_query_stats_t *stats);
+double preludedb_sql_query_stats_get_latency(const preludedb_sql_query_stats_t *stats, double percentile);
+
 int preludedb_sql_query(preludedb_sql_t *sql, const char *query, preludedb_sql_table_t **table);
 
 int preludedb_sql_query_sprintf(preludedb_sql_t *sql, preludedb_sql_table_t **table, const char *format, ...)
                                 __attribute__ ((__format__ (__printf__, 3, 4)));
 
+int preludedb_sql_query_parallel(preludedb_sql_t *sql, const char * const *queries, unsigned int count, preludedb_sql_table_t **tables);
+
 int preludedb_sql_insert(preludedb_sql_t *sql, const char *table, const char *fields, const char *format, ...)
                          __attribute__ ((__format__ (__printf__, 4, 5)));
 
+int preludedb_sql_upsert(preludedb_sql_t *sql, const char *table, const char *fields, const char *key, const char *format, ...)
+                         __attribute__ ((__format__ (__printf__, 5, 6)));
+
+int preludedb_sql_insert_ignore(preludedb_sql_t *sql, const char *table, const char *fields, const char *key, const char *format, ...)
+                                __attribute__ ((__format__ (__printf__, 5, 6)));
+
 int preludedb_sql_get_last_insert_ident(preludedb_sql_t *sql, uint64_t *ident);
 
 int preludedb_sql_build_limit_offset_string(preludedb_sql_t *sql, int limit, int offset, prelude_string_t *output);
@@ -128,9 +168,23 @@ int preludedb_sql_transaction_start(preludedb_sql_t *sql);
 int preludedb_sql_transaction_end(preludedb_sql_t *sql);
 int preludedb_sql_transaction_abort(preludedb_sql_t *sql);
 
+int preludedb_sql_transaction_new(preludedb_sql_t *sql, preludedb_sql_transaction_t **transaction);
+int preludedb_sql_transaction_commit(preludedb_sql_transaction_t *transaction);
+int preludedb_sql_transaction_rollback(preludedb_sql_transaction_t *transaction);
+
+typedef void (*preludedb_sql_transaction_callback_t)(preludedb_sql_t *sql, prelude_bool_t committed, void *data);
+
+int preludedb_sql_transaction_add_callback(preludedb_sql_t *sql, preludedb_sql_transaction_callback_t callback, void *data);
+
+int preludedb_sql_set_data(preludedb_sql_t *sql, const void *key, void *data, void (*destroy)(void *data));
+void *preludedb_sql_get_data(preludedb_sql_t *sql, const void *key);
+
 int preludedb_sql_escape_fast(preludedb_sql_t *sql, const char *input, size_t input_size, char **output);
 int preludedb_sql_escape(preludedb_sql_t *sql, const char *input, char **output);
+int preludedb_sql_escape_append(preludedb_sql_t *sql, prelude_string_t *output, const char *input, size_t input_size);
 int preludedb_sql_escape_binary(preludedb_sql_t *sql, const unsigned char *input, size_t input_size, char **output);
+int preludedb_sql_escape_binary_append(preludedb_sql_t *sql, prelude_string_t *output,
+                                       const unsigned char *input, size_t input_size);
 int preludedb_sql_unescape_binary(preludedb_sql_t *sql, const char *input, size_t input_size,
                                   unsigned char **output, size_t *output_size);
 
@@ -172,6 +226,9 @@ int preludedb_sql_build_time_extract_string(preludedb_sql_t *sql, prelude_string
 
 int preludedb_sql_build_time_timezone_string(preludedb_sql_t *sql, prelude_string_t *output, const char *field, const char *tzvalue);
 
+int preludedb_sql_build_aggregate_string(preludedb_sql_t *sql, prelude_string_t *output, const char *field,
+                                         preludedb_sql_aggregate_type_t type, int param);
+
 int preludedb_sql_build_criterion_string(preludedb_sql_t *sql,
                                          prelude_string_t *output,
                                          const char *field,
@@ -190,6 +247,11 @@ const char *preludedb_sql_get_type(const preludedb_sql_t *sql);
 
 const preludedb_sql_settings_t *preludedb_sql_get_settings(const preludedb_sql_t *sql);
 
+int preludedb_sql_optimize(preludedb_sql_t *sql, const char *table, preludedb_sql_optimize_flags_t flags);
+
+int preludedb_sql_build_create_index_string(preludedb_sql_t *sql, const char *name, const char *table, const char *columns,
+                                            const char *partial_column, const char *partial_value, prelude_string_t *output);
+
 
 /*
  * Deprecated, use preludedb_strerror()
@@ -40,8 +40,10 @@ typedef struct preludedb preludedb_t;
 
 #include "preludedb-path-selection.h"
 #include "preludedb-sql-select.h"
+#include "preludedb-ingest.h"
 
 typedef struct preludedb_result_idents preludedb_result_idents_t;
+typedef struct preludedb_lazy_alert preludedb_lazy_alert_t;
 typedef struct preludedb_result_values preludedb_result_values_t;
 
 typedef enum {
@@ -50,6 +52,13 @@ typedef enum {
         PRELUDEDB_RESULT_IDENTS_ORDER_BY_CREATE_TIME_ASC = 2
 } preludedb_result_idents_order_t;
 
+typedef enum {
+        PRELUDEDB_MODIFICATION_ALERT_INSERT = 0,
+        PRELUDEDB_MODIFICATION_ALERT_DELETE = 1,
+        PRELUDEDB_MODIFICATION_HEARTBEAT_INSERT = 2,
+        PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE = 3
+} preludedb_modification_type_t;
+
 
 #define PRELUDEDB_ERRBUF_SIZE 512
 
@@ -109,8 +118,16 @@ int preludedb_get_heartbeat_idents(preludedb_t *db, idmef_criteria_t *criteria,
                                    preludedb_result_idents_t **result);
 
 int preludedb_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message);
+int preludedb_get_alert_paths(preludedb_t *db, uint64_t ident,
+                              const idmef_path_t * const *paths, size_t size, idmef_message_t **message);
+int preludedb_get_alerts(preludedb_t *db, const uint64_t *idents, size_t count, idmef_message_t **messages);
 int preludedb_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **message);
 
+int preludedb_lazy_alert_new(preludedb_lazy_alert_t **alert, preludedb_t *db, uint64_t ident);
+void preludedb_lazy_alert_destroy(preludedb_lazy_alert_t *alert);
+int preludedb_lazy_alert_get_value(preludedb_lazy_alert_t *alert, const idmef_path_t *path, idmef_value_t **value);
+idmef_message_t *preludedb_lazy_alert_get_message(preludedb_lazy_alert_t *alert);
+
 int preludedb_delete_alert(preludedb_t *db, uint64_t ident);
 
 ssize_t preludedb_delete_alert_from_list(preludedb_t *db, uint64_t *idents, size_t isize);
@@ -143,6 +160,16 @@ int preludedb_update(preludedb_t *db,
 
 int preludedb_optimize(preludedb_t *db);
 
+int preludedb_get_index_advice(preludedb_t *db, unsigned int max, prelude_string_t *output);
+
+unsigned long preludedb_get_modification_count(preludedb_t *db, preludedb_modification_type_t type);
+
+void preludedb_reset_modification_count(preludedb_t *db, preludedb_modification_type_t type, unsigned long count);
+
+uint64_t preludedb_get_alert_cache_hit_count(preludedb_t *db);
+
+uint64_t preludedb_get_alert_cache_miss_count(preludedb_t *db);
+
 int preludedb_transaction_start(preludedb_t *db);
 
 
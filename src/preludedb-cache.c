@@ -0,0 +1,302 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+
+#include "glthread/lock.h"
+#include "preludedb-error.h"
+
+
+/*
+ * Least recently used cache of decoded messages, indexed by ident through
+ * a chained hash table sized to twice the capacity.
+ *
+ * The reference count of libprelude messages is not atomic, so cached
+ * messages are never shared: callers get a copy of their own, and the
+ * cache keeps one.
+ */
+typedef struct preludedb_cache preludedb_cache_t;
+
+
+typedef struct {
+        prelude_list_t bucket_list;
+        prelude_list_t lru_list;
+        uint64_t ident;
+        idmef_message_t *message;
+} cache_entry_t;
+
+
+struct preludedb_cache {
+        gl_lock_t mutex;
+
+        size_t size;
+        size_t count;
+        size_t nbuckets;
+        prelude_list_t *buckets;
+        prelude_list_t lru_list;
+
+        /*
+         * Incremented on every invalidation, so that a message retrieved
+         * while its ident was invalidated is not cached.
+         */
+        unsigned long generation;
+
+        uint64_t hits;
+        uint64_t misses;
+};
+
+
+
+int _preludedb_cache_new(preludedb_cache_t **cache, size_t size);
+void _preludedb_cache_destroy(preludedb_cache_t *cache);
+idmef_message_t *_preludedb_cache_get(preludedb_cache_t *cache, uint64_t ident, unsigned long *generation);
+void _preludedb_cache_add(preludedb_cache_t *cache, uint64_t ident, idmef_message_t *message, unsigned long generation);
+void _preludedb_cache_remove(preludedb_cache_t *cache, uint64_t ident);
+void _preludedb_cache_clear(preludedb_cache_t *cache);
+uint64_t _preludedb_cache_get_hit_count(preludedb_cache_t *cache);
+uint64_t _preludedb_cache_get_miss_count(preludedb_cache_t *cache);
+
+
+
+static prelude_list_t *get_bucket(preludedb_cache_t *cache, uint64_t ident)
+{
+        ident ^= ident >> 33;
+        ident *= 0xff51afd7ed558ccdULL;
+        ident ^= ident >> 33;
+
+        return &cache->buckets[ident & (cache->nbuckets - 1)];
+}
+
+
+
+static cache_entry_t *lookup_entry(preludedb_cache_t *cache, uint64_t ident)
+{
+        prelude_list_t *tmp, *bucket;
+        cache_entry_t *entry;
+
+        bucket = get_bucket(cache, ident);
+
+        prelude_list_for_each(bucket, tmp) {
+                entry = prelude_list_entry(tmp, cache_entry_t, bucket_list);
+                if ( entry->ident == ident )
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+
+static void entry_destroy(preludedb_cache_t *cache, cache_entry_t *entry)
+{
+        prelude_list_del(&entry->bucket_list);
+        prelude_list_del(&entry->lru_list);
+        idmef_message_destroy(entry->message);
+        free(entry);
+
+        cache->count--;
+}
+
+
+
+int _preludedb_cache_new(preludedb_cache_t **cache, size_t size)
+{
+        size_t i;
+
+        *cache = calloc(1, sizeof(**cache));
+        if ( ! *cache )
+                return preludedb_error_from_errno(errno);
+
+        (*cache)->size = size;
+
+        for ( (*cache)->nbuckets = 1; (*cache)->nbuckets < size * 2; (*cache)->nbuckets <<= 1 );
+
+        (*cache)->buckets = malloc((*cache)->nbuckets * sizeof(*(*cache)->buckets));
+        if ( ! (*cache)->buckets ) {
+                free(*cache);
+                return preludedb_error_from_errno(errno);
+        }
+
+        for ( i = 0; i < (*cache)->nbuckets; i++ )
+                prelude_list_init(&(*cache)->buckets[i]);
+
+        prelude_list_init(&(*cache)->lru_list);
+        gl_lock_init((*cache)->mutex);
+
+        return 0;
+}
+
+
+
+void _preludedb_cache_destroy(preludedb_cache_t *cache)
+{
+        _preludedb_cache_clear(cache);
+
+        gl_lock_destroy(cache->mutex);
+        free(cache->buckets);
+        free(cache);
+}
+
+
+
+/*
+ * Returns a copy of the message cached for @ident, or NULL and the
+ * generation to pass to _preludedb_cache_add() once it is retrieved.
+ */
+idmef_message_t *_preludedb_cache_get(preludedb_cache_t *cache, uint64_t ident, unsigned long *generation)
+{
+        cache_entry_t *entry;
+        idmef_message_t *message = NULL;
+
+        gl_lock_lock(cache->mutex);
+
+        entry = lookup_entry(cache, ident);
+        if ( entry && idmef_message_clone(entry->message, &message) < 0 )
+                message = NULL;
+
+        if ( message ) {
+                prelude_list_del(&entry->lru_list);
+                prelude_list_add(&cache->lru_list, &entry->lru_list);
+
+                cache->hits++;
+        } else {
+                *generation = cache->generation;
+                cache->misses++;
+        }
+
+        gl_lock_unlock(cache->mutex);
+
+        return message;
+}
+
+
+
+/*
+ * Cache a copy of @message, unless @ident was invalidated since
+ * _preludedb_cache_get() returned @generation.
+ */
+void _preludedb_cache_add(preludedb_cache_t *cache, uint64_t ident, idmef_message_t *message, unsigned long generation)
+{
+        cache_entry_t *entry;
+        idmef_message_t *copy;
+
+        /*
+         * @message belongs to the caller alone, thus is copied unlocked.
+         */
+        if ( idmef_message_clone(message, &copy) < 0 )
+                return;
+
+        entry = malloc(sizeof(*entry));
+        if ( ! entry ) {
+                idmef_message_destroy(copy);
+                return;
+        }
+
+        gl_lock_lock(cache->mutex);
+
+        if ( generation != cache->generation || lookup_entry(cache, ident) ) {
+                gl_lock_unlock(cache->mutex);
+
+                idmef_message_destroy(copy);
+                free(entry);
+
+                return;
+        }
+
+        if ( cache->count == cache->size )
+                entry_destroy(cache, prelude_list_entry(cache->lru_list.prev, cache_entry_t, lru_list));
+
+        entry->ident = ident;
+        entry->message = copy;
+
+        prelude_list_add(get_bucket(cache, ident), &entry->bucket_list);
+        prelude_list_add(&cache->lru_list, &entry->lru_list);
+        cache->count++;
+
+        gl_lock_unlock(cache->mutex);
+}
+
+
+
+void _preludedb_cache_remove(preludedb_cache_t *cache, uint64_t ident)
+{
+        cache_entry_t *entry;
+
+        gl_lock_lock(cache->mutex);
+
+        cache->generation++;
+
+        entry = lookup_entry(cache, ident);
+        if ( entry )
+                entry_destroy(cache, entry);
+
+        gl_lock_unlock(cache->mutex);
+}
+
+
+
+void _preludedb_cache_clear(preludedb_cache_t *cache)
+{
+        prelude_list_t *tmp, *bkp;
+
+        gl_lock_lock(cache->mutex);
+
+        cache->generation++;
+
+        prelude_list_for_each_safe(&cache->lru_list, tmp, bkp)
+                entry_destroy(cache, prelude_list_entry(tmp, cache_entry_t, lru_list));
+
+        gl_lock_unlock(cache->mutex);
+}
+
+
+
+uint64_t _preludedb_cache_get_hit_count(preludedb_cache_t *cache)
+{
+        uint64_t count;
+
+        gl_lock_lock(cache->mutex);
+        count = cache->hits;
+        gl_lock_unlock(cache->mutex);
+
+        return count;
+}
+
+
+
+uint64_t _preludedb_cache_get_miss_count(preludedb_cache_t *cache)
+{
+        uint64_t count;
+
+        gl_lock_lock(cache->mutex);
+        count = cache->misses;
+        gl_lock_unlock(cache->mutex);
+
+        return count;
+}
@@ -0,0 +1,499 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+
+#ifdef USE_POSIX_THREADS
+# include <pthread.h>
+#endif
+
+#include <libprelude/prelude.h>
+
+#include "preludedb-error.h"
+#include "preludedb.h"
+#include "preludedb-ingest.h"
+
+
+/*
+ * Messages submitted by any number of producers are queued, and inserted
+ * by a dedicated thread in batches sharing a single transaction, so that
+ * the database server only has to make a batch durable once (group
+ * commit). A batch is committed once it holds max_messages messages, or
+ * max_delay milliseconds after its first message was queued, whichever
+ * comes first.
+ */
+#define DEFAULT_MAX_MESSAGES 100
+#define DEFAULT_MAX_DELAY    50
+
+
+/*
+ * Producers block once this many batches are waiting, rather than letting
+ * the queue grow without bound while the database is slower than them.
+ */
+#define MAX_PENDING_BATCHES  4
+
+
+typedef struct {
+        prelude_list_t list;
+        idmef_message_t *message;
+        preludedb_ingest_callback_t callback;
+        void *data;
+        int result;
+} ingest_entry_t;
+
+
+struct preludedb_ingest {
+        preludedb_t *db;
+        unsigned int max_messages;
+        unsigned int max_delay;
+
+#ifdef USE_POSIX_THREADS
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        pthread_cond_t done_cond;
+
+        prelude_list_t queue;
+        unsigned int queued;
+        struct timespec deadline;
+
+        uint64_t submitted;
+        uint64_t completed;
+        unsigned int flushing;
+        prelude_bool_t stop;
+#endif
+};
+
+
+typedef struct {
+        preludedb_ingest_t *ingest;
+        prelude_bool_t done;
+        int result;
+} ingest_wait_t;
+
+
+
+static void entry_complete(ingest_entry_t *entry)
+{
+        if ( entry->callback )
+                entry->callback(entry->message, entry->result, entry->data);
+
+        idmef_message_destroy(entry->message);
+        free(entry);
+}
+
+
+
+/*
+ * Insert @batch in a single transaction. @replayable is set if the
+ * transaction was lost along with the connection before being committed:
+ * the server rolled it back, so the whole batch can safely be inserted
+ * again.
+ */
+static int insert_batch_transaction(preludedb_t *db, prelude_list_t *batch, prelude_bool_t *replayable)
+{
+        int ret;
+        prelude_list_t *tmp;
+        ingest_entry_t *entry;
+
+        ret = preludedb_transaction_start(db);
+        if ( ret < 0 ) {
+                *replayable = preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION);
+                return ret;
+        }
+
+        prelude_list_for_each(batch, tmp) {
+                entry = prelude_list_entry(tmp, ingest_entry_t, list);
+
+                ret = preludedb_insert_message(db, entry->message);
+                if ( ret < 0 ) {
+                        *replayable = preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION);
+                        preludedb_transaction_abort(db);
+                        return ret;
+                }
+        }
+
+        /*
+         * Whether a COMMIT interrupted by a connection loss went through is
+         * unknown: it is not replayed, so that a batch is never inserted
+         * twice.
+         */
+        *replayable = FALSE;
+
+        return preludedb_transaction_end(db);
+}
+
+
+
+/*
+ * Insert @batch in a single transaction, replayed once if the connection
+ * was lost: starting the replay reconnects, waiting as allowed by the
+ * reconnect_attempts setting. Should it still fail for another reason,
+ * the messages are inserted again one by one, so that a single faulty
+ * message does not cause the others to be reported as failed.
+ */
+static void insert_batch(preludedb_t *db, prelude_list_t *batch)
+{
+        int ret;
+        prelude_list_t *tmp;
+        ingest_entry_t *entry;
+        prelude_bool_t replayable;
+
+        ret = insert_batch_transaction(db, batch, &replayable);
+        if ( ret < 0 && replayable ) {
+                prelude_log(PRELUDE_LOG_WARN, "connection lost while inserting a batch of messages, replaying it: %s.\n",
+                            preludedb_strerror(ret));
+
+                ret = insert_batch_transaction(db, batch, &replayable);
+        }
+
+        prelude_list_for_each(batch, tmp) {
+                entry = prelude_list_entry(tmp, ingest_entry_t, list);
+
+                if ( ret < 0 && ! preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION) )
+                        entry->result = preludedb_insert_message(db, entry->message);
+                else
+                        entry->result = ret;
+        }
+}
+
+
+
+#ifdef USE_POSIX_THREADS
+
+static void set_deadline(preludedb_ingest_t *ingest)
+{
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+
+        ingest->deadline.tv_sec = now.tv_sec + ingest->max_delay / 1000;
+        ingest->deadline.tv_nsec = (now.tv_usec + (ingest->max_delay % 1000) * 1000) * 1000;
+
+        if ( ingest->deadline.tv_nsec >= 1000000000 ) {
+                ingest->deadline.tv_sec++;
+                ingest->deadline.tv_nsec -= 1000000000;
+        }
+}
+
+
+
+static void *ingest_thread(void *data)
+{
+        unsigned int count;
+        prelude_list_t batch, *tmp, *bkp;
+        preludedb_ingest_t *ingest = data;
+
+        pthread_mutex_lock(&ingest->mutex);
+
+        while ( TRUE ) {
+                while ( ! ingest->queued && ! ingest->stop )
+                        pthread_cond_wait(&ingest->cond, &ingest->mutex);
+
+                if ( ! ingest->queued && ingest->stop )
+                        break;
+
+                while ( ingest->queued < ingest->max_messages && ! ingest->stop && ! ingest->flushing ) {
+                        if ( pthread_cond_timedwait(&ingest->cond, &ingest->mutex, &ingest->deadline) == ETIMEDOUT )
+                                break;
+                }
+
+                count = 0;
+                prelude_list_init(&batch);
+
+                prelude_list_for_each_safe(&ingest->queue, tmp, bkp) {
+                        if ( count == ingest->max_messages )
+                                break;
+
+                        prelude_list_del(tmp);
+                        prelude_list_add_tail(&batch, tmp);
+                        count++;
+                }
+
+                ingest->queued -= count;
+
+                /*
+                 * Messages queued while this batch is inserted get a full
+                 * window of their own.
+                 */
+                if ( ingest->queued )
+                        set_deadline(ingest);
+
+                pthread_cond_broadcast(&ingest->done_cond);
+                pthread_mutex_unlock(&ingest->mutex);
+
+                insert_batch(ingest->db, &batch);
+
+                count = 0;
+                prelude_list_for_each_safe(&batch, tmp, bkp) {
+                        prelude_list_del(tmp);
+                        entry_complete(prelude_list_entry(tmp, ingest_entry_t, list));
+                        count++;
+                }
+
+                pthread_mutex_lock(&ingest->mutex);
+
+                ingest->completed += count;
+                pthread_cond_broadcast(&ingest->done_cond);
+        }
+
+        pthread_mutex_unlock(&ingest->mutex);
+
+        return NULL;
+}
+
+#endif
+
+
+
+/**
+ * preludedb_ingest_new:
+ * @ingest: Where the new ingest queue will be stored.
+ * @db: Pointer to a db object messages are inserted into.
+ * @max_messages: Maximum number of messages committed together, or 0 for the default (100).
+ * @max_delay: Maximum number of milliseconds a message waits for its batch
+ * to fill up before being committed, or 0 for the default (50).
+ *
+ * Create an ingest queue, inserting messages into @db in batches sharing
+ * a single transaction. @db should not be used to start transactions
+ * while the queue exists: its own transactions are bound to the queue
+ * thread.
+ *
+ * Without thread support, messages are inserted as they are submitted.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_ingest_new(preludedb_ingest_t **ingest, preludedb_t *db, unsigned int max_messages, unsigned int max_delay)
+{
+#ifdef USE_POSIX_THREADS
+        int ret;
+#endif
+
+        prelude_return_val_if_fail(ingest && db, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        *ingest = calloc(1, sizeof(**ingest));
+        if ( ! *ingest )
+                return preludedb_error_from_errno(errno);
+
+        (*ingest)->db = db;
+        (*ingest)->max_messages = max_messages ? max_messages : DEFAULT_MAX_MESSAGES;
+        (*ingest)->max_delay = max_delay ? max_delay : DEFAULT_MAX_DELAY;
+
+#ifdef USE_POSIX_THREADS
+        prelude_list_init(&(*ingest)->queue);
+        pthread_mutex_init(&(*ingest)->mutex, NULL);
+        pthread_cond_init(&(*ingest)->cond, NULL);
+        pthread_cond_init(&(*ingest)->done_cond, NULL);
+
+        ret = pthread_create(&(*ingest)->thread, NULL, ingest_thread, *ingest);
+        if ( ret != 0 ) {
+                pthread_cond_destroy(&(*ingest)->done_cond);
+                pthread_cond_destroy(&(*ingest)->cond);
+                pthread_mutex_destroy(&(*ingest)->mutex);
+                free(*ingest);
+                return preludedb_error_verbose(prelude_error_code_from_errno(ret), "could not create ingest thread: %s", strerror(ret));
+        }
+#endif
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_ingest_destroy:
+ * @ingest: Pointer to an ingest queue.
+ *
+ * Commit the messages still queued, and destroy @ingest.
+ */
+void preludedb_ingest_destroy(preludedb_ingest_t *ingest)
+{
+        prelude_return_if_fail(ingest);
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&ingest->mutex);
+        ingest->stop = TRUE;
+        pthread_cond_signal(&ingest->cond);
+        pthread_mutex_unlock(&ingest->mutex);
+
+        pthread_join(ingest->thread, NULL);
+
+        pthread_cond_destroy(&ingest->done_cond);
+        pthread_cond_destroy(&ingest->cond);
+        pthread_mutex_destroy(&ingest->mutex);
+#endif
+
+        free(ingest);
+}
+
+
+
+/**
+ * preludedb_ingest_submit:
+ * @ingest: Pointer to an ingest queue.
+ * @message: Message to insert.
+ * @callback: Function called once @message is committed or failed to be, or NULL.
+ * @data: Pointer passed to @callback.
+ *
+ * Queue @message for insertion. @callback is called from the queue thread
+ * with the result of the insertion, and must not block. This function
+ * takes a reference on @message, and only blocks if the queue is full.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_ingest_submit(preludedb_ingest_t *ingest, idmef_message_t *message,
+                            preludedb_ingest_callback_t callback, void *data)
+{
+        ingest_entry_t *entry;
+
+        prelude_return_val_if_fail(ingest && message, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        entry = malloc(sizeof(*entry));
+        if ( ! entry )
+                return preludedb_error_from_errno(errno);
+
+        entry->message = idmef_message_ref(message);
+        entry->callback = callback;
+        entry->data = data;
+        entry->result = 0;
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&ingest->mutex);
+
+        while ( ingest->queued >= ingest->max_messages * MAX_PENDING_BATCHES && ! ingest->stop )
+                pthread_cond_wait(&ingest->done_cond, &ingest->mutex);
+
+        if ( ! ingest->queued )
+                set_deadline(ingest);
+
+        prelude_list_add_tail(&ingest->queue, &entry->list);
+        ingest->submitted++;
+
+        if ( ++ingest->queued == 1 || ingest->queued == ingest->max_messages )
+                pthread_cond_signal(&ingest->cond);
+
+        pthread_mutex_unlock(&ingest->mutex);
+#else
+        entry->result = preludedb_insert_message(ingest->db, entry->message);
+        entry_complete(entry);
+#endif
+
+        return 0;
+}
+
+
+
+static void wait_callback(idmef_message_t *message, int error, void *data)
+{
+        ingest_wait_t *wait = data;
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&wait->ingest->mutex);
+#endif
+
+        wait->result = error;
+        wait->done = TRUE;
+
+#ifdef USE_POSIX_THREADS
+        pthread_cond_broadcast(&wait->ingest->done_cond);
+        pthread_mutex_unlock(&wait->ingest->mutex);
+#endif
+}
+
+
+
+/**
+ * preludedb_ingest_insert_message:
+ * @ingest: Pointer to an ingest queue.
+ * @message: Message to insert.
+ *
+ * Queue @message for insertion, and wait until the batch it is part of
+ * is committed.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_ingest_insert_message(preludedb_ingest_t *ingest, idmef_message_t *message)
+{
+        int ret;
+        ingest_wait_t wait;
+
+        wait.ingest = ingest;
+        wait.done = FALSE;
+        wait.result = 0;
+
+        ret = preludedb_ingest_submit(ingest, message, wait_callback, &wait);
+        if ( ret < 0 )
+                return ret;
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&ingest->mutex);
+
+        while ( ! wait.done )
+                pthread_cond_wait(&ingest->done_cond, &ingest->mutex);
+
+        pthread_mutex_unlock(&ingest->mutex);
+#endif
+
+        return wait.result;
+}
+
+
+
+/**
+ * preludedb_ingest_flush:
+ * @ingest: Pointer to an ingest queue.
+ *
+ * Commit the messages queued so far without waiting for their batch to
+ * fill up, and wait until they are.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_ingest_flush(preludedb_ingest_t *ingest)
+{
+#ifdef USE_POSIX_THREADS
+        uint64_t target;
+#endif
+
+        prelude_return_val_if_fail(ingest, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&ingest->mutex);
+
+        target = ingest->submitted;
+        ingest->flushing++;
+        pthread_cond_signal(&ingest->cond);
+
+        while ( ingest->completed < target )
+                pthread_cond_wait(&ingest->done_cond, &ingest->mutex);
+
+        ingest->flushing--;
+        pthread_mutex_unlock(&ingest->mutex);
+#endif
+
+        return 0;
+}
@@ -0,0 +1,847 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb.h"
+#include "preludedb-error.h"
+#include "preludedb-path-selection.h"
+
+
+/*
+ * Recursive descent parser for path selection strings, accepting the
+ * same grammar as the flex/bison parser without setting up a scanner nor
+ * allocating anything but the resulting objects.
+ *
+ * Anything unusual (escaped quotes, characters the flex scanner would
+ * skip, syntax errors) is rejected, for the caller to fall back to the
+ * flex/bison parser, which remains the reference for error reporting.
+ */
+int _preludedb_path_selection_fast_parse(preludedb_selected_path_t *root, const char *str);
+
+
+#define PATH_BUFFER_SIZE 256
+#define NUMBER_BUFFER_SIZE 32
+
+
+typedef enum {
+        TOKEN_END,
+        TOKEN_STRING,
+        TOKEN_NUMBER,
+        TOKEN_IDMEF,
+        TOKEN_LPAREN,
+        TOKEN_RPAREN,
+        TOKEN_COMMA,
+        TOKEN_COLON,
+        TOKEN_SLASH,
+        TOKEN_MIN,
+        TOKEN_MAX,
+        TOKEN_SUM,
+        TOKEN_COUNT,
+        TOKEN_AVG,
+        TOKEN_INTERVAL,
+        TOKEN_EXTRACT,
+        TOKEN_TIMEZONE,
+        TOKEN_APPROX_COUNT_DISTINCT,
+        TOKEN_TOPK,
+        TOKEN_PERCENTILE,
+        TOKEN_YEAR,
+        TOKEN_QUARTER,
+        TOKEN_MONTH,
+        TOKEN_WEEK,
+        TOKEN_YDAY,
+        TOKEN_MDAY,
+        TOKEN_WDAY,
+        TOKEN_HOUR,
+        TOKEN_SEC,
+        TOKEN_MSEC,
+        TOKEN_USEC,
+        TOKEN_ORDER_ASC,
+        TOKEN_ORDER_DESC,
+        TOKEN_GROUP_BY
+} token_type_t;
+
+
+typedef struct {
+        const char *ptr;
+
+        token_type_t type;
+        const char *start;
+        size_t len;
+} parser_t;
+
+
+struct name_table {
+        const char *name;
+        int value;
+};
+
+
+static const struct name_table keyword_table[] = {
+        { "max", TOKEN_MAX                      },
+        { "count", TOKEN_COUNT                  },
+        { "sum", TOKEN_SUM                      },
+        { "avg", TOKEN_AVG                      },
+        { "interval", TOKEN_INTERVAL            },
+        { "extract", TOKEN_EXTRACT              },
+        { "timezone", TOKEN_TIMEZONE            },
+        { "approx_count_distinct", TOKEN_APPROX_COUNT_DISTINCT },
+        { "topk", TOKEN_TOPK                    },
+        { "percentile", TOKEN_PERCENTILE        },
+        { "year", TOKEN_YEAR                    },
+        { "quarter", TOKEN_QUARTER              },
+        { "month", TOKEN_MONTH                  },
+        { "week", TOKEN_WEEK                    },
+        { "yday", TOKEN_YDAY                    },
+        { "mday", TOKEN_MDAY                    },
+        { "wday", TOKEN_WDAY                    },
+        { "hour", TOKEN_HOUR                    },
+        { "min", TOKEN_MIN                      },
+        { "sec", TOKEN_SEC                      },
+        { "msec", TOKEN_MSEC                    },
+        { "usec", TOKEN_USEC                    },
+        { "order_asc", TOKEN_ORDER_ASC          },
+        { "order_desc", TOKEN_ORDER_DESC        },
+        { "group_by", TOKEN_GROUP_BY            },
+        { NULL, 0                               }
+};
+
+
+static const struct name_table extract_filter_table[] = {
+        { "year", PRELUDEDB_SQL_TIME_CONSTRAINT_YEAR            },
+        { "month", PRELUDEDB_SQL_TIME_CONSTRAINT_MONTH          },
+        { "yday", PRELUDEDB_SQL_TIME_CONSTRAINT_YDAY            },
+        { "mday", PRELUDEDB_SQL_TIME_CONSTRAINT_MDAY            },
+        { "wday", PRELUDEDB_SQL_TIME_CONSTRAINT_WDAY            },
+        { "hour", PRELUDEDB_SQL_TIME_CONSTRAINT_HOUR            },
+        { "min", PRELUDEDB_SQL_TIME_CONSTRAINT_MIN              },
+        { "sec", PRELUDEDB_SQL_TIME_CONSTRAINT_SEC              },
+        { "msec", PRELUDEDB_SQL_TIME_CONSTRAINT_MSEC            },
+        { "usec", PRELUDEDB_SQL_TIME_CONSTRAINT_USEC            },
+        { "quarter", PRELUDEDB_SQL_TIME_CONSTRAINT_QUARTER      },
+        { NULL, 0                                               }
+};
+
+
+static const struct name_table interval_filter_table[] = {
+        { "year", PRELUDEDB_SELECTED_OBJECT_INTERVAL_YEAR       },
+        { "month", PRELUDEDB_SELECTED_OBJECT_INTERVAL_MONTH     },
+        { "day", PRELUDEDB_SELECTED_OBJECT_INTERVAL_DAY         },
+        { "hour", PRELUDEDB_SELECTED_OBJECT_INTERVAL_HOUR       },
+        { "min", PRELUDEDB_SELECTED_OBJECT_INTERVAL_MIN         },
+        { "sec", PRELUDEDB_SELECTED_OBJECT_INTERVAL_SEC         },
+        { NULL, 0                                               }
+};
+
+
+
+static int lookup_name(const struct name_table *table, const char *name, size_t len)
+{
+        size_t i;
+
+        for ( i = 0; table[i].name != NULL; i++ ) {
+                if ( strncmp(name, table[i].name, len) == 0 && table[i].name[len] == 0 )
+                        return table[i].value;
+        }
+
+        return -1;
+}
+
+
+
+static inline prelude_bool_t is_digit(char c)
+{
+        return c >= '0' && c <= '9';
+}
+
+
+
+static inline prelude_bool_t is_word(char c)
+{
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit(c) || c == '_';
+}
+
+
+
+static inline prelude_bool_t is_path_word(char c)
+{
+        return is_word(c) || c == '-';
+}
+
+
+
+/*
+ * Matches a path element index, '(-1)', '(*)' or '("key")', returning
+ * what follows it or NULL.
+ */
+static const char *scan_path_index(const char *ptr)
+{
+        const char *start;
+        char quote;
+
+        if ( *ptr++ != '(' )
+                return NULL;
+
+        if ( *ptr == '"' || *ptr == '\'' ) {
+                quote = *ptr++;
+                start = ptr;
+
+                while ( *ptr && *ptr != quote )
+                        ptr++;
+
+                if ( *ptr != quote || ptr == start )
+                        return NULL;
+
+                ptr++;
+        }
+
+        else {
+                if ( *ptr == '-' )
+                        ptr++;
+
+                start = ptr;
+                while ( is_digit(*ptr) || *ptr == '*' )
+                        ptr++;
+
+                if ( ptr == start )
+                        return NULL;
+        }
+
+        return (*ptr == ')') ? ptr + 1 : NULL;
+}
+
+
+
+static const char *scan_path(const char *ptr)
+{
+        const char *start, *end;
+
+        do {
+                start = ptr;
+                while ( is_path_word(*ptr) )
+                        ptr++;
+
+                if ( ptr == start )
+                        return NULL;
+
+                end = scan_path_index(ptr);
+                if ( end )
+                        ptr = end;
+
+                if ( *ptr == '.' )
+                        ptr++;
+
+        } while ( is_path_word(*ptr) );
+
+        return ptr;
+}
+
+
+
+static const char *scan_number(const char *ptr)
+{
+        const char *start, *end;
+
+        if ( *ptr == '-' )
+                ptr++;
+
+        start = ptr;
+        while ( is_digit(*ptr) )
+                ptr++;
+
+        if ( *ptr == '.' && is_digit(ptr[1]) ) {
+                for ( ptr++; is_digit(*ptr); ptr++ );
+
+                if ( *ptr == 'e' || *ptr == 'E' ) {
+                        end = ptr + 1;
+                        if ( *end == '-' || *end == '+' )
+                                end++;
+
+                        if ( is_digit(*end) ) {
+                                for ( ptr = end; is_digit(*ptr); ptr++ );
+                        }
+                }
+        }
+
+        return (ptr == start) ? NULL : ptr;
+}
+
+
+
+static int next_token(parser_t *parser)
+{
+        int ret;
+        const char *ptr = parser->ptr, *end;
+
+        while ( *ptr == ' ' || (*ptr >= '\t' && *ptr <= '\r') )
+                ptr++;
+
+        parser->start = ptr;
+
+        switch ( *ptr ) {
+        case 0:
+                parser->type = TOKEN_END;
+                end = ptr;
+                break;
+
+        case '(':
+                parser->type = TOKEN_LPAREN;
+                end = ptr + 1;
+                break;
+
+        case ')':
+                parser->type = TOKEN_RPAREN;
+                end = ptr + 1;
+                break;
+
+        case ',':
+                parser->type = TOKEN_COMMA;
+                end = ptr + 1;
+                break;
+
+        case ':':
+                parser->type = TOKEN_COLON;
+                end = ptr + 1;
+                break;
+
+        case '/':
+                parser->type = TOKEN_SLASH;
+                end = ptr + 1;
+                break;
+
+        case '"':
+        case '\'':
+                /*
+                 * Escaped characters are left to the flex scanner.
+                 */
+                for ( end = ptr + 1; *end && *end != *ptr; end++ ) {
+                        if ( *end == '\\' )
+                                return -1;
+                }
+
+                if ( *end != *ptr )
+                        return -1;
+
+                parser->type = TOKEN_STRING;
+                end++;
+                break;
+
+        default:
+                if ( *ptr == '-' || *ptr == '.' || is_digit(*ptr) ) {
+                        end = scan_number(ptr);
+                        if ( ! end )
+                                return -1;
+
+                        parser->type = TOKEN_NUMBER;
+                        break;
+                }
+
+                for ( end = ptr; is_word(*end); end++ );
+
+                if ( end == ptr )
+                        return -1;
+
+                if ( *end == '.' && ((end - ptr == 5 && strncmp(ptr, "alert", 5) == 0) ||
+                                     (end - ptr == 9 && strncmp(ptr, "heartbeat", 9) == 0)) ) {
+                        end = scan_path(end + 1);
+                        if ( ! end )
+                                return -1;
+
+                        parser->type = TOKEN_IDMEF;
+                        break;
+                }
+
+                ret = lookup_name(keyword_table, ptr, end - ptr);
+                if ( ret < 0 )
+                        return -1;
+
+                parser->type = ret;
+                break;
+        }
+
+        parser->len = end - ptr;
+        parser->ptr = end;
+
+        return 0;
+}
+
+
+
+static int expect(parser_t *parser, token_type_t type)
+{
+        if ( parser->type != type )
+                return -1;
+
+        return next_token(parser);
+}
+
+
+
+static int parse_value(parser_t *parser, preludedb_selected_object_t **object);
+
+
+
+static int new_int(preludedb_selected_object_t **object, int value)
+{
+        return preludedb_selected_object_new(object, PRELUDEDB_SELECTED_OBJECT_TYPE_INT, &value);
+}
+
+
+
+static int new_path(preludedb_selected_object_t **object, const char *str, size_t len)
+{
+        int ret;
+        char *path, buf[PATH_BUFFER_SIZE];
+
+        if ( len < sizeof(buf) ) {
+                memcpy(buf, str, len);
+                buf[len] = 0;
+
+                return preludedb_selected_object_new(object, PRELUDEDB_SELECTED_OBJECT_TYPE_IDMEFPATH, buf);
+        }
+
+        path = strndup(str, len);
+        if ( ! path )
+                return preludedb_error_from_errno(errno);
+
+        ret = preludedb_selected_object_new(object, PRELUDEDB_SELECTED_OBJECT_TYPE_IDMEFPATH, path);
+        free(path);
+
+        return ret;
+}
+
+
+
+static int new_number(preludedb_selected_object_t **object, const char *str, size_t len)
+{
+        char buf[NUMBER_BUFFER_SIZE];
+
+        if ( len >= sizeof(buf) )
+                return -1;
+
+        memcpy(buf, str, len);
+        buf[len] = 0;
+
+        return new_int(object, atoi(buf));
+}
+
+
+
+/*
+ * Parses the '(number, value)' arguments of the topk() and percentile()
+ * functions, pushing the value first as the flex/bison parser does.
+ */
+static int parse_parameter_arguments(parser_t *parser, preludedb_selected_object_t *func)
+{
+        int ret;
+        preludedb_selected_object_t *param, *arg;
+
+        ret = expect(parser, TOKEN_LPAREN);
+        if ( ret < 0 )
+                return ret;
+
+        if ( parser->type != TOKEN_NUMBER )
+                return -1;
+
+        ret = new_number(&param, parser->start, parser->len);
+        if ( ret < 0 )
+                return ret;
+
+        ret = next_token(parser);
+        if ( ret >= 0 )
+                ret = expect(parser, TOKEN_COMMA);
+
+        if ( ret >= 0 )
+                ret = parse_value(parser, &arg);
+
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(param);
+                return ret;
+        }
+
+        ret = preludedb_selected_object_push_arg(func, arg);
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(arg);
+                preludedb_selected_object_destroy(param);
+                return ret;
+        }
+
+        ret = preludedb_selected_object_push_arg(func, param);
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(param);
+                return ret;
+        }
+
+        return expect(parser, TOKEN_RPAREN);
+}
+
+
+
+/*
+ * Parses the function arguments following @func, which takes ownership
+ * of them: @nvalues values, then an optional string.
+ */
+static int parse_arguments(parser_t *parser, preludedb_selected_object_t *func, unsigned int nvalues,
+                           const struct name_table *filter_table, prelude_bool_t with_string)
+{
+        int ret;
+        unsigned int i;
+        preludedb_selected_object_t *arg;
+
+        ret = expect(parser, TOKEN_LPAREN);
+        if ( ret < 0 )
+                return ret;
+
+        for ( i = 0; i < nvalues; i++ ) {
+                if ( i > 0 ) {
+                        ret = expect(parser, TOKEN_COMMA);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                ret = parse_value(parser, &arg);
+                if ( ret < 0 )
+                        return ret;
+
+                ret = preludedb_selected_object_push_arg(func, arg);
+                if ( ret < 0 ) {
+                        preludedb_selected_object_destroy(arg);
+                        return ret;
+                }
+        }
+
+        if ( filter_table || with_string ) {
+                ret = expect(parser, TOKEN_COMMA);
+                if ( ret < 0 )
+                        return ret;
+
+                if ( parser->type != TOKEN_STRING )
+                        return -1;
+
+                if ( filter_table ) {
+                        ret = lookup_name(filter_table, parser->start + 1, parser->len - 2);
+                        if ( ret < 0 )
+                                return ret;
+
+                        ret = new_int(&arg, ret);
+                }
+                else
+                        ret = preludedb_selected_object_new_string(&arg, parser->start + 1, parser->len - 2);
+
+                if ( ret < 0 )
+                        return ret;
+
+                ret = preludedb_selected_object_push_arg(func, arg);
+                if ( ret < 0 ) {
+                        preludedb_selected_object_destroy(arg);
+                        return ret;
+                }
+
+                ret = next_token(parser);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return expect(parser, TOKEN_RPAREN);
+}
+
+
+
+static int parse_function(parser_t *parser, preludedb_selected_object_t **object)
+{
+        int ret;
+        unsigned int nvalues = 1;
+        prelude_bool_t with_string = FALSE;
+        const struct name_table *filter_table = NULL;
+        preludedb_selected_object_type_t type;
+
+        switch ( parser->type ) {
+        case TOKEN_MIN:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_MIN;
+                break;
+
+        case TOKEN_MAX:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_MAX;
+                break;
+
+        case TOKEN_COUNT:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT;
+                break;
+
+        case TOKEN_AVG:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_AVG;
+                break;
+
+        case TOKEN_APPROX_COUNT_DISTINCT:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT;
+                break;
+
+        case TOKEN_TOPK:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK;
+                nvalues = 0;
+                break;
+
+        case TOKEN_PERCENTILE:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE;
+                nvalues = 0;
+                break;
+
+        case TOKEN_EXTRACT:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_EXTRACT;
+                filter_table = extract_filter_table;
+                break;
+
+        case TOKEN_INTERVAL:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_INTERVAL;
+                filter_table = interval_filter_table;
+                nvalues = 2;
+                break;
+
+        case TOKEN_TIMEZONE:
+                type = PRELUDEDB_SELECTED_OBJECT_TYPE_TIMEZONE;
+                with_string = TRUE;
+                break;
+
+        default:
+                return -1;
+        }
+
+        ret = next_token(parser);
+        if ( ret < 0 )
+                return ret;
+
+        ret = preludedb_selected_object_new(object, type, NULL);
+        if ( ret < 0 )
+                return ret;
+
+        if ( nvalues == 0 )
+                ret = parse_parameter_arguments(parser, *object);
+        else
+                ret = parse_arguments(parser, *object, nvalues, filter_table, with_string);
+
+        if ( ret < 0 )
+                preludedb_selected_object_destroy(*object);
+
+        return ret;
+}
+
+
+
+static int parse_valuetype(parser_t *parser, preludedb_selected_object_t **object)
+{
+        int ret;
+
+        switch ( parser->type ) {
+        case TOKEN_IDMEF:
+                ret = new_path(object, parser->start, parser->len);
+                break;
+
+        case TOKEN_STRING:
+                ret = preludedb_selected_object_new_string(object, parser->start + 1, parser->len - 2);
+                break;
+
+        case TOKEN_NUMBER:
+                ret = new_number(object, parser->start, parser->len);
+                break;
+
+        default:
+                return parse_function(parser, object);
+        }
+
+        if ( ret < 0 )
+                return ret;
+
+        ret = next_token(parser);
+        if ( ret < 0 )
+                preludedb_selected_object_destroy(*object);
+
+        return ret;
+}
+
+
+
+static int get_modifier(token_type_t type)
+{
+        switch ( type ) {
+        case TOKEN_YEAR:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_YEAR;
+
+        case TOKEN_MONTH:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_MONTH;
+
+        case TOKEN_YDAY:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_YDAY;
+
+        case TOKEN_MDAY:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_MDAY;
+
+        case TOKEN_WDAY:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_WDAY;
+
+        case TOKEN_HOUR:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_HOUR;
+
+        case TOKEN_MIN:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_MIN;
+
+        case TOKEN_SEC:
+                return PRELUDEDB_SQL_TIME_CONSTRAINT_SEC;
+
+        default:
+                return -1;
+        }
+}
+
+
+
+static int parse_value(parser_t *parser, preludedb_selected_object_t **object)
+{
+        int ret, modifier;
+        preludedb_selected_object_t *value, *num;
+
+        ret = parse_valuetype(parser, &value);
+        if ( ret < 0 )
+                return ret;
+
+        if ( parser->type != TOKEN_COLON ) {
+                *object = value;
+                return 0;
+        }
+
+        ret = next_token(parser);
+        if ( ret < 0 )
+                goto error;
+
+        ret = modifier = get_modifier(parser->type);
+        if ( ret < 0 )
+                goto error;
+
+        ret = next_token(parser);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_selected_object_new(object, PRELUDEDB_SELECTED_OBJECT_TYPE_EXTRACT, NULL);
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_selected_object_push_arg(*object, value);
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(*object);
+                goto error;
+        }
+
+        ret = new_int(&num, modifier);
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(*object);
+                return ret;
+        }
+
+        ret = preludedb_selected_object_push_arg(*object, num);
+        if ( ret < 0 ) {
+                preludedb_selected_object_destroy(num);
+                preludedb_selected_object_destroy(*object);
+        }
+
+        return ret;
+
+ error:
+        preludedb_selected_object_destroy(value);
+        return ret;
+}
+
+
+
+static int parse_option(parser_t *parser, preludedb_selected_path_flags_t *flags)
+{
+        switch ( parser->type ) {
+        case TOKEN_ORDER_ASC:
+                *flags |= PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_ASC;
+                break;
+
+        case TOKEN_ORDER_DESC:
+                *flags |= PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC;
+                break;
+
+        case TOKEN_GROUP_BY:
+                *flags |= PRELUDEDB_SELECTED_PATH_FLAGS_GROUP_BY;
+                break;
+
+        default:
+                return -1;
+        }
+
+        return next_token(parser);
+}
+
+
+
+/*
+ * Returns 0 and sets up @root on success, a negative value if @str was
+ * not parsed, @root being then left untouched.
+ */
+int _preludedb_path_selection_fast_parse(preludedb_selected_path_t *root, const char *str)
+{
+        int ret;
+        parser_t parser;
+        preludedb_selected_object_t *object;
+        preludedb_selected_path_flags_t flags = 0;
+
+        parser.ptr = str;
+
+        ret = next_token(&parser);
+        if ( ret < 0 )
+                return ret;
+
+        ret = parse_value(&parser, &object);
+        if ( ret < 0 )
+                return ret;
+
+        if ( parser.type == TOKEN_SLASH ) {
+                ret = next_token(&parser);
+
+                while ( ret >= 0 ) {
+                        ret = parse_option(&parser, &flags);
+                        if ( ret < 0 || parser.type != TOKEN_COMMA )
+                                break;
+
+                        ret = next_token(&parser);
+                }
+        }
+
+        if ( ret < 0 || parser.type != TOKEN_END ) {
+                preludedb_selected_object_destroy(object);
+                return -1;
+        }
+
+        preludedb_selected_path_set_object(root, object);
+        if ( flags )
+                preludedb_selected_path_set_flags(root, flags);
+
+        return 0;
+}
@@ -350,8 +350,8 @@ static void yy_fatal_error (yyconst char msg[] ,yyscan_t yyscanner );
 	*yy_cp = '\0'; \
 	yyg->yy_c_buf_p = yy_cp;
 
-#define YY_NUM_RULES 34
-#define YY_END_OF_BUFFER 35
+#define YY_NUM_RULES 37
+#define YY_END_OF_BUFFER 38
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -359,25 +359,29 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static yyconst flex_int16_t yy_accept[161] =
+static yyconst flex_int16_t yy_accept[196] =
     {   0,
-        0,    0,   35,   33,   32,   32,   33,   33,   27,   28,
-       29,   33,   33,   31,    3,   30,   33,   33,   33,   33,
-       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
-       32,    0,    1,    0,    0,    2,    0,    0,    3,    3,
-        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,   38,   36,   35,   35,   36,   36,   30,   31,
+       32,   36,   36,   34,    3,   33,   36,   36,   36,   36,
+       36,   36,   36,   36,   36,   36,   36,   36,   36,   36,
+       36,   35,    0,    1,    0,    0,    2,    0,    0,    3,
+        3,    0,    0,    0,    0,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    1,    0,    0,    2,    0,    0,
-        0,    7,    0,    0,    0,    0,    0,    0,    4,    0,
-       19,    0,    0,    0,    0,   20,    6,    0,    0,    0,
-        0,    0,    0,    0,    3,    0,    0,    0,    0,    0,
-
-       18,    0,   16,    0,   21,    0,    0,    0,   22,   17,
-       14,   15,   11,    0,    5,    0,    0,    0,    0,   13,
-        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,   26,    9,    0,    0,    0,    0,    0,   12,    0,
-        0,   26,   25,    0,    8,    0,    0,   10,    0,    0,
-        0,    0,   23,    0,    0,    0,   26,   24,    0,    0
+        0,    0,    0,    0,    0,    0,    0,    0,    1,    0,
+        0,    2,    0,    0,    0,    0,    7,    0,    0,    0,
+        0,    0,    0,    4,    0,   22,    0,    0,    0,    0,
+        0,   23,    6,    0,    0,    0,    0,    0,    0,    0,
+
+        0,    3,    0,    0,    0,    0,    0,    0,   21,    0,
+       19,    0,   24,    0,    0,    0,    0,   12,   25,   20,
+       17,   18,   14,    0,    0,    5,    0,    0,    0,    0,
+       16,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,   29,    0,    9,    0,    0,
+        0,    0,    0,    0,   15,    0,    0,   29,    0,   28,
+        0,    8,    0,    0,    0,   10,    0,    0,    0,    0,
+        0,    0,   26,    0,    0,    0,    0,   29,    0,   27,
+       13,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,   11,    0
     } ;
 
 static yyconst flex_int32_t yy_ec[256] =
@@ -414,123 +418,185 @@ static yyconst flex_int32_t yy_ec[256] =
 
 static yyconst flex_int32_t yy_meta[44] =
     {   0,
-        1,    1,    1,    2,    3,    1,    1,    1,    1,    1,
-        4,    1,    1,    4,    1,    4,    4,    1,    4,    4,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
-        4,    4,    4
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1
     } ;
 
-static yyconst flex_int16_t yy_base[168] =
+static yyconst flex_int16_t yy_base[196] =
     {   0,
-        0,    0,  233,  234,   42,   44,   44,   45,  234,  234,
-      234,   37,  218,  234,   40,  234,   26,  199,  189,  194,
-       29,  197,   37,  192,  188,   32,  198,  188,   35,   43,
-       69,   64,  234,   71,   72,  234,   73,  209,   67,   69,
-      198,  196,  182,  182,  186,  197,  178,  178,  173,  193,
-      181,  180,  186,  186,  188,  185,  176,  175,  180,  183,
-      178,  181,  180,   76,   80,   84,   87,   90,   94,   92,
-      164,  234,  167,  162,  158,  160,  159,  169,  234,  150,
-      234,  154,  168,  165,  153,  234,  234,  163,  164,  143,
-      156,  141,  147,  167,  166,  142,  141,  157,  143,  138,
-
-      234,  139,  234,  147,  234,  137,  134,  127,  234,  234,
-      234,  234,  234,  157,  234,  146,  148,  145,  126,  234,
-      145,  139,  130,    0,  124,  139,  135,  138,   84,  122,
-      125,  103,  234,  113,  134,  124,  116,  127,  234,  126,
-      106,    0,  234,  111,  234,  121,   88,  234,    0,    0,
-      111,  108,  234,  101,  117,  108,   88,  234,   89,  234,
-      125,  129,  133,  137,   81,  141,  145
+        0,    0,   44,    0,   43,    0,   46,   89,    0,    0,
+        0,  121,  120,    0,    0,    0,  107,  105,   97,  104,
+      117,  111,  124,  108,  121,  110,  126,  125,  117,  131,
+      135,    0,    0,    0,  161,    0,    0,  204,    0,    0,
+      231,  137,  174,  224,  212,  214,  220,  233,  216,  219,
+      216,  238,  228,  229,  237,  239,  228,  244,  243,  236,
+      237,  235,  245,  250,  247,  252,  253,    0,    0,    0,
+        0,    0,    0,  265,  240,  242,    0,  247,  245,  243,
+      247,  248,  260,    0,  243,    0,  249,  265,  264,  267,
+      255,    0,    0,  267,  264,  271,  252,  267,  254,  262,
+
+      284,    0,  262,  268,  264,  282,  270,  267,    0,  270,
+        0,  280,    0,  272,  284,  272,  267,    0,    0,    0,
+        0,    0,    0,  299,  271,    0,  291,  295,  294,  277,
+        0,  298,  287,  295,  288,  310,  303,  286,  304,  304,
+      334,  335,  319,  322,  328,  354,  339,    0,  320,  343,
+      335,  329,  343,  341,    0,  345,  366,    0,  340,    0,
+      336,    0,  353,  340,  349,    0,  380,  423,  460,  372,
+      346,    0,    0,  406,  445,  466,  466,  460,  442,    0,
+        0,  468,    0,  439,  458,  455,  452,  444,  444,  455,
+      452,  462,  448,    0,  486
     } ;
 
-static yyconst flex_int16_t yy_def[168] =
+static yyconst flex_int16_t yy_def[196] =
     {   0,
-      160,    1,  160,  160,  160,  160,  161,  162,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  161,  160,  163,  162,  160,  164,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  161,  161,  163,  162,  162,  164,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  165,  160,  160,  160,  160,  160,  160,
-      160,  165,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  165,  160,  160,  160,  160,  160,  160,  166,  167,
-      160,  160,  160,  160,  166,  167,  165,  160,  160,    0,
-      160,  160,  160,  160,  160,  160,  160
+      195,    1,  195,  195,  195,    5,  195,  195,  195,  195,
+      195,  195,  195,  195,   12,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,    5,    7,  195,    7,    8,  195,    8,   13,   12,
+       13,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,    7,    7,   35,
+        8,    8,   38,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+
+      195,  101,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  136,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  136,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  169,
+      195,  124,  195,  195,  195,  167,  168,  136,  195,  195,
+      195,  195,  182,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,    0
     } ;
 
-static yyconst flex_int16_t yy_nxt[278] =
+static yyconst flex_int16_t yy_nxt[530] =
     {   0,
         4,    5,    6,    7,    8,    9,   10,    4,    4,   11,
        12,   13,   14,   15,   16,    4,    4,    4,    4,   17,
         4,   18,    4,   19,   20,   21,   22,    4,    4,   23,
-        4,   24,    4,   25,    4,   26,   27,   28,    4,   29,
-        4,   30,    4,   31,   31,   31,   31,   33,   38,   36,
-       39,   38,   46,   39,   41,   56,   49,   60,   61,   50,
-       47,   34,   37,   51,   42,   62,   63,   33,   52,   57,
-       31,   31,   53,   32,   65,   35,   36,   68,   38,   33,
-       39,   34,   40,   33,  132,   70,   32,   65,   66,   37,
-       69,   36,   70,   34,   36,  157,   35,   34,   68,  142,
-
-       94,   66,   94,  137,   37,   95,  138,   37,  141,  149,
-      150,   69,  159,  151,  142,  151,  152,  157,  151,  151,
-      159,  151,  158,  154,  151,   32,   32,   32,   32,   35,
-       35,   35,   35,   64,   64,   64,   64,   67,   67,   67,
-       67,  155,  153,  155,  155,  156,  156,  114,  156,  148,
-      147,  146,  145,  144,  143,  140,  139,  136,  135,  134,
-      133,  131,  130,  129,  128,  127,  126,  125,  124,  123,
-      122,  121,  120,  119,  118,  117,  116,  115,  114,   95,
-       95,  113,  112,  111,  110,  109,  108,  107,  106,  105,
-      104,  103,  102,  101,  100,   99,   98,   97,   96,   93,
-
-       92,   91,   90,   89,   88,   87,   86,   85,   84,   83,
-       82,   81,   80,   79,   78,   77,   76,   75,   74,   73,
-       72,   71,   40,   59,   58,   55,   54,   48,   45,   44,
-       43,   40,  160,    3,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160
+        4,   24,   25,   26,    4,   27,   28,   29,    4,   30,
+        4,   31,    4,  195,   32,   32,   33,   33,   33,   34,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   35,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   36,
+       36,   36,   36,   37,   36,   36,   36,   36,   36,   36,
+
+       36,   36,   36,   36,   36,   36,   38,   36,   36,   36,
+       36,   36,   36,   36,   36,   36,   36,   36,   36,   36,
+       36,   36,   36,   36,   36,   36,   36,   36,   36,   36,
+       36,   36,   39,   41,   40,   42,   45,   46,   47,   43,
+       48,   50,   56,   51,   57,   44,   52,   58,   49,   59,
+       53,   61,   63,   64,   65,   54,   62,   66,   67,   55,
+       75,   68,   68,   60,   69,   68,   68,   68,   68,   68,
+       68,   68,   68,   68,   68,   68,   68,   68,   70,   68,
+       68,   68,   68,   68,   68,   68,   68,   68,   68,   68,
+       68,   68,   68,   68,   68,   68,   68,   68,   68,   68,
+
+       68,   68,   68,   68,   71,   71,   76,   71,   72,   71,
+       71,   71,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   73,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   71,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   71,   71,   71,   71,   71,   71,   74,   77,   78,
+       79,   80,   81,   82,   74,   83,   84,   85,   86,   87,
+       88,   89,   90,   91,   92,   93,   94,   95,   96,   97,
+       98,   99,  100,  101,  103,  101,  104,  105,  102,  106,
+      107,  108,  109,  110,  111,  112,  113,  114,  115,  116,
+      117,  118,  119,  120,  121,  122,  123,  102,  124,  125,
+
+      126,  127,  128,  129,  130,  131,  132,  133,  134,  135,
+      136,  137,  138,  139,  140,  141,  142,  143,  144,  145,
+      146,  147,  148,  146,  149,  146,  146,  150,  146,  146,
+      146,  146,  146,  146,  146,  146,  146,  146,  146,  146,
+      146,  146,  146,  146,  146,  146,  146,  146,  146,  146,
+      146,  146,  146,  151,  152,  154,  155,  153,  156,  157,
+      159,  160,  161,  162,  163,  158,  164,  165,  166,  167,
+      168,  171,  172,  169,  173,  174,  170,  175,  195,  169,
+      176,  176,  176,  179,  176,  176,  176,  176,  176,  176,
+      176,  176,  176,  176,  176,  176,  176,  176,  176,  176,
+
+      176,  176,  176,  176,  176,  176,  176,  176,  176,  176,
+      176,  176,  176,  176,  176,  176,  176,  176,  176,  176,
+      176,  176,  176,  177,  177,  177,  177,  180,  177,  177,
+      177,  177,  177,  177,  177,  177,  177,  177,  177,  177,
+      177,  177,  177,  177,  177,  177,  177,  177,  177,  177,
+      177,  177,  177,  177,  177,  177,  177,  177,  177,  177,
+      177,  177,  177,  177,  177,  177,  178,  169,  181,  182,
+      183,  158,  184,  169,  178,  185,  186,  187,  188,  189,
+      190,  191,  192,  193,  194,    3,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195
     } ;
 
-static yyconst flex_int16_t yy_chk[278] =
+static yyconst flex_int16_t yy_chk[530] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    5,    5,    6,    6,    7,   12,    8,
-       12,   15,   21,   15,   17,   26,   23,   29,   29,   23,
-       21,    7,    8,   23,   17,   30,   30,   32,   23,   26,
-       31,   31,   23,   34,   34,   37,   35,   37,   39,   64,
-       39,   32,   40,   65,  165,   40,   66,   66,   34,   35,
-       37,   67,   40,   64,   68,  159,   69,   65,   69,  157,
-
-       70,   66,   70,  129,   67,   70,  129,   68,  132,  141,
-      141,   69,  156,  141,  132,  152,  141,  151,  151,  141,
-      155,  152,  154,  147,  151,  161,  161,  161,  161,  162,
-      162,  162,  162,  163,  163,  163,  163,  164,  164,  164,
-      164,  166,  146,  166,  166,  167,  167,  144,  167,  140,
-      138,  137,  136,  135,  134,  131,  130,  128,  127,  126,
-      125,  123,  122,  121,  119,  118,  117,  116,  114,  108,
-      107,  106,  104,  102,  100,   99,   98,   97,   96,   95,
-       94,   93,   92,   91,   90,   89,   88,   85,   84,   83,
-       82,   80,   78,   77,   76,   75,   74,   73,   71,   63,
-
-       62,   61,   60,   59,   58,   57,   56,   55,   54,   53,
-       52,   51,   50,   49,   48,   47,   46,   45,   44,   43,
-       42,   41,   38,   28,   27,   25,   24,   22,   20,   19,
-       18,   13,    3,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160,  160,  160,  160,
-      160,  160,  160,  160,  160,  160,  160
+        1,    1,    1,    3,    5,    5,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,   12,   13,   12,   17,   18,   19,   20,   17,
+       21,   22,   24,   23,   25,   17,   23,   26,   21,   27,
+       23,   28,   29,   30,   30,   23,   28,   31,   31,   23,
+       42,   35,   35,   27,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+
+       35,   35,   35,   35,   38,   38,   43,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   41,   44,   45,
+       46,   47,   48,   49,   41,   50,   51,   52,   53,   54,
+       55,   56,   57,   58,   59,   60,   61,   62,   63,   64,
+       65,   66,   67,   74,   75,   74,   76,   78,   74,   79,
+       80,   81,   82,   83,   85,   87,   88,   89,   90,   91,
+       94,   95,   96,   97,   98,   99,  100,  101,  103,  104,
+
+      105,  106,  107,  108,  110,  112,  114,  115,  116,  117,
+      124,  125,  127,  128,  129,  130,  132,  133,  134,  135,
+      136,  137,  138,  136,  139,  136,  136,  140,  136,  136,
+      136,  136,  136,  136,  136,  136,  136,  136,  136,  136,
+      136,  136,  136,  136,  136,  136,  136,  136,  136,  136,
+      136,  136,  136,  141,  142,  143,  144,  142,  145,  146,
+      147,  149,  150,  151,  152,  146,  153,  154,  156,  157,
+      157,  159,  161,  157,  163,  164,  157,  165,  170,  157,
+      167,  167,  167,  171,  167,  167,  167,  167,  167,  167,
+      167,  167,  167,  167,  167,  167,  167,  167,  167,  167,
+
+      167,  167,  167,  167,  167,  167,  167,  167,  167,  167,
+      167,  167,  167,  167,  167,  167,  167,  167,  167,  167,
+      167,  167,  167,  168,  168,  168,  168,  174,  168,  168,
+      168,  168,  168,  168,  168,  168,  168,  168,  168,  168,
+      168,  168,  168,  168,  168,  168,  168,  168,  168,  168,
+      168,  168,  168,  168,  168,  168,  168,  168,  168,  168,
+      168,  168,  168,  168,  168,  168,  169,  169,  175,  176,
+      177,  178,  179,  169,  182,  184,  185,  186,  187,  188,
+      189,  190,  191,  192,  193,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195,  195,
+      195,  195,  195,  195,  195,  195,  195,  195,  195
     } ;
 
 /* The intent behind this definition is that it'll catch
@@ -551,7 +617,7 @@ static yyconst flex_int16_t yy_chk[278] =
 
   #define TOKEN(id) return t##id
 #define YY_NO_INPUT 1
-#line 555 "preludedb-path-selection-parser.lex.c"
+#line 621 "preludedb-path-selection-parser.lex.c"
 
 #define INITIAL 0
 
@@ -818,7 +884,7 @@ YY_DECL
 #line 19 "preludedb-path-selection-parser.lex.l"
 
 
-#line 822 "preludedb-path-selection-parser.lex.c"
+#line 888 "preludedb-path-selection-parser.lex.c"
 
 	while ( 1 )		/* loops until end-of-file is reached */
 		{
@@ -845,13 +911,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 161 )
+				if ( yy_current_state >= 196 )
 					yy_c = yy_meta[(unsigned int) yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 234 );
+		while ( yy_base[yy_current_state] != 486 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -959,83 +1025,98 @@ YY_RULE_SETUP
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 65 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(YEAR); }
+#line 64 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(APPROX_COUNT_DISTINCT); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 66 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(QUARTER); }
+#line 65 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(TOPK); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 67 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(MONTH); }
+#line 66 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(PERCENTILE); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
 #line 68 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(WEEK); }
+{ TOKEN(YEAR); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
 #line 69 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(YDAY); }
+{ TOKEN(QUARTER); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
 #line 70 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(MDAY); }
+{ TOKEN(MONTH); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
 #line 71 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(WDAY); }
+{ TOKEN(WEEK); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
 #line 72 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(HOUR); }
+{ TOKEN(YDAY); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
 #line 73 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(MIN); }
+{ TOKEN(MDAY); }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
 #line 74 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(SEC); }
+{ TOKEN(WDAY); }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
 #line 75 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(MSEC); }
+{ TOKEN(HOUR); }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
 #line 76 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(USEC); }
+{ TOKEN(MIN); }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 79 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(ORDER_ASC); }
+#line 77 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(SEC); }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 80 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(ORDER_DESC); }
+#line 78 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(MSEC); }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 81 "preludedb-path-selection-parser.lex.l"
-{ TOKEN(GROUP_BY); }
+#line 79 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(USEC); }
 	YY_BREAK
 case 26:
-/* rule 26 can match eol */
+YY_RULE_SETUP
+#line 82 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(ORDER_ASC); }
+	YY_BREAK
+case 27:
 YY_RULE_SETUP
 #line 83 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(ORDER_DESC); }
+	YY_BREAK
+case 28:
+YY_RULE_SETUP
+#line 84 "preludedb-path-selection-parser.lex.l"
+{ TOKEN(GROUP_BY); }
+	YY_BREAK
+case 29:
+/* rule 29 can match eol */
+YY_RULE_SETUP
+#line 86 "preludedb-path-selection-parser.lex.l"
 {
         int ret;
 
@@ -1048,48 +1129,48 @@ YY_RULE_SETUP
         TOKEN(IDMEF);
 }
 	YY_BREAK
-case 27:
+case 30:
 YY_RULE_SETUP
-#line 95 "preludedb-path-selection-parser.lex.l"
+#line 98 "preludedb-path-selection-parser.lex.l"
 { TOKEN(LPAREN); }
 	YY_BREAK
-case 28:
+case 31:
 YY_RULE_SETUP
-#line 96 "preludedb-path-selection-parser.lex.l"
+#line 99 "preludedb-path-selection-parser.lex.l"
 { TOKEN(RPAREN); }
 	YY_BREAK
-case 29:
+case 32:
 YY_RULE_SETUP
-#line 97 "preludedb-path-selection-parser.lex.l"
+#line 100 "preludedb-path-selection-parser.lex.l"
 { TOKEN(COMMA); }
 	YY_BREAK
-case 30:
+case 33:
 YY_RULE_SETUP
-#line 98 "preludedb-path-selection-parser.lex.l"
+#line 101 "preludedb-path-selection-parser.lex.l"
 { TOKEN(COLON); }
 	YY_BREAK
-case 31:
+case 34:
 YY_RULE_SETUP
-#line 99 "preludedb-path-selection-parser.lex.l"
+#line 102 "preludedb-path-selection-parser.lex.l"
 { TOKEN(SLASH); }
 	YY_BREAK
-case 32:
-/* rule 32 can match eol */
+case 35:
+/* rule 35 can match eol */
 YY_RULE_SETUP
-#line 100 "preludedb-path-selection-parser.lex.l"
+#line 103 "preludedb-path-selection-parser.lex.l"
 // skip whitespace
 	YY_BREAK
-case 33:
+case 36:
 YY_RULE_SETUP
-#line 101 "preludedb-path-selection-parser.lex.l"
+#line 104 "preludedb-path-selection-parser.lex.l"
 { fprintf(stderr, "Unknown token '%s'\n", yytext); }
 	YY_BREAK
-case 34:
+case 37:
 YY_RULE_SETUP
-#line 103 "preludedb-path-selection-parser.lex.l"
+#line 106 "preludedb-path-selection-parser.lex.l"
 ECHO;
 	YY_BREAK
-#line 1093 "preludedb-path-selection-parser.lex.c"
+#line 1174 "preludedb-path-selection-parser.lex.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1384,7 +1465,7 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 161 )
+			if ( yy_current_state >= 196 )
 				yy_c = yy_meta[(unsigned int) yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
@@ -1413,11 +1494,11 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 161 )
+		if ( yy_current_state >= 196 )
 			yy_c = yy_meta[(unsigned int) yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-	yy_is_jam = (yy_current_state == 160);
+	yy_is_jam = (yy_current_state == 195);
 
 	(void)yyg;
 	return yy_is_jam ? 0 : yy_current_state;
@@ -2216,7 +2297,7 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 103 "preludedb-path-selection-parser.lex.l"
+#line 106 "preludedb-path-selection-parser.lex.l"
 
 
 
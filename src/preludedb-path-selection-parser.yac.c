@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 1 "preludedb-path-selection-parser.yac.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 1 "preludedb-path-selection-parser.yac.y"
 
   #include "config.h"
   #include <stdio.h>
@@ -71,152 +76,97 @@
   #include "preludedb-path-selection-parser.yac.h"
   #include "preludedb-path-selection-parser.lex.h"
 
-#line 75 "preludedb-path-selection-parser.yac.c" /* yacc.c:339  */
+#line 80 "preludedb-path-selection-parser.yac.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 1
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "y.tab.h".  */
-#ifndef YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED
-# define YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-/* "%code requires" blocks.  */
-#line 15 "preludedb-path-selection-parser.yac.y" /* yacc.c:355  */
-
-
-#ifndef YY_TYPEDEF_YY_SCANNER_T
-# define YY_TYPEDEF_YY_SCANNER_T
-typedef void* yyscan_t;
-#endif
-
-#line 113 "preludedb-path-selection-parser.yac.c" /* yacc.c:355  */
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    tSTRING = 258,
-    tIDMEF = 259,
-    tNUMBER = 260,
-    tERROR = 261,
-    tLPAREN = 262,
-    tRPAREN = 263,
-    tCOLON = 264,
-    tCOMMA = 265,
-    tSLASH = 266,
-    tMIN = 267,
-    tMAX = 268,
-    tSUM = 269,
-    tCOUNT = 270,
-    tINTERVAL = 271,
-    tAVG = 272,
-    tEXTRACT = 273,
-    tTIMEZONE = 274,
-    tYEAR = 275,
-    tQUARTER = 276,
-    tMONTH = 277,
-    tWEEK = 278,
-    tYDAY = 279,
-    tMDAY = 280,
-    tWDAY = 281,
-    tDAY = 282,
-    tHOUR = 283,
-    tSEC = 284,
-    tMSEC = 285,
-    tUSEC = 286,
-    tORDER_ASC = 287,
-    tORDER_DESC = 288,
-    tGROUP_BY = 289
-  };
-#endif
-/* Tokens.  */
-#define tSTRING 258
-#define tIDMEF 259
-#define tNUMBER 260
-#define tERROR 261
-#define tLPAREN 262
-#define tRPAREN 263
-#define tCOLON 264
-#define tCOMMA 265
-#define tSLASH 266
-#define tMIN 267
-#define tMAX 268
-#define tSUM 269
-#define tCOUNT 270
-#define tINTERVAL 271
-#define tAVG 272
-#define tEXTRACT 273
-#define tTIMEZONE 274
-#define tYEAR 275
-#define tQUARTER 276
-#define tMONTH 277
-#define tWEEK 278
-#define tYDAY 279
-#define tMDAY 280
-#define tWDAY 281
-#define tDAY 282
-#define tHOUR 283
-#define tSEC 284
-#define tMSEC 285
-#define tUSEC 286
-#define tORDER_ASC 287
-#define tORDER_DESC 288
-#define tGROUP_BY 289
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
-union YYSTYPE
+#include "preludedb-path-selection-parser.yac.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-#line 23 "preludedb-path-selection-parser.yac.y" /* yacc.c:355  */
-
-        int val;
-        int flags;
-        int error;
-        preludedb_selected_object_interval_t interval;
-        preludedb_selected_object_type_t type;
-        preludedb_selected_object_t *object;
-
-#line 202 "preludedb-path-selection-parser.yac.c" /* yacc.c:355  */
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_tSTRING = 3,                    /* tSTRING  */
+  YYSYMBOL_tIDMEF = 4,                     /* tIDMEF  */
+  YYSYMBOL_tNUMBER = 5,                    /* tNUMBER  */
+  YYSYMBOL_tERROR = 6,                     /* tERROR  */
+  YYSYMBOL_tLPAREN = 7,                    /* tLPAREN  */
+  YYSYMBOL_tRPAREN = 8,                    /* tRPAREN  */
+  YYSYMBOL_tCOLON = 9,                     /* tCOLON  */
+  YYSYMBOL_tCOMMA = 10,                    /* tCOMMA  */
+  YYSYMBOL_tSLASH = 11,                    /* tSLASH  */
+  YYSYMBOL_tMIN = 12,                      /* tMIN  */
+  YYSYMBOL_tMAX = 13,                      /* tMAX  */
+  YYSYMBOL_tSUM = 14,                      /* tSUM  */
+  YYSYMBOL_tCOUNT = 15,                    /* tCOUNT  */
+  YYSYMBOL_tINTERVAL = 16,                 /* tINTERVAL  */
+  YYSYMBOL_tAVG = 17,                      /* tAVG  */
+  YYSYMBOL_tEXTRACT = 18,                  /* tEXTRACT  */
+  YYSYMBOL_tTIMEZONE = 19,                 /* tTIMEZONE  */
+  YYSYMBOL_tAPPROX_COUNT_DISTINCT = 20,    /* tAPPROX_COUNT_DISTINCT  */
+  YYSYMBOL_tTOPK = 21,                     /* tTOPK  */
+  YYSYMBOL_tPERCENTILE = 22,               /* tPERCENTILE  */
+  YYSYMBOL_tYEAR = 23,                     /* tYEAR  */
+  YYSYMBOL_tQUARTER = 24,                  /* tQUARTER  */
+  YYSYMBOL_tMONTH = 25,                    /* tMONTH  */
+  YYSYMBOL_tWEEK = 26,                     /* tWEEK  */
+  YYSYMBOL_tYDAY = 27,                     /* tYDAY  */
+  YYSYMBOL_tMDAY = 28,                     /* tMDAY  */
+  YYSYMBOL_tWDAY = 29,                     /* tWDAY  */
+  YYSYMBOL_tDAY = 30,                      /* tDAY  */
+  YYSYMBOL_tHOUR = 31,                     /* tHOUR  */
+  YYSYMBOL_tSEC = 32,                      /* tSEC  */
+  YYSYMBOL_tMSEC = 33,                     /* tMSEC  */
+  YYSYMBOL_tUSEC = 34,                     /* tUSEC  */
+  YYSYMBOL_tORDER_ASC = 35,                /* tORDER_ASC  */
+  YYSYMBOL_tORDER_DESC = 36,               /* tORDER_DESC  */
+  YYSYMBOL_tGROUP_BY = 37,                 /* tGROUP_BY  */
+  YYSYMBOL_YYACCEPT = 38,                  /* $accept  */
+  YYSYMBOL_expressions = 39,               /* expressions  */
+  YYSYMBOL_option = 40,                    /* option  */
+  YYSYMBOL_expression_option = 41,         /* expression_option  */
+  YYSYMBOL_oneargfunc = 42,                /* oneargfunc  */
+  YYSYMBOL_onearg = 43,                    /* onearg  */
+  YYSYMBOL_extract = 44,                   /* extract  */
+  YYSYMBOL_extractfunc = 45,               /* extractfunc  */
+  YYSYMBOL_interval = 46,                  /* interval  */
+  YYSYMBOL_intervalfunc = 47,              /* intervalfunc  */
+  YYSYMBOL_timezone = 48,                  /* timezone  */
+  YYSYMBOL_timezonefunc = 49,              /* timezonefunc  */
+  YYSYMBOL_param = 50,                     /* param  */
+  YYSYMBOL_paramfunc = 51,                 /* paramfunc  */
+  YYSYMBOL_func = 52,                      /* func  */
+  YYSYMBOL_modifier = 53,                  /* modifier  */
+  YYSYMBOL_valuetype = 54,                 /* valuetype  */
+  YYSYMBOL_value = 55                      /* value  */
 };
-
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
-int yyparse (yyscan_t scanner, preludedb_selected_path_t *root);
 
-#endif /* !YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED  */
-
-/* Copy the second part of user declarations.  */
-
-#line 218 "preludedb-path-selection-parser.yac.c" /* yacc.c:358  */
 /* Unqualified %code blocks.  */
-#line 33 "preludedb-path-selection-parser.yac.y" /* yacc.c:359  */
+#line 33 "preludedb-path-selection-parser.yac.y"
 
     static void yyerror(yyscan_t scanner, preludedb_selected_path_t *root, const char *msg)
     {
@@ -275,34 +225,93 @@ int yyparse (yyscan_t scanner, preludedb_selected_path_t *root);
             return get_filter((const struct filter_table *) &time_filter_table, str);
     }
 
-#line 279 "preludedb-path-selection-parser.yac.c" /* yacc.c:359  */
+#line 229 "preludedb-path-selection-parser.yac.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
 #else
 typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -310,15 +319,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -332,47 +354,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -385,8 +403,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -451,8 +483,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -461,17 +492,17 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -484,11 +515,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -500,12 +531,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -515,30 +546,33 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  25
+#define YYFINAL  30
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   58
+#define YYLAST   70
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  35
+#define YYNTOKENS  38
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  16
+#define YYNNTS  18
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  39
+#define YYNRULES  44
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  64
+#define YYNSTATES  74
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   289
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   292
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -568,188 +602,201 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
-      25,    26,    27,    28,    29,    30,    31,    32,    33,    34
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,   122,   122,   126,   127,   129,   130,   131,   133,   134,
-     137,   138,   139,   140,   143,   150,   151,   178,   179,   207,
-     208,   220,   220,   220,   220,   222,   223,   224,   225,   226,
-     227,   228,   229,   231,   231,   231,   231,   232,   261,   262
+       0,   125,   125,   129,   130,   132,   133,   134,   136,   137,
+     140,   141,   142,   143,   144,   147,   154,   155,   182,   183,
+     211,   212,   224,   225,   226,   241,   241,   241,   241,   241,
+     243,   244,   245,   246,   247,   248,   249,   250,   252,   252,
+     252,   252,   253,   282,   283
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 1
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "tSTRING", "tIDMEF", "tNUMBER", "tERROR",
-  "tLPAREN", "tRPAREN", "tCOLON", "tCOMMA", "tSLASH", "tMIN", "tMAX",
-  "tSUM", "tCOUNT", "tINTERVAL", "tAVG", "tEXTRACT", "tTIMEZONE", "tYEAR",
+  "\"end of file\"", "error", "\"invalid token\"", "tSTRING", "tIDMEF",
+  "tNUMBER", "tERROR", "tLPAREN", "tRPAREN", "tCOLON", "tCOMMA", "tSLASH",
+  "tMIN", "tMAX", "tSUM", "tCOUNT", "tINTERVAL", "tAVG", "tEXTRACT",
+  "tTIMEZONE", "tAPPROX_COUNT_DISTINCT", "tTOPK", "tPERCENTILE", "tYEAR",
   "tQUARTER", "tMONTH", "tWEEK", "tYDAY", "tMDAY", "tWDAY", "tDAY",
   "tHOUR", "tSEC", "tMSEC", "tUSEC", "tORDER_ASC", "tORDER_DESC",
   "tGROUP_BY", "$accept", "expressions", "option", "expression_option",
   "oneargfunc", "onearg", "extract", "extractfunc", "interval",
-  "intervalfunc", "timezone", "timezonefunc", "func", "modifier",
-  "valuetype", "value", YY_NULLPTR
+  "intervalfunc", "timezone", "timezonefunc", "param", "paramfunc", "func",
+  "modifier", "valuetype", "value", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -27
+#define YYPACT_NINF (-32)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-27)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-       3,   -27,   -27,   -27,   -27,   -27,   -27,   -27,   -27,   -27,
-     -27,   -27,   -27,    13,    -2,   -27,     7,   -27,    16,   -27,
-      17,   -27,   -27,    19,    21,   -27,    32,    32,    32,    32,
-       5,   -22,    31,    30,    33,    36,   -27,   -27,   -27,   -27,
-     -27,   -27,   -27,   -27,   -27,   -27,   -27,   -27,   -27,    42,
-     -27,    38,    32,    39,   -22,    45,    44,    47,   -27,   -27,
-      53,   -27,    49,   -27
+       3,   -32,   -32,   -32,   -32,   -32,   -32,   -32,   -32,   -32,
+     -32,   -32,   -32,   -32,   -32,   -32,     5,     6,   -32,     7,
+     -32,    10,   -32,    20,   -32,    22,   -32,   -32,    23,    24,
+     -32,    44,    44,    44,    44,    26,    14,   -25,    25,    28,
+      30,    34,    41,   -32,   -32,   -32,   -32,   -32,   -32,   -32,
+     -32,   -32,   -32,   -32,   -32,   -32,    42,   -32,    31,    44,
+      33,    44,   -25,    45,    48,    46,    47,   -32,   -32,    64,
+     -32,   -32,    60,   -32
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     4,    34,    33,    35,    39,    10,    11,    12,    17,
-      13,    15,    19,     0,     0,    21,     0,    23,     0,    22,
-       0,    24,    36,    38,     3,     1,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,    31,    25,    26,    27,
-      28,    29,    30,    32,    37,     5,     6,     7,     9,     2,
-      14,     0,     0,     0,     0,     0,     0,     0,     8,    16,
-       0,    20,     0,    18
+       0,     4,    39,    38,    40,    44,    10,    11,    12,    18,
+      13,    16,    20,    14,    22,    23,     0,     0,    25,     0,
+      27,     0,    26,     0,    28,     0,    29,    41,    43,     3,
+       1,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    36,    30,    31,    32,    33,    34,    35,
+      37,    42,     5,     6,     7,     9,     2,    15,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     8,    17,     0,
+      21,    24,     0,    19
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -27,   -27,     4,   -27,   -27,   -27,   -27,   -27,   -27,   -27,
-     -27,   -27,   -27,   -27,   -27,   -26
+     -32,   -32,     8,   -32,   -32,   -32,   -32,   -32,   -32,   -32,
+     -32,   -32,   -32,   -32,   -32,   -32,   -32,   -31
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,    13,    48,    49,    14,    15,    16,    17,    18,    19,
-      20,    21,    22,    44,    23,    24
+       0,    16,    55,    56,    17,    18,    19,    20,    21,    22,
+      23,    24,    25,    26,    27,    51,    28,    29
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_uint8 yytable[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-      32,    33,    34,    35,     1,    26,     2,     3,     4,     5,
-      45,    46,    47,    25,    27,     6,     7,    36,     8,     9,
-      10,    11,    12,    28,    29,    37,    56,    38,    30,    39,
-      40,    41,    31,    42,    43,     2,     3,     4,     5,    50,
-      51,    55,    57,    52,     6,     7,    53,     8,     9,    10,
-      11,    12,    54,    59,    60,    61,    62,    63,    58
+      38,    39,    40,    41,     1,    30,     2,     3,     4,     5,
+      52,    53,    54,    31,    32,     6,     7,    33,     8,     9,
+      10,    11,    12,    13,    14,    15,    43,    34,    64,    35,
+      66,    42,    36,    57,    63,    37,    65,    44,    58,    45,
+      59,    46,    47,    48,    60,    49,    50,     2,     3,     4,
+       5,    61,    62,    68,    70,    71,     6,     7,    69,     8,
+       9,    10,    11,    12,    13,    14,    15,    72,    73,     0,
+      67
 };
 
-static const yytype_uint8 yycheck[] =
+static const yytype_int8 yycheck[] =
 {
-      26,    27,    28,    29,     1,     7,     3,     4,     5,     6,
-      32,    33,    34,     0,     7,    12,    13,    12,    15,    16,
-      17,    18,    19,     7,     7,    20,    52,    22,     9,    24,
-      25,    26,    11,    28,    29,     3,     4,     5,     6,     8,
-      10,     3,     3,    10,    12,    13,    10,    15,    16,    17,
-      18,    19,    10,     8,    10,     8,     3,     8,    54
+      31,    32,    33,    34,     1,     0,     3,     4,     5,     6,
+      35,    36,    37,     7,     7,    12,    13,     7,    15,    16,
+      17,    18,    19,    20,    21,    22,    12,     7,    59,     7,
+      61,     5,     9,     8,     3,    11,     3,    23,    10,    25,
+      10,    27,    28,    29,    10,    31,    32,     3,     4,     5,
+       6,    10,    10,     8,     8,     8,    12,    13,    10,    15,
+      16,    17,    18,    19,    20,    21,    22,     3,     8,    -1,
+      62
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     1,     3,     4,     5,     6,    12,    13,    15,    16,
-      17,    18,    19,    36,    39,    40,    41,    42,    43,    44,
-      45,    46,    47,    49,    50,     0,     7,     7,     7,     7,
-       9,    11,    50,    50,    50,    50,    12,    20,    22,    24,
-      25,    26,    28,    29,    48,    32,    33,    34,    37,    38,
-       8,    10,    10,    10,    10,     3,    50,     3,    37,     8,
-      10,     8,     3,     8
+      17,    18,    19,    20,    21,    22,    39,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    54,    55,
+       0,     7,     7,     7,     7,     7,     9,    11,    55,    55,
+      55,    55,     5,    12,    23,    25,    27,    28,    29,    31,
+      32,    53,    35,    36,    37,    40,    41,     8,    10,    10,
+      10,    10,    10,     3,    55,     3,    55,    40,     8,    10,
+       8,     8,     3,     8
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    35,    36,    36,    36,    37,    37,    37,    38,    38,
-      39,    39,    39,    39,    40,    41,    42,    43,    44,    45,
-      46,    47,    47,    47,    47,    48,    48,    48,    48,    48,
-      48,    48,    48,    49,    49,    49,    49,    50,    50,    50
+       0,    38,    39,    39,    39,    40,    40,    40,    41,    41,
+      42,    42,    42,    42,    42,    43,    44,    45,    46,    47,
+      48,    49,    50,    50,    51,    52,    52,    52,    52,    52,
+      53,    53,    53,    53,    53,    53,    53,    53,    54,    54,
+      54,    54,    55,    55,    55
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
        0,     2,     3,     1,     1,     1,     1,     1,     3,     1,
-       1,     1,     1,     1,     4,     1,     6,     1,     8,     1,
-       6,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     3,     1,     1
+       1,     1,     1,     1,     1,     4,     1,     6,     1,     8,
+       1,     6,     1,     1,     6,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     3,     1,     1
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (scanner, root, YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (scanner, root, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -766,57 +813,54 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, scanner, root); \
+                  Kind, Value, scanner, root); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (scanner);
-  YYUSE (root);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (scanner);
+  YY_USE (root);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, scanner, root);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, root);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -825,7 +869,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, yys
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -848,21 +892,21 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule, yyscan_t scanner, preludedb_selected_path_t *root)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, yyscan_t scanner, preludedb_selected_path_t *root)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                                              , scanner, root);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, root);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -877,8 +921,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -901,28 +945,76 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
 static char *
@@ -936,10 +1028,10 @@ yystpcpy (char *yydest, const char *yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -947,14 +1039,13 @@ yystpcpy (char *yydest, const char *yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
         switch (*++yyp)
           {
@@ -965,7 +1056,10 @@ yytnamerr (char *yyres, const char *yystr)
           case '\\':
             if (*++yyp != '\\')
               goto do_not_strip_quotes;
-            /* Fall through.  */
+            else
+              goto append;
+
+          append:
           default:
             if (yyres)
               yyres[yyn] = *yyp;
@@ -980,36 +1074,20 @@ yytnamerr (char *yyres, const char *yystr)
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
 }
-# endif
+#endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
 
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
 static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
 {
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
+  /* Actual size of YYARG. */
   int yycount = 0;
-
   /* There are many possibilities here to consider:
      - If this state is a consistent state with a default action, then
        the only way this function was invoked is if the default action
@@ -1033,63 +1111,78 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
        one exception: it will still contain any token that will not be
        accepted due to an error action in a later state.
   */
-  if (yytoken != YYEMPTY)
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
     {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
     }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
 
   switch (yycount)
     {
-# define YYCASE_(N, S)                      \
+#define YYCASE_(N, S)                       \
       case N:                               \
         yyformat = S;                       \
-      break
+        break
+    default: /* Avoid compiler warnings. */
       YYCASE_(0, YY_("syntax error"));
       YYCASE_(1, YY_("syntax error, unexpected %s"));
       YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
       YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
       YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
       YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
+#undef YYCASE_
     }
 
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
   {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
   }
 
   if (*yymsg_alloc < yysize)
@@ -1098,7 +1191,7 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
       if (! (yysize <= *yymsg_alloc
              && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
         *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
+      return -1;
     }
 
   /* Avoid sprintf, as that infringes on the user's name space.
@@ -1110,41 +1203,44 @@ yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
     while ((*yyp = *yyformat) != '\0')
       if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
         {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
           yyformat += 2;
         }
       else
         {
-          yyp++;
-          yyformat++;
+          ++yyp;
+          ++yyformat;
         }
   }
   return 0;
 }
-#endif /* YYERROR_VERBOSE */
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, yyscan_t scanner, preludedb_selected_path_t *root)
 {
-  YYUSE (yyvaluep);
-  YYUSE (scanner);
-  YYUSE (root);
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
+  YY_USE (root);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1152,7 +1248,7 @@ yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, yyscan_t scanner,
 int
 yyparse (yyscan_t scanner, preludedb_selected_path_t *root)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1163,45 +1259,41 @@ YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
 YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+    int yyerrstatus = 0;
 
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
   /* Buffer for error messages, and its allocated size.  */
   char yymsgbuf[128];
   char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1209,71 +1301,75 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
                     &yystacksize);
-
         yyss = yyss1;
         yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1281,30 +1377,31 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1315,18 +1412,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, scanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1354,15 +1462,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1377,7 +1483,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1397,101 +1503,107 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 122 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 2: /* expressions: value tSLASH expression_option  */
+#line 125 "preludedb-path-selection-parser.yac.y"
+                                            {
                 preludedb_selected_path_set_object(root, (yyvsp[-2].object));
                 preludedb_selected_path_set_flags(root, (yyvsp[0].flags));
              }
-#line 1407 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1513 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 3:
-#line 126 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { preludedb_selected_path_set_object(root, (yyvsp[0].object)); }
-#line 1413 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 3: /* expressions: value  */
+#line 129 "preludedb-path-selection-parser.yac.y"
+                     { preludedb_selected_path_set_object(root, (yyvsp[0].object)); }
+#line 1519 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 4:
-#line 127 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { return (errno < 0) ? errno : -1; }
-#line 1419 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 4: /* expressions: error  */
+#line 130 "preludedb-path-selection-parser.yac.y"
+                     { return (errno < 0) ? errno : -1; }
+#line 1525 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 5:
-#line 129 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_ASC; }
-#line 1425 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 5: /* option: tORDER_ASC  */
+#line 132 "preludedb-path-selection-parser.yac.y"
+                      { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_ASC; }
+#line 1531 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 6:
-#line 130 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC; }
-#line 1431 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 6: /* option: tORDER_DESC  */
+#line 133 "preludedb-path-selection-parser.yac.y"
+                      { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_ORDER_DESC; }
+#line 1537 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 7:
-#line 131 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_GROUP_BY; }
-#line 1437 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 7: /* option: tGROUP_BY  */
+#line 134 "preludedb-path-selection-parser.yac.y"
+                      { (yyval.flags) = PRELUDEDB_SELECTED_PATH_FLAGS_GROUP_BY; }
+#line 1543 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 8:
-#line 133 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = (yyvsp[-2].flags)|(yyvsp[0].flags); }
-#line 1443 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 8: /* expression_option: expression_option tCOMMA option  */
+#line 136 "preludedb-path-selection-parser.yac.y"
+                                                   { (yyval.flags) = (yyvsp[-2].flags)|(yyvsp[0].flags); }
+#line 1549 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 9:
-#line 134 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = (yyvsp[0].flags); }
-#line 1449 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 9: /* expression_option: option  */
+#line 137 "preludedb-path-selection-parser.yac.y"
+                            { (yyval.flags) = (yyvsp[0].flags); }
+#line 1555 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 10:
-#line 137 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_MIN; }
-#line 1455 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 10: /* oneargfunc: tMIN  */
+#line 140 "preludedb-path-selection-parser.yac.y"
+                  { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_MIN; }
+#line 1561 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 11:
-#line 138 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_MAX; }
-#line 1461 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 11: /* oneargfunc: tMAX  */
+#line 141 "preludedb-path-selection-parser.yac.y"
+                  { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_MAX; }
+#line 1567 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 12:
-#line 139 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT; }
-#line 1467 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 12: /* oneargfunc: tCOUNT  */
+#line 142 "preludedb-path-selection-parser.yac.y"
+                    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT; }
+#line 1573 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 13:
-#line 140 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_AVG; }
-#line 1473 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 13: /* oneargfunc: tAVG  */
+#line 143 "preludedb-path-selection-parser.yac.y"
+                  { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_AVG; }
+#line 1579 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 14:
-#line 143 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 14: /* oneargfunc: tAPPROX_COUNT_DISTINCT  */
+#line 144 "preludedb-path-selection-parser.yac.y"
+                                    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT; }
+#line 1585 "preludedb-path-selection-parser.yac.c"
+    break;
+
+  case 15: /* onearg: oneargfunc tLPAREN value tRPAREN  */
+#line 147 "preludedb-path-selection-parser.yac.y"
+                                         {
         preludedb_selected_object_t *parent;
         preludedb_selected_object_new(&parent, (yyvsp[-3].type), NULL);
         preludedb_selected_object_push_arg(parent, (yyvsp[-1].object));
         (yyval.object) = parent;
 }
-#line 1484 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1596 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 15:
-#line 150 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_EXTRACT; }
-#line 1490 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 16: /* extract: tEXTRACT  */
+#line 154 "preludedb-path-selection-parser.yac.y"
+                  { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_EXTRACT; }
+#line 1602 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 16:
-#line 151 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 17: /* extractfunc: extract tLPAREN value tCOMMA tSTRING tRPAREN  */
+#line 155 "preludedb-path-selection-parser.yac.y"
+                                                          {
         int tf;
         preludedb_selected_object_t *parent, *arg;
 
@@ -1517,18 +1629,18 @@ yyreduce:
         preludedb_selected_object_push_arg(parent, arg);
         (yyval.object) = parent;
 }
-#line 1521 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1633 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 17:
-#line 178 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_INTERVAL; }
-#line 1527 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 18: /* interval: tINTERVAL  */
+#line 182 "preludedb-path-selection-parser.yac.y"
+                    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_INTERVAL; }
+#line 1639 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 18:
-#line 179 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 19: /* intervalfunc: interval tLPAREN value tCOMMA value tCOMMA tSTRING tRPAREN  */
+#line 183 "preludedb-path-selection-parser.yac.y"
+                                                                         {
         int tf;
         preludedb_selected_object_t *parent, *arg;
 
@@ -1555,18 +1667,18 @@ yyreduce:
         preludedb_selected_object_push_arg(parent, arg);
         (yyval.object) = parent;
 }
-#line 1559 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1671 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 19:
-#line 207 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_TIMEZONE; }
-#line 1565 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 20: /* timezone: tTIMEZONE  */
+#line 211 "preludedb-path-selection-parser.yac.y"
+                    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_TIMEZONE; }
+#line 1677 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 20:
-#line 208 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 21: /* timezonefunc: timezone tLPAREN value tCOMMA tSTRING tRPAREN  */
+#line 212 "preludedb-path-selection-parser.yac.y"
+                                                            {
         preludedb_selected_object_t *parent;
 
         errno = preludedb_selected_object_new(&parent, (yyvsp[-5].type), NULL);
@@ -1577,60 +1689,91 @@ yyreduce:
         preludedb_selected_object_push_arg(parent, (yyvsp[-1].object));
         (yyval.object) = parent;
 }
-#line 1581 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1693 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 25:
-#line 222 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_YEAR; }
-#line 1587 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 22: /* param: tTOPK  */
+#line 224 "preludedb-path-selection-parser.yac.y"
+              { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK; }
+#line 1699 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 26:
-#line 223 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MONTH; }
-#line 1593 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 23: /* param: tPERCENTILE  */
+#line 225 "preludedb-path-selection-parser.yac.y"
+                    { (yyval.type) = PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE; }
+#line 1705 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 27:
-#line 224 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_YDAY; }
-#line 1599 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 24: /* paramfunc: param tLPAREN tNUMBER tCOMMA value tRPAREN  */
+#line 226 "preludedb-path-selection-parser.yac.y"
+                                                      {
+        preludedb_selected_object_t *parent;
+
+        errno = preludedb_selected_object_new(&parent, (yyvsp[-5].type), NULL);
+        if ( errno < 0 ) {
+                preludedb_selected_object_destroy((yyvsp[-3].object));
+                preludedb_selected_object_destroy((yyvsp[-1].object));
+                YYERROR;
+        }
+
+        preludedb_selected_object_push_arg(parent, (yyvsp[-1].object));
+        preludedb_selected_object_push_arg(parent, (yyvsp[-3].object));
+        (yyval.object) = parent;
+}
+#line 1724 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 28:
-#line 225 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MDAY; }
-#line 1605 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 30: /* modifier: tYEAR  */
+#line 243 "preludedb-path-selection-parser.yac.y"
+                 { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_YEAR; }
+#line 1730 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 29:
-#line 226 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_WDAY; }
-#line 1611 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 31: /* modifier: tMONTH  */
+#line 244 "preludedb-path-selection-parser.yac.y"
+                  { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MONTH; }
+#line 1736 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 30:
-#line 227 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_HOUR; }
-#line 1617 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 32: /* modifier: tYDAY  */
+#line 245 "preludedb-path-selection-parser.yac.y"
+                 { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_YDAY; }
+#line 1742 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 31:
-#line 228 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MIN; }
-#line 1623 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 33: /* modifier: tMDAY  */
+#line 246 "preludedb-path-selection-parser.yac.y"
+                 { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MDAY; }
+#line 1748 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 32:
-#line 229 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_SEC; }
-#line 1629 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 34: /* modifier: tWDAY  */
+#line 247 "preludedb-path-selection-parser.yac.y"
+                 { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_WDAY; }
+#line 1754 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 37:
-#line 232 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    {
+  case 35: /* modifier: tHOUR  */
+#line 248 "preludedb-path-selection-parser.yac.y"
+                 { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_HOUR; }
+#line 1760 "preludedb-path-selection-parser.yac.c"
+    break;
+
+  case 36: /* modifier: tMIN  */
+#line 249 "preludedb-path-selection-parser.yac.y"
+                { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_MIN; }
+#line 1766 "preludedb-path-selection-parser.yac.c"
+    break;
+
+  case 37: /* modifier: tSEC  */
+#line 250 "preludedb-path-selection-parser.yac.y"
+                { (yyval.flags) = PRELUDEDB_SQL_TIME_CONSTRAINT_SEC; }
+#line 1772 "preludedb-path-selection-parser.yac.c"
+    break;
+
+  case 42: /* value: valuetype tCOLON modifier  */
+#line 253 "preludedb-path-selection-parser.yac.y"
+                                  {
         int ret;
         preludedb_selected_object_t *f, *num;
 
@@ -1659,17 +1802,18 @@ yyreduce:
 
         (yyval.object) = f;
 }
-#line 1663 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1806 "preludedb-path-selection-parser.yac.c"
     break;
 
-  case 39:
-#line 262 "preludedb-path-selection-parser.yac.y" /* yacc.c:1646  */
-    { errno = (yyvsp[0].error); YYERROR; }
-#line 1669 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+  case 44: /* value: tERROR  */
+#line 283 "preludedb-path-selection-parser.yac.y"
+               { errno = (yyvsp[0].error); YYERROR; }
+#line 1812 "preludedb-path-selection-parser.yac.c"
     break;
 
 
-#line 1673 "preludedb-path-selection-parser.yac.c" /* yacc.c:1646  */
+#line 1816 "preludedb-path-selection-parser.yac.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1683,25 +1827,23 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -1712,50 +1854,44 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (scanner, root, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
       {
+        yypcontext_t yyctx
+          = {yyssp, yytoken};
         char const *yymsgp = YY_("syntax error");
         int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
         if (yysyntax_error_status == 0)
           yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
+        else if (yysyntax_error_status == -1)
           {
             if (yymsg != yymsgbuf)
               YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
               {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
               }
             else
               {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
               }
           }
         yyerror (scanner, root, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1784,12 +1920,11 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
-
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -1806,13 +1941,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -1826,7 +1962,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, scanner, root);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, root);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1838,7 +1974,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1849,26 +1985,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (scanner, root, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1884,20 +2024,19 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, scanner, root);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, root);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
   return yyresult;
 }
-#line 264 "preludedb-path-selection-parser.yac.y" /* yacc.c:1906  */
+
+#line 285 "preludedb-path-selection-parser.yac.y"
 
 
 int preludedb_path_selection_parse(preludedb_selected_path_t *root, const char *str)
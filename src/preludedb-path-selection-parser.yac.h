@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -30,6 +31,10 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED
 # define YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED
 /* Debug traces.  */
@@ -40,7 +45,7 @@
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 15 "preludedb-path-selection-parser.yac.y" /* yacc.c:1909  */
+#line 15 "preludedb-path-selection-parser.yac.y"
 
 
 #ifndef YY_TYPEDEF_YY_SCANNER_T
@@ -48,87 +53,61 @@ extern int yydebug;
 typedef void* yyscan_t;
 #endif
 
-#line 52 "preludedb-path-selection-parser.yac.h" /* yacc.c:1909  */
+#line 57 "preludedb-path-selection-parser.yac.h"
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    tSTRING = 258,
-    tIDMEF = 259,
-    tNUMBER = 260,
-    tERROR = 261,
-    tLPAREN = 262,
-    tRPAREN = 263,
-    tCOLON = 264,
-    tCOMMA = 265,
-    tSLASH = 266,
-    tMIN = 267,
-    tMAX = 268,
-    tSUM = 269,
-    tCOUNT = 270,
-    tINTERVAL = 271,
-    tAVG = 272,
-    tEXTRACT = 273,
-    tTIMEZONE = 274,
-    tYEAR = 275,
-    tQUARTER = 276,
-    tMONTH = 277,
-    tWEEK = 278,
-    tYDAY = 279,
-    tMDAY = 280,
-    tWDAY = 281,
-    tDAY = 282,
-    tHOUR = 283,
-    tSEC = 284,
-    tMSEC = 285,
-    tUSEC = 286,
-    tORDER_ASC = 287,
-    tORDER_DESC = 288,
-    tGROUP_BY = 289
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    tSTRING = 258,                 /* tSTRING  */
+    tIDMEF = 259,                  /* tIDMEF  */
+    tNUMBER = 260,                 /* tNUMBER  */
+    tERROR = 261,                  /* tERROR  */
+    tLPAREN = 262,                 /* tLPAREN  */
+    tRPAREN = 263,                 /* tRPAREN  */
+    tCOLON = 264,                  /* tCOLON  */
+    tCOMMA = 265,                  /* tCOMMA  */
+    tSLASH = 266,                  /* tSLASH  */
+    tMIN = 267,                    /* tMIN  */
+    tMAX = 268,                    /* tMAX  */
+    tSUM = 269,                    /* tSUM  */
+    tCOUNT = 270,                  /* tCOUNT  */
+    tINTERVAL = 271,               /* tINTERVAL  */
+    tAVG = 272,                    /* tAVG  */
+    tEXTRACT = 273,                /* tEXTRACT  */
+    tTIMEZONE = 274,               /* tTIMEZONE  */
+    tAPPROX_COUNT_DISTINCT = 275,  /* tAPPROX_COUNT_DISTINCT  */
+    tTOPK = 276,                   /* tTOPK  */
+    tPERCENTILE = 277,             /* tPERCENTILE  */
+    tYEAR = 278,                   /* tYEAR  */
+    tQUARTER = 279,                /* tQUARTER  */
+    tMONTH = 280,                  /* tMONTH  */
+    tWEEK = 281,                   /* tWEEK  */
+    tYDAY = 282,                   /* tYDAY  */
+    tMDAY = 283,                   /* tMDAY  */
+    tWDAY = 284,                   /* tWDAY  */
+    tDAY = 285,                    /* tDAY  */
+    tHOUR = 286,                   /* tHOUR  */
+    tSEC = 287,                    /* tSEC  */
+    tMSEC = 288,                   /* tMSEC  */
+    tUSEC = 289,                   /* tUSEC  */
+    tORDER_ASC = 290,              /* tORDER_ASC  */
+    tORDER_DESC = 291,             /* tORDER_DESC  */
+    tGROUP_BY = 292                /* tGROUP_BY  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
-#define tSTRING 258
-#define tIDMEF 259
-#define tNUMBER 260
-#define tERROR 261
-#define tLPAREN 262
-#define tRPAREN 263
-#define tCOLON 264
-#define tCOMMA 265
-#define tSLASH 266
-#define tMIN 267
-#define tMAX 268
-#define tSUM 269
-#define tCOUNT 270
-#define tINTERVAL 271
-#define tAVG 272
-#define tEXTRACT 273
-#define tTIMEZONE 274
-#define tYEAR 275
-#define tQUARTER 276
-#define tMONTH 277
-#define tWEEK 278
-#define tYDAY 279
-#define tMDAY 280
-#define tWDAY 281
-#define tDAY 282
-#define tHOUR 283
-#define tSEC 284
-#define tMSEC 285
-#define tUSEC 286
-#define tORDER_ASC 287
-#define tORDER_DESC 288
-#define tGROUP_BY 289
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
 union YYSTYPE
 {
-#line 23 "preludedb-path-selection-parser.yac.y" /* yacc.c:1909  */
+#line 23 "preludedb-path-selection-parser.yac.y"
 
         int val;
         int flags;
@@ -137,9 +116,9 @@ union YYSTYPE
         preludedb_selected_object_type_t type;
         preludedb_selected_object_t *object;
 
-#line 141 "preludedb-path-selection-parser.yac.h" /* yacc.c:1909  */
-};
+#line 120 "preludedb-path-selection-parser.yac.h"
 
+};
 typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
@@ -147,6 +126,8 @@ typedef union YYSTYPE YYSTYPE;
 
 
 
+
 int yyparse (yyscan_t scanner, preludedb_selected_path_t *root);
 
+
 #endif /* !YY_YY_PRELUDEDB_PATH_SELECTION_PARSER_YAC_H_INCLUDED  */
@@ -94,6 +94,7 @@ typedef void* yyscan_t;
 %token tSTRING tIDMEF tNUMBER tERROR
 %token tLPAREN tRPAREN tCOLON tCOMMA tSLASH
 %token tMIN tMAX tSUM tCOUNT tINTERVAL tAVG tEXTRACT tTIMEZONE
+%token tAPPROX_COUNT_DISTINCT tTOPK tPERCENTILE
 %token tYEAR tQUARTER tMONTH tWEEK tYDAY tMDAY tWDAY tDAY tHOUR tSEC tMSEC tUSEC
 %token tORDER_ASC tORDER_DESC tGROUP_BY
 
@@ -107,11 +108,13 @@ typedef void* yyscan_t;
 %type<object> intervalfunc
 %type<object> extractfunc
 %type<object> timezonefunc
+%type<object> paramfunc
 %type<val> expressions
 %type<type> oneargfunc
 %type<type> extract
 %type<type> interval
 %type<type> timezone
+%type<type> param
 %type<flags> option
 %type<flags> expression_option
 %type<flags> modifier
@@ -138,6 +141,7 @@ oneargfunc:  tMIN { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_MIN; }
            | tMAX { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_MAX; }
            | tCOUNT { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT; }
            | tAVG { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_AVG; }
+           | tAPPROX_COUNT_DISTINCT { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT; }
 
 
 onearg: oneargfunc tLPAREN value tRPAREN {
@@ -217,7 +221,24 @@ timezonefunc: timezone tLPAREN value tCOMMA tSTRING tRPAREN {
         $$ = parent;
 }
 
-func: onearg | intervalfunc | extractfunc | timezonefunc
+param:  tTOPK { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK; }
+      | tPERCENTILE { $$ = PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE; }
+paramfunc: param tLPAREN tNUMBER tCOMMA value tRPAREN {
+        preludedb_selected_object_t *parent;
+
+        errno = preludedb_selected_object_new(&parent, $1, NULL);
+        if ( errno < 0 ) {
+                preludedb_selected_object_destroy($3);
+                preludedb_selected_object_destroy($5);
+                YYERROR;
+        }
+
+        preludedb_selected_object_push_arg(parent, $5);
+        preludedb_selected_object_push_arg(parent, $3);
+        $$ = parent;
+}
+
+func: onearg | intervalfunc | extractfunc | timezonefunc | paramfunc
 
 modifier:  tYEAR { $$ = PRELUDEDB_SQL_TIME_CONSTRAINT_YEAR; }
          | tMONTH { $$ = PRELUDEDB_SQL_TIME_CONSTRAINT_MONTH; }
@@ -30,7 +30,9 @@
 #include <libprelude/idmef.h>
 #include <libprelude/prelude-list.h>
 #include <libprelude/prelude-log.h>
+#include <libprelude/prelude-hash.h>
 
+#include "glthread/lock.h"
 #include "preludedb.h"
 #include "preludedb-error.h"
 #include "preludedb-path-selection.h"
@@ -38,7 +40,18 @@
 #include "preludedb-plugin-format-prv.h"
 
 
+/*
+ * Parsed selection strings are cached process wide: the parsed objects
+ * must not be modified once built, so that they can be shared between
+ * the selections of every thread. Their reference count is updated
+ * atomically, so that referencing an object never takes a lock.
+ */
+#define SELECTION_CACHE_MAX 1024
+
+
 preludedb_plugin_format_t *_preludedb_get_plugin_format(preludedb_t *db);
+int _preludedb_path_selection_fast_parse(preludedb_selected_path_t *root, const char *str);
+void _preludedb_path_selection_cache_clear(void);
 
 
 struct preludedb_selected_object {
@@ -75,6 +88,109 @@ struct preludedb_path_selection {
 };
 
 
+typedef struct {
+        char *str;
+        preludedb_selected_object_t *object;
+        preludedb_selected_path_flags_t flags;
+} selection_cache_entry_t;
+
+
+static prelude_hash_t *selection_cache = NULL;
+static unsigned int selection_cache_count = 0;
+
+gl_lock_define_initialized(static, selection_cache_lock)
+
+
+
+static void selection_cache_entry_destroy(void *data)
+{
+        selection_cache_entry_t *entry = data;
+
+        preludedb_selected_object_destroy(entry->object);
+        free(entry->str);
+        free(entry);
+}
+
+
+
+static prelude_bool_t selection_cache_get(const char *str, preludedb_selected_object_t **object, preludedb_selected_path_flags_t *flags)
+{
+        selection_cache_entry_t *entry = NULL;
+
+        gl_lock_lock(selection_cache_lock);
+
+        if ( selection_cache )
+                entry = prelude_hash_get(selection_cache, str);
+
+        if ( entry ) {
+                *object = preludedb_selected_object_ref(entry->object);
+                *flags = entry->flags;
+        }
+
+        gl_lock_unlock(selection_cache_lock);
+
+        return entry ? TRUE : FALSE;
+}
+
+
+
+static void selection_cache_add(const char *str, preludedb_selected_object_t *object, preludedb_selected_path_flags_t flags)
+{
+        selection_cache_entry_t *entry;
+
+        entry = malloc(sizeof(*entry));
+        if ( ! entry )
+                return;
+
+        entry->str = strdup(str);
+        if ( ! entry->str ) {
+                free(entry);
+                return;
+        }
+
+        entry->flags = flags;
+        entry->object = preludedb_selected_object_ref(object);
+
+        gl_lock_lock(selection_cache_lock);
+
+        if ( selection_cache && selection_cache_count >= SELECTION_CACHE_MAX ) {
+                prelude_hash_destroy(selection_cache);
+                selection_cache = NULL;
+        }
+
+        if ( ! selection_cache ) {
+                selection_cache_count = 0;
+                if ( prelude_hash_new(&selection_cache, NULL, NULL, NULL, selection_cache_entry_destroy) < 0 )
+                        selection_cache = NULL;
+        }
+
+        if ( ! selection_cache || prelude_hash_get(selection_cache, str) || prelude_hash_set(selection_cache, entry->str, entry) < 0 ) {
+                gl_lock_unlock(selection_cache_lock);
+                selection_cache_entry_destroy(entry);
+                return;
+        }
+
+        selection_cache_count++;
+
+        gl_lock_unlock(selection_cache_lock);
+}
+
+
+
+void _preludedb_path_selection_cache_clear(void)
+{
+        gl_lock_lock(selection_cache_lock);
+
+        if ( selection_cache ) {
+                prelude_hash_destroy(selection_cache);
+                selection_cache = NULL;
+                selection_cache_count = 0;
+        }
+
+        gl_lock_unlock(selection_cache_lock);
+}
+
+
 
 /**
  * preludedb_selected_object_push_arg:
@@ -83,6 +199,11 @@ struct preludedb_path_selection {
  *
  * Push @arg as an argument of @object (which needs be a function).
  *
+ * Objects obtained from a selected path created through
+ * preludedb_selected_path_new_string() may be shared through the
+ * selection cache, and must not be modified: only use this function
+ * on objects that you created yourself.
+ *
  * Returns: 0 on success, a negative value on error.
  */
 int preludedb_selected_object_push_arg(preludedb_selected_object_t *object, preludedb_selected_object_t *arg)
@@ -107,7 +228,8 @@ int preludedb_selected_object_push_arg(preludedb_selected_object_t *object, prel
  */
 preludedb_selected_object_t *preludedb_selected_object_ref(preludedb_selected_object_t *object)
 {
-        object->refcount++;
+        __sync_add_and_fetch(&object->refcount, 1);
+
         return object;
 }
 
@@ -219,7 +341,7 @@ void preludedb_selected_object_destroy(preludedb_selected_object_t *object)
         if ( ! object )
                 return;
 
-        if ( --object->refcount > 0 )
+        if ( __sync_sub_and_fetch(&object->refcount, 1) > 0 )
                 return;
 
         if ( object->type == PRELUDEDB_SELECTED_OBJECT_TYPE_STRING )
@@ -345,6 +467,16 @@ idmef_value_type_id_t preludedb_selected_object_get_value_type(preludedb_selecte
                         *dtype = object->type;
                         return IDMEF_VALUE_TYPE_UINT32;
 
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT:
+                        *dtype = object->type;
+                        *data = NULL;
+                        return IDMEF_VALUE_TYPE_UINT64;
+
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE:
+                        *dtype = object->type;
+                        *data = NULL;
+                        return IDMEF_VALUE_TYPE_DOUBLE;
+
                 case PRELUDEDB_SELECTED_OBJECT_TYPE_STRING:
                         *dtype = object->type;
                         *data = object->data.sval;
@@ -353,6 +485,7 @@ idmef_value_type_id_t preludedb_selected_object_get_value_type(preludedb_selecte
                 case PRELUDEDB_SELECTED_OBJECT_TYPE_AVG:
                 case PRELUDEDB_SELECTED_OBJECT_TYPE_MAX:
                 case PRELUDEDB_SELECTED_OBJECT_TYPE_MIN:
+                case PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK:
                         return preludedb_selected_object_get_value_type(object->data.args[0], data, dtype);
 
                 case PRELUDEDB_SELECTED_OBJECT_TYPE_INTERVAL:
@@ -382,14 +515,31 @@ void preludedb_selected_path_set_flags(preludedb_selected_path_t *path, preluded
 int preludedb_selected_path_new_string(preludedb_selected_path_t **selected_path, const char *str)
 {
         int ret;
+        preludedb_selected_object_t *object;
+        preludedb_selected_path_flags_t flags;
+
+        if ( selection_cache_get(str, &object, &flags) ) {
+                ret = preludedb_selected_path_new(selected_path, object, flags);
+                if ( ret < 0 )
+                        preludedb_selected_object_destroy(object);
+
+                return ret;
+        }
 
         ret = preludedb_selected_path_new(selected_path, NULL, 0);
         if ( ret < 0 )
                 return ret;
 
-        ret = preludedb_path_selection_parse(*selected_path, str);
+        ret = _preludedb_path_selection_fast_parse(*selected_path, str);
         if ( ret < 0 )
+                ret = preludedb_path_selection_parse(*selected_path, str);
+
+        if ( ret < 0 ) {
                 preludedb_selected_path_destroy(*selected_path);
+                return ret;
+        }
+
+        selection_cache_add(str, (*selected_path)->object, (*selected_path)->flags);
 
         return ret;
 }
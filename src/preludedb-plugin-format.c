@@ -80,6 +80,42 @@ void preludedb_plugin_format_set_get_alert_func(preludedb_plugin_format_t *plugi
 
 
 
+/**
+ * preludedb_plugin_format_set_get_alert_paths_func:
+ * @plugin: Pointer to a format plugin object.
+ * @func: Function retrieving part of an alert.
+ *
+ * @func populates the alert stored in its message argument with the
+ * subtrees required by the given paths, creating the alert first if the
+ * message argument points to NULL. Its last argument is a plugin defined
+ * mask of the subtrees fetched so far, 0 for a new alert: those are not
+ * fetched again, even when they turned out to be empty, and the mask is
+ * updated with the subtrees @func fetches.
+ */
+void preludedb_plugin_format_set_get_alert_paths_func(preludedb_plugin_format_t *plugin,
+                                                      preludedb_plugin_format_get_alert_paths_func_t func)
+{
+        plugin->get_alert_paths = func;
+}
+
+
+
+/**
+ * preludedb_plugin_format_set_get_alerts_func:
+ * @plugin: Pointer to a format plugin object.
+ * @func: Function retrieving several alerts at once.
+ *
+ * @func stores one new message per ident in its messages argument, in
+ * the order of the idents, and returns no message at all on error.
+ */
+void preludedb_plugin_format_set_get_alerts_func(preludedb_plugin_format_t *plugin,
+                                                 preludedb_plugin_format_get_alerts_func_t func)
+{
+        plugin->get_alerts = func;
+}
+
+
+
 void preludedb_plugin_format_set_get_heartbeat_func(preludedb_plugin_format_t *plugin, preludedb_plugin_format_get_heartbeat_func_t func)
 {
         plugin->get_heartbeat = func;
@@ -241,6 +277,21 @@ void preludedb_plugin_format_set_optimize_func(preludedb_plugin_format_t *plugin
 
 
 
+/**
+ * preludedb_plugin_format_set_get_index_advice_func
+ * @plugin: Plugin object the @func function applies to
+ * @func: Pointer to an index advice function
+ *
+ * Setter for plugin supporting index recommendations
+ */
+void preludedb_plugin_format_set_get_index_advice_func(preludedb_plugin_format_t *plugin,
+                                                       preludedb_plugin_format_get_index_advice_func_t func)
+{
+        plugin->get_index_advice = func;
+}
+
+
+
 int preludedb_plugin_format_new(preludedb_plugin_format_t **ret)
 {
         *ret = calloc(1, sizeof(**ret));
@@ -31,6 +31,10 @@
 #include "preludedb-plugin-sql.h"
 
 
+void _preludedb_sql_hex_encode(char *output, const unsigned char *input, size_t size);
+int _preludedb_sql_hex_decode(unsigned char *output, const char *input, size_t size);
+
+
 #define PRELUDEDB_ENOTSUP(x) preludedb_error_verbose(prelude_error_code_from_errno(ENOSYS), "Database backend does not support '%s' operation", x)
 
 
@@ -62,22 +66,17 @@ struct preludedb_plugin_sql {
         preludedb_plugin_sql_get_server_version_func_t get_server_version;
         preludedb_plugin_sql_get_last_insert_ident_func_t get_last_insert_ident;
         preludedb_plugin_sql_build_time_timezone_string_func_t build_time_timezone_string;
+        preludedb_plugin_sql_build_optimize_string_func_t build_optimize_string;
+        preludedb_plugin_sql_build_create_index_string_func_t build_create_index_string;
+        preludedb_plugin_sql_build_upsert_string_func_t build_upsert_string;
+        preludedb_plugin_sql_build_aggregate_string_func_t build_aggregate_string;
+        unsigned int max_sessions;
+        preludedb_plugin_sql_escape_flags_t escape_flags;
+        preludedb_plugin_sql_get_escape_flags_func_t get_escape_flags;
 };
 
 
 
-static void bin2hex(const unsigned char *in, size_t inlen, char *out)
-{
-        static const char hex[] = "0123456789ABCDEF";
-
-        while ( inlen-- ) {
-                *(out++) = hex[*in >> 4];
-                *(out++) = hex[*in++ & 0x0f];
-        }
-}
-
-
-
 void preludedb_plugin_sql_set_open_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_open_func_t func)
 {
         plugin->open = func;
@@ -113,7 +112,9 @@ void preludedb_plugin_sql_set_escape_func(preludedb_plugin_sql_t *plugin, prelud
 int _preludedb_plugin_sql_escape(preludedb_plugin_sql_t *plugin, void *session, const char *input, size_t input_size, char **output)
 {
         if ( ! plugin->escape )
-                return _preludedb_plugin_sql_escape_binary(plugin, session, (const unsigned char *) input, input_size, output);
+                return _preludedb_plugin_sql_escape_binary(plugin, session,
+                                                           _preludedb_plugin_sql_get_session_escape_flags(plugin, session),
+                                                           (const unsigned char *) input, input_size, output);
 
         return plugin->escape(session, input, input_size, output);
 }
@@ -125,15 +126,36 @@ void preludedb_plugin_sql_set_escape_binary_func(preludedb_plugin_sql_t *plugin,
 }
 
 
-int _preludedb_plugin_sql_escape_binary(preludedb_plugin_sql_t *plugin, void *session,
+/*
+ * Returns the prefix of the hexadecimal binary literals understood by a
+ * session with escape @flags, or NULL if binary buffers are escaped by
+ * the backend itself.
+ */
+const char *_preludedb_plugin_sql_get_binary_hex_prefix(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_escape_flags_t flags)
+{
+        if ( flags & PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_BYTEA_HEX )
+                return "'\\x";
+
+        if ( ! plugin->escape_binary )
+                return "X'";
+
+        return NULL;
+}
+
+
+int _preludedb_plugin_sql_escape_binary(preludedb_plugin_sql_t *plugin, void *session, preludedb_plugin_sql_escape_flags_t flags,
                                         const unsigned char *input, size_t input_size, char **output)
 {
-        size_t outsize;
+        size_t outsize, prefix_len;
+        const char *prefix;
 
-        if ( plugin->escape_binary )
+        prefix = _preludedb_plugin_sql_get_binary_hex_prefix(plugin, flags);
+        if ( ! prefix )
                 return plugin->escape_binary(session, input, input_size, output);
 
-        outsize = (input_size * 2) + 4;
+        prefix_len = strlen(prefix);
+
+        outsize = prefix_len + (input_size * 2) + 2;
         if ( outsize <= input_size )
                 return preludedb_error(PRELUDEDB_ERROR_GENERIC);
 
@@ -141,10 +163,8 @@ int _preludedb_plugin_sql_escape_binary(preludedb_plugin_sql_t *plugin, void *se
         if ( ! *output )
                 return preludedb_error_from_errno(errno);
 
-        (*output)[0] = 'X';
-        (*output)[1] = '\'';
-
-        bin2hex(input, input_size, *output + 2);
+        memcpy(*output, prefix, prefix_len);
+        _preludedb_sql_hex_encode(*output + prefix_len, input, input_size);
 
         (*output)[outsize - 2] = '\'';
         (*output)[outsize - 1] = '\0';
@@ -159,9 +179,36 @@ void preludedb_plugin_sql_set_unescape_binary_func(preludedb_plugin_sql_t *plugi
 }
 
 
+/*
+ * Whether @input is in the bytea hex output format, decoded by the library.
+ */
+prelude_bool_t _preludedb_plugin_sql_is_binary_hex(preludedb_plugin_sql_t *plugin, const char *input, size_t input_size)
+{
+        if ( ! (plugin->escape_flags & PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_BYTEA_HEX) )
+                return FALSE;
+
+        return input_size >= 2 && input[0] == '\\' && input[1] == 'x';
+}
+
+
 int _preludedb_plugin_sql_unescape_binary(preludedb_plugin_sql_t *plugin, void *session, const char *input,
                                           size_t input_size, unsigned char **output, size_t *output_size)
 {
+        if ( _preludedb_plugin_sql_is_binary_hex(plugin, input, input_size) ) {
+                *output_size = (input_size - 2) / 2;
+
+                *output = malloc(*output_size ? *output_size : 1);
+                if ( ! *output )
+                        return preludedb_error_from_errno(errno);
+
+                if ( _preludedb_sql_hex_decode(*output, input + 2, input_size - 2) < 0 ) {
+                        free(*output);
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_VALUE, "invalid hexadecimal binary value");
+                }
+
+                return 0;
+        }
+
         if ( plugin->unescape_binary )
                 return plugin->unescape_binary(session, input, output, output_size);
 
@@ -481,6 +528,128 @@ long _preludedb_plugin_sql_get_server_version(preludedb_plugin_sql_t *plugin, vo
 }
 
 
+void preludedb_plugin_sql_set_build_optimize_string_func(preludedb_plugin_sql_t *plugin,
+                                                         preludedb_plugin_sql_build_optimize_string_func_t func)
+{
+        plugin->build_optimize_string = func;
+}
+
+
+int _preludedb_plugin_sql_build_optimize_string(preludedb_plugin_sql_t *plugin, void *session, const char *table,
+                                                preludedb_sql_optimize_flags_t flag, prelude_string_t *output)
+{
+        if ( ! plugin->build_optimize_string )
+                return PRELUDEDB_ENOTSUP("build_optimize_string");
+
+        return plugin->build_optimize_string(session, table, flag, output);
+}
+
+
+void preludedb_plugin_sql_set_build_create_index_string_func(preludedb_plugin_sql_t *plugin,
+                                                             preludedb_plugin_sql_build_create_index_string_func_t func)
+{
+        plugin->build_create_index_string = func;
+}
+
+
+int _preludedb_plugin_sql_build_create_index_string(preludedb_plugin_sql_t *plugin, void *session,
+                                                    const char *name, const char *table, const char *columns,
+                                                    const char *partial_column, const char *partial_value,
+                                                    prelude_string_t *output)
+{
+        if ( ! plugin->build_create_index_string )
+                return PRELUDEDB_ENOTSUP("build_create_index_string");
+
+        return plugin->build_create_index_string(session, name, table, columns, partial_column, partial_value, output);
+}
+
+
+void preludedb_plugin_sql_set_build_upsert_string_func(preludedb_plugin_sql_t *plugin,
+                                                       preludedb_plugin_sql_build_upsert_string_func_t func)
+{
+        plugin->build_upsert_string = func;
+}
+
+
+int _preludedb_plugin_sql_build_upsert_string(preludedb_plugin_sql_t *plugin, void *session, const char *table,
+                                              const char *fields, const char *values, const char *key,
+                                              const char * const *columns, size_t size, prelude_string_t *output)
+{
+        if ( ! plugin->build_upsert_string )
+                return PRELUDEDB_ENOTSUP("build_upsert_string");
+
+        return plugin->build_upsert_string(session, table, fields, values, key, columns, size, output);
+}
+
+
+void preludedb_plugin_sql_set_build_aggregate_string_func(preludedb_plugin_sql_t *plugin,
+                                                          preludedb_plugin_sql_build_aggregate_string_func_t func)
+{
+        plugin->build_aggregate_string = func;
+}
+
+
+int _preludedb_plugin_sql_build_aggregate_string(preludedb_plugin_sql_t *plugin, void *session, prelude_string_t *output,
+                                                 const char *field, preludedb_sql_aggregate_type_t type, int param)
+{
+        if ( ! plugin->build_aggregate_string )
+                return PRELUDEDB_ENOTSUP("build_aggregate_string");
+
+        return plugin->build_aggregate_string(session, output, field, type, param);
+}
+
+
+/*
+ * Backends that cannot run concurrent transactions on separate
+ * connections to the same database limit the number of sessions.
+ */
+void preludedb_plugin_sql_set_max_sessions(preludedb_plugin_sql_t *plugin, unsigned int max)
+{
+        plugin->max_sessions = max;
+}
+
+
+unsigned int _preludedb_plugin_sql_get_max_sessions(preludedb_plugin_sql_t *plugin)
+{
+        return plugin->max_sessions;
+}
+
+
+/*
+ * Backends whose string literals only require single quotes to be doubled
+ * let the library escape strings itself, without locking the session.
+ */
+void preludedb_plugin_sql_set_escape_flags(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_escape_flags_t flags)
+{
+        plugin->escape_flags = flags;
+}
+
+
+preludedb_plugin_sql_escape_flags_t _preludedb_plugin_sql_get_escape_flags(preludedb_plugin_sql_t *plugin)
+{
+        return plugin->escape_flags;
+}
+
+
+/*
+ * Backends whose escaping depends on the server a session is connected
+ * to narrow down the escape flags of the plugin for each session.
+ */
+void preludedb_plugin_sql_set_get_escape_flags_func(preludedb_plugin_sql_t *plugin, preludedb_plugin_sql_get_escape_flags_func_t func)
+{
+        plugin->get_escape_flags = func;
+}
+
+
+preludedb_plugin_sql_escape_flags_t _preludedb_plugin_sql_get_session_escape_flags(preludedb_plugin_sql_t *plugin, void *session)
+{
+        if ( ! plugin->get_escape_flags )
+                return plugin->escape_flags;
+
+        return plugin->get_escape_flags(session);
+}
+
+
 int preludedb_plugin_sql_new(preludedb_plugin_sql_t **plugin)
 {
         *plugin = calloc(1, sizeof(**plugin));
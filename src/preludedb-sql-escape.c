@@ -0,0 +1,221 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libprelude/prelude.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+# include <immintrin.h>
+# define ESCAPE_SCAN_AVX2 1
+#endif
+
+#if defined(__GNUC__) && defined(__SSE2__)
+# include <emmintrin.h>
+# define ESCAPE_SCAN_SSE2 1
+#endif
+
+
+/*
+ * Scanning of string literals for the bytes that need escaping: clean
+ * runs, the vast majority of the input, are then copied as is. Where
+ * available, SSE2 and AVX2 compare 16 and 32 bytes at a time.
+ *
+ * With @quote_only, as for backends configured with standard conforming
+ * strings, only single quotes need escaping (by doubling them) and a NUL
+ * byte ends the string. Otherwise, backslashes, double quotes, line feeds,
+ * carriage returns and Ctrl-Z need escaping as well, which is left to the
+ * backend.
+ */
+size_t _preludedb_sql_escape_span(const char *input, size_t size, prelude_bool_t quote_only);
+size_t _preludedb_sql_escape_write(char *output, const char *input, size_t size);
+int _preludedb_sql_escape_append(prelude_string_t *output, const char *input, size_t size);
+
+
+
+static inline prelude_bool_t is_special(unsigned char c, prelude_bool_t quote_only)
+{
+        if ( c == '\'' || c == 0 )
+                return TRUE;
+
+        if ( quote_only )
+                return FALSE;
+
+        return c == '\\' || c == '"' || c == '\n' || c == '\r' || c == '\032';
+}
+
+
+
+#ifdef ESCAPE_SCAN_AVX2
+static inline unsigned int scan32(const char *input, prelude_bool_t quote_only)
+{
+        __m256i v, m;
+
+        v = _mm256_loadu_si256((const __m256i *) input);
+        m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')), _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+
+        if ( ! quote_only ) {
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\032')));
+        }
+
+        return (unsigned int) _mm256_movemask_epi8(m);
+}
+#endif
+
+
+
+#ifdef ESCAPE_SCAN_SSE2
+static inline unsigned int scan16(const char *input, prelude_bool_t quote_only)
+{
+        __m128i v, m;
+
+        v = _mm_loadu_si128((const __m128i *) input);
+        m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\'')), _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+
+        if ( ! quote_only ) {
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\032')));
+        }
+
+        return (unsigned int) _mm_movemask_epi8(m);
+}
+#endif
+
+
+
+/*
+ * Returns the length of the leading run of @input free of bytes needing
+ * escaping, @size if there are none.
+ */
+size_t _preludedb_sql_escape_span(const char *input, size_t size, prelude_bool_t quote_only)
+{
+        size_t i = 0;
+#if defined(ESCAPE_SCAN_AVX2) || defined(ESCAPE_SCAN_SSE2)
+        unsigned int mask;
+#endif
+
+#ifdef ESCAPE_SCAN_AVX2
+        for ( ; i + 32 <= size; i += 32 ) {
+                mask = scan32(input + i, quote_only);
+                if ( mask )
+                        return i + __builtin_ctz(mask);
+        }
+#endif
+
+#ifdef ESCAPE_SCAN_SSE2
+        for ( ; i + 16 <= size; i += 16 ) {
+                mask = scan16(input + i, quote_only);
+                if ( mask )
+                        return i + __builtin_ctz(mask);
+        }
+#endif
+
+        for ( ; i < size; i++ ) {
+                if ( is_special(input[i], quote_only) )
+                        return i;
+        }
+
+        return size;
+}
+
+
+
+/*
+ * Write the quoted literal for @input, in which only single quotes and
+ * NUL bytes may need escaping, to @output, which must be at least
+ * 2 * @size + 3 bytes long. Returns the length of the literal.
+ */
+size_t _preludedb_sql_escape_write(char *output, const char *input, size_t size)
+{
+        size_t run;
+        char *ptr = output;
+
+        *ptr++ = '\'';
+
+        while ( size ) {
+                run = _preludedb_sql_escape_span(input, size, TRUE);
+                memcpy(ptr, input, run);
+                ptr += run;
+
+                if ( run == size || input[run] == 0 )
+                        break;
+
+                *ptr++ = '\'';
+                *ptr++ = '\'';
+
+                input += run + 1;
+                size -= run + 1;
+        }
+
+        *ptr++ = '\'';
+        *ptr = 0;
+
+        return ptr - output;
+}
+
+
+
+/*
+ * Same as _preludedb_sql_escape_write(), appending the literal to @output.
+ */
+int _preludedb_sql_escape_append(prelude_string_t *output, const char *input, size_t size)
+{
+        int ret;
+        size_t run;
+
+        ret = prelude_string_ncat(output, "'", 1);
+        if ( ret < 0 )
+                return ret;
+
+        while ( size ) {
+                run = _preludedb_sql_escape_span(input, size, TRUE);
+
+                if ( run ) {
+                        ret = prelude_string_ncat(output, input, run);
+                        if ( ret < 0 )
+                                return ret;
+                }
+
+                if ( run == size || input[run] == 0 )
+                        break;
+
+                ret = prelude_string_ncat(output, "''", 2);
+                if ( ret < 0 )
+                        return ret;
+
+                input += run + 1;
+                size -= run + 1;
+        }
+
+        return prelude_string_ncat(output, "'", 1);
+}
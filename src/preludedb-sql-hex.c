@@ -0,0 +1,352 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libprelude/prelude.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+# include <emmintrin.h>
+# define HEX_SSE2 1
+#endif
+
+/*
+ * AVX2 is not part of the baseline instruction set: the AVX2 routines are
+ * built for it specifically, and only used when the CPU supports it.
+ */
+#if defined(HEX_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# include <immintrin.h>
+# define HEX_AVX2 1
+# define HEX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+/*
+ * Hexadecimal encoding and decoding of binary buffers, as used by binary
+ * literals (X'...' or '\x...') and by the PostgreSQL bytea hex output.
+ * Encoding outputs uppercase digits, decoding accepts both cases.
+ */
+void _preludedb_sql_hex_encode(char *output, const unsigned char *input, size_t size);
+int _preludedb_sql_hex_decode(unsigned char *output, const char *input, size_t size);
+int _preludedb_sql_hex_append(prelude_string_t *output, const unsigned char *input, size_t size);
+
+
+#ifndef MIN
+# define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+
+#define HEX_APPEND_CHUNK 2048
+
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+
+
+static inline int hex_value(unsigned char c)
+{
+        if ( c >= '0' && c <= '9' )
+                return c - '0';
+
+        c |= 0x20;
+        if ( c >= 'a' && c <= 'f' )
+                return c - 'a' + 10;
+
+        return -1;
+}
+
+
+
+#ifdef HEX_SSE2
+static inline __m128i nibble_to_hex16(__m128i n)
+{
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '0' - 10));
+        return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), alpha);
+}
+
+
+
+static size_t encode_sse2(char *output, const unsigned char *input, size_t size)
+{
+        size_t i;
+        __m128i v, hi, lo, mask = _mm_set1_epi8(0x0f);
+
+        for ( i = 0; i + 16 <= size; i += 16 ) {
+                v = _mm_loadu_si128((const __m128i *) (input + i));
+
+                hi = nibble_to_hex16(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+                lo = nibble_to_hex16(_mm_and_si128(v, mask));
+
+                _mm_storeu_si128((__m128i *) (output + i * 2), _mm_unpacklo_epi8(hi, lo));
+                _mm_storeu_si128((__m128i *) (output + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+
+        return i;
+}
+
+
+
+/*
+ * Converts 16 hexadecimal digits into their values, setting @invalid for
+ * any other character.
+ */
+static inline __m128i hex_to_nibble16(__m128i v, __m128i *invalid)
+{
+        __m128i digit, alpha, isdigit, isalpha;
+
+        digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        isdigit = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)), _mm_cmplt_epi8(digit, _mm_set1_epi8(10)));
+
+        alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        isalpha = _mm_and_si128(_mm_cmpgt_epi8(alpha, _mm_set1_epi8(-1)), _mm_cmplt_epi8(alpha, _mm_set1_epi8(6)));
+
+        *invalid = _mm_or_si128(*invalid, _mm_andnot_si128(_mm_or_si128(isdigit, isalpha), _mm_set1_epi8(-1)));
+
+        return _mm_or_si128(_mm_and_si128(digit, isdigit),
+                            _mm_and_si128(_mm_add_epi8(alpha, _mm_set1_epi8(10)), isalpha));
+}
+
+
+
+/*
+ * Merges each pair of nibbles, the first one being the high order one,
+ * into the low byte of each 16 bits word.
+ */
+static inline __m128i merge_nibbles16(__m128i n)
+{
+        return _mm_and_si128(_mm_or_si128(_mm_slli_epi16(n, 4), _mm_srli_epi16(n, 8)), _mm_set1_epi16(0x00ff));
+}
+
+
+
+static size_t decode_sse2(unsigned char *output, const char *input, size_t size, prelude_bool_t *error)
+{
+        size_t i;
+        __m128i a, b, invalid = _mm_setzero_si128();
+
+        for ( i = 0; i + 32 <= size; i += 32 ) {
+                a = merge_nibbles16(hex_to_nibble16(_mm_loadu_si128((const __m128i *) (input + i)), &invalid));
+                b = merge_nibbles16(hex_to_nibble16(_mm_loadu_si128((const __m128i *) (input + i + 16)), &invalid));
+
+                if ( _mm_movemask_epi8(invalid) ) {
+                        *error = TRUE;
+                        return i;
+                }
+
+                _mm_storeu_si128((__m128i *) (output + i / 2), _mm_packus_epi16(a, b));
+        }
+
+        return i;
+}
+#endif
+
+
+
+#ifdef HEX_AVX2
+static inline HEX_TARGET_AVX2 __m256i nibble_to_hex32(__m256i n)
+{
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(n, _mm256_set1_epi8(9)), _mm256_set1_epi8('A' - '0' - 10));
+        return _mm256_add_epi8(_mm256_add_epi8(n, _mm256_set1_epi8('0')), alpha);
+}
+
+
+
+static HEX_TARGET_AVX2 size_t encode_avx2(char *output, const unsigned char *input, size_t size)
+{
+        size_t i;
+        __m256i v, hi, lo, mask = _mm256_set1_epi8(0x0f);
+
+        for ( i = 0; i + 32 <= size; i += 32 ) {
+                v = _mm256_loadu_si256((const __m256i *) (input + i));
+
+                hi = nibble_to_hex32(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+                lo = nibble_to_hex32(_mm256_and_si256(v, mask));
+
+                /*
+                 * Unpacking works within each 128 bits lane.
+                 */
+                v = _mm256_unpacklo_epi8(hi, lo);
+                lo = _mm256_unpackhi_epi8(hi, lo);
+
+                _mm256_storeu_si256((__m256i *) (output + i * 2), _mm256_permute2x128_si256(v, lo, 0x20));
+                _mm256_storeu_si256((__m256i *) (output + i * 2 + 32), _mm256_permute2x128_si256(v, lo, 0x31));
+        }
+
+        return i;
+}
+
+
+
+static inline HEX_TARGET_AVX2 __m256i hex_to_nibble32(__m256i v, __m256i *invalid)
+{
+        __m256i digit, alpha, isdigit, isalpha;
+
+        digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        isdigit = _mm256_and_si256(_mm256_cmpgt_epi8(digit, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(10), digit));
+
+        alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        isalpha = _mm256_and_si256(_mm256_cmpgt_epi8(alpha, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(6), alpha));
+
+        *invalid = _mm256_or_si256(*invalid, _mm256_andnot_si256(_mm256_or_si256(isdigit, isalpha), _mm256_set1_epi8(-1)));
+
+        return _mm256_or_si256(_mm256_and_si256(digit, isdigit),
+                               _mm256_and_si256(_mm256_add_epi8(alpha, _mm256_set1_epi8(10)), isalpha));
+}
+
+
+
+static inline HEX_TARGET_AVX2 __m256i merge_nibbles32(__m256i n)
+{
+        return _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(n, 4), _mm256_srli_epi16(n, 8)), _mm256_set1_epi16(0x00ff));
+}
+
+
+
+static HEX_TARGET_AVX2 size_t decode_avx2(unsigned char *output, const char *input, size_t size, prelude_bool_t *error)
+{
+        size_t i;
+        __m256i a, b, invalid = _mm256_setzero_si256();
+
+        for ( i = 0; i + 64 <= size; i += 64 ) {
+                a = merge_nibbles32(hex_to_nibble32(_mm256_loadu_si256((const __m256i *) (input + i)), &invalid));
+                b = merge_nibbles32(hex_to_nibble32(_mm256_loadu_si256((const __m256i *) (input + i + 32)), &invalid));
+
+                if ( _mm256_movemask_epi8(invalid) ) {
+                        *error = TRUE;
+                        return i;
+                }
+
+                /*
+                 * Packing works within each 128 bits lane, restore the order of the quadwords.
+                 */
+                a = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256((__m256i *) (output + i / 2), a);
+        }
+
+        return i;
+}
+
+
+
+static inline prelude_bool_t has_avx2(void)
+{
+        return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+#endif
+
+
+
+/*
+ * Writes the 2 * @size hexadecimal digits of @input to @output, which is
+ * not NUL terminated.
+ */
+void _preludedb_sql_hex_encode(char *output, const unsigned char *input, size_t size)
+{
+        size_t i = 0;
+
+#ifdef HEX_AVX2
+        if ( size >= 32 && has_avx2() )
+                i = encode_avx2(output, input, size);
+#endif
+
+#ifdef HEX_SSE2
+        i += encode_sse2(output + i * 2, input + i, size - i);
+#endif
+
+        for ( ; i < size; i++ ) {
+                output[i * 2] = hex_digits[input[i] >> 4];
+                output[i * 2 + 1] = hex_digits[input[i] & 0x0f];
+        }
+}
+
+
+
+/*
+ * Decodes the @size hexadecimal digits of @input into the @size / 2 bytes
+ * of @output. Returns -1 if @size is odd or @input is not hexadecimal.
+ */
+int _preludedb_sql_hex_decode(unsigned char *output, const char *input, size_t size)
+{
+        size_t i = 0;
+        int high, low;
+        prelude_bool_t error = FALSE;
+
+        if ( size % 2 )
+                return -1;
+
+#ifdef HEX_AVX2
+        if ( size >= 64 && has_avx2() )
+                i = decode_avx2(output, input, size, &error);
+#endif
+
+#ifdef HEX_SSE2
+        if ( ! error )
+                i += decode_sse2(output + i / 2, input + i, size - i, &error);
+#endif
+
+        if ( error )
+                return -1;
+
+        for ( ; i < size; i += 2 ) {
+                high = hex_value(input[i]);
+                low = hex_value(input[i + 1]);
+
+                if ( high < 0 || low < 0 )
+                        return -1;
+
+                output[i / 2] = (high << 4) | low;
+        }
+
+        return 0;
+}
+
+
+
+/*
+ * Appends the hexadecimal digits of @input to @output, encoding through a
+ * stack buffer rather than an intermediate allocation.
+ */
+int _preludedb_sql_hex_append(prelude_string_t *output, const unsigned char *input, size_t size)
+{
+        int ret;
+        size_t len;
+        char buf[HEX_APPEND_CHUNK * 2];
+
+        while ( size ) {
+                len = MIN(size, HEX_APPEND_CHUNK);
+
+                _preludedb_sql_hex_encode(buf, input, len);
+
+                ret = prelude_string_ncat(output, buf, len * 2);
+                if ( ret < 0 )
+                        return ret;
+
+                input += len;
+                size -= len;
+        }
+
+        return 0;
+}
@@ -0,0 +1,517 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/time.h>
+
+#ifdef USE_POSIX_THREADS
+# include <pthread.h>
+#endif
+
+#include <libprelude/prelude.h>
+#include <libprelude/prelude-log.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+
+
+#ifndef MIN
+# define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+
+
+/*
+ * Queries are copied into a ring buffer by the caller and written out by
+ * a dedicated thread, so that logging does not add I/O latency to the
+ * query path. When the buffer is full, queries are dropped rather than
+ * waiting for the writer.
+ */
+#define LOG_BUFFER_SIZE (1024 * 1024)
+#define LOG_DEFAULT_MAX_FILES 5
+#define LOG_BINARY_MAGIC "PRELUDEDB-QLOG1\n"
+
+
+typedef enum {
+        LOG_FORMAT_TEXT   = 0,
+        LOG_FORMAT_BINARY = 1
+} log_format_t;
+
+
+typedef struct {
+        uint32_t sec;
+        uint32_t usec;
+        uint32_t elapsed;
+        uint32_t len;
+} log_record_t;
+
+
+typedef struct preludedb_sql_log {
+        FILE *fd;
+        char *filename;
+        log_format_t format;
+
+        unsigned int sample;
+        unsigned int sample_count;
+        double threshold;
+
+        size_t size;
+        size_t max_size;
+        unsigned int max_files;
+
+        uint64_t dropped;
+
+#ifdef USE_POSIX_THREADS
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        prelude_bool_t stop;
+
+        unsigned char *buffer;
+        size_t head;
+        size_t tail;
+        size_t used;
+#endif
+} preludedb_sql_log_t;
+
+
+
+int _preludedb_sql_log_new(preludedb_sql_log_t **log, const char *filename, const preludedb_sql_settings_t *settings);
+void _preludedb_sql_log_destroy(preludedb_sql_log_t *log);
+void _preludedb_sql_log_query(preludedb_sql_log_t *log, const struct timeval *date, double elapsed, const char *query);
+
+
+
+static int get_uint_setting(const preludedb_sql_settings_t *settings, const char *name, unsigned long *value)
+{
+        char *eptr;
+        const char *str;
+
+        str = preludedb_sql_settings_get(settings, name);
+        if ( ! str )
+                return 0;
+
+        *value = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                               "invalid value '%s' for setting '%s'", str, name);
+
+        return 0;
+}
+
+
+
+static int load_settings(preludedb_sql_log_t *log, const preludedb_sql_settings_t *settings)
+{
+        int ret;
+        char *eptr;
+        const char *str;
+        unsigned long value;
+
+        value = 1;
+        ret = get_uint_setting(settings, PRELUDEDB_SQL_SETTING_LOG_SAMPLE, &value);
+        if ( ret < 0 )
+                return ret;
+        log->sample = value ? value : 1;
+
+        value = 0;
+        ret = get_uint_setting(settings, PRELUDEDB_SQL_SETTING_LOG_MAX_SIZE, &value);
+        if ( ret < 0 )
+                return ret;
+        log->max_size = value;
+
+        value = LOG_DEFAULT_MAX_FILES;
+        ret = get_uint_setting(settings, PRELUDEDB_SQL_SETTING_LOG_MAX_FILES, &value);
+        if ( ret < 0 )
+                return ret;
+        log->max_files = value;
+
+        str = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_LOG_THRESHOLD);
+        if ( str ) {
+                log->threshold = strtod(str, &eptr);
+                if ( eptr == str || *eptr || log->threshold < 0 )
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                                       "invalid value '%s' for setting '%s'", str, PRELUDEDB_SQL_SETTING_LOG_THRESHOLD);
+        }
+
+        str = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_LOG_FORMAT);
+        if ( ! str || strcmp(str, "text") == 0 )
+                log->format = LOG_FORMAT_TEXT;
+
+        else if ( strcmp(str, "binary") == 0 )
+                log->format = LOG_FORMAT_BINARY;
+
+        else return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                            "invalid value '%s' for setting '%s', should be 'text' or 'binary'",
+                                            str, PRELUDEDB_SQL_SETTING_LOG_FORMAT);
+
+        return 0;
+}
+
+
+
+static int log_open(preludedb_sql_log_t *log, const char *mode)
+{
+        int fd, ret;
+
+        if ( ! log->filename ) {
+                log->fd = stdout;
+                return 0;
+        }
+
+        log->fd = fopen(log->filename, mode);
+        if ( ! log->fd )
+                return preludedb_error_verbose(prelude_error_code_from_errno(errno),
+                                               "Could not open '%s' for writing: %s", log->filename, strerror(errno));
+
+        fd = fileno(log->fd);
+
+        ret = fcntl(fd, F_GETFD);
+        if ( ret >= 0 )
+                fcntl(fd, F_SETFD, ret | FD_CLOEXEC);
+
+        fseek(log->fd, 0, SEEK_END);
+        log->size = ftell(log->fd);
+
+        if ( log->format == LOG_FORMAT_BINARY && log->size == 0 )
+                log->size = fwrite(LOG_BINARY_MAGIC, 1, sizeof(LOG_BINARY_MAGIC) - 1, log->fd);
+
+        return 0;
+}
+
+
+
+static void log_close(preludedb_sql_log_t *log)
+{
+        if ( log->fd && log->fd != stdout )
+                fclose(log->fd);
+        else if ( log->fd )
+                fflush(log->fd);
+
+        log->fd = NULL;
+}
+
+
+
+static void log_rotate(preludedb_sql_log_t *log)
+{
+        int ret;
+        unsigned int i;
+        char src[PATH_MAX], dst[PATH_MAX];
+
+        log_close(log);
+
+        for ( i = log->max_files; i > 1; i-- ) {
+                snprintf(src, sizeof(src), "%s.%u", log->filename, i - 1);
+                snprintf(dst, sizeof(dst), "%s.%u", log->filename, i);
+                rename(src, dst);
+        }
+
+        if ( log->max_files > 0 ) {
+                snprintf(dst, sizeof(dst), "%s.1", log->filename);
+                rename(log->filename, dst);
+        }
+
+        ret = log_open(log, "w");
+        if ( ret < 0 )
+                prelude_log(PRELUDE_LOG_ERR, "query log rotation failed: %s.\n", preludedb_strerror(ret));
+}
+
+
+
+static void put_uint32(unsigned char *out, uint32_t value)
+{
+        out[0] = value >> 24;
+        out[1] = value >> 16;
+        out[2] = value >> 8;
+        out[3] = value;
+}
+
+
+
+/*
+ * Binary records are made of the query date (seconds, microseconds), its
+ * duration in microseconds and the query length, as big endian 32 bits
+ * integers, followed by the query itself.
+ */
+static void log_write(preludedb_sql_log_t *log, const log_record_t *rec,
+                      const void *query1, size_t len1, const void *query2, size_t len2)
+{
+        int ret;
+        unsigned char hdr[16];
+
+        if ( ! log->fd )
+                return;
+
+        if ( log->format == LOG_FORMAT_BINARY ) {
+                put_uint32(hdr, rec->sec);
+                put_uint32(hdr + 4, rec->usec);
+                put_uint32(hdr + 8, rec->elapsed);
+                put_uint32(hdr + 12, rec->len);
+
+                fwrite(hdr, 1, sizeof(hdr), log->fd);
+                log->size += sizeof(hdr) + rec->len;
+        }
+
+        else {
+                ret = fprintf(log->fd, "%fs ", (double) rec->elapsed / 1000000);
+                log->size += (ret > 0) ? ret + rec->len + 1 : 0;
+        }
+
+        fwrite(query1, 1, len1, log->fd);
+        if ( len2 )
+                fwrite(query2, 1, len2, log->fd);
+
+        if ( log->format == LOG_FORMAT_TEXT )
+                fputc('\n', log->fd);
+
+        if ( log->filename && log->max_size && log->size >= log->max_size )
+                log_rotate(log);
+}
+
+
+
+#ifdef USE_POSIX_THREADS
+
+static void buffer_put(preludedb_sql_log_t *log, const void *data, size_t len)
+{
+        size_t first = MIN(len, LOG_BUFFER_SIZE - log->head);
+
+        memcpy(log->buffer + log->head, data, first);
+        memcpy(log->buffer, (const unsigned char *) data + first, len - first);
+
+        log->head = (log->head + len) % LOG_BUFFER_SIZE;
+}
+
+
+
+static void buffer_get(preludedb_sql_log_t *log, size_t *offset, void *data, size_t len)
+{
+        size_t first = MIN(len, LOG_BUFFER_SIZE - *offset);
+
+        memcpy(data, log->buffer + *offset, first);
+        memcpy((unsigned char *) data + first, log->buffer, len - first);
+
+        *offset = (*offset + len) % LOG_BUFFER_SIZE;
+}
+
+
+
+/*
+ * The writer only accesses the [tail, tail + used) area, which producers
+ * never touch until it is released, so that records can be written out
+ * without holding the mutex.
+ */
+static void *log_writer_thread(void *data)
+{
+        uint64_t dropped;
+        log_record_t rec;
+        size_t offset, used, remaining, first;
+        preludedb_sql_log_t *log = data;
+
+        pthread_mutex_lock(&log->mutex);
+
+        while ( TRUE ) {
+                while ( ! log->used && ! log->stop )
+                        pthread_cond_wait(&log->cond, &log->mutex);
+
+                if ( ! log->used && log->stop )
+                        break;
+
+                offset = log->tail;
+                used = log->used;
+                dropped = log->dropped;
+                log->dropped = 0;
+
+                pthread_mutex_unlock(&log->mutex);
+
+                if ( dropped )
+                        prelude_log(PRELUDE_LOG_WARN, "query log buffer full: %" PRELUDE_PRIu64 " queries were not logged.\n", dropped);
+
+                remaining = used;
+                while ( remaining ) {
+                        buffer_get(log, &offset, &rec, sizeof(rec));
+
+                        first = MIN(rec.len, LOG_BUFFER_SIZE - offset);
+                        log_write(log, &rec, log->buffer + offset, first, log->buffer, rec.len - first);
+
+                        offset = (offset + rec.len) % LOG_BUFFER_SIZE;
+                        remaining -= sizeof(rec) + rec.len;
+                }
+
+                if ( log->fd )
+                        fflush(log->fd);
+
+                pthread_mutex_lock(&log->mutex);
+
+                log->tail = offset;
+                log->used -= used;
+        }
+
+        pthread_mutex_unlock(&log->mutex);
+
+        return NULL;
+}
+
+#endif
+
+
+
+static void log_destroy(preludedb_sql_log_t *log)
+{
+        log_close(log);
+
+#ifdef USE_POSIX_THREADS
+        free(log->buffer);
+#endif
+
+        free(log->filename);
+        free(log);
+}
+
+
+
+int _preludedb_sql_log_new(preludedb_sql_log_t **log, const char *filename, const preludedb_sql_settings_t *settings)
+{
+        int ret;
+
+        *log = calloc(1, sizeof(**log));
+        if ( ! *log )
+                return preludedb_error_from_errno(errno);
+
+        if ( settings ) {
+                ret = load_settings(*log, settings);
+                if ( ret < 0 )
+                        goto error;
+        } else {
+                (*log)->sample = 1;
+                (*log)->max_files = LOG_DEFAULT_MAX_FILES;
+        }
+
+        if ( filename ) {
+                (*log)->filename = strdup(filename);
+                if ( ! (*log)->filename ) {
+                        ret = preludedb_error_from_errno(errno);
+                        goto error;
+                }
+        }
+
+        ret = log_open(*log, "a");
+        if ( ret < 0 )
+                goto error;
+
+#ifdef USE_POSIX_THREADS
+        (*log)->buffer = malloc(LOG_BUFFER_SIZE);
+        if ( ! (*log)->buffer ) {
+                ret = preludedb_error_from_errno(errno);
+                goto error;
+        }
+
+        pthread_mutex_init(&(*log)->mutex, NULL);
+        pthread_cond_init(&(*log)->cond, NULL);
+
+        ret = pthread_create(&(*log)->thread, NULL, log_writer_thread, *log);
+        if ( ret != 0 ) {
+                pthread_cond_destroy(&(*log)->cond);
+                pthread_mutex_destroy(&(*log)->mutex);
+                ret = preludedb_error_verbose(prelude_error_code_from_errno(ret), "could not create query log thread: %s", strerror(ret));
+                goto error;
+        }
+#endif
+
+        return 0;
+
+ error:
+        log_destroy(*log);
+        return ret;
+}
+
+
+
+/*
+ * Queued queries are flushed before returning.
+ */
+void _preludedb_sql_log_destroy(preludedb_sql_log_t *log)
+{
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&log->mutex);
+        log->stop = TRUE;
+        pthread_cond_signal(&log->cond);
+        pthread_mutex_unlock(&log->mutex);
+
+        pthread_join(log->thread, NULL);
+
+        pthread_cond_destroy(&log->cond);
+        pthread_mutex_destroy(&log->mutex);
+#endif
+
+        log_destroy(log);
+}
+
+
+
+void _preludedb_sql_log_query(preludedb_sql_log_t *log, const struct timeval *date, double elapsed, const char *query)
+{
+        log_record_t rec;
+
+        if ( elapsed < log->threshold )
+                return;
+
+        rec.sec = date->tv_sec;
+        rec.usec = date->tv_usec;
+        rec.elapsed = elapsed * 1000000;
+        rec.len = strlen(query);
+
+#ifdef USE_POSIX_THREADS
+        pthread_mutex_lock(&log->mutex);
+
+        if ( log->sample > 1 && log->sample_count++ % log->sample != 0 )
+                goto out;
+
+        if ( sizeof(rec) + rec.len > LOG_BUFFER_SIZE - log->used ) {
+                log->dropped++;
+                goto out;
+        }
+
+        buffer_put(log, &rec, sizeof(rec));
+        buffer_put(log, query, rec.len);
+        log->used += sizeof(rec) + rec.len;
+
+        pthread_cond_signal(&log->cond);
+
+ out:
+        pthread_mutex_unlock(&log->mutex);
+#else
+        if ( log->sample > 1 && log->sample_count++ % log->sample != 0 )
+                return;
+
+        log_write(log, &rec, query, rec.len, NULL, 0);
+        if ( log->fd )
+                fflush(log->fd);
+#endif
+}
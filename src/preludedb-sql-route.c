@@ -0,0 +1,115 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+
+#include "config.h"
+
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include <libprelude/prelude.h>
+
+
+prelude_bool_t _preludedb_sql_is_read_only(const char *query);
+
+
+
+/*
+ * Words that make a SELECT unsafe to run on a replica: row locking
+ * (FOR UPDATE, FOR SHARE, LOCK IN SHARE MODE), SELECT ... INTO, and
+ * functions with side effects or bound to the primary's session.
+ */
+static const char * const unsafe_words[] = {
+        "INTO", "FOR", "LOCK",
+        "nextval", "setval", "currval", "lastval",
+        "last_insert_id", "last_insert_rowid",
+        "get_lock", "release_lock",
+        "pg_advisory_lock", "pg_advisory_xact_lock",
+        "pg_try_advisory_lock", "pg_try_advisory_xact_lock"
+};
+
+
+
+static prelude_bool_t is_unsafe_word(const char *word, size_t len)
+{
+        unsigned int i;
+
+        for ( i = 0; i < sizeof(unsafe_words) / sizeof(*unsafe_words); i++ ) {
+                if ( strlen(unsafe_words[i]) == len && strncasecmp(word, unsafe_words[i], len) == 0 )
+                        return TRUE;
+        }
+
+        return FALSE;
+}
+
+
+
+/*
+ * Whether @query is a single SELECT that can run on a replica. Words
+ * within quoted literals and identifiers are not looked at.
+ */
+prelude_bool_t _preludedb_sql_is_read_only(const char *query)
+{
+        char quote;
+        const char *word;
+
+        while ( isspace((unsigned char) *query) )
+                query++;
+
+        if ( strncasecmp(query, "SELECT", 6) != 0 )
+                return FALSE;
+
+        while ( *query ) {
+                if ( *query == '\'' || *query == '"' || *query == '`' ) {
+                        quote = *query++;
+
+                        while ( *query && *query != quote ) {
+                                if ( *query == '\\' && query[1] )
+                                        query++;
+                                query++;
+                        }
+
+                        if ( *query )
+                                query++;
+                }
+
+                else if ( *query == ';' ) {
+                        for ( query++; isspace((unsigned char) *query); query++ );
+                        if ( *query )
+                                return FALSE;
+                }
+
+                else if ( isalpha((unsigned char) *query) || *query == '_' ) {
+                        word = query;
+                        while ( isalnum((unsigned char) *query) || *query == '_' )
+                                query++;
+
+                        if ( is_unsafe_word(word, query - word) )
+                                return FALSE;
+                }
+
+                else query++;
+        }
+
+        return TRUE;
+}
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <limits.h>
 
 #include <libprelude/prelude.h>
 
@@ -50,6 +51,7 @@ struct preludedb_sql_select {
         unsigned int field_count;
         unsigned int index;
         preludedb_sql_select_flags_t flags;
+        prelude_bool_t topk;
 };
 
 
@@ -78,6 +80,53 @@ static const char *func_to_string(preludedb_selected_object_type_t type)
 }
 
 
+
+static int get_aggregate_param(preludedb_selected_object_t *object, int min, int max, int *param)
+{
+        preludedb_selected_object_t *arg;
+
+        arg = preludedb_selected_object_get_arg(object, 1);
+        if ( ! arg || preludedb_selected_object_get_type(arg) != PRELUDEDB_SELECTED_OBJECT_TYPE_INT )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Missing numeric parameter for function '%d'",
+                                               preludedb_selected_object_get_type(object));
+
+        *param = *(const int *) preludedb_selected_object_get_data(arg);
+        if ( *param < min || *param > max )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_GENERIC, "Parameter '%d' out of the [%d, %d] range", *param, min, max);
+
+        return 0;
+}
+
+
+
+/*
+ * Approximate aggregates are built by the SQL plugin, which might not
+ * support them: the caller then computes them from the raw values,
+ * selected with the PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE flag.
+ */
+static int aggregate_to_string(preludedb_sql_select_t *select, preludedb_selected_object_type_t type,
+                               const char *field, int param, prelude_string_t *out)
+{
+        switch ( type ) {
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT:
+                return preludedb_sql_build_aggregate_string(preludedb_get_sql(select->db), out, field,
+                                                            PRELUDEDB_SQL_AGGREGATE_APPROX_COUNT_DISTINCT, 0);
+
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE:
+                return preludedb_sql_build_aggregate_string(preludedb_get_sql(select->db), out, field,
+                                                            PRELUDEDB_SQL_AGGREGATE_PERCENTILE, param);
+
+        default:
+                /*
+                 * topk() selects its argument, the most frequent values
+                 * being retrieved through GROUP BY / ORDER BY COUNT(*).
+                 */
+                select->topk = TRUE;
+                return prelude_string_cat(out, field);
+        }
+}
+
+
 static int preludedb_selected_object_to_string(preludedb_sql_select_t *select, preludedb_selected_path_t *selected,
                                                preludedb_selected_object_t *object, prelude_string_t *out, void *data, int depth)
 {
@@ -130,6 +179,47 @@ static int preludedb_selected_object_to_string(preludedb_sql_select_t *select, p
                                                                *(const int *) preludedb_selected_object_get_data(preludedb_selected_object_get_arg(object, 2)));
         }
 
+        else if ( type == PRELUDEDB_SELECTED_OBJECT_TYPE_APPROX_COUNT_DISTINCT ||
+                  type == PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK ||
+                  type == PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE ) {
+                int param = 0;
+
+                if ( type == PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK )
+                        ret = get_aggregate_param(object, 1, INT_MAX, &param);
+
+                else if ( type == PRELUDEDB_SELECTED_OBJECT_TYPE_PERCENTILE )
+                        ret = get_aggregate_param(object, 0, 100, &param);
+
+                if ( ret < 0 )
+                        goto error;
+
+                if ( select->flags & PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE ) {
+                        ret = preludedb_selected_object_to_string(select, selected, preludedb_selected_object_get_arg(object, 0), out, data, depth + 1);
+                        if ( ret < 0 )
+                                goto error;
+                }
+
+                else {
+                        ret = prelude_string_new(&tmp1);
+                        if ( ret < 0 )
+                                goto error;
+
+                        ret = preludedb_selected_object_to_string(select, selected, preludedb_selected_object_get_arg(object, 0), tmp1, data, depth + 1);
+                        if ( ret < 0 )
+                                goto error;
+
+                        ret = aggregate_to_string(select, type, prelude_string_get_string(tmp1), param, out);
+                        if ( ret < 0 )
+                                goto error;
+                }
+        }
+
+        else if ( type == PRELUDEDB_SELECTED_OBJECT_TYPE_COUNT && select->flags & PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE ) {
+                ret = preludedb_selected_object_to_string(select, selected, preludedb_selected_object_get_arg(object, 0), out, data, depth + 1);
+                if ( ret < 0 )
+                        goto error;
+        }
+
        else if ( type == PRELUDEDB_SELECTED_OBJECT_TYPE_TIMEZONE ) {
                 ret = prelude_string_new(&tmp1);
                 if ( ret < 0 )
@@ -290,6 +380,7 @@ void preludedb_sql_select_destroy(preludedb_sql_select_t *select)
 int preludedb_sql_select_add_selected(preludedb_sql_select_t *select, preludedb_selected_path_t *selpath, void *data)
 {
         int ret;
+        preludedb_selected_path_flags_t flags;
 
         if ( ! prelude_string_is_empty(select->fields) ) {
                 ret = prelude_string_cat(select->fields, ", ");
@@ -301,7 +392,12 @@ int preludedb_sql_select_add_selected(preludedb_sql_select_t *select, preludedb_
         if ( ret < 0 )
                 return ret;
 
-        return sql_select_add_options(select, preludedb_selected_path_get_column_count(selpath), preludedb_selected_path_get_flags(selpath));
+        flags = preludedb_selected_path_get_flags(selpath);
+        if ( ! (select->flags & PRELUDEDB_SQL_SELECT_FLAGS_RAW_AGGREGATE) &&
+             preludedb_selected_object_get_type(preludedb_selected_path_get_object(selpath)) == PRELUDEDB_SELECTED_OBJECT_TYPE_TOPK )
+                flags |= PRELUDEDB_SELECTED_PATH_FLAGS_GROUP_BY;
+
+        return sql_select_add_options(select, preludedb_selected_path_get_column_count(selpath), flags);
 }
 
 
@@ -399,7 +495,15 @@ int preludedb_sql_select_modifiers_to_string(preludedb_sql_select_t *select, pre
                         return ret;
         }
 
-        if ( ! prelude_string_is_empty(select->order_by) ) {
+        if ( select->topk ) {
+                ret = prelude_string_sprintf(output, " ORDER BY COUNT(*) DESC%s%s",
+                                             prelude_string_is_empty(select->order_by) ? "" : ", ",
+                                             prelude_string_get_string_or_default(select->order_by, ""));
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        else if ( ! prelude_string_is_empty(select->order_by) ) {
                 ret = prelude_string_sprintf(output, " ORDER BY %s", prelude_string_get_string(select->order_by));
                 if ( ret < 0 )
                         return ret;
@@ -28,13 +28,26 @@
 #include <ctype.h>
 
 #include <libprelude/prelude-hash.h>
+#include <libprelude/prelude-list.h>
 
 #include "preludedb-error.h"
 #include "preludedb-sql-settings.h"
 
 
+typedef struct {
+        prelude_list_t list;
+        char *name;
+        char *value;
+} setting_t;
+
+
+/*
+ * Settings are looked up through the hash, and kept in a list as well
+ * for them to be copied.
+ */
 struct preludedb_sql_settings {
         prelude_hash_t *hash;
+        prelude_list_t list;
 };
 
 
@@ -55,9 +68,13 @@ int preludedb_sql_settings_new(preludedb_sql_settings_t **settings)
         if ( ! *settings )
                 return prelude_error_from_errno(errno);
 
-        ret = prelude_hash_new(&(*settings)->hash, NULL, NULL, free, free);
-        if ( ret < 0 )
+        ret = prelude_hash_new(&(*settings)->hash, NULL, NULL, NULL, NULL);
+        if ( ret < 0 ) {
                 free(*settings);
+                return ret;
+        }
+
+        prelude_list_init(&(*settings)->list);
 
         return ret;
 }
@@ -83,12 +100,64 @@ int preludedb_sql_settings_new_from_string(preludedb_sql_settings_t **settings,
 
 void preludedb_sql_settings_destroy(preludedb_sql_settings_t *settings)
 {
+        setting_t *setting;
+        prelude_list_t *tmp, *bkp;
+
         prelude_hash_destroy(settings->hash);
+
+        prelude_list_for_each_safe(&settings->list, tmp, bkp) {
+                setting = prelude_list_entry(tmp, setting_t, list);
+                free(setting->name);
+                free(setting->value);
+                free(setting);
+        }
+
         free(settings);
 }
 
 
 
+/*
+ * Set @name to @value, both of which are then owned by @settings.
+ */
+static int settings_set(preludedb_sql_settings_t *settings, char *name, char *value)
+{
+        int ret;
+        setting_t *setting;
+
+        setting = prelude_hash_get(settings->hash, name);
+        if ( setting ) {
+                free(name);
+                free(setting->value);
+                setting->value = value;
+                return 0;
+        }
+
+        setting = malloc(sizeof(*setting));
+        if ( ! setting ) {
+                free(name);
+                free(value);
+                return preludedb_error_from_errno(errno);
+        }
+
+        setting->name = name;
+        setting->value = value;
+
+        ret = prelude_hash_set(settings->hash, setting->name, setting);
+        if ( ret < 0 ) {
+                free(name);
+                free(value);
+                free(setting);
+                return ret;
+        }
+
+        prelude_list_add_tail(&settings->list, &setting->list);
+
+        return 0;
+}
+
+
+
 int preludedb_sql_settings_set(preludedb_sql_settings_t *settings,
                                const char *name, const char *value)
 {
@@ -104,7 +173,35 @@ int preludedb_sql_settings_set(preludedb_sql_settings_t *settings,
                 return preludedb_error_from_errno(errno);
         }
 
-        return prelude_hash_set(settings->hash, n, v);
+        return settings_set(settings, n, v);
+}
+
+
+
+/*
+ * Create @dst holding a copy of every setting of @settings.
+ */
+int _preludedb_sql_settings_clone(const preludedb_sql_settings_t *settings, preludedb_sql_settings_t **dst)
+{
+        int ret;
+        setting_t *setting;
+        prelude_list_t *tmp;
+
+        ret = preludedb_sql_settings_new(dst);
+        if ( ret < 0 )
+                return ret;
+
+        prelude_list_for_each(&settings->list, tmp) {
+                setting = prelude_list_entry(tmp, setting_t, list);
+
+                ret = preludedb_sql_settings_set(*dst, setting->name, setting->value);
+                if ( ret < 0 ) {
+                        preludedb_sql_settings_destroy(*dst);
+                        return ret;
+                }
+        }
+
+        return 0;
 }
 
 
@@ -189,7 +286,7 @@ int preludedb_sql_settings_set_from_string(preludedb_sql_settings_t *settings, c
                 if ( ret < 0 )
                         return ret;
 
-                ret = prelude_hash_set(settings->hash, name, value);
+                ret = settings_set(settings, name, value);
                 if ( ret < 0 )
                         return ret;
         }
@@ -201,7 +298,11 @@ int preludedb_sql_settings_set_from_string(preludedb_sql_settings_t *settings, c
 
 const char *preludedb_sql_settings_get(const preludedb_sql_settings_t *settings, const char *name)
 {
-        return prelude_hash_get(settings->hash, name);
+        setting_t *setting;
+
+        setting = prelude_hash_get(settings->hash, name);
+
+        return setting ? setting->value : NULL;
 }
 
 
@@ -0,0 +1,564 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <libprelude/prelude.h>
+#include <libprelude/prelude-hash.h>
+
+#include "glthread/lock.h"
+#include "preludedb-error.h"
+#include "preludedb-sql.h"
+
+
+/*
+ * Latencies are accounted in microseconds using a log-linear histogram:
+ * each power of two is split into HISTOGRAM_SUB_BUCKETS linear buckets,
+ * which bounds the relative error of reported percentiles to 12.5%.
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS 3
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS (40 * HISTOGRAM_SUB_BUCKETS)
+
+
+typedef struct preludedb_sql_stats preludedb_sql_stats_t;
+
+
+struct preludedb_sql_query_stats {
+        prelude_list_t list;
+        char *shape;
+
+        uint64_t count;
+        uint64_t errors;
+        uint64_t rows;
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+        double query_time;
+        double fetch_time;
+
+        uint32_t histogram[HISTOGRAM_BUCKETS];
+};
+
+
+struct preludedb_sql_stats {
+        prelude_hash_t *hash;
+        prelude_list_t query_list;
+        gl_lock_t mutex;
+
+        double escape_time;
+        double format_time;
+};
+
+
+
+int _preludedb_sql_stats_new(preludedb_sql_stats_t **stats);
+void _preludedb_sql_stats_destroy(preludedb_sql_stats_t *stats);
+void _preludedb_sql_stats_reset(preludedb_sql_stats_t *stats);
+preludedb_sql_query_stats_t *_preludedb_sql_stats_record_query(preludedb_sql_stats_t *stats, const char *query, double elapsed, int ret);
+void _preludedb_sql_stats_record_fetch(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *qstats,
+                                       uint64_t rows, uint64_t bytes, double elapsed);
+void _preludedb_sql_stats_record_escape(preludedb_sql_stats_t *stats, double elapsed);
+void _preludedb_sql_stats_record_format(preludedb_sql_stats_t *stats, double elapsed);
+preludedb_sql_query_stats_t *_preludedb_sql_stats_get_next(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *prev);
+double _preludedb_sql_stats_get_escape_time(preludedb_sql_stats_t *stats);
+double _preludedb_sql_stats_get_format_time(preludedb_sql_stats_t *stats);
+
+
+
+static unsigned int histogram_index(uint64_t usec)
+{
+        unsigned int msb = 0;
+        uint64_t tmp = usec;
+
+        if ( usec < HISTOGRAM_SUB_BUCKETS )
+                return usec;
+
+        while ( tmp >>= 1 )
+                msb++;
+
+        tmp = (msb - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS +
+              ((usec >> (msb - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1));
+
+        return (tmp < HISTOGRAM_BUCKETS) ? tmp : HISTOGRAM_BUCKETS - 1;
+}
+
+
+
+/*
+ * The wall clock might step back while a query is running, and a double
+ * too large for an uint64_t cannot be converted: clamp before converting.
+ */
+static uint64_t elapsed_to_usec(double elapsed)
+{
+        if ( ! (elapsed > 0) )
+                return 0;
+
+        if ( elapsed >= (double) UINT32_MAX )
+                return (uint64_t) UINT32_MAX * 1000000;
+
+        return elapsed * 1000000;
+}
+
+
+
+/*
+ * Return the upper bound, in microseconds, of the given bucket.
+ */
+static uint64_t histogram_value(unsigned int idx)
+{
+        unsigned int shift;
+
+        if ( idx < HISTOGRAM_SUB_BUCKETS )
+                return idx + 1;
+
+        shift = idx / HISTOGRAM_SUB_BUCKETS - 1;
+
+        return (uint64_t) (HISTOGRAM_SUB_BUCKETS + idx % HISTOGRAM_SUB_BUCKETS + 1) << shift;
+}
+
+
+
+static prelude_bool_t is_word_char(int c)
+{
+        return isalnum(c) || c == '_';
+}
+
+
+
+/*
+ * Strip literal values from the query, so that queries only differing by
+ * their arguments are accounted together: quoted strings and numbers are
+ * replaced by '?', consecutive literals in a list are folded, and blanks
+ * are collapsed.
+ */
+static int normalize_query(const char *query, prelude_string_t *out)
+{
+        int ret;
+        const char *ptr = query;
+        prelude_bool_t last_is_space = FALSE;
+        prelude_bool_t last_is_word = FALSE;
+        const char *tail;
+
+        while ( *ptr ) {
+                if ( *ptr == '\'' ) {
+                        for ( ptr++; *ptr; ptr++ ) {
+                                if ( *ptr == '\\' && ptr[1] )
+                                        ptr++;
+
+                                else if ( *ptr == '\'' ) {
+                                        if ( ptr[1] != '\'' )
+                                                break;
+                                        ptr++;
+                                }
+                        }
+
+                        if ( *ptr )
+                                ptr++;
+                }
+
+                else if ( isdigit((unsigned char) *ptr) && ! last_is_word ) {
+                        while ( isalnum((unsigned char) *ptr) || *ptr == '.' )
+                                ptr++;
+                }
+
+                else if ( isspace((unsigned char) *ptr) ) {
+                        while ( isspace((unsigned char) *ptr) )
+                                ptr++;
+
+                        if ( ! last_is_space && prelude_string_get_len(out) ) {
+                                ret = prelude_string_ncat(out, " ", 1);
+                                if ( ret < 0 )
+                                        return ret;
+                        }
+
+                        last_is_space = TRUE;
+                        continue;
+                }
+
+                else {
+                        last_is_word = is_word_char((unsigned char) *ptr);
+                        last_is_space = FALSE;
+
+                        ret = prelude_string_ncat(out, ptr, 1);
+                        if ( ret < 0 )
+                                return ret;
+
+                        ptr++;
+                        continue;
+                }
+
+                /*
+                 * A literal was skipped: fold it into the previous placeholder
+                 * if the output already ends with "?, " or "?,".
+                 */
+                last_is_word = FALSE;
+                last_is_space = FALSE;
+
+                tail = prelude_string_get_string(out);
+                if ( tail ) {
+                        size_t len = prelude_string_get_len(out);
+
+                        if ( len >= 3 && strcmp(tail + len - 3, "?, ") == 0 ) {
+                                prelude_string_truncate(out, len - 2);
+                                continue;
+                        }
+
+                        if ( len >= 2 && strcmp(tail + len - 2, "?,") == 0 ) {
+                                prelude_string_truncate(out, len - 1);
+                                continue;
+                        }
+                }
+
+                ret = prelude_string_ncat(out, "?", 1);
+                if ( ret < 0 )
+                        return ret;
+
+        }
+
+        return 0;
+}
+
+
+
+static void query_stats_destroy(void *data)
+{
+        preludedb_sql_query_stats_t *qstats = data;
+
+        free(qstats->shape);
+        free(qstats);
+}
+
+
+
+int _preludedb_sql_stats_new(preludedb_sql_stats_t **stats)
+{
+        int ret;
+
+        *stats = calloc(1, sizeof(**stats));
+        if ( ! *stats )
+                return preludedb_error_from_errno(errno);
+
+        ret = prelude_hash_new(&(*stats)->hash, NULL, NULL, NULL, query_stats_destroy);
+        if ( ret < 0 ) {
+                free(*stats);
+                return ret;
+        }
+
+        prelude_list_init(&(*stats)->query_list);
+        gl_lock_init((*stats)->mutex);
+
+        return 0;
+}
+
+
+
+void _preludedb_sql_stats_destroy(preludedb_sql_stats_t *stats)
+{
+        prelude_hash_destroy(stats->hash);
+        gl_lock_destroy(stats->mutex);
+        free(stats);
+}
+
+
+
+/*
+ * Entries are kept, so that tables still referencing them remain valid.
+ */
+void _preludedb_sql_stats_reset(preludedb_sql_stats_t *stats)
+{
+        prelude_list_t *tmp;
+        preludedb_sql_query_stats_t *qstats;
+
+        gl_lock_lock(stats->mutex);
+
+        prelude_list_for_each(&stats->query_list, tmp) {
+                qstats = prelude_list_entry(tmp, preludedb_sql_query_stats_t, list);
+
+                qstats->count = qstats->errors = qstats->rows = 0;
+                qstats->bytes_sent = qstats->bytes_received = 0;
+                qstats->query_time = qstats->fetch_time = 0;
+                memset(qstats->histogram, 0, sizeof(qstats->histogram));
+        }
+
+        stats->escape_time = stats->format_time = 0;
+
+        gl_lock_unlock(stats->mutex);
+}
+
+
+
+preludedb_sql_query_stats_t *_preludedb_sql_stats_record_query(preludedb_sql_stats_t *stats, const char *query, double elapsed, int ret)
+{
+        prelude_string_t *shape;
+        preludedb_sql_query_stats_t *qstats;
+
+        if ( prelude_string_new(&shape) < 0 )
+                return NULL;
+
+        if ( normalize_query(query, shape) < 0 ) {
+                prelude_string_destroy(shape);
+                return NULL;
+        }
+
+        gl_lock_lock(stats->mutex);
+
+        qstats = prelude_hash_get(stats->hash, prelude_string_get_string_or_default(shape, ""));
+        if ( ! qstats ) {
+                qstats = calloc(1, sizeof(*qstats));
+                if ( ! qstats )
+                        goto out;
+
+                if ( prelude_string_get_string_released(shape, &qstats->shape) < 0 || ! qstats->shape ) {
+                        free(qstats);
+                        qstats = NULL;
+                        goto out;
+                }
+
+                if ( prelude_hash_set(stats->hash, qstats->shape, qstats) < 0 ) {
+                        query_stats_destroy(qstats);
+                        qstats = NULL;
+                        goto out;
+                }
+
+                prelude_list_add_tail(&stats->query_list, &qstats->list);
+        }
+
+        qstats->count++;
+        qstats->query_time += (elapsed > 0) ? elapsed : 0;
+        qstats->bytes_sent += strlen(query);
+        qstats->histogram[histogram_index(elapsed_to_usec(elapsed))]++;
+
+        if ( ret < 0 )
+                qstats->errors++;
+
+ out:
+        gl_lock_unlock(stats->mutex);
+        prelude_string_destroy(shape);
+
+        return qstats;
+}
+
+
+
+void _preludedb_sql_stats_record_fetch(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *qstats,
+                                       uint64_t rows, uint64_t bytes, double elapsed)
+{
+        gl_lock_lock(stats->mutex);
+
+        qstats->rows += rows;
+        qstats->bytes_received += bytes;
+        qstats->fetch_time += elapsed;
+
+        gl_lock_unlock(stats->mutex);
+}
+
+
+
+void _preludedb_sql_stats_record_escape(preludedb_sql_stats_t *stats, double elapsed)
+{
+        gl_lock_lock(stats->mutex);
+        stats->escape_time += elapsed;
+        gl_lock_unlock(stats->mutex);
+}
+
+
+
+void _preludedb_sql_stats_record_format(preludedb_sql_stats_t *stats, double elapsed)
+{
+        gl_lock_lock(stats->mutex);
+        stats->format_time += elapsed;
+        gl_lock_unlock(stats->mutex);
+}
+
+
+
+double _preludedb_sql_stats_get_escape_time(preludedb_sql_stats_t *stats)
+{
+        return stats->escape_time;
+}
+
+
+
+double _preludedb_sql_stats_get_format_time(preludedb_sql_stats_t *stats)
+{
+        return stats->format_time;
+}
+
+
+
+preludedb_sql_query_stats_t *_preludedb_sql_stats_get_next(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *prev)
+{
+        prelude_list_t *tmp;
+
+        gl_lock_lock(stats->mutex);
+
+        tmp = (prev) ? prev->list.next : stats->query_list.next;
+        if ( tmp == &stats->query_list )
+                tmp = NULL;
+
+        gl_lock_unlock(stats->mutex);
+
+        return (tmp) ? prelude_list_entry(tmp, preludedb_sql_query_stats_t, list) : NULL;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_shape:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the normalized query, with literal values replaced by '?'.
+ */
+const char *preludedb_sql_query_stats_get_shape(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->shape;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_count:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the number of queries executed with this shape.
+ */
+uint64_t preludedb_sql_query_stats_get_count(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->count;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_error_count:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the number of queries with this shape that failed.
+ */
+uint64_t preludedb_sql_query_stats_get_error_count(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->errors;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_row_count:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Rows are accounted once the table they belong to is destroyed.
+ *
+ * Returns: the number of rows fetched from queries with this shape.
+ */
+uint64_t preludedb_sql_query_stats_get_row_count(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->rows;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_bytes_sent:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the total size of the queries sent to the server.
+ */
+uint64_t preludedb_sql_query_stats_get_bytes_sent(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->bytes_sent;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_bytes_received:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the total size of the fields fetched from the result rows.
+ */
+uint64_t preludedb_sql_query_stats_get_bytes_received(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->bytes_received;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_query_time:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the time, in seconds, spent executing queries of this shape.
+ */
+double preludedb_sql_query_stats_get_query_time(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->query_time;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_fetch_time:
+ * @stats: Pointer to a query statistics object.
+ *
+ * Returns: the time, in seconds, spent fetching rows from queries of this shape.
+ */
+double preludedb_sql_query_stats_get_fetch_time(const preludedb_sql_query_stats_t *stats)
+{
+        return stats->fetch_time;
+}
+
+
+
+/**
+ * preludedb_sql_query_stats_get_latency:
+ * @stats: Pointer to a query statistics object.
+ * @percentile: Percentile to compute, between 0 and 100.
+ *
+ * Returns: the query execution latency, in seconds, under which @percentile
+ * of the queries of this shape completed.
+ */
+double preludedb_sql_query_stats_get_latency(const preludedb_sql_query_stats_t *stats, double percentile)
+{
+        unsigned int i;
+        uint64_t total = 0, target;
+
+        if ( ! stats->count )
+                return 0;
+
+        target = (uint64_t) ((stats->count * percentile) / 100);
+        if ( target >= stats->count )
+                target = stats->count - 1;
+
+        for ( i = 0; i < HISTOGRAM_BUCKETS; i++ ) {
+                total += stats->histogram[i];
+                if ( total > target )
+                        break;
+        }
+
+        return (double) histogram_value((i < HISTOGRAM_BUCKETS) ? i : HISTOGRAM_BUCKETS - 1) / 1000000;
+}
@@ -29,11 +29,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string.h>
+#include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
-#include <fcntl.h>
 
 #if TIME_WITH_SYS_TIME
 # include <sys/time.h>
@@ -66,42 +66,172 @@
 # define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #endif
 
+#ifndef MIN
+# define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+
 #define SQL_NULL_FIELD (void *) 0xdeadbeef
 
+#define DEFAULT_MAX_SESSIONS 4
+
+/*
+ * Delays in milliseconds between connection attempts, which double after
+ * each failure.
+ */
+#define DEFAULT_RECONNECT_DELAY 100
+#define MAX_RECONNECT_DELAY     30000
+
+/*
+ * Weight of the latest query in the latency average of a read replica.
+ */
+#define REPLICA_LATENCY_WEIGHT 0.2
+
+#define ROUTE_TO_PRIMARY 2
+
+
+/*
+ * Transactions are bound to the thread that started them. Without POSIX
+ * threads, threads cannot be told apart: sessions are then not pooled,
+ * and a transaction holds the main session until it ends.
+ */
+#if USE_POSIX_THREADS
+# include <pthread.h>
+typedef pthread_t sql_thread_t;
+# define sql_thread_self() pthread_self()
+# define sql_thread_equal(t1, t2) pthread_equal(t1, t2)
+# define SQL_POOLED_SESSIONS 1
+#else
+typedef int sql_thread_t;
+# define sql_thread_self() 0
+# define sql_thread_equal(t1, t2) 1
+# define SQL_POOLED_SESSIONS 0
+#endif
+
 
 typedef enum {
-        PRELUDEDB_SQL_STATUS_CONNECTED    = 0x01,
-        PRELUDEDB_SQL_STATUS_TRANSACTION  = 0x02
+        PRELUDEDB_SQL_STATUS_CONNECTED    = 0x01
 } preludedb_sql_status_t;
 
 
+typedef struct preludedb_sql_stats preludedb_sql_stats_t;
+typedef struct preludedb_sql_log preludedb_sql_log_t;
+
+
+typedef struct {
+        prelude_list_t list;
+        void *data;
+        preludedb_sql_status_t status;
+        gl_recursive_lock_t mutex;
+
+        /*
+         * Connection settings, if they differ from those of the sql object.
+         */
+        preludedb_sql_settings_t *settings;
+
+        /*
+         * How the server the session is connected to expects literals
+         * to be escaped, set on connection.
+         */
+        preludedb_plugin_sql_escape_flags_t escape_flags;
+} preludedb_sql_session_t;
+
+
+typedef enum {
+        SQL_READ_POLICY_ROUND_ROBIN   = 0,
+        SQL_READ_POLICY_LEAST_LATENCY = 1
+} sql_read_policy_t;
+
+
+typedef struct {
+        preludedb_sql_session_t session;
+
+        /*
+         * Moving average of the time queries take on this replica.
+         */
+        double latency;
+
+        /*
+         * Connection failures in a row, and time before which the replica
+         * is not tried again after the last one.
+         */
+        unsigned int failures;
+        struct timeval retry_time;
+} sql_replica_t;
+
+
+typedef struct {
+        prelude_list_t list;
+        preludedb_sql_transaction_callback_t callback;
+        void *data;
+} transaction_callback_t;
 
-#define assert_connected(sql)                                             \
-        if ( ! (sql->status & PRELUDEDB_SQL_STATUS_CONNECTED) ) {         \
-                int __ret;                                                \
-                                                                          \
-                __ret = preludedb_sql_connect(sql);                       \
-                if ( __ret < 0 ) {                                        \
-                        gl_recursive_lock_unlock(sql->mutex);             \
-                        return __ret;                                     \
-                }                                                         \
-        }
+
+typedef struct {
+        prelude_list_t list;
+        const void *key;
+        void *data;
+        void (*destroy)(void *data);
+} sql_data_t;
+
+
+struct preludedb_sql_transaction {
+        prelude_list_t list;
+        preludedb_sql_t *sql;
+        preludedb_sql_session_t *session;
+        sql_thread_t thread;
+        prelude_bool_t external;
+        prelude_list_t callbacks;
+};
 
 
 struct preludedb_sql {
         char *type;
         preludedb_sql_settings_t *settings;
         preludedb_plugin_sql_t *plugin;
-        preludedb_sql_status_t status;
-        void *session;
-        FILE *logfile;
-        prelude_bool_t internal_transaction_disabled;
-        gl_recursive_lock_t mutex;
+        preludedb_sql_log_t *log;
         int refcount;
+
+        /*
+         * Queries run on the main session, unless the calling thread
+         * has a transaction open, in which case they run on the session
+         * the transaction is bound to. Transactions get a session of
+         * their own from the pool, up to max_sessions counting the main
+         * session.
+         */
+        preludedb_sql_session_t main_session;
+        gl_lock_t pool_lock;
+        prelude_list_t idle_sessions;
+        prelude_list_t transactions;
+        unsigned int session_count;
+        unsigned int max_sessions;
+
+        unsigned int reconnect_attempts;
+        unsigned int reconnect_delay;
+
+        /*
+         * Read-only queries issued outside of a transaction are spread
+         * over the read replicas, if any. Until read_your_writes
+         * milliseconds after the last write, they stay on the primary.
+         */
+        sql_replica_t *replicas;
+        unsigned int nreplicas;
+        unsigned int next_replica;
+        sql_read_policy_t read_policy;
+        unsigned int read_your_writes;
+        struct timeval last_write;
+
+        preludedb_sql_stats_t *stats;
+        prelude_bool_t stats_enabled;
+
+        /*
+         * Data attached by the format plugins, see preludedb_sql_set_data().
+         */
+        prelude_list_t data_list;
 };
 
 struct preludedb_sql_table {
         preludedb_sql_t *sql;
+        preludedb_sql_session_t *session;
         void *data;
 
         preludedb_sql_row_t **rows;
@@ -109,6 +239,10 @@ struct preludedb_sql_table {
         unsigned int row_count;
         unsigned int column_count;
 
+        preludedb_sql_query_stats_t *stats;
+        uint64_t bytes;
+        double fetch_time;
+
         uint16_t refcount;
         uint8_t done;
 };
@@ -134,8 +268,31 @@ struct preludedb_sql_row {
 int _preludedb_sql_transaction_start(preludedb_sql_t *sql);
 int _preludedb_sql_transaction_end(preludedb_sql_t *sql);
 int _preludedb_sql_transaction_abort(preludedb_sql_t *sql);
-void _preludedb_sql_enable_internal_transaction(preludedb_sql_t *sql);
-void _preludedb_sql_disable_internal_transaction(preludedb_sql_t *sql);
+
+int _preludedb_sql_stats_new(preludedb_sql_stats_t **stats);
+void _preludedb_sql_stats_destroy(preludedb_sql_stats_t *stats);
+void _preludedb_sql_stats_reset(preludedb_sql_stats_t *stats);
+preludedb_sql_query_stats_t *_preludedb_sql_stats_record_query(preludedb_sql_stats_t *stats, const char *query, double elapsed, int ret);
+void _preludedb_sql_stats_record_fetch(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *qstats,
+                                       uint64_t rows, uint64_t bytes, double elapsed);
+void _preludedb_sql_stats_record_escape(preludedb_sql_stats_t *stats, double elapsed);
+void _preludedb_sql_stats_record_format(preludedb_sql_stats_t *stats, double elapsed);
+
+size_t _preludedb_sql_escape_span(const char *input, size_t size, prelude_bool_t quote_only);
+size_t _preludedb_sql_escape_write(char *output, const char *input, size_t size);
+int _preludedb_sql_escape_append(prelude_string_t *output, const char *input, size_t size);
+int _preludedb_sql_hex_append(prelude_string_t *output, const unsigned char *input, size_t size);
+preludedb_sql_query_stats_t *_preludedb_sql_stats_get_next(preludedb_sql_stats_t *stats, preludedb_sql_query_stats_t *prev);
+double _preludedb_sql_stats_get_escape_time(preludedb_sql_stats_t *stats);
+double _preludedb_sql_stats_get_format_time(preludedb_sql_stats_t *stats);
+
+int _preludedb_sql_log_new(preludedb_sql_log_t **log, const char *filename, const preludedb_sql_settings_t *settings);
+void _preludedb_sql_log_destroy(preludedb_sql_log_t *log);
+void _preludedb_sql_log_query(preludedb_sql_log_t *log, const struct timeval *date, double elapsed, const char *query);
+
+int _preludedb_sql_settings_clone(const preludedb_sql_settings_t *settings, preludedb_sql_settings_t **dst);
+
+prelude_bool_t _preludedb_sql_is_read_only(const char *query);
 
 
 extern prelude_list_t _sql_plugin_list;
@@ -147,274 +304,1354 @@ static inline preludedb_sql_row_t *field2row(preludedb_sql_field_t *field)
 }
 
 
-static inline void update_sql_from_errno(preludedb_sql_t *sql, preludedb_error_t error)
+static inline double get_elapsed(const struct timeval *start)
+{
+        double elapsed;
+        struct timeval end;
+
+        gettimeofday(&end, NULL);
+
+        /*
+         * The wall clock might have been stepped back in the meantime.
+         */
+        elapsed = (end.tv_sec - start->tv_sec) + (double) (end.tv_usec - start->tv_usec) / 1000000;
+
+        return (elapsed > 0) ? elapsed : 0;
+}
+
+
+static inline void update_sql_from_errno(preludedb_sql_t *sql, preludedb_sql_session_t *session, preludedb_error_t error)
 {
         if ( preludedb_error_check(error, PRELUDEDB_ERROR_CONNECTION) ) {
-                _preludedb_plugin_sql_close(sql->plugin, sql->session);
-                sql->status &= ~PRELUDEDB_SQL_STATUS_CONNECTED;
+                _preludedb_plugin_sql_close(sql->plugin, session->data);
+                session->status &= ~PRELUDEDB_SQL_STATUS_CONNECTED;
         }
 }
 
 
 
-/**
- * preludedb_sql_new:
- * @new: Pointer to a sql object to initialize.
- * @type: Type of the database.
- * @settings: Settings for the choosen database.
- *
- * This function initialize the @new object, load and setup the plugin that
- * handle the database named @type with the configuration stored in @settings.
- *
- * Returns: 0 on success or a negative value if an error occur.
- */
-int preludedb_sql_new(preludedb_sql_t **new, const char *type, preludedb_sql_settings_t *settings)
+static int session_new(preludedb_sql_session_t **session)
 {
-        *new = calloc(1, sizeof(**new));
-        if ( ! *new )
+        *session = calloc(1, sizeof(**session));
+        if ( ! *session )
                 return preludedb_error_from_errno(errno);
 
-        (*new)->refcount = 1;
-        gl_recursive_lock_init(((*new)->mutex));
+        gl_recursive_lock_init((*session)->mutex);
 
-        if ( ! type ) {
-                type = preludedb_sql_settings_get_type(settings);
-                if ( ! type ) {
-                        free(*new);
-                        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "No database type specified");
-                }
-        }
+        return 0;
+}
 
-        (*new)->type = strdup(type);
-        if ( ! (*new)->type ) {
-                free(*new);
-                return preludedb_error_from_errno(errno);
-        }
 
-        (*new)->settings = settings;
 
-        (*new)->plugin = (preludedb_plugin_sql_t *) prelude_plugin_search_by_name(&_sql_plugin_list, type);
-        if ( ! (*new)->plugin ) {
-                free((*new)->type);
-                free(*new);
-                return preludedb_error_verbose(PRELUDEDB_ERROR_CANNOT_LOAD_SQL_PLUGIN, "Could not load sql plugin '%s'", type);
+static void session_close(preludedb_sql_t *sql, preludedb_sql_session_t *session)
+{
+        if ( session->status & PRELUDEDB_SQL_STATUS_CONNECTED )
+                _preludedb_plugin_sql_close(sql->plugin, session->data);
+
+        if ( session->settings )
+                preludedb_sql_settings_destroy(session->settings);
+
+        gl_recursive_lock_destroy(session->mutex);
+}
+
+
+
+static preludedb_sql_transaction_t *get_transaction(preludedb_sql_t *sql)
+{
+        prelude_list_t *tmp;
+        sql_thread_t self = sql_thread_self();
+        preludedb_sql_transaction_t *transaction, *found = NULL;
+
+        gl_lock_lock(sql->pool_lock);
+
+        prelude_list_for_each(&sql->transactions, tmp) {
+                transaction = prelude_list_entry(tmp, preludedb_sql_transaction_t, list);
+
+                if ( sql_thread_equal(transaction->thread, self) ) {
+                        found = transaction;
+                        break;
+                }
         }
 
-        if ( preludedb_sql_settings_get_log(settings) )
-                preludedb_sql_enable_query_logging(*new, preludedb_sql_settings_get_log(settings));
+        gl_lock_unlock(sql->pool_lock);
 
-        return 0;
+        return found;
 }
 
 
 
-preludedb_sql_t *preludedb_sql_ref(preludedb_sql_t *sql)
+static preludedb_sql_session_t *get_session(preludedb_sql_t *sql)
 {
-        sql->refcount++;
-        return sql;
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+
+        return transaction ? transaction->session : &sql->main_session;
 }
 
 
 
+static int preludedb_sql_connect(preludedb_sql_t *sql, preludedb_sql_session_t *session);
 
-/**
- * preludedb_sql_destroy:
- * @sql: Pointer to a sql object.
+
+/*
+ * Delay, in milliseconds, following connection failure number @attempt.
+ */
+static unsigned int reconnect_delay(preludedb_sql_t *sql, unsigned int attempt)
+{
+        unsigned int delay;
+
+        delay = MIN(sql->reconnect_delay, MAX_RECONNECT_DELAY);
+        while ( attempt-- && delay < MAX_RECONNECT_DELAY )
+                delay = MIN(delay * 2, MAX_RECONNECT_DELAY);
+
+        return delay;
+}
+
+
+
+/*
+ * Sleep before retrying after connection failure number @attempt, counted
+ * from 0. The delay doubles with each attempt, and is randomized so that
+ * clients losing the server at the same time do not all come back at once.
  *
- * Destroy @sql and the underlying plugin.
+ * Returns FALSE, without waiting, once reconnect_attempts is exhausted.
  */
-void preludedb_sql_destroy(preludedb_sql_t *sql)
+static prelude_bool_t reconnect_wait(preludedb_sql_t *sql, unsigned int attempt)
 {
-        if ( --sql->refcount > 0 )
-                return;
+        unsigned int delay, seed;
+        struct timeval now;
+        struct timespec ts;
 
-        if ( sql->status & PRELUDEDB_SQL_STATUS_CONNECTED )
-                _preludedb_plugin_sql_close(sql->plugin, sql->session);
+        if ( attempt >= sql->reconnect_attempts )
+                return FALSE;
 
-        if ( sql->logfile )
-                fclose(sql->logfile);
+        delay = reconnect_delay(sql, attempt);
 
-        gl_recursive_lock_destroy(sql->mutex);
-        preludedb_sql_settings_destroy(sql->settings);
+        gettimeofday(&now, NULL);
+        seed = now.tv_sec ^ now.tv_usec;
+        delay = delay / 2 + rand_r(&seed) % (delay / 2 + 1);
 
-        free(sql->type);
-        free(sql);
+        ts.tv_sec = delay / 1000;
+        ts.tv_nsec = (delay % 1000) * 1000000;
+        while ( nanosleep(&ts, &ts) < 0 && errno == EINTR );
+
+        return TRUE;
 }
 
 
 
-/**
- * preludedb_sql_enable_query_logging:
- * @sql: Pointer to a sql object.
- * @filename: Where the logs will be written.
- *
- * Log all queries in the specified file.
- *
- * Returns: 0 on success, or a negative value if an error occur.
+/*
+ * Lock the session queries from the calling thread run on, connecting
+ * it if needed. A failed connection is retried as allowed by the
+ * reconnect_attempts setting. This is the only place connection failures
+ * are waited out: callers retrying an operation rely on it.
  */
-int preludedb_sql_enable_query_logging(preludedb_sql_t *sql, const char *filename)
+static int session_lock_connected(preludedb_sql_t *sql, preludedb_sql_session_t *session)
 {
-        int fd, ret;
+        int ret;
+        unsigned int attempt = 0;
 
-        if ( ! filename ) {
-                sql->logfile = stdout;
-                return 0;
-        }
+        gl_recursive_lock_lock(session->mutex);
 
-        sql->logfile = fopen(filename, "a");
-        if ( ! sql->logfile )
-                return preludedb_error_verbose(prelude_error_code_from_errno(errno),
-                                               "Could not open '%s' for writing: %s", filename, strerror(errno));
+        if ( session->status & PRELUDEDB_SQL_STATUS_CONNECTED )
+                return 0;
 
-        fd = fileno(sql->logfile);
+        while ( (ret = preludedb_sql_connect(sql, session)) < 0 ) {
+                if ( ! preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION) || ! reconnect_wait(sql, attempt++) )
+                        break;
+        }
 
-        ret = fcntl(fd, F_GETFD);
         if ( ret < 0 )
-                return 0;
+                gl_recursive_lock_unlock(session->mutex);
 
-        fcntl(fd, F_SETFD, ret | FD_CLOEXEC);
-
-        return 0;
+        return ret;
 }
 
 
 
-/**
- * preludedb_sql_disable_query_logging:
- * @sql: Pointer to a sql object.
- *
- * Disable query logging.
- */
-void preludedb_sql_disable_query_logging(preludedb_sql_t *sql)
+static int session_lock(preludedb_sql_t *sql, preludedb_sql_session_t **session)
 {
-        if ( sql->logfile && sql->logfile != stdout )
-                fclose(sql->logfile);
+        *session = get_session(sql);
 
-        sql->logfile = NULL;
+        return session_lock_connected(sql, *session);
 }
 
 
 
-static int preludedb_sql_connect(preludedb_sql_t *sql)
+/*
+ * Escape flags of the session queries from the calling thread run on,
+ * which is only locked if it has to be connected first.
+ */
+static int get_escape_flags(preludedb_sql_t *sql, preludedb_plugin_sql_escape_flags_t *flags)
 {
         int ret;
+        preludedb_sql_session_t *session = get_session(sql);
 
-        ret = _preludedb_plugin_sql_open(sql->plugin, sql->settings, &sql->session);
-        if ( ret < 0 )
-                return ret;
+        if ( ! (session->status & PRELUDEDB_SQL_STATUS_CONNECTED) ) {
+                ret = session_lock_connected(sql, session);
+                if ( ret < 0 )
+                        return ret;
+
+                gl_recursive_lock_unlock(session->mutex);
+        }
 
-        sql->status = PRELUDEDB_SQL_STATUS_CONNECTED;
+        *flags = session->escape_flags;
 
         return 0;
 }
 
 
 
-int preludedb_sql_table_new(preludedb_sql_table_t **new, void *data)
+/*
+ * Take a session for a new transaction: an idle pooled session, a new one
+ * if the pool is not full, or the main session otherwise.
+ */
+static int pool_get_session(preludedb_sql_t *sql, preludedb_sql_session_t **session)
 {
-        *new = malloc(sizeof(**new));
-        if ( ! *new )
-                return preludedb_error_from_errno(errno);
+        int ret = 0;
 
-        (*new)->rows = NULL;
-        (*new)->nrow = 0;
-        (*new)->row_count = 0;
-        (*new)->column_count = 0;
-        (*new)->done = FALSE;
-        (*new)->refcount = 1;
-        (*new)->data = data;
+        gl_lock_lock(sql->pool_lock);
 
-        return 0;
-}
+        if ( ! prelude_list_is_empty(&sql->idle_sessions) ) {
+                *session = prelude_list_entry(sql->idle_sessions.next, preludedb_sql_session_t, list);
+                prelude_list_del(&(*session)->list);
+        }
 
+        else if ( SQL_POOLED_SESSIONS && sql->session_count + 1 < sql->max_sessions ) {
+                ret = session_new(session);
+                if ( ret == 0 )
+                        sql->session_count++;
+        }
 
+        else *session = &sql->main_session;
 
-void *preludedb_sql_table_get_data(preludedb_sql_table_t *table)
-{
-        return table->data;
+        gl_lock_unlock(sql->pool_lock);
+
+        return ret;
 }
 
 
 
-/**
- * preludedb_sql_query:
- * @sql: Pointer to a sql object.
- * @query: The SQL query to execute.
- * @table: Pointer to a table where the query result will be stored if the type of query return
- * results (i.e a SELECT can results, but an INSERT never results) and if the query is sucessfull.
- *
- * Execute a SQL query.
- *
- * Returns: 1 if result are available, 0 for no result, -1 if an error occured.
- */
-int preludedb_sql_query(preludedb_sql_t *sql, const char *query, preludedb_sql_table_t **table)
+static void pool_put_session(preludedb_sql_t *sql, preludedb_sql_session_t *session)
 {
-        int ret;
-        struct timeval start, end;
-
-        gl_recursive_lock_lock(sql->mutex);
-        assert_connected(sql);
-
-        gettimeofday(&start, NULL);
+        if ( session == &sql->main_session )
+                return;
 
-        ret = _preludedb_plugin_sql_query(sql->plugin, sql->session, query, table);
-        if ( ret < 0 )
-                update_sql_from_errno(sql, ret);
+        gl_lock_lock(sql->pool_lock);
+        prelude_list_add(&sql->idle_sessions, &session->list);
+        gl_lock_unlock(sql->pool_lock);
+}
 
-        gettimeofday(&end, NULL);
-        gl_recursive_lock_unlock(sql->mutex);
 
-        if ( sql->logfile ) {
-                fprintf(sql->logfile, "%fs %s\n",
-                        (end.tv_sec + (double) end.tv_usec / 1000000) -
-                        (start.tv_sec + (double) start.tv_usec / 1000000), query);
 
-                fflush(sql->logfile);
-        }
+static void replicas_destroy(preludedb_sql_t *sql)
+{
+        unsigned int i;
 
-        if ( ret <= 0 )
-                return ret;
+        for ( i = 0; i < sql->nreplicas; i++ )
+                session_close(sql, &sql->replicas[i].session);
 
-        (*table)->sql = preludedb_sql_ref(sql);
-        return 1;
+        free(sql->replicas);
 }
 
 
 
-/**
- * preludedb_sql_query_sprintf:
- * @sql: Pointer to a sql object.
- * @table: Pointer to a table where the query result will be stored if the type of query return
- * results (i.e a SELECT can results, but an INSERT never results) and if the query is sucessfull.
- * @format: The SQL query to execute in a printf format string.
- * @...: Arguments referenced in @format.
- *
- * Execute a SQL query.
- *
- * Returns: 1 if the query returns results, 0 if it does not, or negative value if an error occur.
+/*
+ * Settings of the replica given as "host[:port]" in @str: a copy of the
+ * primary's settings, with the host and port overridden.
  */
-int preludedb_sql_query_sprintf(preludedb_sql_t *sql, preludedb_sql_table_t **table,
-                                const char *format, ...)
+static int replica_settings_new(preludedb_sql_settings_t **settings, const preludedb_sql_settings_t *primary,
+                                const char *str, size_t len)
 {
         int ret;
-        va_list ap;
-        prelude_string_t *query;
+        char *host, *port;
 
-        ret = prelude_string_new(&query);
-        if ( ret < 0 )
+        host = strndup(str, len);
+        if ( ! host )
+                return preludedb_error_from_errno(errno);
+
+        port = strrchr(host, ':');
+        if ( port )
+                *port++ = 0;
+
+        ret = _preludedb_sql_settings_clone(primary, settings);
+        if ( ret < 0 ) {
+                free(host);
                 return ret;
+        }
 
-        va_start(ap, format);
-        ret = prelude_string_vprintf(query, format, ap);
-        va_end(ap);
+        ret = preludedb_sql_settings_set_host(*settings, host);
+        if ( ret >= 0 && port )
+                ret = preludedb_sql_settings_set_port(*settings, port);
+
+        free(host);
 
         if ( ret < 0 )
-                goto error;
+                preludedb_sql_settings_destroy(*settings);
+
+        return ret;
+}
+
+
+
+/*
+ * Parse the read_replicas setting, a comma separated list of
+ * "host[:port]", along with the settings controlling how reads are
+ * routed to them.
+ */
+static int replicas_new(preludedb_sql_t *sql, const preludedb_sql_settings_t *settings)
+{
+        int ret;
+        size_t len;
+        const char *str, *policy, *rw;
+        unsigned int count = 1;
+
+        str = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_READ_REPLICAS);
+        if ( ! str || ! *str )
+                return 0;
+
+        policy = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_READ_POLICY);
+        if ( ! policy || strcmp(policy, "round-robin") == 0 )
+                sql->read_policy = SQL_READ_POLICY_ROUND_ROBIN;
+
+        else if ( strcmp(policy, "least-latency") == 0 )
+                sql->read_policy = SQL_READ_POLICY_LEAST_LATENCY;
+
+        else
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "invalid value '%s' for setting '%s'",
+                                               policy, PRELUDEDB_SQL_SETTING_READ_POLICY);
+
+        rw = preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_READ_YOUR_WRITES);
+        if ( rw )
+                sql->read_your_writes = strtoul(rw, NULL, 10);
+
+        for ( rw = str; (rw = strchr(rw, ',')); rw++ )
+                count++;
+
+        sql->replicas = calloc(count, sizeof(*sql->replicas));
+        if ( ! sql->replicas )
+                return preludedb_error_from_errno(errno);
+
+        while ( *str ) {
+                len = strcspn(str, ",");
+
+                if ( len > 0 ) {
+                        ret = replica_settings_new(&sql->replicas[sql->nreplicas].session.settings, settings, str, len);
+                        if ( ret < 0 ) {
+                                replicas_destroy(sql);
+                                return ret;
+                        }
+
+                        gl_recursive_lock_init(sql->replicas[sql->nreplicas].session.mutex);
+                        sql->nreplicas++;
+                }
+
+                str += len;
+                if ( *str == ',' )
+                        str++;
+        }
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_sql_new:
+ * @new: Pointer to a sql object to initialize.
+ * @type: Type of the database.
+ * @settings: Settings for the choosen database.
+ *
+ * This function initialize the @new object, load and setup the plugin that
+ * handle the database named @type with the configuration stored in @settings.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_new(preludedb_sql_t **new, const char *type, preludedb_sql_settings_t *settings)
+{
+        int ret;
+        unsigned int max;
+
+        *new = calloc(1, sizeof(**new));
+        if ( ! *new )
+                return preludedb_error_from_errno(errno);
+
+        (*new)->refcount = 1;
+
+        if ( ! type ) {
+                type = preludedb_sql_settings_get_type(settings);
+                if ( ! type ) {
+                        free(*new);
+                        return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING, "No database type specified");
+                }
+        }
+
+        (*new)->type = strdup(type);
+        if ( ! (*new)->type ) {
+                free(*new);
+                return preludedb_error_from_errno(errno);
+        }
+
+        (*new)->settings = settings;
+
+        (*new)->plugin = (preludedb_plugin_sql_t *) prelude_plugin_search_by_name(&_sql_plugin_list, type);
+        if ( ! (*new)->plugin ) {
+                free((*new)->type);
+                free(*new);
+                return preludedb_error_verbose(PRELUDEDB_ERROR_CANNOT_LOAD_SQL_PLUGIN, "Could not load sql plugin '%s'", type);
+        }
+
+        (*new)->max_sessions = DEFAULT_MAX_SESSIONS;
+        if ( preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_MAX_SESSIONS) )
+                (*new)->max_sessions = strtoul(preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_MAX_SESSIONS), NULL, 10);
+
+        /*
+         * The setting cannot raise the limit of the plugin.
+         */
+        max = _preludedb_plugin_sql_get_max_sessions((*new)->plugin);
+        if ( max && (*new)->max_sessions > max )
+                (*new)->max_sessions = max;
+
+        if ( preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_RECONNECT_ATTEMPTS) )
+                (*new)->reconnect_attempts = strtoul(preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_RECONNECT_ATTEMPTS), NULL, 10);
+
+        (*new)->reconnect_delay = DEFAULT_RECONNECT_DELAY;
+        if ( preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_RECONNECT_DELAY) )
+                (*new)->reconnect_delay = strtoul(preludedb_sql_settings_get(settings, PRELUDEDB_SQL_SETTING_RECONNECT_DELAY), NULL, 10);
+
+        ret = replicas_new(*new, settings);
+        if ( ret < 0 ) {
+                free((*new)->type);
+                free(*new);
+                return ret;
+        }
+
+        /*
+         * The main session counts toward the limit.
+         */
+        (*new)->session_count = 1;
+        gl_recursive_lock_init((*new)->main_session.mutex);
+        gl_lock_init((*new)->pool_lock);
+        prelude_list_init(&(*new)->idle_sessions);
+        prelude_list_init(&(*new)->transactions);
+        prelude_list_init(&(*new)->data_list);
+
+        if ( preludedb_sql_settings_get_log(settings) )
+                preludedb_sql_enable_query_logging(*new, preludedb_sql_settings_get_log(settings));
+
+        return 0;
+}
+
+
+
+preludedb_sql_t *preludedb_sql_ref(preludedb_sql_t *sql)
+{
+        sql->refcount++;
+        return sql;
+}
+
+
+
+
+static void sql_data_destroy(sql_data_t *entry)
+{
+        prelude_list_del(&entry->list);
+
+        if ( entry->destroy )
+                entry->destroy(entry->data);
+
+        free(entry);
+}
+
+
+
+/**
+ * preludedb_sql_destroy:
+ * @sql: Pointer to a sql object.
+ *
+ * Destroy @sql and the underlying plugin.
+ */
+void preludedb_sql_destroy(preludedb_sql_t *sql)
+{
+        prelude_list_t *tmp, *bkp;
+        preludedb_sql_session_t *session;
+
+        if ( --sql->refcount > 0 )
+                return;
+
+        prelude_list_for_each_safe(&sql->idle_sessions, tmp, bkp) {
+                session = prelude_list_entry(tmp, preludedb_sql_session_t, list);
+                prelude_list_del(&session->list);
+                session_close(sql, session);
+                free(session);
+        }
+
+        session_close(sql, &sql->main_session);
+        replicas_destroy(sql);
+        gl_lock_destroy(sql->pool_lock);
+
+        prelude_list_for_each_safe(&sql->data_list, tmp, bkp)
+                sql_data_destroy(prelude_list_entry(tmp, sql_data_t, list));
+
+        if ( sql->log )
+                _preludedb_sql_log_destroy(sql->log);
+
+        if ( sql->stats )
+                _preludedb_sql_stats_destroy(sql->stats);
+
+        preludedb_sql_settings_destroy(sql->settings);
+
+        free(sql->type);
+        free(sql);
+}
+
+
+
+/**
+ * preludedb_sql_enable_query_logging:
+ * @sql: Pointer to a sql object.
+ * @filename: Where the logs will be written.
+ *
+ * Log all queries in the specified file, or on stdout if @filename is NULL.
+ *
+ * Queries are handed to a background writer thread, and are dropped rather
+ * than delaying the caller if the writer falls behind. The following @sql
+ * settings control what gets logged and how:
+ * %PRELUDEDB_SQL_SETTING_LOG_SAMPLE to only log one query out of N,
+ * %PRELUDEDB_SQL_SETTING_LOG_THRESHOLD to only log queries slower than the given
+ * number of seconds, %PRELUDEDB_SQL_SETTING_LOG_MAX_SIZE and
+ * %PRELUDEDB_SQL_SETTING_LOG_MAX_FILES to rotate the log once it reaches the given
+ * size in bytes, and %PRELUDEDB_SQL_SETTING_LOG_FORMAT to choose between the "text"
+ * and "binary" formats.
+ *
+ * Returns: 0 on success, or a negative value if an error occur.
+ */
+int preludedb_sql_enable_query_logging(preludedb_sql_t *sql, const char *filename)
+{
+        int ret;
+        preludedb_sql_log_t *log;
+
+        ret = _preludedb_sql_log_new(&log, filename, sql->settings);
+        if ( ret < 0 )
+                return ret;
+
+        preludedb_sql_disable_query_logging(sql);
+        sql->log = log;
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_sql_disable_query_logging:
+ * @sql: Pointer to a sql object.
+ *
+ * Disable query logging.
+ */
+void preludedb_sql_disable_query_logging(preludedb_sql_t *sql)
+{
+        if ( sql->log )
+                _preludedb_sql_log_destroy(sql->log);
+
+        sql->log = NULL;
+}
+
+
+
+/**
+ * preludedb_sql_enable_statistics:
+ * @sql: Pointer to a sql object.
+ *
+ * Start accounting, for each query shape (the query with its literal values
+ * stripped), the number of executions, the latency distribution, the number
+ * of rows and bytes transferred, as well as the time spent escaping values
+ * and formatting queries on the client side.
+ *
+ * Returns: 0 on success, or a negative value if an error occur.
+ */
+int preludedb_sql_enable_statistics(preludedb_sql_t *sql)
+{
+        int ret;
+
+        prelude_return_val_if_fail(sql, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! sql->stats ) {
+                ret = _preludedb_sql_stats_new(&sql->stats);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        sql->stats_enabled = TRUE;
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_sql_disable_statistics:
+ * @sql: Pointer to a sql object.
+ *
+ * Stop accounting query statistics. Statistics gathered so far remain
+ * available until @sql is destroyed.
+ */
+void preludedb_sql_disable_statistics(preludedb_sql_t *sql)
+{
+        prelude_return_if_fail(sql);
+        sql->stats_enabled = FALSE;
+}
+
+
+
+/**
+ * preludedb_sql_reset_statistics:
+ * @sql: Pointer to a sql object.
+ *
+ * Reset all the query statistics gathered so far.
+ */
+void preludedb_sql_reset_statistics(preludedb_sql_t *sql)
+{
+        prelude_return_if_fail(sql);
+
+        if ( sql->stats )
+                _preludedb_sql_stats_reset(sql->stats);
+}
+
+
+
+/**
+ * preludedb_sql_get_next_query_stats:
+ * @sql: Pointer to a sql object.
+ * @prev: Pointer to the previous query statistics, or NULL to get the first one.
+ *
+ * Iterate over the statistics of each query shape seen since statistics were enabled.
+ *
+ * Returns: the next query statistics object, or NULL if there is none.
+ */
+preludedb_sql_query_stats_t *preludedb_sql_get_next_query_stats(preludedb_sql_t *sql, preludedb_sql_query_stats_t *prev)
+{
+        prelude_return_val_if_fail(sql, NULL);
+
+        if ( ! sql->stats )
+                return NULL;
+
+        return _preludedb_sql_stats_get_next(sql->stats, prev);
+}
+
+
+
+/**
+ * preludedb_sql_get_escape_time:
+ * @sql: Pointer to a sql object.
+ *
+ * Returns: the time, in seconds, spent escaping values since statistics were enabled.
+ */
+double preludedb_sql_get_escape_time(preludedb_sql_t *sql)
+{
+        prelude_return_val_if_fail(sql, 0);
+        return (sql->stats) ? _preludedb_sql_stats_get_escape_time(sql->stats) : 0;
+}
+
+
+
+/**
+ * preludedb_sql_get_format_time:
+ * @sql: Pointer to a sql object.
+ *
+ * Returns: the time, in seconds, spent formatting queries since statistics were enabled.
+ */
+double preludedb_sql_get_format_time(preludedb_sql_t *sql)
+{
+        prelude_return_val_if_fail(sql, 0);
+        return (sql->stats) ? _preludedb_sql_stats_get_format_time(sql->stats) : 0;
+}
+
+
+
+/**
+ * preludedb_sql_get_statistics_string:
+ * @sql: Pointer to a sql object.
+ * @output: Pointer to a #prelude_string_t where the statistics will be written.
+ *
+ * Write a human readable report of the query statistics to @output, one
+ * line per query shape.
+ *
+ * Returns: 0 on success, or a negative value if an error occur.
+ */
+int preludedb_sql_get_statistics_string(preludedb_sql_t *sql, prelude_string_t *output)
+{
+        int ret;
+        preludedb_sql_query_stats_t *qstats = NULL;
+
+        prelude_return_val_if_fail(sql, prelude_error(PRELUDE_ERROR_ASSERTION));
+        prelude_return_val_if_fail(output, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        ret = prelude_string_sprintf(output, "escape=%fs format=%fs\n",
+                                     preludedb_sql_get_escape_time(sql), preludedb_sql_get_format_time(sql));
+        if ( ret < 0 )
+                return ret;
+
+        while ( (qstats = preludedb_sql_get_next_query_stats(sql, qstats)) ) {
+                ret = prelude_string_sprintf(output, "count=%" PRELUDE_PRIu64 " errors=%" PRELUDE_PRIu64
+                                             " rows=%" PRELUDE_PRIu64 " sent=%" PRELUDE_PRIu64 " received=%" PRELUDE_PRIu64
+                                             " query=%fs fetch=%fs p50=%fs p95=%fs p99=%fs %s\n",
+                                             preludedb_sql_query_stats_get_count(qstats),
+                                             preludedb_sql_query_stats_get_error_count(qstats),
+                                             preludedb_sql_query_stats_get_row_count(qstats),
+                                             preludedb_sql_query_stats_get_bytes_sent(qstats),
+                                             preludedb_sql_query_stats_get_bytes_received(qstats),
+                                             preludedb_sql_query_stats_get_query_time(qstats),
+                                             preludedb_sql_query_stats_get_fetch_time(qstats),
+                                             preludedb_sql_query_stats_get_latency(qstats, 50),
+                                             preludedb_sql_query_stats_get_latency(qstats, 95),
+                                             preludedb_sql_query_stats_get_latency(qstats, 99),
+                                             preludedb_sql_query_stats_get_shape(qstats));
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return 0;
+}
+
+
+
+static int preludedb_sql_connect(preludedb_sql_t *sql, preludedb_sql_session_t *session)
+{
+        int ret;
+
+        ret = _preludedb_plugin_sql_open(sql->plugin, session->settings ? session->settings : sql->settings, &session->data);
+        if ( ret < 0 )
+                return ret;
+
+        session->escape_flags = _preludedb_plugin_sql_get_session_escape_flags(sql->plugin, session->data);
+        session->status = PRELUDEDB_SQL_STATUS_CONNECTED;
+
+        return 0;
+}
+
+
+
+int preludedb_sql_table_new(preludedb_sql_table_t **new, void *data)
+{
+        *new = malloc(sizeof(**new));
+        if ( ! *new )
+                return preludedb_error_from_errno(errno);
+
+        (*new)->rows = NULL;
+        (*new)->nrow = 0;
+        (*new)->row_count = 0;
+        (*new)->column_count = 0;
+        (*new)->stats = NULL;
+        (*new)->bytes = 0;
+        (*new)->fetch_time = 0;
+        (*new)->done = FALSE;
+        (*new)->refcount = 1;
+        (*new)->data = data;
+
+        return 0;
+}
+
+
+
+void *preludedb_sql_table_get_data(preludedb_sql_table_t *table)
+{
+        return table->data;
+}
+
+
+
+static int session_query(preludedb_sql_t *sql, preludedb_sql_session_t *session, const char *query, preludedb_sql_table_t **table)
+{
+        int ret;
+        double elapsed;
+        struct timeval start;
+        preludedb_sql_query_stats_t *qstats = NULL;
+
+        ret = session_lock_connected(sql, session);
+        if ( ret < 0 )
+                return ret;
+
+        gettimeofday(&start, NULL);
+
+        ret = _preludedb_plugin_sql_query(sql->plugin, session->data, query, table);
+        if ( ret < 0 )
+                update_sql_from_errno(sql, session, ret);
+
+        elapsed = get_elapsed(&start);
+        gl_recursive_lock_unlock(session->mutex);
+
+        if ( sql->log )
+                _preludedb_sql_log_query(sql->log, &start, elapsed, query);
+
+        if ( sql->stats_enabled )
+                qstats = _preludedb_sql_stats_record_query(sql->stats, query, elapsed, ret);
+
+        if ( ret <= 0 )
+                return ret;
+
+        (*table)->sql = preludedb_sql_ref(sql);
+        (*table)->session = session;
+        (*table)->stats = qstats;
+
+        return 1;
+}
+
+
+
+static prelude_bool_t replica_is_available(const sql_replica_t *replica, const struct timeval *now)
+{
+        if ( ! replica->failures )
+                return TRUE;
+
+        if ( now->tv_sec != replica->retry_time.tv_sec )
+                return now->tv_sec > replica->retry_time.tv_sec;
+
+        return now->tv_usec >= replica->retry_time.tv_usec;
+}
+
+
+
+/*
+ * Pick a replica according to the read policy, leaving out those that
+ * failed to connect until their retry time is reached.
+ *
+ * Returns NULL if no replica is available.
+ */
+static sql_replica_t *replica_pick(preludedb_sql_t *sql, const struct timeval *now)
+{
+        unsigned int i;
+        sql_replica_t *replica = NULL, *cur;
+
+        gl_lock_lock(sql->pool_lock);
+
+        for ( i = 0; i < sql->nreplicas; i++ ) {
+                if ( sql->read_policy == SQL_READ_POLICY_ROUND_ROBIN ) {
+                        cur = &sql->replicas[sql->next_replica++ % sql->nreplicas];
+                        if ( replica_is_available(cur, now) ) {
+                                replica = cur;
+                                break;
+                        }
+                }
+
+                else {
+                        cur = &sql->replicas[i];
+                        if ( replica_is_available(cur, now) && (! replica || cur->latency < replica->latency) )
+                                replica = cur;
+                }
+        }
+
+        gl_lock_unlock(sql->pool_lock);
+
+        return replica;
+}
+
+
+
+/*
+ * Record the outcome of a query that took @elapsed seconds on @replica.
+ */
+static void replica_update(preludedb_sql_t *sql, sql_replica_t *replica, const struct timeval *now, double elapsed, int ret)
+{
+        unsigned int delay;
+
+        gl_lock_lock(sql->pool_lock);
+
+        if ( ret < 0 && preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION) ) {
+                delay = reconnect_delay(sql, replica->failures++);
+
+                replica->retry_time.tv_sec = now->tv_sec + delay / 1000;
+                replica->retry_time.tv_usec = now->tv_usec + (delay % 1000) * 1000;
+                if ( replica->retry_time.tv_usec >= 1000000 ) {
+                        replica->retry_time.tv_sec++;
+                        replica->retry_time.tv_usec -= 1000000;
+                }
+        }
+
+        else {
+                replica->failures = 0;
+                replica->latency = replica->latency ? (1 - REPLICA_LATENCY_WEIGHT) * replica->latency + REPLICA_LATENCY_WEIGHT * elapsed : elapsed;
+        }
+
+        gl_lock_unlock(sql->pool_lock);
+}
+
+
+
+/*
+ * Record that a write was just made on the primary, whether within a
+ * transaction or not: the COMMIT of a transaction counts as one.
+ */
+static void mark_write(preludedb_sql_t *sql)
+{
+        struct timeval now;
+
+        gettimeofday(&now, NULL);
+
+        gl_lock_lock(sql->pool_lock);
+        sql->last_write = now;
+        gl_lock_unlock(sql->pool_lock);
+}
+
+
+
+/*
+ * Run the read-only @query on a read replica if no write was made during
+ * the last read_your_writes milliseconds. A replica that cannot be
+ * reached leaves the query to the primary, and is not tried again before
+ * its reconnection delay expires.
+ *
+ * Returns ROUTE_TO_PRIMARY if @query is to run on the primary.
+ */
+static int route_query(preludedb_sql_t *sql, const char *query, preludedb_sql_table_t **table)
+{
+        int ret;
+        double elapsed;
+        struct timeval now;
+        sql_replica_t *replica;
+
+        gettimeofday(&now, NULL);
+
+        if ( sql->read_your_writes ) {
+                gl_lock_lock(sql->pool_lock);
+                elapsed = (now.tv_sec - sql->last_write.tv_sec) + (double) (now.tv_usec - sql->last_write.tv_usec) / 1000000;
+                gl_lock_unlock(sql->pool_lock);
+
+                if ( elapsed * 1000 < sql->read_your_writes )
+                        return ROUTE_TO_PRIMARY;
+        }
+
+        replica = replica_pick(sql, &now);
+        if ( ! replica )
+                return ROUTE_TO_PRIMARY;
+
+        ret = session_query(sql, &replica->session, query, table);
+        replica_update(sql, replica, &now, get_elapsed(&now), ret);
+
+        if ( ret < 0 && preludedb_error_check(ret, PRELUDEDB_ERROR_CONNECTION) )
+                return ROUTE_TO_PRIMARY;
+
+        return ret;
+}
+
+
+
+/**
+ * preludedb_sql_query:
+ * @sql: Pointer to a sql object.
+ * @query: The SQL query to execute.
+ * @table: Pointer to a table where the query result will be stored if the type of query return
+ * results (i.e a SELECT can results, but an INSERT never results) and if the query is sucessfull.
+ *
+ * Execute a SQL query.
+ *
+ * If read replicas are configured, a SELECT issued outside of a transaction
+ * may be run on one of them rather than on the primary, unless it locks rows,
+ * has an INTO clause or calls a function with side effects.
+ *
+ * Returns: 1 if result are available, 0 for no result, -1 if an error occured.
+ */
+int preludedb_sql_query(preludedb_sql_t *sql, const char *query, preludedb_sql_table_t **table)
+{
+        int ret;
+        prelude_bool_t read_only;
+
+        if ( ! sql->nreplicas )
+                return session_query(sql, get_session(sql), query, table);
+
+        /*
+         * Within a transaction, every query has to see the transaction's writes.
+         */
+        read_only = _preludedb_sql_is_read_only(query);
+        if ( read_only && ! get_transaction(sql) ) {
+                ret = route_query(sql, query, table);
+                if ( ret != ROUTE_TO_PRIMARY )
+                        return ret;
+        }
+
+        ret = session_query(sql, get_session(sql), query, table);
+
+        /*
+         * Marked once the write is done, so that reads wait for it to be
+         * visible on the replicas rather than for it to start.
+         */
+        if ( ! read_only )
+                mark_write(sql);
+
+        return ret;
+}
+
+
+
+/**
+ * preludedb_sql_query_sprintf:
+ * @sql: Pointer to a sql object.
+ * @table: Pointer to a table where the query result will be stored if the type of query return
+ * results (i.e a SELECT can results, but an INSERT never results) and if the query is sucessfull.
+ * @format: The SQL query to execute in a printf format string.
+ * @...: Arguments referenced in @format.
+ *
+ * Execute a SQL query.
+ *
+ * Returns: 1 if the query returns results, 0 if it does not, or negative value if an error occur.
+ */
+int preludedb_sql_query_sprintf(preludedb_sql_t *sql, preludedb_sql_table_t **table,
+                                const char *format, ...)
+{
+        int ret;
+        va_list ap;
+        struct timeval start;
+        prelude_string_t *query;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        if ( sql->stats_enabled )
+                gettimeofday(&start, NULL);
+
+        va_start(ap, format);
+        ret = prelude_string_vprintf(query, format, ap);
+        va_end(ap);
+
+        if ( ret < 0 )
+                goto error;
+
+        if ( sql->stats_enabled )
+                _preludedb_sql_stats_record_format(sql->stats, get_elapsed(&start));
 
         ret = preludedb_sql_query(sql, prelude_string_get_string(query), table);
 
- error:
+ error:
+        prelude_string_destroy(query);
+
+        return ret;
+}
+
+
+
+#if SQL_POOLED_SESSIONS
+
+typedef struct {
+        preludedb_sql_t *sql;
+        const char * const *queries;
+        preludedb_sql_table_t **tables;
+        unsigned int count;
+
+        gl_lock_t mutex;
+        unsigned int next;
+        int error;
+        char *errmsg;
+} parallel_query_t;
+
+
+
+/*
+ * Rows are fetched by the worker, so that the result no longer depends
+ * on the session once it goes back to the pool.
+ */
+static int parallel_query_run(parallel_query_t *pq, preludedb_sql_session_t *session, unsigned int i)
+{
+        int ret;
+        preludedb_sql_row_t *row;
+
+        ret = session_query(pq->sql, session, pq->queries[i], &pq->tables[i]);
+        if ( ret <= 0 ) {
+                pq->tables[i] = NULL;
+                return ret;
+        }
+
+        while ( (ret = preludedb_sql_table_fetch_row(pq->tables[i], &row)) > 0 );
+
+        return ret;
+}
+
+
+
+static void *parallel_query_thread(void *data)
+{
+        int ret;
+        unsigned int i;
+        parallel_query_t *pq = data;
+        preludedb_sql_session_t *session = NULL;
+
+        ret = pool_get_session(pq->sql, &session);
+
+        while ( 1 ) {
+                gl_lock_lock(pq->mutex);
+
+                if ( ret < 0 && ! pq->error ) {
+                        pq->error = ret;
+                        pq->errmsg = strdup(preludedb_strerror(ret));
+                }
+
+                i = pq->next++;
+                if ( pq->error || i >= pq->count ) {
+                        gl_lock_unlock(pq->mutex);
+                        break;
+                }
+
+                gl_lock_unlock(pq->mutex);
+
+                ret = parallel_query_run(pq, session, i);
+        }
+
+        if ( session )
+                pool_put_session(pq->sql, session);
+
+        return NULL;
+}
+
+#endif
+
+
+
+/**
+ * preludedb_sql_query_parallel:
+ * @sql: Pointer to a sql object.
+ * @queries: Array of @count SQL queries to execute.
+ * @count: Number of queries.
+ * @tables: Array of @count tables where the result of each query will be stored,
+ * or NULL if the query returned no result.
+ *
+ * Execute independent read-only queries concurrently, each on a session
+ * of its own where @sql allows it (see %PRELUDEDB_SQL_SETTING_MAX_SESSIONS).
+ * The queries run one after the other within the transaction of the
+ * calling thread if it has one open, so that they see its changes.
+ *
+ * Returns: 0 on success or a negative value if an error occur, in which
+ * case no table is returned.
+ */
+int preludedb_sql_query_parallel(preludedb_sql_t *sql, const char * const *queries, unsigned int count, preludedb_sql_table_t **tables)
+{
+        int ret = 0;
+        unsigned int i;
+
+        prelude_return_val_if_fail(sql && queries && tables, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        memset(tables, 0, count * sizeof(*tables));
+
+#if SQL_POOLED_SESSIONS
+        if ( count > 1 && sql->max_sessions > 1 && ! get_transaction(sql) ) {
+                pthread_t *threads;
+                unsigned int nthreads;
+                parallel_query_t pq;
+
+                nthreads = MIN(count, sql->max_sessions);
+
+                threads = malloc(nthreads * sizeof(*threads));
+                if ( ! threads )
+                        return preludedb_error_from_errno(errno);
+
+                memset(&pq, 0, sizeof(pq));
+                pq.sql = sql;
+                pq.queries = queries;
+                pq.tables = tables;
+                pq.count = count;
+                gl_lock_init(pq.mutex);
+
+                for ( i = 0; i < nthreads; i++ ) {
+                        ret = pthread_create(&threads[i], NULL, parallel_query_thread, &pq);
+                        if ( ret != 0 ) {
+                                ret = preludedb_error_from_errno(ret);
+                                break;
+                        }
+                }
+
+                /*
+                 * Should some threads fail to start, the others still
+                 * run all the queries.
+                 */
+                if ( i > 0 )
+                        ret = 0;
+
+                nthreads = i;
+                for ( i = 0; i < nthreads; i++ )
+                        pthread_join(threads[i], NULL);
+
+                free(threads);
+                gl_lock_destroy(pq.mutex);
+
+                if ( pq.error ) {
+                        ret = prelude_error_verbose_make(prelude_error_get_source(pq.error), prelude_error_get_code(pq.error),
+                                                         "%s", pq.errmsg ? pq.errmsg : "parallel query failed");
+                        if ( pq.errmsg )
+                                free(pq.errmsg);
+                }
+
+                goto out;
+        }
+#endif
+
+        for ( i = 0; i < count; i++ ) {
+                ret = preludedb_sql_query(sql, queries[i], &tables[i]);
+                if ( ret < 0 )
+                        break;
+
+                if ( ret == 0 )
+                        tables[i] = NULL;
+        }
+
+#if SQL_POOLED_SESSIONS
+ out:
+#endif
+        if ( ret < 0 ) {
+                for ( i = 0; i < count; i++ ) {
+                        if ( tables[i] )
+                                preludedb_sql_table_destroy(tables[i]);
+
+                        tables[i] = NULL;
+                }
+
+                return ret;
+        }
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_sql_insert:
+ * @sql: Pointer to a sql object.
+ * @table: the name of the table where to insert values.
+ * @fields: a list of comma separated field names where the values will be inserted.
+ * @format: The values to insert in a printf format string.
+ * @...: Argument referenced throught @format.
+ *
+ * Insert values in a table.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_insert(preludedb_sql_t *sql, const char *table, const char *fields,
+                         const char *format, ...)
+{
+        int ret;
+        va_list ap;
+        prelude_string_t *query;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        ret = prelude_string_sprintf(query, "INSERT INTO %s (%s) VALUES(", table, fields);
+        if ( ret < 0 )
+                goto error;
+
+        va_start(ap, format);
+        ret = prelude_string_vprintf(query, format, ap);
+        va_end(ap);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_cat(query, ")");
+        if ( ret < 0 )
+                goto error;
+
+        ret = preludedb_sql_query(sql, prelude_string_get_string(query), NULL);
+
+ error:
+        prelude_string_destroy(query);
+
+        return ret;
+}
+
+
+
+static char *next_column(char **ptr)
+{
+        char *start, *end;
+
+        start = *ptr + strspn(*ptr, " ");
+        if ( ! *start )
+                return NULL;
+
+        end = strchr(start, ',');
+        *ptr = end ? end + 1 : start + strlen(start);
+
+        if ( ! end )
+                end = start + strlen(start);
+
+        while ( end > start && end[-1] == ' ' )
+                end--;
+
+        *end = 0;
+
+        return start;
+}
+
+
+
+static prelude_bool_t is_key_column(const char *key, const char *column)
+{
+        size_t len = strlen(column);
+
+        while ( *(key += strspn(key, " ,")) ) {
+                if ( strncmp(key, column, len) == 0 && (key[len] == 0 || key[len] == ',' || key[len] == ' ') )
+                        return TRUE;
+
+                key += strcspn(key, ",");
+        }
+
+        return FALSE;
+}
+
+
+
+static int sql_vupsert(preludedb_sql_t *sql, const char *table, const char *fields, const char *key,
+                       prelude_bool_t update, const char *format, va_list ap)
+{
+        int ret;
+        size_t size = 0;
+        const char **columns;
+        char *buf, *ptr, *column;
+        prelude_string_t *values, *query;
+
+        buf = strdup(fields);
+        if ( ! buf )
+                return preludedb_error_from_errno(errno);
+
+        columns = malloc((strlen(fields) / 2 + 1) * sizeof(*columns));
+        if ( ! columns ) {
+                free(buf);
+                return preludedb_error_from_errno(errno);
+        }
+
+        ptr = buf;
+        while ( update && (column = next_column(&ptr)) ) {
+                if ( ! is_key_column(key, column) )
+                        columns[size++] = column;
+        }
+
+        ret = prelude_string_new(&values);
+        if ( ret < 0 )
+                goto error;
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 ) {
+                prelude_string_destroy(values);
+                goto error;
+        }
+
+        ret = prelude_string_vprintf(values, format, ap);
+        if ( ret < 0 )
+                goto out;
+
+        ret = _preludedb_plugin_sql_build_upsert_string(sql->plugin, sql->main_session.data, table, fields,
+                                                        prelude_string_get_string(values), key, columns, size, query);
+        if ( ret < 0 )
+                goto out;
+
+        ret = preludedb_sql_query(sql, prelude_string_get_string(query), NULL);
+
+ out:
         prelude_string_destroy(query);
+        prelude_string_destroy(values);
+
+ error:
+        free(columns);
+        free(buf);
 
         return ret;
 }
@@ -422,46 +1659,62 @@ int preludedb_sql_query_sprintf(preludedb_sql_t *sql, preludedb_sql_table_t **ta
 
 
 /**
- * preludedb_sql_insert:
+ * preludedb_sql_upsert:
  * @sql: Pointer to a sql object.
  * @table: the name of the table where to insert values.
  * @fields: a list of comma separated field names where the values will be inserted.
+ * @key: a list of comma separated field names, among @fields, forming a unique key of @table.
  * @format: The values to insert in a printf format string.
  * @...: Argument referenced throught @format.
  *
- * Insert values in a table.
+ * Insert values in a table, or update the fields that are not part of
+ * @key if a row with the same @key already exists, using the native
+ * statement of the underlying database.
  *
  * Returns: 0 on success or a negative value if an error occur.
  */
-int preludedb_sql_insert(preludedb_sql_t *sql, const char *table, const char *fields,
+int preludedb_sql_upsert(preludedb_sql_t *sql, const char *table, const char *fields, const char *key,
                          const char *format, ...)
 {
         int ret;
         va_list ap;
-        prelude_string_t *query;
-
-        ret = prelude_string_new(&query);
-        if ( ret < 0 )
-                return ret;
 
-        ret = prelude_string_sprintf(query, "INSERT INTO %s (%s) VALUES(", table, fields);
-        if ( ret < 0 )
-                goto error;
+        prelude_return_val_if_fail(sql && table && fields && key && format, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         va_start(ap, format);
-        ret = prelude_string_vprintf(query, format, ap);
+        ret = sql_vupsert(sql, table, fields, key, TRUE, format, ap);
         va_end(ap);
-        if ( ret < 0 )
-                goto error;
 
-        ret = prelude_string_cat(query, ")");
-        if ( ret < 0 )
-                goto error;
+        return ret;
+}
 
-        ret = preludedb_sql_query(sql, prelude_string_get_string(query), NULL);
 
- error:
-        prelude_string_destroy(query);
+
+/**
+ * preludedb_sql_insert_ignore:
+ * @sql: Pointer to a sql object.
+ * @table: the name of the table where to insert values.
+ * @fields: a list of comma separated field names where the values will be inserted.
+ * @key: a list of comma separated field names, among @fields, forming a unique key of @table.
+ * @format: The values to insert in a printf format string.
+ * @...: Argument referenced throught @format.
+ *
+ * Insert values in a table, unless a row with the same @key already
+ * exists, in which case it is left untouched.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_insert_ignore(preludedb_sql_t *sql, const char *table, const char *fields, const char *key,
+                                const char *format, ...)
+{
+        int ret;
+        va_list ap;
+
+        prelude_return_val_if_fail(sql && table && fields && key && format, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        va_start(ap, format);
+        ret = sql_vupsert(sql, table, fields, key, FALSE, format, ap);
+        va_end(ap);
 
         return ret;
 }
@@ -477,164 +1730,468 @@ int preludedb_sql_insert(preludedb_sql_t *sql, const char *table, const char *fi
  * Return the last insert ident allocated by the database server when
  * writing to a table with an auto increment field.
  *
- * Returns: 0 on success or a negative value if an error occurs.
+ * Returns: 0 on success or a negative value if an error occurs.
+ */
+int preludedb_sql_get_last_insert_ident(preludedb_sql_t *sql, uint64_t *ident)
+{
+        return _preludedb_plugin_sql_get_last_insert_ident(sql->plugin, get_session(sql)->data, ident);
+}
+
+
+
+
+
+/**
+ * preludedb_sql_build_limit_offset_string:
+ * @sql: Pointer to a sql object.
+ * @limit: The limit value, a value inferior to zero will disable the limit.
+ * @offset: The offset value, a value inferior to zero will disable the offset.
+ * @output: Where the limit/offset built string will be stored.
+ *
+ * Build a limit/offset string for a SQL query, depending on the underlying type of database.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_build_limit_offset_string(preludedb_sql_t *sql, int limit, int offset, prelude_string_t *output)
+{
+        return _preludedb_plugin_sql_build_limit_offset_string(sql->plugin, sql->main_session.data, limit, offset, output);
+}
+
+
+
+static int transaction_begin(preludedb_sql_t *sql, prelude_bool_t external, preludedb_sql_transaction_t **out)
+{
+        int ret;
+        preludedb_sql_transaction_t *transaction;
+
+        if ( get_transaction(sql) )
+                return preludedb_error(PRELUDEDB_ERROR_ALREADY_IN_TRANSACTION);
+
+        transaction = calloc(1, sizeof(*transaction));
+        if ( ! transaction )
+                return preludedb_error_from_errno(errno);
+
+        ret = pool_get_session(sql, &transaction->session);
+        if ( ret < 0 ) {
+                free(transaction);
+                return ret;
+        }
+
+        /*
+         * The session lock is held until the transaction ends: this only
+         * ever blocks other threads when the transaction fell back to the
+         * main session.
+         */
+        gl_recursive_lock_lock(transaction->session->mutex);
+
+        transaction->sql = sql;
+        transaction->external = external;
+        transaction->thread = sql_thread_self();
+        prelude_list_init(&transaction->callbacks);
+
+        gl_lock_lock(sql->pool_lock);
+        prelude_list_add_tail(&sql->transactions, &transaction->list);
+        gl_lock_unlock(sql->pool_lock);
+
+        ret = preludedb_sql_query(sql, "BEGIN", NULL);
+        if ( ret < 0 ) {
+                gl_lock_lock(sql->pool_lock);
+                prelude_list_del(&transaction->list);
+                gl_lock_unlock(sql->pool_lock);
+
+                gl_recursive_lock_unlock(transaction->session->mutex);
+                pool_put_session(sql, transaction->session);
+                free(transaction);
+
+                return ret;
+        }
+
+        if ( out )
+                *out = transaction;
+
+        return ret;
+}
+
+
+
+static void transaction_destroy(preludedb_sql_transaction_t *transaction, prelude_bool_t committed)
+{
+        prelude_list_t *tmp, *bkp;
+        transaction_callback_t *callback;
+        preludedb_sql_t *sql = transaction->sql;
+
+        gl_lock_lock(sql->pool_lock);
+        prelude_list_del(&transaction->list);
+        gl_lock_unlock(sql->pool_lock);
+
+        gl_recursive_lock_unlock(transaction->session->mutex);
+        pool_put_session(sql, transaction->session);
+
+        prelude_list_for_each_safe(&transaction->callbacks, tmp, bkp) {
+                callback = prelude_list_entry(tmp, transaction_callback_t, list);
+                callback->callback(sql, committed, callback->data);
+
+                prelude_list_del(&callback->list);
+                free(callback);
+        }
+
+        free(transaction);
+}
+
+
+
+static int transaction_commit(preludedb_sql_transaction_t *transaction)
+{
+        int ret;
+
+        ret = preludedb_sql_query(transaction->sql, "COMMIT", NULL);
+        if ( ret >= 0 && transaction->sql->nreplicas )
+                mark_write(transaction->sql);
+
+        transaction_destroy(transaction, (ret < 0) ? FALSE : TRUE);
+
+        return ret;
+}
+
+
+
+static int transaction_rollback(preludedb_sql_transaction_t *transaction)
+{
+        int ret;
+        char *original_error = NULL;
+
+        if ( _prelude_thread_get_error() )
+                original_error = strdup(_prelude_thread_get_error());
+
+        if ( original_error && ! (transaction->session->status & PRELUDEDB_SQL_STATUS_CONNECTED) ) {
+                ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s. No ROLLBACK possible due to connection closure",
+                                              original_error);
+                goto error;
+        }
+
+        ret = preludedb_sql_query(transaction->sql, "ROLLBACK", NULL);
+        if ( ret < 0 ) {
+                if ( original_error )
+                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s.\nROLLBACK failed: %s", original_error, preludedb_strerror(ret));
+                else
+                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "ROLLBACK failed: %s", preludedb_strerror(ret));
+        }
+
+    error:
+        if ( original_error )
+                free(original_error);
+
+        transaction_destroy(transaction, FALSE);
+
+        return ret;
+}
+
+
+
+/*
+ * Begin a transaction on behalf of the library user: transactions
+ * requested internally by the calling thread are merged into it until
+ * it ends.
+ */
+int _preludedb_sql_transaction_start(preludedb_sql_t *sql)
+{
+        return transaction_begin(sql, TRUE, NULL);
+}
+
+
+
+/**
+ * preludedb_sql_transaction_start:
+ * @sql: Pointer to a sql object.
+ *
+ * Begin a sql transaction. Queries issued through @sql by the calling
+ * thread run within the transaction until it ends, while other threads
+ * keep using their own session.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_transaction_start(preludedb_sql_t *sql)
+{
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+        if ( transaction && transaction->external )
+                return 0;
+
+        return transaction_begin(sql, FALSE, NULL);
+}
+
+
+
+int _preludedb_sql_transaction_end(preludedb_sql_t *sql)
+{
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+        if ( ! transaction )
+                return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
+
+        return transaction_commit(transaction);
+}
+
+
+
+
+/**
+ * preludedb_sql_transaction_end:
+ * @sql: Pointer to a sql object.
+ *
+ * Finish a sql transaction (SQL COMMIT command).
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_transaction_end(preludedb_sql_t *sql)
+{
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+        if ( ! transaction )
+                return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
+
+        if ( transaction->external )
+                return 0;
+
+        return transaction_commit(transaction);
+}
+
+
+
+int _preludedb_sql_transaction_abort(preludedb_sql_t *sql)
+{
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+        if ( ! transaction )
+                return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
+
+        return transaction_rollback(transaction);
+}
+
+
+
+
+/**
+ * preludedb_sql_transaction_abort:
+ * @sql: Pointer to a sql object.
+ *
+ * Abort a sql transaction (SQL ROLLBACK command).
+ *
+ * Returns: 0 on success or a negative value if an error occur.
  */
-int preludedb_sql_get_last_insert_ident(preludedb_sql_t *sql, uint64_t *ident)
+int preludedb_sql_transaction_abort(preludedb_sql_t *sql)
 {
-        return _preludedb_plugin_sql_get_last_insert_ident(sql->plugin, sql->session, ident);
-}
+        preludedb_sql_transaction_t *transaction;
+
+        transaction = get_transaction(sql);
+        if ( ! transaction )
+                return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
 
+        if ( transaction->external )
+                return 0;
 
+        return transaction_rollback(transaction);
+}
 
 
 
 /**
- * preludedb_sql_build_limit_offset_string:
+ * preludedb_sql_transaction_new:
  * @sql: Pointer to a sql object.
- * @limit: The limit value, a value inferior to zero will disable the limit.
- * @offset: The offset value, a value inferior to zero will disable the offset.
- * @output: Where the limit/offset built string will be stored.
+ * @transaction: Where the new transaction will be stored.
  *
- * Build a limit/offset string for a SQL query, depending on the underlying type of database.
+ * Begin a sql transaction, on a session of its own where @sql allows it
+ * (see %PRELUDEDB_SQL_SETTING_MAX_SESSIONS), so that it does not block
+ * other threads using @sql. The transaction is bound to the calling
+ * thread: queries issued through @sql by this thread, including those
+ * of the library functions, run within it until
+ * preludedb_sql_transaction_commit() or preludedb_sql_transaction_rollback()
+ * is called.
  *
  * Returns: 0 on success or a negative value if an error occur.
  */
-int preludedb_sql_build_limit_offset_string(preludedb_sql_t *sql, int limit, int offset, prelude_string_t *output)
+int preludedb_sql_transaction_new(preludedb_sql_t *sql, preludedb_sql_transaction_t **transaction)
 {
-        return _preludedb_plugin_sql_build_limit_offset_string(sql->plugin, sql->session, limit, offset, output);
+        prelude_return_val_if_fail(sql && transaction, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        return transaction_begin(sql, TRUE, transaction);
 }
 
 
 
-int _preludedb_sql_transaction_start(preludedb_sql_t *sql)
+/**
+ * preludedb_sql_transaction_commit:
+ * @transaction: Pointer to a transaction object.
+ *
+ * Commit @transaction, and destroy it.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_transaction_commit(preludedb_sql_transaction_t *transaction)
 {
-        int ret;
-
-        gl_recursive_lock_lock(sql->mutex);
-
-        if ( sql->status & PRELUDEDB_SQL_STATUS_TRANSACTION ) {
-                gl_recursive_lock_unlock(sql->mutex);
-                return preludedb_error(PRELUDEDB_ERROR_ALREADY_IN_TRANSACTION);
-        }
-
-        ret = preludedb_sql_query(sql, "BEGIN", NULL);
-        if ( ret < 0 )
-                gl_recursive_lock_unlock(sql->mutex);
-        else
-                sql->status |= PRELUDEDB_SQL_STATUS_TRANSACTION;
+        prelude_return_val_if_fail(transaction, prelude_error(PRELUDE_ERROR_ASSERTION));
 
-        return ret;
+        return transaction_commit(transaction);
 }
 
 
 
 /**
- * preludedb_sql_transaction_start:
- * @sql: Pointer to a sql object.
+ * preludedb_sql_transaction_rollback:
+ * @transaction: Pointer to a transaction object.
  *
- * Begin a sql transaction.
+ * Roll @transaction back, and destroy it.
  *
  * Returns: 0 on success or a negative value if an error occur.
  */
-int preludedb_sql_transaction_start(preludedb_sql_t *sql)
+int preludedb_sql_transaction_rollback(preludedb_sql_transaction_t *transaction)
 {
-        if ( sql->internal_transaction_disabled )
-                return 0;
+        prelude_return_val_if_fail(transaction, prelude_error(PRELUDE_ERROR_ASSERTION));
 
-        return _preludedb_sql_transaction_start(sql);
+        return transaction_rollback(transaction);
 }
 
 
 
-int _preludedb_sql_transaction_end(preludedb_sql_t *sql)
+/**
+ * preludedb_sql_transaction_add_callback:
+ * @sql: Pointer to a sql object.
+ * @callback: Function to call once the transaction ends.
+ * @data: Data passed to @callback.
+ *
+ * Register @callback to be called once the transaction the calling thread
+ * has open on @sql is committed or rolled back, so that state derived from
+ * rows written within the transaction can be kept or discarded accordingly.
+ *
+ * Returns: 0 on success, #PRELUDEDB_ERROR_NOT_IN_TRANSACTION if the calling
+ * thread has no transaction open, or another negative value if an error occur.
+ */
+int preludedb_sql_transaction_add_callback(preludedb_sql_t *sql, preludedb_sql_transaction_callback_t callback, void *data)
 {
-        int ret;
+        transaction_callback_t *entry;
+        preludedb_sql_transaction_t *transaction;
 
-        if ( ! (sql->status & PRELUDEDB_SQL_STATUS_TRANSACTION) )
+        prelude_return_val_if_fail(sql && callback, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        transaction = get_transaction(sql);
+        if ( ! transaction )
                 return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
 
-        ret = preludedb_sql_query(sql, "COMMIT", NULL);
-        sql->status &= ~PRELUDEDB_SQL_STATUS_TRANSACTION;
+        entry = malloc(sizeof(*entry));
+        if ( ! entry )
+                return preludedb_error_from_errno(errno);
 
-        gl_recursive_lock_unlock(sql->mutex);
+        entry->callback = callback;
+        entry->data = data;
+        prelude_list_add_tail(&transaction->callbacks, &entry->list);
 
-        return ret;
+        return 0;
 }
 
 
 
-
 /**
- * preludedb_sql_transaction_end:
+ * preludedb_sql_set_data:
  * @sql: Pointer to a sql object.
+ * @key: Unique address identifying the data.
+ * @data: Data to attach to @sql.
+ * @destroy: Function called to release @data, or NULL.
  *
- * Finish a sql transaction (SQL COMMIT command).
+ * Attach @data to @sql under @key, replacing (and releasing) any data
+ * previously attached under the same key. @data is released when @sql
+ * is destroyed.
  *
  * Returns: 0 on success or a negative value if an error occur.
  */
-int preludedb_sql_transaction_end(preludedb_sql_t *sql)
+int preludedb_sql_set_data(preludedb_sql_t *sql, const void *key, void *data, void (*destroy)(void *data))
 {
-        if ( sql->internal_transaction_disabled )
-                return 0;
-
-        return _preludedb_sql_transaction_end(sql);
-}
-
+        prelude_list_t *tmp;
+        sql_data_t *entry, *old = NULL;
 
+        prelude_return_val_if_fail(sql && key, prelude_error(PRELUDE_ERROR_ASSERTION));
 
-int _preludedb_sql_transaction_abort(preludedb_sql_t *sql)
-{
-        int ret;
-        char *original_error = NULL;
+        entry = malloc(sizeof(*entry));
+        if ( ! entry )
+                return preludedb_error_from_errno(errno);
 
-        if ( ! (sql->status & PRELUDEDB_SQL_STATUS_TRANSACTION) )
-                return preludedb_error(PRELUDEDB_ERROR_NOT_IN_TRANSACTION);
+        entry->key = key;
+        entry->data = data;
+        entry->destroy = destroy;
 
-        if ( _prelude_thread_get_error() )
-                original_error = strdup(_prelude_thread_get_error());
+        gl_lock_lock(sql->pool_lock);
 
-        sql->status &= ~PRELUDEDB_SQL_STATUS_TRANSACTION;
+        prelude_list_for_each(&sql->data_list, tmp) {
+                old = prelude_list_entry(tmp, sql_data_t, list);
+                if ( old->key == key )
+                        break;
 
-        if ( original_error && ! (sql->status & PRELUDEDB_SQL_STATUS_CONNECTED) ) {
-                ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s. No ROLLBACK possible due to connection closure",
-                                              original_error);
-                goto error;
+                old = NULL;
         }
 
-        ret = preludedb_sql_query(sql, "ROLLBACK", NULL);
-        if ( ret < 0 ) {
-                if ( original_error )
-                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "%s.\nROLLBACK failed: %s", original_error, preludedb_strerror(ret));
-                else
-                        ret = preludedb_error_verbose(PRELUDEDB_ERROR_QUERY, "ROLLBACK failed: %s", preludedb_strerror(ret));
-        }
+        if ( old )
+                prelude_list_del(&old->list);
 
-    error:
-        if ( original_error )
-                free(original_error);
+        prelude_list_add_tail(&sql->data_list, &entry->list);
 
-        gl_recursive_lock_unlock(sql->mutex);
+        gl_lock_unlock(sql->pool_lock);
 
-        return ret;
-}
+        if ( old ) {
+                prelude_list_init(&old->list);
+                sql_data_destroy(old);
+        }
 
+        return 0;
+}
 
 
 
 /**
- * preludedb_sql_transaction_abort:
+ * preludedb_sql_get_data:
  * @sql: Pointer to a sql object.
+ * @key: Address identifying the data.
  *
- * Abort a sql transaction (SQL ROLLBACK command).
- *
- * Returns: 0 on success or a negative value if an error occur.
+ * Returns: the data attached to @sql under @key, or NULL.
  */
-int preludedb_sql_transaction_abort(preludedb_sql_t *sql)
+void *preludedb_sql_get_data(preludedb_sql_t *sql, const void *key)
 {
-        if ( sql->internal_transaction_disabled )
-                return 0;
+        void *data = NULL;
+        prelude_list_t *tmp;
+        sql_data_t *entry;
+
+        prelude_return_val_if_fail(sql && key, NULL);
+
+        gl_lock_lock(sql->pool_lock);
+
+        prelude_list_for_each(&sql->data_list, tmp) {
+                entry = prelude_list_entry(tmp, sql_data_t, list);
+                if ( entry->key == key ) {
+                        data = entry->data;
+                        break;
+                }
+        }
+
+        gl_lock_unlock(sql->pool_lock);
+
+        return data;
+}
+
 
-        return _preludedb_sql_transaction_abort(sql);
+
+/*
+ * Strings are escaped without involving the backend when it only requires
+ * single quotes to be doubled, or when they hold nothing to escape, which
+ * is the common case.
+ */
+static prelude_bool_t can_escape_locally(preludedb_sql_t *sql, const char *input, size_t input_size)
+{
+        if ( _preludedb_plugin_sql_get_escape_flags(sql->plugin) & PRELUDEDB_PLUGIN_SQL_ESCAPE_FLAGS_QUOTE_ONLY )
+                return TRUE;
+
+        return _preludedb_sql_escape_span(input, input_size, FALSE) == input_size;
 }
 
 
@@ -653,18 +2210,91 @@ int preludedb_sql_transaction_abort(preludedb_sql_t *sql)
 int preludedb_sql_escape_fast(preludedb_sql_t *sql, const char *input, size_t input_size, char **output)
 {
         int ret;
+        size_t rsize;
+        struct timeval start;
+        preludedb_sql_session_t *session;
 
         if ( ! input ) {
                 *output = (char *) strdup("NULL");
                 return *output ? 0 : preludedb_error_from_errno(errno);
         }
 
-        gl_recursive_lock_lock(sql->mutex);
+        if ( sql->stats_enabled )
+                gettimeofday(&start, NULL);
+
+        if ( can_escape_locally(sql, input, input_size) ) {
+                rsize = input_size * 2 + 3;
+                if ( rsize <= input_size )
+                        return preludedb_error(PRELUDEDB_ERROR_GENERIC);
+
+                *output = malloc(rsize);
+                if ( ! *output )
+                        return preludedb_error_from_errno(errno);
+
+                _preludedb_sql_escape_write(*output, input, input_size);
+                ret = 0;
+        }
+
+        else {
+                ret = session_lock(sql, &session);
+                if ( ret < 0 )
+                        return ret;
+
+                ret = _preludedb_plugin_sql_escape(sql->plugin, session->data, input, input_size, output);
+                gl_recursive_lock_unlock(session->mutex);
+        }
+
+        if ( sql->stats_enabled )
+                _preludedb_sql_stats_record_escape(sql->stats, get_elapsed(&start));
+
+        return ret;
+}
+
+
+
+/**
+ * preludedb_sql_escape_append:
+ * @sql: Pointer to a sql object.
+ * @output: String the escaped literal is appended to.
+ * @input: Buffer to escape, or NULL.
+ * @input_size: Buffer size.
+ *
+ * Append the quoted and escaped string literal for @input, or NULL, to
+ * @output. Unlike preludedb_sql_escape(), no intermediate buffer is
+ * allocated, and the database session is not locked unless @input holds
+ * characters only the backend knows how to escape.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_escape_append(preludedb_sql_t *sql, prelude_string_t *output, const char *input, size_t input_size)
+{
+        int ret;
+        char *escaped;
+        struct timeval start;
+
+        prelude_return_val_if_fail(sql && output, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! input )
+                return prelude_string_cat(output, "NULL");
+
+        if ( ! can_escape_locally(sql, input, input_size) ) {
+                ret = preludedb_sql_escape_fast(sql, input, input_size, &escaped);
+                if ( ret < 0 )
+                        return ret;
+
+                ret = prelude_string_cat(output, escaped);
+                free(escaped);
+
+                return ret;
+        }
+
+        if ( sql->stats_enabled )
+                gettimeofday(&start, NULL);
 
-        assert_connected(sql);
-        ret = _preludedb_plugin_sql_escape(sql->plugin, sql->session, input, input_size, output);
+        ret = _preludedb_sql_escape_append(output, input, input_size);
 
-        gl_recursive_lock_unlock(sql->mutex);
+        if ( sql->stats_enabled )
+                _preludedb_sql_stats_record_escape(sql->stats, get_elapsed(&start));
 
         return ret;
 }
@@ -703,18 +2333,101 @@ int preludedb_sql_escape_binary(preludedb_sql_t *sql, const unsigned char *input
                                 char **output)
 {
         int ret;
+        struct timeval start;
+        preludedb_sql_session_t *session;
+        preludedb_plugin_sql_escape_flags_t flags;
 
         if ( ! input ) {
                 *output = (char *) strdup("NULL");
                 return *output ? 0 : preludedb_error_from_errno(errno);
         }
 
-        gl_recursive_lock_lock(sql->mutex);
+        ret = get_escape_flags(sql, &flags);
+        if ( ret < 0 )
+                return ret;
+
+        if ( sql->stats_enabled )
+                gettimeofday(&start, NULL);
+
+        /*
+         * Hexadecimal literals are built by the library, without the session.
+         */
+        if ( _preludedb_plugin_sql_get_binary_hex_prefix(sql->plugin, flags) )
+                ret = _preludedb_plugin_sql_escape_binary(sql->plugin, NULL, flags, input, input_size, output);
+
+        else {
+                ret = session_lock(sql, &session);
+                if ( ret < 0 )
+                        return ret;
+
+                ret = _preludedb_plugin_sql_escape_binary(sql->plugin, session->data, session->escape_flags,
+                                                          input, input_size, output);
+                gl_recursive_lock_unlock(session->mutex);
+        }
+
+        if ( sql->stats_enabled )
+                _preludedb_sql_stats_record_escape(sql->stats, get_elapsed(&start));
+
+        return ret;
+}
+
+
+
+/**
+ * preludedb_sql_escape_binary_append:
+ * @sql: Pointer to a sql object.
+ * @output: String the escaped literal is appended to.
+ * @input: Buffer to escape, or NULL.
+ * @input_size: Buffer size.
+ *
+ * Append the binary literal for @input, or NULL, to @output. When the
+ * backend accepts hexadecimal binary literals, the buffer is encoded
+ * directly into @output.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_escape_binary_append(preludedb_sql_t *sql, prelude_string_t *output,
+                                       const unsigned char *input, size_t input_size)
+{
+        int ret;
+        char *escaped;
+        const char *prefix;
+        struct timeval start;
+        preludedb_plugin_sql_escape_flags_t flags;
+
+        prelude_return_val_if_fail(sql && output, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! input )
+                return prelude_string_cat(output, "NULL");
+
+        ret = get_escape_flags(sql, &flags);
+        if ( ret < 0 )
+                return ret;
+
+        prefix = _preludedb_plugin_sql_get_binary_hex_prefix(sql->plugin, flags);
+        if ( ! prefix ) {
+                ret = preludedb_sql_escape_binary(sql, input, input_size, &escaped);
+                if ( ret < 0 )
+                        return ret;
+
+                ret = prelude_string_cat(output, escaped);
+                free(escaped);
+
+                return ret;
+        }
+
+        if ( sql->stats_enabled )
+                gettimeofday(&start, NULL);
 
-        assert_connected(sql);
-        ret = _preludedb_plugin_sql_escape_binary(sql->plugin, sql->session, input, input_size, output);
+        ret = prelude_string_cat(output, prefix);
+        if ( ret >= 0 )
+                ret = _preludedb_sql_hex_append(output, input, input_size);
 
-        gl_recursive_lock_unlock(sql->mutex);
+        if ( ret >= 0 )
+                ret = prelude_string_ncat(output, "'", 1);
+
+        if ( sql->stats_enabled )
+                _preludedb_sql_stats_record_escape(sql->stats, get_elapsed(&start));
 
         return ret;
 }
@@ -737,13 +2450,17 @@ int preludedb_sql_unescape_binary(preludedb_sql_t *sql, const char *input, size_
                                   unsigned char **output, size_t *output_size)
 {
         int ret;
+        preludedb_sql_session_t *session;
 
-        gl_recursive_lock_lock(sql->mutex);
+        if ( _preludedb_plugin_sql_is_binary_hex(sql->plugin, input, input_size) )
+                return _preludedb_plugin_sql_unescape_binary(sql->plugin, NULL, input, input_size, output, output_size);
 
-        assert_connected(sql);
-        ret = _preludedb_plugin_sql_unescape_binary(sql->plugin, sql->session, input, input_size, output, output_size);
+        ret = session_lock(sql, &session);
+        if ( ret < 0 )
+                return ret;
 
-        gl_recursive_lock_unlock(sql->mutex);
+        ret = _preludedb_plugin_sql_unescape_binary(sql->plugin, session->data, input, input_size, output, output_size);
+        gl_recursive_lock_unlock(session->mutex);
 
         return ret;
 }
@@ -779,7 +2496,10 @@ void preludedb_sql_table_destroy(preludedb_sql_table_t *table)
 
         free(table->rows);
 
-        _preludedb_plugin_sql_table_destroy(table->sql->plugin, table->sql->session, table);
+        if ( table->stats )
+                _preludedb_sql_stats_record_fetch(table->sql->stats, table->stats, table->nrow, table->bytes, table->fetch_time);
+
+        _preludedb_plugin_sql_table_destroy(table->sql->plugin, table->session->data, table);
         preludedb_sql_destroy(table->sql);
         free(table);
 }
@@ -855,7 +2575,7 @@ void preludedb_sql_row_destroy(preludedb_sql_row_t *row)
                 return;
         }
 
-        _preludedb_plugin_sql_row_destroy(row->table->sql->plugin, row->table->sql->session, row->table, row);
+        _preludedb_plugin_sql_row_destroy(row->table->sql->plugin, row->table->session->data, row->table, row);
 
         for ( i = 0; i < preludedb_sql_table_get_column_count(row->table); i++ ) {
                 if ( row->fields[i].value )
@@ -883,6 +2603,9 @@ int preludedb_sql_row_new_field(preludedb_sql_row_t *row, preludedb_sql_field_t
         ftbl[num].len = len;
         *field = &ftbl[num];
 
+        if ( row->table->stats )
+                row->table->bytes += len;
+
         return 1;
 }
 
@@ -905,7 +2628,7 @@ void preludedb_sql_field_destroy(preludedb_sql_field_t *field)
         row = field2row(field);
 
         if ( row->refcount == 0 )
-                _preludedb_plugin_sql_field_destroy(row->table->sql->plugin, row->table->sql->session, row->table, row, field);
+                _preludedb_plugin_sql_field_destroy(row->table->sql->plugin, row->table->session->data, row->table, row, field);
         else
                 preludedb_sql_row_destroy(row);
 }
@@ -923,7 +2646,7 @@ void preludedb_sql_field_destroy(preludedb_sql_field_t *field)
  */
 const char *preludedb_sql_table_get_column_name(preludedb_sql_table_t *table, unsigned int column_num)
 {
-        return _preludedb_plugin_sql_get_column_name(table->sql->plugin, table->sql->session, table, column_num);
+        return _preludedb_plugin_sql_get_column_name(table->sql->plugin, table->session->data, table, column_num);
 }
 
 
@@ -939,7 +2662,7 @@ const char *preludedb_sql_table_get_column_name(preludedb_sql_table_t *table, un
  */
 int preludedb_sql_table_get_column_num(preludedb_sql_table_t *table, const char *column_name)
 {
-        return _preludedb_plugin_sql_get_column_num(table->sql->plugin, table->sql->session, table, column_name);
+        return _preludedb_plugin_sql_get_column_num(table->sql->plugin, table->session->data, table, column_name);
 }
 
 
@@ -955,7 +2678,7 @@ int preludedb_sql_table_get_column_num(preludedb_sql_table_t *table, const char
 unsigned int preludedb_sql_table_get_column_count(preludedb_sql_table_t *table)
 {
         if ( ! table->column_count )
-                table->column_count = _preludedb_plugin_sql_get_column_count(table->sql->plugin, table->sql->session, table);
+                table->column_count = _preludedb_plugin_sql_get_column_count(table->sql->plugin, table->session->data, table);
 
         return table->column_count;
 }
@@ -979,7 +2702,7 @@ unsigned int preludedb_sql_table_get_row_count(preludedb_sql_table_t *table)
         if ( table->row_count )
                 return table->row_count;
 
-        ret = _preludedb_plugin_sql_get_row_count(table->sql->plugin, table->sql->session, table);
+        ret = _preludedb_plugin_sql_get_row_count(table->sql->plugin, table->session->data, table);
         if ( ret >= 0 ) {
                 table->row_count = ret;
                 return ret;
@@ -1029,6 +2752,7 @@ unsigned int preludedb_sql_table_get_row_count(preludedb_sql_table_t *table)
 int preludedb_sql_table_get_row(preludedb_sql_table_t *table, unsigned int row_index, preludedb_sql_row_t **row)
 {
         int ret;
+        struct timeval start;
 
         if ( row_index == (unsigned int) -1 )
                 row_index = table->nrow;
@@ -1045,9 +2769,16 @@ int preludedb_sql_table_get_row(preludedb_sql_table_t *table, unsigned int row_i
                 return preludedb_error_verbose(PRELUDEDB_ERROR_INDEX, "Invalid row '%u'", row_index);
         }
 
-        ret = _preludedb_plugin_sql_fetch_row(table->sql->plugin, table->sql->session, table, row_index, row);
+        if ( table->stats )
+                gettimeofday(&start, NULL);
+
+        ret = _preludedb_plugin_sql_fetch_row(table->sql->plugin, table->session->data, table, row_index, row);
+
+        if ( table->stats )
+                table->fetch_time += get_elapsed(&start);
+
         if ( ret < 0 ) {
-                update_sql_from_errno(table->sql, ret);
+                update_sql_from_errno(table->sql, table->session, ret);
                 return ret;
         }
 
@@ -1113,9 +2844,9 @@ int preludedb_sql_row_get_field(preludedb_sql_row_t *row, int column_num, prelud
 
 
         ret = _preludedb_plugin_sql_fetch_field(row->table->sql->plugin,
-                                                row->table->sql->session, row->table, row, column_num, field);
+                                                row->table->session->data, row->table, row, column_num, field);
         if ( ret < 0 ) {
-                update_sql_from_errno(row->table->sql, ret);
+                update_sql_from_errno(row->table->sql, row->table->session, ret);
                 return ret;
         }
 
@@ -1590,6 +3321,27 @@ int preludedb_sql_build_time_timezone_string(preludedb_sql_t *sql, prelude_strin
 
 
 
+/**
+ * preludedb_sql_build_aggregate_string:
+ * @sql: Pointer to a sql object.
+ * @output: Pointer to a string object, where the result content will be stored.
+ * @field: The sql field name.
+ * @type: The aggregate to compute over @field.
+ * @param: The aggregate parameter, the percentile for #PRELUDEDB_SQL_AGGREGATE_PERCENTILE.
+ *
+ * Build the expression computing the approximate aggregate @type server side.
+ *
+ * Returns: 0 on success, a negative value with the %PRELUDE_ERROR_ENOSYS code if the
+ * database cannot compute @type, or another negative value if an error occur.
+ */
+int preludedb_sql_build_aggregate_string(preludedb_sql_t *sql, prelude_string_t *output, const char *field,
+                                         preludedb_sql_aggregate_type_t type, int param)
+{
+        return _preludedb_plugin_sql_build_aggregate_string(sql->plugin, sql->main_session.data, output, field, type, param);
+}
+
+
+
 
 /**
  * preludedb_sql_build_criterion_string:
@@ -1750,7 +3502,7 @@ int preludedb_sql_time_to_timestamp(preludedb_sql_t *sql,
  */
 long preludedb_sql_get_server_version(const preludedb_sql_t *sql)
 {
-        return _preludedb_plugin_sql_get_server_version(sql->plugin, sql->session);
+        return _preludedb_plugin_sql_get_server_version(sql->plugin, sql->main_session.data);
 }
 
 
@@ -1784,6 +3536,92 @@ const preludedb_sql_settings_t *preludedb_sql_get_settings(const preludedb_sql_t
 
 
 
+/**
+ * preludedb_sql_optimize:
+ * @sql: Pointer to a sql object.
+ * @table: Name of the table to optimize, or NULL.
+ * @flags: Bitwise OR of the #preludedb_sql_optimize_flags_t maintenance operations to run.
+ *
+ * Run the maintenance statements matching @flags on @table, using the
+ * syntax of the underlying database. Space is reclaimed before statistics
+ * are refreshed, so that they describe the compacted table.
+ *
+ * When @table is NULL, only the database wide housekeeping that complements
+ * the per table operations is run. Operations the database has no
+ * equivalent for are silently skipped.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_optimize(preludedb_sql_t *sql, const char *table, preludedb_sql_optimize_flags_t flags)
+{
+        int ret = 0;
+        prelude_string_t *query;
+        preludedb_sql_table_t *res;
+        preludedb_sql_optimize_flags_t flag;
+
+        prelude_return_val_if_fail(sql, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        ret = prelude_string_new(&query);
+        if ( ret < 0 )
+                return ret;
+
+        for ( flag = PRELUDEDB_SQL_OPTIMIZE_RECLAIM; flag; flag >>= 1 ) {
+                if ( ! (flags & flag) )
+                        continue;
+
+                prelude_string_clear(query);
+
+                ret = _preludedb_plugin_sql_build_optimize_string(sql->plugin, sql->main_session.data, table, flag, query);
+                if ( ret < 0 )
+                        break;
+
+                if ( prelude_string_is_empty(query) )
+                        continue;
+
+                ret = preludedb_sql_query(sql, prelude_string_get_string(query), &res);
+                if ( ret < 0 )
+                        break;
+
+                if ( ret > 0 )
+                        preludedb_sql_table_destroy(res);
+        }
+
+        prelude_string_destroy(query);
+
+        return (ret < 0) ? ret : 0;
+}
+
+
+
+/**
+ * preludedb_sql_build_create_index_string:
+ * @sql: Pointer to a sql object.
+ * @name: Name of the index.
+ * @table: Name of the indexed table.
+ * @columns: Comma separated list of the indexed columns.
+ * @partial_column: Column restricting the indexed rows, or NULL.
+ * @partial_value: Escaped value @partial_column must be equal to.
+ * @output: Where the statement will be stored.
+ *
+ * Build a statement creating an index, without blocking writers to @table
+ * where the underlying database allows it. Rows are restricted to those
+ * where @partial_column equals @partial_value: databases without partial
+ * indexes index @partial_column first instead.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_sql_build_create_index_string(preludedb_sql_t *sql, const char *name, const char *table, const char *columns,
+                                            const char *partial_column, const char *partial_value, prelude_string_t *output)
+{
+        prelude_return_val_if_fail(sql && name && table && columns && output, prelude_error(PRELUDE_ERROR_ASSERTION));
+        prelude_return_val_if_fail(! partial_column || partial_value, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        return _preludedb_plugin_sql_build_create_index_string(sql->plugin, sql->main_session.data, name, table, columns,
+                                                               partial_column, partial_value, output);
+}
+
+
+
 
 /**
  * preludedb_sql_get_plugin_error:
@@ -1802,16 +3640,3 @@ const char *preludedb_sql_get_plugin_error(preludedb_sql_t *sql)
         return NULL;
 }
 
-
-
-void _preludedb_sql_enable_internal_transaction(preludedb_sql_t *sql)
-{
-        sql->internal_transaction_disabled = FALSE;
-}
-
-
-
-void _preludedb_sql_disable_internal_transaction(preludedb_sql_t *sql)
-{
-        sql->internal_transaction_disabled = TRUE;
-}
@@ -26,9 +26,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <libprelude/prelude.h>
 
+#include "glthread/lock.h"
 
 #include "preludedb-error.h"
 #include "preludedb-sql-settings.h"
@@ -44,11 +46,26 @@
 #define PRELUDEDB_ENOTSUP(x) preludedb_error_verbose(prelude_error_code_from_errno(ENOSYS), "Database format does not support '%s' operation", x)
 
 
+typedef struct preludedb_cache preludedb_cache_t;
+
+
 struct preludedb {
         int refcount;
         char *format_version;
         preludedb_sql_t *sql;
         preludedb_plugin_format_t *plugin;
+
+        /*
+         * Number of messages inserted or deleted since the last
+         * optimization, used to skip tables that did not change.
+         */
+        gl_lock_t modification_lock;
+        unsigned long modification_count[4];
+
+        /*
+         * Decoded alerts, if the "alert_cache_size" setting enables it.
+         */
+        preludedb_cache_t *alert_cache;
 };
 
 struct preludedb_result_idents {
@@ -57,6 +74,17 @@ struct preludedb_result_idents {
         int refcount;
 };
 
+struct preludedb_lazy_alert {
+        preludedb_t *db;
+        uint64_t ident;
+        idmef_message_t *message;
+
+        /*
+         * Subtrees fetched so far, as reported by the format plugin.
+         */
+        unsigned int fetched;
+};
+
 struct preludedb_result_values {
         int refcount;
         preludedb_t *db;
@@ -68,8 +96,158 @@ preludedb_plugin_format_t *_preludedb_get_plugin_format(preludedb_t *db);
 int _preludedb_sql_transaction_start(preludedb_sql_t *sql);
 int _preludedb_sql_transaction_end(preludedb_sql_t *sql);
 int _preludedb_sql_transaction_abort(preludedb_sql_t *sql);
-void _preludedb_sql_enable_internal_transaction(preludedb_sql_t *sql);
-void _preludedb_sql_disable_internal_transaction(preludedb_sql_t *sql);
+
+int _preludedb_cache_new(preludedb_cache_t **cache, size_t size);
+void _preludedb_cache_destroy(preludedb_cache_t *cache);
+idmef_message_t *_preludedb_cache_get(preludedb_cache_t *cache, uint64_t ident, unsigned long *generation);
+void _preludedb_cache_add(preludedb_cache_t *cache, uint64_t ident, idmef_message_t *message, unsigned long generation);
+void _preludedb_cache_remove(preludedb_cache_t *cache, uint64_t ident);
+void _preludedb_cache_clear(preludedb_cache_t *cache);
+uint64_t _preludedb_cache_get_hit_count(preludedb_cache_t *cache);
+uint64_t _preludedb_cache_get_miss_count(preludedb_cache_t *cache);
+
+void _preludedb_path_selection_cache_clear(void);
+
+
+
+static void add_modification(preludedb_t *db, preludedb_modification_type_t type, ssize_t count)
+{
+        if ( count <= 0 )
+                return;
+
+        gl_lock_lock(db->modification_lock);
+        db->modification_count[type] += count;
+        gl_lock_unlock(db->modification_lock);
+}
+
+
+
+/*
+ * Remove the alerts of @idents from the cache, or every alert if @idents
+ * is NULL.
+ */
+static void remove_alerts(preludedb_t *db, const uint64_t *idents, size_t isize)
+{
+        size_t i;
+
+        if ( ! idents ) {
+                _preludedb_cache_clear(db->alert_cache);
+                return;
+        }
+
+        for ( i = 0; i < isize; i++ )
+                _preludedb_cache_remove(db->alert_cache, idents[i]);
+}
+
+
+
+typedef struct {
+        preludedb_t *db;
+        uint64_t *idents;
+        size_t isize;
+} pending_invalidation_t;
+
+
+
+static void transaction_ended_cb(preludedb_sql_t *sql, prelude_bool_t committed, void *data)
+{
+        pending_invalidation_t *pending = data;
+
+        remove_alerts(pending->db, pending->idents, pending->isize);
+
+        free(pending->idents);
+        free(pending);
+}
+
+
+
+/*
+ * Within a transaction of the caller, other threads keep reading the rows
+ * it modified, and may cache them again, until it is committed: the alerts
+ * are then removed from the cache once more when it ends.
+ */
+static void invalidate_alerts(preludedb_t *db, const uint64_t *idents, size_t isize)
+{
+        int ret;
+        pending_invalidation_t *pending;
+
+        if ( ! db->alert_cache )
+                return;
+
+        remove_alerts(db, idents, isize);
+
+        pending = calloc(1, sizeof(*pending));
+        if ( ! pending )
+                return;
+
+        pending->db = db;
+        pending->isize = isize;
+
+        if ( idents ) {
+                pending->idents = malloc(isize * sizeof(*idents));
+                if ( ! pending->idents ) {
+                        free(pending);
+                        return;
+                }
+
+                memcpy(pending->idents, idents, isize * sizeof(*idents));
+        }
+
+        ret = preludedb_sql_transaction_add_callback(db->sql, transaction_ended_cb, pending);
+        if ( ret < 0 ) {
+                free(pending->idents);
+                free(pending);
+        }
+}
+
+
+
+static void invalidate_alert_from_result_idents(preludedb_t *db, preludedb_result_idents_t *result)
+{
+        uint64_t *idents;
+        unsigned int i, count;
+
+        if ( ! db->alert_cache )
+                return;
+
+        count = preludedb_result_idents_get_count(result);
+        if ( ! count )
+                return;
+
+        idents = malloc(count * sizeof(*idents));
+        if ( ! idents ) {
+                invalidate_alerts(db, NULL, 0);
+                return;
+        }
+
+        for ( i = 0; i < count && preludedb_result_idents_get(result, i, &idents[i]) > 0; i++ );
+
+        invalidate_alerts(db, idents, i);
+        free(idents);
+}
+
+
+
+static int init_alert_cache(preludedb_t *db)
+{
+        char *eptr;
+        const char *str;
+        unsigned long size;
+
+        str = preludedb_sql_settings_get(preludedb_sql_get_settings(db->sql), PRELUDEDB_SQL_SETTING_ALERT_CACHE_SIZE);
+        if ( ! str )
+                return 0;
+
+        size = strtoul(str, &eptr, 10);
+        if ( eptr == str || *eptr )
+                return preludedb_error_verbose(PRELUDEDB_ERROR_INVALID_SETTINGS_STRING,
+                                               "invalid value '%s' for setting '%s'", str, PRELUDEDB_SQL_SETTING_ALERT_CACHE_SIZE);
+
+        if ( size == 0 )
+                return 0;
+
+        return _preludedb_cache_new(&db->alert_cache, size);
+}
 
 
 
@@ -123,6 +301,8 @@ void preludedb_deinit(void)
         if ( --libpreludedb_refcount > 0 )
                 return;
 
+        _preludedb_path_selection_cache_clear();
+
         iter = NULL;
         while ( (pl = prelude_plugin_get_next(&_sql_plugin_list, &iter)) ) {
                 prelude_plugin_unload(pl);
@@ -216,6 +396,7 @@ int preludedb_new(preludedb_t **db, preludedb_sql_t *sql, const char *format_nam
 
         (*db)->refcount = 1;
         (*db)->sql = preludedb_sql_ref(sql);
+        gl_lock_init((*db)->modification_lock);
 
         if ( format_name )
                 ret = preludedb_set_format(*db, format_name);
@@ -225,6 +406,9 @@ int preludedb_new(preludedb_t **db, preludedb_sql_t *sql, const char *format_nam
         if ( ret >= 0 && (*db)->plugin->init )
                 ret = (*db)->plugin->init(*db);
 
+        if ( ret >= 0 )
+                ret = init_alert_cache(*db);
+
         if ( ret < 0 ) {
                 if ( errbuf )
                         preludedb_get_error(*db, ret, errbuf, size);
@@ -232,6 +416,10 @@ int preludedb_new(preludedb_t **db, preludedb_sql_t *sql, const char *format_nam
                 if ( (*db)->format_version )
                         free((*db)->format_version);
 
+                if ( (*db)->alert_cache )
+                        _preludedb_cache_destroy((*db)->alert_cache);
+
+                gl_lock_destroy((*db)->modification_lock);
                 free(*db);
         }
 
@@ -261,8 +449,12 @@ void preludedb_destroy(preludedb_t *db)
         if ( --db->refcount != 0 )
                 return;
 
+        if ( db->alert_cache )
+                _preludedb_cache_destroy(db->alert_cache);
+
         preludedb_sql_destroy(db->sql);
         free(db->format_version);
+        gl_lock_destroy(db->modification_lock);
         free(db);
 }
 
@@ -374,9 +566,21 @@ char *preludedb_get_error(preludedb_t *db, preludedb_error_t error, char *errbuf
  */
 int preludedb_insert_message(preludedb_t *db, idmef_message_t *message)
 {
+        int ret;
+
         prelude_return_val_if_fail(db && message, prelude_error(PRELUDE_ERROR_ASSERTION));
 
-        return db->plugin->insert_message(db, message);
+        ret = db->plugin->insert_message(db, message);
+        if ( ret < 0 )
+                return ret;
+
+        if ( idmef_message_get_type(message) == IDMEF_MESSAGE_TYPE_ALERT )
+                add_modification(db, PRELUDEDB_MODIFICATION_ALERT_INSERT, 1);
+
+        else if ( idmef_message_get_type(message) == IDMEF_MESSAGE_TYPE_HEARTBEAT )
+                add_modification(db, PRELUDEDB_MODIFICATION_HEARTBEAT_INSERT, 1);
+
+        return ret;
 }
 
 
@@ -615,12 +819,127 @@ int preludedb_get_heartbeat_idents(preludedb_t *db,
  * @ident: Internal database ident of the alert.
  * @message: Pointer to an idmef message object where the retrieved message will be stored.
  *
+ * If the "alert_cache_size" setting enables the alert cache, @message
+ * may be a copy of a cached alert.
+ *
  * Returns: 0 on success or a negative value if an error occur.
  */
 int preludedb_get_alert(preludedb_t *db, uint64_t ident, idmef_message_t **message)
 {
+        int ret;
+        unsigned long generation;
+
         prelude_return_val_if_fail(db && message, prelude_error(PRELUDE_ERROR_ASSERTION));
-        return db->plugin->get_alert(db, ident, message);
+
+        if ( ! db->alert_cache )
+                return db->plugin->get_alert(db, ident, message);
+
+        *message = _preludedb_cache_get(db->alert_cache, ident, &generation);
+        if ( *message )
+                return 0;
+
+        ret = db->plugin->get_alert(db, ident, message);
+        if ( ret >= 0 )
+                _preludedb_cache_add(db->alert_cache, ident, *message, generation);
+
+        return ret;
+}
+
+
+
+static int get_alerts_one_by_one(preludedb_t *db, const uint64_t *idents, size_t count, idmef_message_t **messages)
+{
+        int ret;
+        size_t i;
+
+        for ( i = 0; i < count; i++ ) {
+                ret = preludedb_get_alert(db, idents[i], &messages[i]);
+                if ( ret < 0 ) {
+                        while ( i-- )
+                                idmef_message_destroy(messages[i]);
+
+                        return ret;
+                }
+        }
+
+        return 0;
+}
+
+
+
+/**
+ * preludedb_get_alerts:
+ * @db: Pointer to a db object.
+ * @idents: Internal database idents of the alerts.
+ * @count: Number of idents in @idents.
+ * @messages: Array of @count idmef message pointers where the retrieved messages will be stored.
+ *
+ * Retrieve several alerts at once, in the order of @idents. Plugins
+ * supporting it read each of their tables once for the whole set of
+ * alerts, rather than once per alert. Alerts found in the alert cache
+ * are not retrieved again, and are copied as with preludedb_get_alert().
+ *
+ * Returns: 0 on success or a negative value if an error occur, in which
+ * case no message is returned.
+ */
+int preludedb_get_alerts(preludedb_t *db, const uint64_t *idents, size_t count, idmef_message_t **messages)
+{
+        int ret = 0;
+        size_t i, j, nmissing = 0;
+        uint64_t *missing = NULL;
+        unsigned long *generations = NULL;
+        idmef_message_t **fetched = NULL;
+
+        prelude_return_val_if_fail(db && (idents || count == 0) && (messages || count == 0), prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! db->plugin->get_alerts )
+                return get_alerts_one_by_one(db, idents, count, messages);
+
+        if ( count == 0 )
+                return 0;
+
+        missing = malloc(count * sizeof(*missing));
+        generations = malloc(count * sizeof(*generations));
+        fetched = malloc(count * sizeof(*fetched));
+        if ( ! missing || ! generations || ! fetched ) {
+                ret = preludedb_error_from_errno(errno);
+                goto out;
+        }
+
+        for ( i = 0; i < count; i++ ) {
+                messages[i] = (db->alert_cache) ? _preludedb_cache_get(db->alert_cache, idents[i], &generations[i]) : NULL;
+                if ( ! messages[i] )
+                        missing[nmissing++] = idents[i];
+        }
+
+        if ( nmissing > 0 ) {
+                ret = db->plugin->get_alerts(db, missing, nmissing, fetched);
+                if ( ret < 0 ) {
+                        for ( i = 0; i < count; i++ ) {
+                                if ( messages[i] )
+                                        idmef_message_destroy(messages[i]);
+                        }
+
+                        goto out;
+                }
+        }
+
+        for ( i = 0, j = 0; i < count; i++ ) {
+                if ( messages[i] )
+                        continue;
+
+                messages[i] = fetched[j++];
+
+                if ( db->alert_cache )
+                        _preludedb_cache_add(db->alert_cache, idents[i], messages[i], generations[i]);
+        }
+
+ out:
+        free(missing);
+        free(generations);
+        free(fetched);
+
+        return ret;
 }
 
 
@@ -640,6 +959,137 @@ int preludedb_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **m
 }
 
 
+
+/**
+ * preludedb_get_alert_paths:
+ * @db: Pointer to a db object.
+ * @ident: Internal database ident of the alert.
+ * @paths: Array of alert paths to populate.
+ * @size: Number of paths in @paths.
+ * @message: Pointer to an idmef message object where the retrieved message will be stored.
+ *
+ * Retrieve the part of an alert needed to populate @paths, leaving the
+ * subtrees nothing in @paths refers to empty. This is much cheaper than
+ * preludedb_get_alert() when only a few paths are needed. Plugins not
+ * supporting it retrieve the whole alert.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_get_alert_paths(preludedb_t *db, uint64_t ident,
+                              const idmef_path_t * const *paths, size_t size, idmef_message_t **message)
+{
+        unsigned int fetched = 0;
+
+        prelude_return_val_if_fail(db && message, prelude_error(PRELUDE_ERROR_ASSERTION));
+        prelude_return_val_if_fail(paths || size == 0, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! db->plugin->get_alert_paths )
+                return db->plugin->get_alert(db, ident, message);
+
+        *message = NULL;
+
+        return db->plugin->get_alert_paths(db, ident, paths, size, message, &fetched);
+}
+
+
+
+/**
+ * preludedb_lazy_alert_new:
+ * @alert: Where the new lazy alert will be stored.
+ * @db: Pointer to a db object.
+ * @ident: Internal database ident of the alert.
+ *
+ * Create an alert whose subtrees are only retrieved from @db when first
+ * accessed through preludedb_lazy_alert_get_value(). @db must remain
+ * valid for the lifetime of @alert.
+ *
+ * Returns: 0 on success or a negative value if an error occur.
+ */
+int preludedb_lazy_alert_new(preludedb_lazy_alert_t **alert, preludedb_t *db, uint64_t ident)
+{
+        int ret;
+
+        prelude_return_val_if_fail(alert && db, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        *alert = malloc(sizeof(**alert));
+        if ( ! *alert )
+                return preludedb_error_from_errno(errno);
+
+        (*alert)->db = db;
+        (*alert)->ident = ident;
+        (*alert)->fetched = 0;
+        (*alert)->message = NULL;
+
+        if ( db->plugin->get_alert_paths )
+                ret = db->plugin->get_alert_paths(db, ident, NULL, 0, &(*alert)->message, &(*alert)->fetched);
+        else
+                ret = db->plugin->get_alert(db, ident, &(*alert)->message);
+
+        if ( ret < 0 )
+                free(*alert);
+
+        return ret;
+}
+
+
+
+/**
+ * preludedb_lazy_alert_destroy:
+ * @alert: Pointer to a lazy alert.
+ *
+ * Destroy @alert, and release its message.
+ */
+void preludedb_lazy_alert_destroy(preludedb_lazy_alert_t *alert)
+{
+        prelude_return_if_fail(alert);
+
+        idmef_message_destroy(alert->message);
+        free(alert);
+}
+
+
+
+/**
+ * preludedb_lazy_alert_get_value:
+ * @alert: Pointer to a lazy alert.
+ * @path: Alert path to retrieve.
+ * @value: Where the value of @path will be stored.
+ *
+ * Retrieve the value of @path, fetching the subtree it belongs to from
+ * the database if it was not accessed yet.
+ *
+ * Returns: 1 if @path is set, 0 if it is not, or a negative value if an error occur.
+ */
+int preludedb_lazy_alert_get_value(preludedb_lazy_alert_t *alert, const idmef_path_t *path, idmef_value_t **value)
+{
+        int ret;
+
+        prelude_return_val_if_fail(alert && path && value, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( alert->db->plugin->get_alert_paths ) {
+                ret = alert->db->plugin->get_alert_paths(alert->db, alert->ident, &path, 1, &alert->message, &alert->fetched);
+                if ( ret < 0 )
+                        return ret;
+        }
+
+        return idmef_path_get(path, alert->message, value);
+}
+
+
+
+/**
+ * preludedb_lazy_alert_get_message:
+ * @alert: Pointer to a lazy alert.
+ *
+ * Returns: the message of @alert, populated with the subtrees accessed so far.
+ */
+idmef_message_t *preludedb_lazy_alert_get_message(preludedb_lazy_alert_t *alert)
+{
+        prelude_return_val_if_fail(alert, NULL);
+        return alert->message;
+}
+
+
 /**
  * preludedb_delete_alert:
  * @db: Pointer to a db object.
@@ -651,8 +1101,17 @@ int preludedb_get_heartbeat(preludedb_t *db, uint64_t ident, idmef_message_t **m
  */
 int preludedb_delete_alert(preludedb_t *db, uint64_t ident)
 {
+        int ret;
+
         prelude_return_val_if_fail(db, prelude_error(PRELUDE_ERROR_ASSERTION));
-        return db->plugin->delete_alert(db, ident);
+
+        ret = db->plugin->delete_alert(db, ident);
+        if ( ret >= 0 )
+                add_modification(db, PRELUDEDB_MODIFICATION_ALERT_DELETE, 1);
+
+        invalidate_alerts(db, &ident, 1);
+
+        return ret;
 }
 
 
@@ -668,12 +1127,18 @@ int preludedb_delete_alert(preludedb_t *db, uint64_t ident)
  */
 ssize_t preludedb_delete_alert_from_list(preludedb_t *db, uint64_t *idents, size_t isize)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         if ( isize == 0 )
                 return 0;
 
-        return _preludedb_plugin_format_delete_alert_from_list(db->plugin, db, idents, isize);
+        ret = _preludedb_plugin_format_delete_alert_from_list(db->plugin, db, idents, isize);
+        add_modification(db, PRELUDEDB_MODIFICATION_ALERT_DELETE, ret);
+        invalidate_alerts(db, idents, isize);
+
+        return ret;
 }
 
 
@@ -688,8 +1153,15 @@ ssize_t preludedb_delete_alert_from_list(preludedb_t *db, uint64_t *idents, size
  */
 ssize_t preludedb_delete_alert_from_result_idents(preludedb_t *db, preludedb_result_idents_t *result)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db && result, prelude_error(PRELUDE_ERROR_ASSERTION));
-        return _preludedb_plugin_format_delete_alert_from_result_idents(db->plugin, db, result);
+
+        ret = _preludedb_plugin_format_delete_alert_from_result_idents(db->plugin, db, result);
+        add_modification(db, PRELUDEDB_MODIFICATION_ALERT_DELETE, ret);
+        invalidate_alert_from_result_idents(db, result);
+
+        return ret;
 }
 
 
@@ -705,8 +1177,15 @@ ssize_t preludedb_delete_alert_from_result_idents(preludedb_t *db, preludedb_res
  */
 int preludedb_delete_heartbeat(preludedb_t *db, uint64_t ident)
 {
+        int ret;
+
         prelude_return_val_if_fail(db, prelude_error(PRELUDE_ERROR_ASSERTION));
-        return db->plugin->delete_heartbeat(db, ident);
+
+        ret = db->plugin->delete_heartbeat(db, ident);
+        if ( ret >= 0 )
+                add_modification(db, PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE, 1);
+
+        return ret;
 }
 
 
@@ -722,12 +1201,17 @@ int preludedb_delete_heartbeat(preludedb_t *db, uint64_t ident)
  */
 ssize_t preludedb_delete_heartbeat_from_list(preludedb_t *db, uint64_t *idents, size_t isize)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         if ( isize == 0 )
                 return 0;
 
-        return _preludedb_plugin_format_delete_heartbeat_from_list(db->plugin, db, idents, isize);
+        ret = _preludedb_plugin_format_delete_heartbeat_from_list(db->plugin, db, idents, isize);
+        add_modification(db, PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE, ret);
+
+        return ret;
 }
 
 
@@ -743,8 +1227,14 @@ ssize_t preludedb_delete_heartbeat_from_list(preludedb_t *db, uint64_t *idents,
  */
 ssize_t preludedb_delete_heartbeat_from_result_idents(preludedb_t *db, preludedb_result_idents_t *result)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db && result, prelude_error(PRELUDE_ERROR_ASSERTION));
-        return _preludedb_plugin_format_delete_heartbeat_from_result_idents(db->plugin, db, result);
+
+        ret = _preludedb_plugin_format_delete_heartbeat_from_result_idents(db->plugin, db, result);
+        add_modification(db, PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE, ret);
+
+        return ret;
 }
 
 
@@ -839,12 +1329,17 @@ ssize_t preludedb_update_from_list(preludedb_t *db,
                                    const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
                                    uint64_t *idents, size_t isize)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db && paths && values, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         if ( ! db->plugin->update_from_list )
                 return preludedb_error_from_errno(ENOSYS);
 
-        return db->plugin->update_from_list(db, paths, values, pvsize, idents, isize);
+        ret = db->plugin->update_from_list(db, paths, values, pvsize, idents, isize);
+        invalidate_alerts(db, idents, isize);
+
+        return ret;
 }
 
 
@@ -852,12 +1347,17 @@ ssize_t preludedb_update_from_result_idents(preludedb_t *db,
                                             const idmef_path_t * const *paths, const idmef_value_t * const *values, size_t pvsize,
                                             preludedb_result_idents_t *result)
 {
+        ssize_t ret;
+
         prelude_return_val_if_fail(db && paths && values && result, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         if ( ! db->plugin->update_from_result_idents )
                 return PRELUDEDB_ENOTSUP("update_from_result_ident");
 
-        return db->plugin->update_from_result_idents(db, paths, values, pvsize, result);
+        ret = db->plugin->update_from_result_idents(db, paths, values, pvsize, result);
+        invalidate_alert_from_result_idents(db, result);
+
+        return ret;
 }
 
 
@@ -883,12 +1383,21 @@ int preludedb_update(preludedb_t *db,
                      preludedb_path_selection_t *order,
                      int limit, int offset)
 {
+        int ret;
+
         prelude_return_val_if_fail(db && paths && values, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         if ( ! db->plugin->update )
                 return PRELUDEDB_ENOTSUP("update");
 
-        return db->plugin->update(db, paths, values, pvsize, criteria, order, limit, offset);
+        ret = db->plugin->update(db, paths, values, pvsize, criteria, order, limit, offset);
+
+        /*
+         * The updated idents are unknown.
+         */
+        invalidate_alerts(db, NULL, 0);
+
+        return ret;
 }
 
 
@@ -913,30 +1422,127 @@ int preludedb_optimize(preludedb_t *db)
 
 
 
+/**
+ * preludedb_get_index_advice:
+ * @db: Pointer to a db object.
+ * @max: Maximum number of recommendations.
+ * @output: Where the recommendations will be stored.
+ *
+ * Recommend indexes for the most frequent criteria shapes seen by
+ * the format plugin since it was loaded. Each recommendation is a comment
+ * line giving the number of queries it would have served, followed by the
+ * statement creating the index, on a line of its own.
+ *
+ * Returns: the number of recommendations, or a negative value if an error occurred.
+ */
+int preludedb_get_index_advice(preludedb_t *db, unsigned int max, prelude_string_t *output)
+{
+        prelude_return_val_if_fail(db && output, prelude_error(PRELUDE_ERROR_ASSERTION));
+
+        if ( ! db->plugin->get_index_advice )
+                return PRELUDEDB_ENOTSUP("get_index_advice");
+
+        return db->plugin->get_index_advice(db, max, output);
+}
+
+
+
+/**
+ * preludedb_get_modification_count:
+ * @db: Pointer to a db object.
+ * @type: Type of modification.
+ *
+ * Returns: the number of messages inserted or deleted through @db, as selected
+ * by @type, since @db was created or since the count was last reset.
+ */
+unsigned long preludedb_get_modification_count(preludedb_t *db, preludedb_modification_type_t type)
+{
+        unsigned long count;
+
+        prelude_return_val_if_fail(db, 0);
+        prelude_return_val_if_fail(type <= PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE, 0);
+
+        gl_lock_lock(db->modification_lock);
+        count = db->modification_count[type];
+        gl_lock_unlock(db->modification_lock);
+
+        return count;
+}
+
+
+
+/**
+ * preludedb_reset_modification_count:
+ * @db: Pointer to a db object.
+ * @type: Type of modification.
+ * @count: Value previously returned by preludedb_get_modification_count().
+ *
+ * Subtract @count from the modification count of @type, so that
+ * modifications happening while the caller processed them are kept.
+ */
+void preludedb_reset_modification_count(preludedb_t *db, preludedb_modification_type_t type, unsigned long count)
+{
+        prelude_return_if_fail(db);
+        prelude_return_if_fail(type <= PRELUDEDB_MODIFICATION_HEARTBEAT_DELETE);
+
+        gl_lock_lock(db->modification_lock);
+        if ( count > db->modification_count[type] )
+                count = db->modification_count[type];
+
+        db->modification_count[type] -= count;
+        gl_lock_unlock(db->modification_lock);
+}
+
+
+
+
+/**
+ * preludedb_get_alert_cache_hit_count:
+ * @db: Pointer to a db object.
+ *
+ * Returns: the number of preludedb_get_alert() calls served from the alert
+ * cache of @db, or 0 if it has none.
+ */
+uint64_t preludedb_get_alert_cache_hit_count(preludedb_t *db)
+{
+        prelude_return_val_if_fail(db, 0);
+        return db->alert_cache ? _preludedb_cache_get_hit_count(db->alert_cache) : 0;
+}
+
+
+
+/**
+ * preludedb_get_alert_cache_miss_count:
+ * @db: Pointer to a db object.
+ *
+ * Returns: the number of preludedb_get_alert() calls the alert cache of
+ * @db could not serve, or 0 if it has none.
+ */
+uint64_t preludedb_get_alert_cache_miss_count(preludedb_t *db)
+{
+        prelude_return_val_if_fail(db, 0);
+        return db->alert_cache ? _preludedb_cache_get_miss_count(db->alert_cache) : 0;
+}
+
+
 
 /**
  * preludedb_transaction_start:
  * @db: Pointer to a #preludedb_t object.
  *
- * Begin a transaction using @db object. Internal transaction
- * handling will be disabled until preludedb_transaction_end()
- * or preludedb_transaction_abort() is called.
+ * Begin a transaction using @db object. Operations the calling
+ * thread performs on @db are part of the transaction, and their
+ * internal transaction handling is disabled, until preludedb_transaction_end()
+ * or preludedb_transaction_abort() is called. Other threads using @db
+ * are not affected.
  *
  * Returns: 0 on success or a negative value if an error occur.
  */
 int preludedb_transaction_start(preludedb_t *db)
 {
-        int ret;
-
         prelude_return_val_if_fail(db && db->sql, prelude_error(PRELUDE_ERROR_ASSERTION));
 
-        ret = _preludedb_sql_transaction_start(db->sql);
-        if ( ret < 0 )
-                return ret;
-
-        _preludedb_sql_disable_internal_transaction(db->sql);
-
-        return ret;
+        return _preludedb_sql_transaction_start(db->sql);
 }
 
 
@@ -958,7 +1564,6 @@ int preludedb_transaction_end(preludedb_t *db)
         prelude_return_val_if_fail(db && db->sql, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         ret = _preludedb_sql_transaction_end(db->sql);
-        _preludedb_sql_enable_internal_transaction(db->sql);
 
         if ( ret < 0 )
                 return ret;
@@ -985,7 +1590,6 @@ int preludedb_transaction_abort(preludedb_t *db)
         prelude_return_val_if_fail(db && db->sql, prelude_error(PRELUDE_ERROR_ASSERTION));
 
         ret = _preludedb_sql_transaction_abort(db->sql);
-        _preludedb_sql_enable_internal_transaction(db->sql);
 
         if ( ret < 0 )
                 return ret;
@@ -0,0 +1,163 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb-error.h"
+#include "preludedb-sql-settings.h"
+#include "preludedb-sql.h"
+
+#include "classic-compress.h"
+
+#include "tests.h"
+
+
+#define HEADER_SIZE 8
+#define TEXT_SIZE 10000
+
+
+
+static unsigned char *compress_value(classic_compress_algorithm_t algorithm, const unsigned char *input, size_t size,
+                                     classic_compress_algorithm_t stored, size_t *outsize)
+{
+        unsigned char *output;
+
+        ASSERT(classic_compress(algorithm, NULL, input, size, &output, outsize) == 0);
+        ASSERT(*outsize >= HEADER_SIZE);
+        ASSERT(output[3] == stored);
+
+        return output;
+}
+
+
+
+static void test_roundtrip(classic_compress_algorithm_t algorithm, const unsigned char *input, size_t size,
+                           classic_compress_algorithm_t stored)
+{
+        size_t outsize, len;
+        unsigned char *output, *value;
+
+        output = compress_value(algorithm, input, size, stored, &outsize);
+        if ( stored == CLASSIC_COMPRESS_NONE )
+                ASSERT(outsize == HEADER_SIZE + size);
+        else
+                ASSERT(outsize < size);
+
+        ASSERT(classic_decompress(NULL, output, outsize, &value, &len) == 1);
+        ASSERT(len == size);
+        ASSERT(memcmp(value, input, size) == 0);
+        ASSERT(value[len] == 0);
+
+        free(value);
+        free(output);
+}
+
+
+
+/*
+ * Values whose header or data do not decode are read back as is.
+ */
+static void test_invalid(classic_compress_algorithm_t algorithm, const unsigned char *input, size_t size)
+{
+        size_t outsize, len;
+        unsigned char *output, *value = NULL;
+
+        output = compress_value(algorithm, input, size, algorithm, &outsize);
+
+        ASSERT(classic_decompress(NULL, output, outsize - 1, &value, &len) == 0);
+        ASSERT(value == NULL);
+
+        memset(output + 4, 0xff, 4);
+        ASSERT(classic_decompress(NULL, output, outsize, &value, &len) == 0);
+        ASSERT(value == NULL);
+
+        free(output);
+}
+
+
+
+static void test_no_header(const unsigned char *text)
+{
+        size_t outsize, len;
+        unsigned char *output, *value = NULL;
+
+        ASSERT(classic_decompress(NULL, text, TEXT_SIZE, &value, &len) == 0);
+        ASSERT(classic_decompress(NULL, (const unsigned char *) "\xffPZ", 3, &value, &len) == 0);
+        ASSERT(value == NULL);
+
+        output = compress_value(CLASSIC_COMPRESS_NONE, text, 100, CLASSIC_COMPRESS_NONE, &outsize);
+
+        output[7]++;
+        ASSERT(classic_decompress(NULL, output, outsize, &value, &len) == 0);
+        output[7]--;
+
+        output[3] = 0x7f;
+        ASSERT(classic_decompress(NULL, output, outsize, &value, &len) == 0);
+        ASSERT(value == NULL);
+
+        free(output);
+}
+
+
+
+int main(void)
+{
+        size_t i;
+        unsigned int seed = 1;
+        classic_compress_algorithm_t algorithm;
+        unsigned char text[TEXT_SIZE], noise[64];
+        const char sentence[] = "alert classification source target node address 10.0.0.1 ";
+
+        for ( i = 0; i < sizeof(text); i++ )
+                text[i] = sentence[i % (sizeof(sentence) - 1)];
+
+        for ( i = 0; i < sizeof(noise); i++ )
+                noise[i] = test_random(&seed);
+
+        ASSERT(classic_compress_algorithm_from_string("none", &algorithm) == 0);
+        ASSERT(algorithm == CLASSIC_COMPRESS_NONE);
+        ASSERT(classic_compress_algorithm_from_string("bogus", &algorithm) < 0);
+
+        test_roundtrip(CLASSIC_COMPRESS_NONE, text, 0, CLASSIC_COMPRESS_NONE);
+        test_roundtrip(CLASSIC_COMPRESS_NONE, text, sizeof(text), CLASSIC_COMPRESS_NONE);
+        test_no_header(text);
+
+        if ( classic_compress_algorithm_from_string("lz4", &algorithm) == 0 ) {
+                test_roundtrip(algorithm, text, sizeof(text), CLASSIC_COMPRESS_LZ4);
+                test_roundtrip(algorithm, noise, sizeof(noise), CLASSIC_COMPRESS_NONE);
+                test_invalid(algorithm, text, sizeof(text));
+        }
+
+        if ( classic_compress_algorithm_from_string("zstd", &algorithm) == 0 ) {
+                test_roundtrip(algorithm, text, sizeof(text), CLASSIC_COMPRESS_ZSTD);
+                test_roundtrip(algorithm, noise, sizeof(noise), CLASSIC_COMPRESS_NONE);
+                test_invalid(algorithm, text, sizeof(text));
+        }
+
+        return 0;
+}
@@ -0,0 +1,152 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <libprelude/prelude.h>
+
+#include "classic-sketch.h"
+
+#include "tests.h"
+
+
+/*
+ * With 4096 registers, the standard error of the HyperLogLog estimate
+ * is about 1.6%: allow three times as much.
+ */
+#define HLL_MAX_ERROR 0.05
+
+
+
+static void test_hll_empty(void)
+{
+        ASSERT(classic_hll_estimate(NULL) == 0);
+}
+
+
+
+static void test_hll(unsigned int count)
+{
+        char buf[32];
+        unsigned int i;
+        double estimate;
+        uint8_t *registers = NULL;
+
+        for ( i = 0; i < count; i++ ) {
+                snprintf(buf, sizeof(buf), "value-%u", i);
+                ASSERT(classic_hll_add(&registers, buf, strlen(buf)) == 0);
+        }
+
+        estimate = classic_hll_estimate(registers);
+        ASSERT(fabs(estimate - count) <= count * HLL_MAX_ERROR);
+
+        /*
+         * Values seen already leave the estimate unchanged.
+         */
+        for ( i = 0; i < count; i += 3 ) {
+                snprintf(buf, sizeof(buf), "value-%u", i);
+                ASSERT(classic_hll_add(&registers, buf, strlen(buf)) == 0);
+        }
+
+        ASSERT(classic_hll_estimate(registers) == estimate);
+
+        free(registers);
+}
+
+
+
+static void test_p2_exact(void)
+{
+        classic_p2_t p2;
+
+        memset(&p2, 0, sizeof(p2));
+
+        classic_p2_add(&p2, 0.5, 4);
+        ASSERT(classic_p2_get(&p2, 0.5) == 4);
+
+        classic_p2_add(&p2, 0.5, 1);
+        classic_p2_add(&p2, 0.5, 3);
+        classic_p2_add(&p2, 0.5, 2);
+
+        /*
+         * Less than 5 values: interpolated as percentile_cont() does.
+         */
+        ASSERT(classic_p2_get(&p2, 0) == 1);
+        ASSERT(classic_p2_get(&p2, 0.5) == 2.5);
+        ASSERT(classic_p2_get(&p2, 0.75) == 3.25);
+        ASSERT(classic_p2_get(&p2, 1) == 4);
+}
+
+
+
+static void test_p2(double quantile)
+{
+        classic_p2_t p2;
+        unsigned int i, j, tmp, seed = 1;
+        static unsigned int values[10001];
+        const unsigned int count = sizeof(values) / sizeof(*values);
+
+        /*
+         * Shuffled 0 .. 10000, so that the exact result is 10000 * quantile.
+         */
+        for ( i = 0; i < count; i++ )
+                values[i] = i;
+
+        for ( i = count - 1; i > 0; i-- ) {
+                j = ((test_random(&seed) << 15) | test_random(&seed)) % (i + 1);
+                tmp = values[i];
+                values[i] = values[j];
+                values[j] = tmp;
+        }
+
+        memset(&p2, 0, sizeof(p2));
+
+        for ( i = 0; i < count; i++ )
+                classic_p2_add(&p2, quantile, values[i]);
+
+        ASSERT(p2.count == count);
+        ASSERT(classic_p2_get(&p2, 0) == 0);
+        ASSERT(classic_p2_get(&p2, 1) == count - 1);
+        ASSERT(fabs(classic_p2_get(&p2, quantile) - (count - 1) * quantile) <= (count - 1) * 0.02);
+}
+
+
+
+int main(void)
+{
+        test_hll_empty();
+        test_hll(10);
+        test_hll(1000);
+        test_hll(100000);
+
+        test_p2_exact();
+        test_p2(0.5);
+        test_p2(0.9);
+        test_p2(0.99);
+
+        return 0;
+}
@@ -0,0 +1,221 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libprelude/prelude.h>
+
+#include "preludedb.h"
+#include "preludedb-path-selection.h"
+
+#include "tests.h"
+
+
+int _preludedb_path_selection_fast_parse(preludedb_selected_path_t *root, const char *str);
+
+
+/*
+ * Selections the fast parser handles, which must give the same result
+ * as the flex/bison parser.
+ */
+static const char *fast_selections[] = {
+        "alert.messageid",
+        "alert.classification.text/group_by",
+        "alert.source(0).node.address(0).address/order_asc,group_by",
+        "heartbeat.analyzer(-1).name",
+        "alert.create_time:hour",
+        "count(alert.messageid)/order_desc",
+        "max(alert.create_time)",
+        "min(alert.assessment.impact.severity)",
+        "avg(alert.assessment.confidence.confidence)",
+        "approx_count_distinct(alert.source(0).node.address(0).address)",
+        "extract(alert.create_time, 'year')",
+        "extract(alert.create_time, \"quarter\")/group_by",
+        "interval(alert.create_time, 1, 'day')",
+        "timezone(alert.create_time, 'Europe/Paris')",
+        "topk(10, alert.classification.text)",
+        "percentile(95, alert.assessment.impact.severity)",
+        "count(extract(alert.create_time, 'hour'))",
+        "  alert.messageid  /  order_asc ",
+        "'a string'",
+        "42",
+};
+
+
+/*
+ * Selections the fast parser leaves to the flex/bison parser.
+ */
+static const char *fallback_selections[] = {
+        "timezone(alert.create_time, 'Europe\\/Paris')",
+        "count(alert.messageid) !",
+};
+
+
+static const char *invalid_selections[] = {
+        "",
+        "alert.nosuchpath",
+        "extract(alert.create_time, 'ye\\ar')",
+        "count(alert.messageid",
+        "count(alert.messageid))",
+        "alert.messageid/bogus",
+        "alert.messageid/",
+        "extract(alert.create_time, 'century')",
+        "topk(alert.classification.text, 10)",
+};
+
+
+
+static void compare_objects(preludedb_selected_object_t *o1, preludedb_selected_object_t *o2)
+{
+        size_t i;
+        preludedb_selected_object_t *a1, *a2;
+        preludedb_selected_object_type_t type = preludedb_selected_object_get_type(o1);
+
+        ASSERT(preludedb_selected_object_get_type(o2) == type);
+
+        switch ( type ) {
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_STRING:
+                ASSERT(strcmp(preludedb_selected_object_get_data(o1), preludedb_selected_object_get_data(o2)) == 0);
+                break;
+
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_INT:
+                ASSERT(*(const int *) preludedb_selected_object_get_data(o1) == *(const int *) preludedb_selected_object_get_data(o2));
+                break;
+
+        case PRELUDEDB_SELECTED_OBJECT_TYPE_IDMEFPATH:
+                ASSERT(strcmp(idmef_path_get_name(preludedb_selected_object_get_data(o1), -1),
+                              idmef_path_get_name(preludedb_selected_object_get_data(o2), -1)) == 0);
+                break;
+
+        default:
+                ASSERT(preludedb_selected_object_is_function(o1));
+
+                for ( i = 0; ; i++ ) {
+                        a1 = preludedb_selected_object_get_arg(o1, i);
+                        a2 = preludedb_selected_object_get_arg(o2, i);
+
+                        ASSERT((a1 == NULL) == (a2 == NULL));
+                        if ( ! a1 )
+                                break;
+
+                        compare_objects(a1, a2);
+                }
+
+                break;
+        }
+}
+
+
+
+static void test_fast(const char *str)
+{
+        preludedb_selected_path_t *fast, *reference;
+
+        ASSERT(preludedb_selected_path_new(&fast, NULL, 0) == 0);
+        ASSERT(preludedb_selected_path_new(&reference, NULL, 0) == 0);
+
+        if ( _preludedb_path_selection_fast_parse(fast, str) < 0 ) {
+                fprintf(stderr, "'%s' not handled by the fast parser\n", str);
+                abort();
+        }
+
+        ASSERT(preludedb_path_selection_parse(reference, str) >= 0);
+
+        compare_objects(preludedb_selected_path_get_object(fast), preludedb_selected_path_get_object(reference));
+        ASSERT(preludedb_selected_path_get_flags(fast) == preludedb_selected_path_get_flags(reference));
+
+        preludedb_selected_path_destroy(fast);
+        preludedb_selected_path_destroy(reference);
+}
+
+
+
+static void test_fast_rejects(const char *str)
+{
+        preludedb_selected_path_t *fast;
+
+        ASSERT(preludedb_selected_path_new(&fast, NULL, 0) == 0);
+        ASSERT(_preludedb_path_selection_fast_parse(fast, str) < 0);
+        ASSERT(preludedb_selected_path_get_object(fast) == NULL);
+
+        preludedb_selected_path_destroy(fast);
+}
+
+
+
+static void test_fallback(const char *str)
+{
+        preludedb_selected_path_t *selected, *reference;
+
+        test_fast_rejects(str);
+
+        ASSERT(preludedb_selected_path_new(&reference, NULL, 0) == 0);
+        ASSERT(preludedb_path_selection_parse(reference, str) >= 0);
+
+        ASSERT(preludedb_selected_path_new_string(&selected, str) >= 0);
+        compare_objects(preludedb_selected_path_get_object(selected), preludedb_selected_path_get_object(reference));
+        ASSERT(preludedb_selected_path_get_flags(selected) == preludedb_selected_path_get_flags(reference));
+
+        preludedb_selected_path_destroy(selected);
+        preludedb_selected_path_destroy(reference);
+}
+
+
+
+static void test_invalid(const char *str)
+{
+        preludedb_selected_path_t *selected, *reference;
+
+        test_fast_rejects(str);
+
+        ASSERT(preludedb_selected_path_new(&reference, NULL, 0) == 0);
+        ASSERT(preludedb_path_selection_parse(reference, str) < 0);
+        preludedb_selected_path_destroy(reference);
+
+        ASSERT(preludedb_selected_path_new_string(&selected, str) < 0);
+}
+
+
+
+int main(void)
+{
+        size_t i;
+
+        ASSERT(prelude_init(NULL, NULL) >= 0);
+
+        for ( i = 0; i < sizeof(fast_selections) / sizeof(*fast_selections); i++ )
+                test_fast(fast_selections[i]);
+
+        for ( i = 0; i < sizeof(fallback_selections) / sizeof(*fallback_selections); i++ )
+                test_fallback(fallback_selections[i]);
+
+        for ( i = 0; i < sizeof(invalid_selections) / sizeof(*invalid_selections); i++ )
+                test_invalid(invalid_selections[i]);
+
+        prelude_deinit();
+
+        return 0;
+}
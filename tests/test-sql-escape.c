@@ -0,0 +1,170 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libprelude/prelude.h>
+
+#include "tests.h"
+
+
+#define MAX_SIZE 200
+
+
+size_t _preludedb_sql_escape_span(const char *input, size_t size, prelude_bool_t quote_only);
+size_t _preludedb_sql_escape_write(char *output, const char *input, size_t size);
+int _preludedb_sql_escape_append(prelude_string_t *output, const char *input, size_t size);
+
+
+
+static size_t reference_escape(char *output, const char *input, size_t size)
+{
+        size_t i;
+        char *ptr = output;
+
+        *ptr++ = '\'';
+
+        for ( i = 0; i < size && input[i] != 0; i++ ) {
+                if ( input[i] == '\'' )
+                        *ptr++ = '\'';
+
+                *ptr++ = input[i];
+        }
+
+        *ptr++ = '\'';
+        *ptr = 0;
+
+        return ptr - output;
+}
+
+
+
+static void test_span(void)
+{
+        size_t size, pos, i;
+        char input[MAX_SIZE];
+        const char special[] = { '\'', 0, '\\', '"', '\n', '\r', '\032' };
+
+        memset(input, 'a', sizeof(input));
+
+        for ( size = 0; size <= MAX_SIZE; size++ ) {
+                ASSERT(_preludedb_sql_escape_span(input, size, TRUE) == size);
+                ASSERT(_preludedb_sql_escape_span(input, size, FALSE) == size);
+        }
+
+        for ( pos = 0; pos < MAX_SIZE; pos++ ) {
+                for ( i = 0; i < sizeof(special); i++ ) {
+                        input[pos] = special[i];
+
+                        ASSERT(_preludedb_sql_escape_span(input, MAX_SIZE, FALSE) == pos);
+                        ASSERT(_preludedb_sql_escape_span(input, pos, FALSE) == pos);
+
+                        /*
+                         * Only single quotes and NUL bytes matter to
+                         * backends with standard conforming strings.
+                         */
+                        ASSERT(_preludedb_sql_escape_span(input, MAX_SIZE, TRUE) == ((i < 2) ? pos : MAX_SIZE));
+                }
+
+                input[pos] = 'a';
+        }
+}
+
+
+
+static void test_write(void)
+{
+        size_t len;
+        char output[16];
+
+        ASSERT(_preludedb_sql_escape_write(output, "", 0) == 2);
+        ASSERT(strcmp(output, "''") == 0);
+
+        ASSERT(_preludedb_sql_escape_write(output, "it's", 4) == 7);
+        ASSERT(strcmp(output, "'it''s'") == 0);
+
+        ASSERT(_preludedb_sql_escape_write(output, "''", 2) == 6);
+        ASSERT(strcmp(output, "''''''") == 0);
+
+        /*
+         * A NUL byte ends the string.
+         */
+        len = _preludedb_sql_escape_write(output, "ab\0c'd", 6);
+        ASSERT(len == 4);
+        ASSERT(strcmp(output, "'ab'") == 0);
+
+        ASSERT(_preludedb_sql_escape_write(output, "a\\b", 3) == 5);
+        ASSERT(strcmp(output, "'a\\b'") == 0);
+}
+
+
+
+static void test_random_input(void)
+{
+        int ret;
+        unsigned int seed = 1;
+        size_t size, i, len, round;
+        prelude_string_t *str;
+        char input[MAX_SIZE], output[MAX_SIZE * 2 + 3], expected[MAX_SIZE * 2 + 3];
+        const char alphabet[] = "abcdefgh''''\\\"\n\r";
+
+        ASSERT(prelude_string_new(&str) >= 0);
+
+        for ( round = 0; round < 2000; round++ ) {
+                size = test_random(&seed) % (MAX_SIZE + 1);
+
+                for ( i = 0; i < size; i++ )
+                        input[i] = alphabet[test_random(&seed) % (sizeof(alphabet) - 1)];
+
+                if ( size && round % 10 == 0 )
+                        input[test_random(&seed) % size] = 0;
+
+                len = reference_escape(expected, input, size);
+
+                ASSERT(_preludedb_sql_escape_write(output, input, size) == len);
+                ASSERT(memcmp(output, expected, len + 1) == 0);
+
+                prelude_string_clear(str);
+
+                ret = _preludedb_sql_escape_append(str, input, size);
+                ASSERT(ret >= 0);
+                ASSERT(prelude_string_get_len(str) == len);
+                ASSERT(memcmp(prelude_string_get_string(str), expected, len) == 0);
+        }
+
+        prelude_string_destroy(str);
+}
+
+
+
+int main(void)
+{
+        test_span();
+        test_write();
+        test_random_input();
+
+        return 0;
+}
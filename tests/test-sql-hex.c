@@ -0,0 +1,163 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <libprelude/prelude.h>
+
+#include "tests.h"
+
+
+/*
+ * Sizes are chosen to cover the SIMD blocks as well as the scalar tails.
+ */
+#define MAX_SIZE 300
+
+
+void _preludedb_sql_hex_encode(char *output, const unsigned char *input, size_t size);
+int _preludedb_sql_hex_decode(unsigned char *output, const char *input, size_t size);
+int _preludedb_sql_hex_append(prelude_string_t *output, const unsigned char *input, size_t size);
+
+
+
+static void reference_encode(char *output, const unsigned char *input, size_t size)
+{
+        size_t i;
+
+        for ( i = 0; i < size; i++ )
+                snprintf(output + i * 2, 3, "%02X", input[i]);
+}
+
+
+
+static void test_encode(const unsigned char *input)
+{
+        size_t size;
+        char output[MAX_SIZE * 2 + 1], expected[MAX_SIZE * 2 + 1];
+
+        for ( size = 0; size <= MAX_SIZE; size++ ) {
+                memset(output, 0, sizeof(output));
+                reference_encode(expected, input, size);
+
+                _preludedb_sql_hex_encode(output, input, size);
+                ASSERT(memcmp(output, expected, size * 2) == 0);
+                ASSERT(output[size * 2] == 0);
+        }
+}
+
+
+
+static void test_decode(const unsigned char *input)
+{
+        size_t size, i;
+        char hex[MAX_SIZE * 2];
+        unsigned char output[MAX_SIZE];
+
+        for ( size = 0; size <= MAX_SIZE; size++ ) {
+                reference_encode(hex, input, size);
+
+                ASSERT(_preludedb_sql_hex_decode(output, hex, size * 2) == 0);
+                ASSERT(memcmp(output, input, size) == 0);
+
+                /*
+                 * Lowercase digits are accepted as well.
+                 */
+                for ( i = 0; i < size * 2; i++ )
+                        hex[i] = tolower((unsigned char) hex[i]);
+
+                ASSERT(_preludedb_sql_hex_decode(output, hex, size * 2) == 0);
+                ASSERT(memcmp(output, input, size) == 0);
+        }
+
+        ASSERT(_preludedb_sql_hex_decode(output, "ABC", 3) < 0);
+}
+
+
+
+static void test_decode_invalid(void)
+{
+        size_t i, j;
+        char hex[MAX_SIZE * 2];
+        unsigned char output[MAX_SIZE];
+        const char invalid[] = { 'G', 'g', '/', ':', '@', '`', ' ', 0, '\xff' };
+
+        memset(hex, 'a', sizeof(hex));
+
+        for ( i = 0; i < sizeof(hex); i++ ) {
+                for ( j = 0; j < sizeof(invalid); j++ ) {
+                        hex[i] = invalid[j];
+                        ASSERT(_preludedb_sql_hex_decode(output, hex, sizeof(hex)) < 0);
+                }
+
+                hex[i] = 'a';
+        }
+
+        ASSERT(_preludedb_sql_hex_decode(output, hex, sizeof(hex)) == 0);
+}
+
+
+
+static void test_append(const unsigned char *input)
+{
+        size_t size;
+        prelude_string_t *str;
+        char expected[MAX_SIZE * 2 + 1];
+
+        ASSERT(prelude_string_new(&str) >= 0);
+
+        for ( size = 0; size <= MAX_SIZE; size += 7 ) {
+                prelude_string_clear(str);
+                reference_encode(expected, input, size);
+
+                ASSERT(prelude_string_ncat(str, "X'", 2) >= 0);
+                ASSERT(_preludedb_sql_hex_append(str, input, size) == 0);
+
+                ASSERT(prelude_string_get_len(str) == size * 2 + 2);
+                ASSERT(memcmp(prelude_string_get_string(str) + 2, expected, size * 2) == 0);
+        }
+
+        prelude_string_destroy(str);
+}
+
+
+
+int main(void)
+{
+        size_t i;
+        unsigned int seed = 1;
+        unsigned char input[MAX_SIZE];
+
+        for ( i = 0; i < sizeof(input); i++ )
+                input[i] = (i < 256) ? i : test_random(&seed);
+
+        test_encode(input);
+        test_decode(input);
+        test_decode_invalid();
+        test_append(input);
+
+        return 0;
+}
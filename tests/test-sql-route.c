@@ -0,0 +1,81 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libprelude/prelude.h>
+
+#include "tests.h"
+
+
+prelude_bool_t _preludedb_sql_is_read_only(const char *query);
+
+
+static const struct {
+        const char *query;
+        prelude_bool_t read_only;
+} queries[] = {
+        { "SELECT 1", TRUE },
+        { "  select * FROM Prelude_Alert", TRUE },
+        { "SELECT COUNT(*) FROM Prelude_Alert WHERE _ident > 10;", TRUE },
+        { "SELECT 1;  \n", TRUE },
+        { "SELECT text FROM Prelude_Classification WHERE text = 'INTO the FOR loop'", TRUE },
+        { "SELECT \"for\" FROM t", TRUE },
+        { "SELECT `lock` FROM t", TRUE },
+        { "SELECT 'it\\'s FOR' FROM t", TRUE },
+        { "SELECT format_date, lockout, into_x FROM t", TRUE },
+
+        { "INSERT INTO Prelude_Alert (messageid) VALUES ('1')", FALSE },
+        { "UPDATE Prelude_Alert SET messageid = '1'", FALSE },
+        { "DELETE FROM Prelude_Alert", FALSE },
+        { "BEGIN", FALSE },
+        { "COMMIT", FALSE },
+        { "WITH x AS (DELETE FROM t RETURNING *) SELECT * FROM x", FALSE },
+        { "SELECT * FROM Prelude_Alert FOR UPDATE", FALSE },
+        { "SELECT * FROM Prelude_Alert LOCK IN SHARE MODE", FALSE },
+        { "SELECT * INTO backup FROM Prelude_Alert", FALSE },
+        { "SELECT nextval('Prelude_Alert_seq')", FALSE },
+        { "SELECT LAST_INSERT_ID()", FALSE },
+        { "SELECT last_insert_rowid()", FALSE },
+        { "SELECT pg_advisory_lock(1)", FALSE },
+        { "SELECT 1; DELETE FROM Prelude_Alert", FALSE },
+        { "SELECT 'a'; DELETE FROM Prelude_Alert", FALSE },
+};
+
+
+
+int main(void)
+{
+        size_t i;
+
+        for ( i = 0; i < sizeof(queries) / sizeof(*queries); i++ ) {
+                if ( _preludedb_sql_is_read_only(queries[i].query) != queries[i].read_only ) {
+                        fprintf(stderr, "'%s' should %sbe read only\n", queries[i].query, queries[i].read_only ? "" : "not ");
+                        return 1;
+                }
+        }
+
+        return 0;
+}
@@ -0,0 +1,54 @@
+/*****
+*
+* Copyright (C) 2016 CS-SI. All Rights Reserved.
+*
+* This file is part of the PreludeDB library.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2, or (at your option)
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*****/
+
+#ifndef _LIBPRELUDEDB_TESTS_H
+#define _LIBPRELUDEDB_TESTS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*
+ * Aborts, reporting the location of the failed check, unless @expr
+ * holds. Unlike assert(), the check is never compiled out.
+ */
+#define ASSERT(expr) do {                                                               \
+        if ( ! (expr) ) {                                                               \
+                fprintf(stderr, "%s:%d: assertion '%s' failed\n", __FILE__, __LINE__, #expr); \
+                fflush(stderr);                                                         \
+                abort();                                                                \
+        }                                                                               \
+} while (0)
+
+
+/*
+ * Small deterministic pseudo random generator, so that failures can be
+ * reproduced.
+ */
+static inline unsigned int test_random(unsigned int *seed)
+{
+        *seed = *seed * 1103515245 + 12345;
+        return (*seed >> 16) & 0x7fff;
+}
+
+
+#endif /* _LIBPRELUDEDB_TESTS_H */